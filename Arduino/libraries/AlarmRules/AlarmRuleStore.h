@@ -0,0 +1,75 @@
+#ifndef AlarmRuleStore_h
+#define AlarmRuleStore_h
+
+#include "AlarmRules.h"
+#include <RonoBoxPlatform.h>
+
+#include <LittleFS.h>
+#if RONOBOX_HAS_PREFERENCES
+  #include <Preferences.h>
+#endif
+
+// Sauvegarde des règles d'alarme, une écriture par modification reçue.
+// Support retenu selon la cible: AlarmRuleStore.
+template <bool HasNvs>
+struct AlarmRuleStorageBackend;
+
+#if RONOBOX_HAS_PREFERENCES
+// NVS: une clé binaire dans un espace de noms dédié
+class PreferencesRuleStorage : public AlarmRuleStorage {
+public:
+    bool load(AlarmRuleSet& set) override {
+        Preferences preferences;
+        preferences.begin("alarm-rules", true);
+        size_t length = preferences.getBytes("rules", &set, sizeof(set));
+        preferences.end();
+        return length == sizeof(set);
+    }
+
+    bool save(const AlarmRuleSet& set) override {
+        Preferences preferences;
+        preferences.begin("alarm-rules", false);
+        size_t length = preferences.putBytes("rules", &set, sizeof(set));
+        preferences.end();
+        return length == sizeof(set);
+    }
+};
+
+template <>
+struct AlarmRuleStorageBackend<true> {
+    typedef PreferencesRuleStorage Type;
+};
+#endif
+
+// L'EEPROM émulée appartient à ConfigStore: fichier LittleFS à la place.
+// LittleFS.begin() doit avoir été appelé par le sketch.
+class LittleFSRuleStorage : public AlarmRuleStorage {
+public:
+    bool load(AlarmRuleSet& set) override {
+        File file = LittleFS.open(PATH, "r");
+        if (!file) return false;
+        size_t length = file.read((uint8_t*)&set, sizeof(set));
+        file.close();
+        return length == sizeof(set);
+    }
+
+    bool save(const AlarmRuleSet& set) override {
+        File file = LittleFS.open(PATH, "w");
+        if (!file) return false;
+        size_t length = file.write((const uint8_t*)&set, sizeof(set));
+        file.close();
+        return length == sizeof(set);
+    }
+
+private:
+    static constexpr const char* PATH = "/alarms.bin";
+};
+
+template <>
+struct AlarmRuleStorageBackend<false> {
+    typedef LittleFSRuleStorage Type;
+};
+
+typedef AlarmRuleStorageBackend<PlatformConfig::HAS_NVS>::Type AlarmRuleStore;
+
+#endif
@@ -0,0 +1,351 @@
+#ifndef AlarmRules_h
+#define AlarmRules_h
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <ConfigStore.h>
+#include <DeviceLog.h>
+#include <stddef.h>
+
+// ALARM_ABOVE / ALARM_BELOW: la mesure franchit le seuil
+// ALARM_RISE: la mesure monte plus vite que le seuil (unités par seconde), pente
+//             mesurée sur au moins une fenêtre (1 s par défaut, voir setRiseWindow)
+enum AlarmCondition : uint8_t {
+    ALARM_ABOVE,
+    ALARM_BELOW,
+    ALARM_RISE
+};
+
+// Règle de taille fixe: elle est enregistrée telle quelle en flash
+struct AlarmRule {
+    char input[16];         // Nom de la grandeur surveillée (ex: "gaz")
+    uint8_t condition;      // AlarmCondition
+    uint8_t action;         // Code interprété par le sketch (buzzer, motif d'alerte...)
+    uint8_t enabled;
+    uint8_t reserved;
+    float threshold;
+    float hysteresis;       // Marge à repasser avant de revenir à la normale
+    uint32_t durationMs;    // Durée pendant laquelle la condition doit tenir
+};
+
+// Jeu de règles persisté, versionné et protégé par CRC32
+struct AlarmRuleSet {
+    static const uint8_t MAX_RULES = 8;
+
+    uint32_t magic;
+    uint16_t version;
+    uint8_t count;
+    uint8_t reserved;
+    AlarmRule rules[MAX_RULES];
+    uint32_t crc;           // CRC32 de tous les champs qui précèdent
+};
+
+// Support de sauvegarde des règles (voir AlarmRuleStore.h)
+class AlarmRuleStorage {
+public:
+    virtual ~AlarmRuleStorage() {}
+    virtual bool load(AlarmRuleSet& set) = 0;
+    virtual bool save(const AlarmRuleSet& set) = 0;
+};
+
+// Moteur de règles d'alarme local. Le sketch déclare les grandeurs surveillées, puis
+// appelle evaluate() juste après chaque nouvel échantillon: la réaction (buzzer,
+// indicateur) ne dépend ni du réseau ni de la période des tâches de publication.
+//
+// Une règle s'active quand sa condition tient durationMs, et ne retombe qu'une fois
+// la mesure revenue au-delà de l'hystérésis. Chaque transition appelle le callback.
+class AlarmEngine {
+public:
+    static const uint8_t MAX_RULES = AlarmRuleSet::MAX_RULES;
+    static const uint8_t MAX_INPUTS = 6;
+    static const uint32_t MAGIC = 0x4D52414C; // "LARM"
+    static const uint16_t VERSION = 1;
+    static const unsigned long RISE_WINDOW_MS = 1000;
+
+    // Place des chaînes recopiées par deserializeJson() ("input", "condition" et les clés)
+    static const size_t JSON_STRING_BUDGET = 128;
+
+    typedef void (*AlarmCallback)(uint8_t index, const AlarmRule& rule, bool active);
+
+    AlarmEngine() : inputCount(0), riseWindowMs(RISE_WINDOW_MS), storage(nullptr), callback(nullptr) {
+        ruleSet.count = 0;
+    }
+
+    // Déclare une grandeur (nom littéral, non copié). Retourne son identifiant, ou -1.
+    int addInput(const char* name) {
+        if (inputCount >= MAX_INPUTS) return -1;
+        inputs[inputCount] = InputState();
+        inputs[inputCount].name = name;
+        return inputCount++;
+    }
+
+    void onAlarm(AlarmCallback alarmCallback) {
+        callback = alarmCallback;
+    }
+
+    // Intervalle minimal sur lequel la pente ALARM_RISE est calculée. Entre deux trames
+    // ADC (10 ms), 1 LSB de bruit vaut déjà plusieurs %/s: la pente est donc prise par
+    // rapport à un échantillon vieux d'au moins cette durée (entre 1 et 2 fenêtres).
+    void setRiseWindow(unsigned long windowMs) {
+        riseWindowMs = windowMs > 0 ? windowMs : 1;
+    }
+
+    // Reprend les règles enregistrées si elles sont valides, sinon celles du sketch
+    bool begin(const AlarmRule* defaults, uint8_t count, AlarmRuleStorage* ruleStorage = nullptr) {
+        storage = ruleStorage;
+
+        AlarmRuleSet stored;
+        if (storage && storage->load(stored) && isValid(stored)) {
+            ruleSet = stored;
+            RB_LOG_INFO("[Alarme] %u règles chargées depuis la flash", ruleSet.count);
+        } else {
+            ruleSet.count = count > MAX_RULES ? MAX_RULES : count;
+            for (uint8_t i = 0; i < ruleSet.count; i++) {
+                ruleSet.rules[i] = defaults[i];
+            }
+        }
+        resolveAll();
+        return true;
+    }
+
+    void evaluate(int input, float value) {
+        evaluate(input, value, millis());
+    }
+
+    // Horloge explicite: permet de rejouer une série d'échantillons hors carte
+    void evaluate(int input, float value, unsigned long now) {
+        if (input < 0 || input >= inputCount) return;
+
+        InputState& state = inputs[input];
+        if (!state.hasReference) {
+            state.referenceValue = state.candidateValue = value;
+            state.referenceTime = state.candidateTime = now;
+            state.hasReference = true;
+        } else if (now - state.candidateTime >= riseWindowMs) {
+            // Le candidat a assez vieilli: il devient la référence, cet échantillon le remplace
+            state.referenceValue = state.candidateValue;
+            state.referenceTime = state.candidateTime;
+            state.candidateValue = value;
+            state.candidateTime = now;
+        }
+        if (now - state.referenceTime >= riseWindowMs) {
+            state.rate = (value - state.referenceValue) * 1000.0f / (now - state.referenceTime);
+        }
+
+        for (uint8_t i = 0; i < ruleSet.count; i++) {
+            if (ruleInput[i] == input) {
+                step(i, ruleSet.rules[i].condition == ALARM_RISE ? state.rate : value, now);
+            }
+        }
+    }
+
+    // Remplace la règle index, ou l'ajoute en fin de table si index == size()
+    bool setRule(uint8_t index, const AlarmRule& rule) {
+        if (index > ruleSet.count || index >= MAX_RULES) return false;
+        if (findInput(rule.input) < 0 || rule.condition > ALARM_RISE) return false;
+
+        release(index);
+        ruleSet.rules[index] = rule;
+        ruleSet.rules[index].input[sizeof(rule.input) - 1] = '\0';
+        if (index == ruleSet.count) ruleSet.count++;
+        resolveAll();
+        return save();
+    }
+
+    bool removeRule(uint8_t index) {
+        if (index >= ruleSet.count) return false;
+
+        release(index);
+        for (uint8_t i = index; i + 1 < ruleSet.count; i++) {
+            ruleSet.rules[i] = ruleSet.rules[i + 1];
+            states[i] = states[i + 1];
+        }
+        ruleSet.count--;
+        states[ruleSet.count] = RuleState();
+        resolveAll();
+        return save();
+    }
+
+    // Mise à jour depuis un message, ex:
+    //   {"rule":0,"input":"gaz","condition":"above","threshold":30,"hysteresis":3,
+    //    "duration_ms":0,"action":0,"enabled":true}
+    //   {"rule":0,"delete":true}
+    // Les champs absents gardent la valeur de la règle existante.
+    bool applyJson(const char* json, size_t length) {
+        StaticJsonDocument<JSON_OBJECT_SIZE(10) + JSON_STRING_BUDGET> doc;
+        if (deserializeJson(doc, json, length)) return false;
+
+        int index = doc["rule"] | -1;
+        if (index < 0 || index > ruleSet.count) return false;
+        if (doc["delete"] | false) return removeRule(index);
+
+        AlarmRule rule = {};
+        if (index < ruleSet.count) {
+            rule = ruleSet.rules[index];
+        } else {
+            rule.enabled = 1;
+        }
+
+        const char* input = doc["input"] | (const char*)nullptr;
+        if (input) {
+            strncpy(rule.input, input, sizeof(rule.input) - 1);
+            rule.input[sizeof(rule.input) - 1] = '\0';
+        }
+        const char* condition = doc["condition"] | (const char*)nullptr;
+        if (condition) {
+            int parsed = parseCondition(condition);
+            if (parsed < 0) return false;
+            rule.condition = parsed;
+        }
+        rule.threshold = doc["threshold"] | rule.threshold;
+        rule.hysteresis = doc["hysteresis"] | rule.hysteresis;
+        rule.durationMs = doc["duration_ms"] | rule.durationMs;
+        rule.action = doc["action"] | rule.action;
+        rule.enabled = (doc["enabled"] | (rule.enabled != 0)) ? 1 : 0;
+
+        return setRule(index, rule);
+    }
+
+    // Première règle active dans l'ordre de la table (la plus prioritaire), ou -1
+    int firstActive() const {
+        for (uint8_t i = 0; i < ruleSet.count; i++) {
+            if (states[i].active) return i;
+        }
+        return -1;
+    }
+
+    bool isActive(uint8_t index) const {
+        return index < ruleSet.count && states[index].active;
+    }
+
+    const AlarmRule& getRule(uint8_t index) const {
+        return ruleSet.rules[index];
+    }
+
+    uint8_t size() const { return ruleSet.count; }
+
+    static const char* conditionName(uint8_t condition) {
+        switch (condition) {
+            case ALARM_ABOVE: return "above";
+            case ALARM_BELOW: return "below";
+            case ALARM_RISE:  return "rise";
+            default:          return "?";
+        }
+    }
+
+private:
+    struct InputState {
+        const char* name = nullptr;
+        float rate = 0;                 // Unités par seconde depuis la référence
+        float referenceValue = 0;       // Échantillon vieux d'au moins riseWindowMs
+        unsigned long referenceTime = 0;
+        float candidateValue = 0;       // Prochaine référence
+        unsigned long candidateTime = 0;
+        bool hasReference = false;
+    };
+
+    struct RuleState {
+        bool active = false;
+        bool pending = false;           // Condition vraie, durée pas encore écoulée
+        unsigned long since = 0;
+    };
+
+    InputState inputs[MAX_INPUTS];
+    uint8_t inputCount;
+    unsigned long riseWindowMs;
+    AlarmRuleSet ruleSet;
+    RuleState states[MAX_RULES];
+    int8_t ruleInput[MAX_RULES];        // Grandeur de chaque règle, -1 si inconnue ou désactivée
+    AlarmRuleStorage* storage;
+    AlarmCallback callback;
+
+    void step(uint8_t index, float value, unsigned long now) {
+        const AlarmRule& rule = ruleSet.rules[index];
+        RuleState& state = states[index];
+
+        // NaN: aucune comparaison n'est vraie, l'état est simplement conservé
+        bool tripped, cleared;
+        if (rule.condition == ALARM_BELOW) {
+            tripped = value < rule.threshold;
+            cleared = value > rule.threshold + rule.hysteresis;
+        } else {
+            tripped = value > rule.threshold;
+            cleared = value < rule.threshold - rule.hysteresis;
+        }
+
+        if (!state.active) {
+            if (!tripped) {
+                state.pending = false;
+                return;
+            }
+            if (!state.pending) {
+                state.pending = true;
+                state.since = now;
+            }
+            if (now - state.since >= rule.durationMs) {
+                state.active = true;
+                state.pending = false;
+                if (callback) callback(index, rule, true);
+            }
+        } else if (cleared) {
+            state.active = false;
+            if (callback) callback(index, rule, false);
+        }
+    }
+
+    // Retombée d'une règle remplacée ou supprimée: le sketch coupe ce qu'elle pilotait
+    void release(uint8_t index) {
+        if (index < ruleSet.count && states[index].active) {
+            states[index].active = false;
+            if (callback) callback(index, ruleSet.rules[index], false);
+        }
+        if (index < MAX_RULES) states[index] = RuleState();
+    }
+
+    void resolveAll() {
+        for (uint8_t i = 0; i < ruleSet.count; i++) {
+            ruleInput[i] = ruleSet.rules[i].enabled ? findInput(ruleSet.rules[i].input) : -1;
+            if (ruleSet.rules[i].enabled && ruleInput[i] < 0) {
+                RB_LOG_WARN("[Alarme] Règle %u: grandeur inconnue '%s'", i, ruleSet.rules[i].input);
+            }
+        }
+    }
+
+    int findInput(const char* name) const {
+        for (uint8_t i = 0; i < inputCount; i++) {
+            if (strcmp(inputs[i].name, name) == 0) return i;
+        }
+        return -1;
+    }
+
+    static int parseCondition(const char* name) {
+        for (uint8_t i = ALARM_ABOVE; i <= ALARM_RISE; i++) {
+            if (strcmp(conditionName(i), name) == 0) return i;
+        }
+        return -1;
+    }
+
+    bool save() {
+        if (!storage) return true;
+        ruleSet.magic = MAGIC;
+        ruleSet.version = VERSION;
+        ruleSet.reserved = 0;
+        ruleSet.crc = computeCrc(ruleSet);
+        if (!storage->save(ruleSet)) {
+            RB_LOG_ERROR("[Alarme] Échec de l'enregistrement des règles");
+            return false;
+        }
+        return true;
+    }
+
+    static bool isValid(const AlarmRuleSet& set) {
+        return set.magic == MAGIC && set.version == VERSION &&
+               set.count <= MAX_RULES && set.crc == computeCrc(set);
+    }
+
+    static uint32_t computeCrc(const AlarmRuleSet& set) {
+        return ~ConfigStore::crc32((const uint8_t*)&set, offsetof(AlarmRuleSet, crc));
+    }
+};
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef AnalogAcquisition_h
+#define AnalogAcquisition_h
+
+#include <Arduino.h>
+#include <DeviceLog.h>
+#include "SignalFilter.h"
+
+// Mode continu de l'ADC (DMA) disponible à partir du core ESP32 3.x
+#if defined(ESP32) && defined(ESP_ARDUINO_VERSION_MAJOR) && ESP_ARDUINO_VERSION_MAJOR >= 3
+  #define ANALOG_ACQUISITION_CONTINUOUS
+#endif
+
+// Acquisition analogique en tâche de fond, filtrée et étalonnée par voie.
+//
+// ESP32 (core 3.x): l'ADC tourne en mode continu; le pilote moyenne `oversample`
+// conversions par voie et signale chaque trame depuis une interruption. update()
+// ne fait que passer la dernière trame dans les filtres.
+// Autres cibles: update() fait une seule conversion par voie et par milliseconde,
+// le suréchantillonnage est réparti sur les itérations de loop().
+//
+// Dans les deux cas, loop() ne fait jamais d'analogRead bloquant en rafale.
+// Une seule instance par carte: le mode continu monopolise le DMA de l'ADC.
+class AnalogAcquisition {
+public:
+    static const uint8_t MAX_CHANNELS = 4;
+
+    AnalogAcquisition() : channelCount(0), running(false), lastSample(0) {}
+
+    // Déclare une voie (avant begin()). smoothingShift: moyenne exponentielle avec
+    // alpha = 1 / 2^shift. Sans courbe, value() retourne la valeur brute filtrée.
+    // Retourne l'identifiant de la voie, ou -1 si la table est pleine.
+    int addChannel(uint8_t pin, const CalibrationPoint* curve = nullptr, uint8_t points = 0,
+                   uint8_t smoothingShift = 2) {
+        if (channelCount >= MAX_CHANNELS || running) return -1;
+        pins[channelCount] = pin;
+        channels[channelCount].configure(curve, points, smoothingShift);
+        return channelCount++;
+    }
+
+    // oversample: conversions moyennées par échantillon filtré
+    // sampleRateHz: fréquence totale de conversion en mode continu (ESP32: 20 kHz minimum)
+    bool begin(uint8_t oversample = 64, uint32_t sampleRateHz = 20000) {
+        if (channelCount == 0) return false;
+
+        #ifdef ANALOG_ACQUISITION_CONTINUOUS
+            frameReady = false;
+            if (!analogContinuous(pins, channelCount, oversample, sampleRateHz, &onFrame)) {
+                RB_LOG_ERROR("[ADC] Échec de configuration du mode continu");
+                return false;
+            }
+            running = analogContinuousStart();
+        #else
+            (void)sampleRateHz;
+            for (uint8_t i = 0; i < channelCount; i++) {
+                oversamplers[i] = Oversampler(oversample);
+            }
+            running = true;
+        #endif
+        return running;
+    }
+
+    void end() {
+        #ifdef ANALOG_ACQUISITION_CONTINUOUS
+            if (running) {
+                analogContinuousStop();
+                analogContinuousDeinit();
+            }
+        #endif
+        running = false;
+    }
+
+    // À appeler à chaque loop(): ne bloque jamais
+    void update() {
+        if (!running) return;
+
+        #ifdef ANALOG_ACQUISITION_CONTINUOUS
+            if (!frameReady) return;
+            frameReady = false;
+
+            adc_continuous_data_t* result = nullptr;
+            if (!analogContinuousRead(&result, 0)) return;
+            // Une entrée par broche, dans l'ordre passé à analogContinuous()
+            for (uint8_t i = 0; i < channelCount; i++) {
+                channels[i].push(result[i].avg_read_raw);
+            }
+        #else
+            unsigned long now = millis();
+            if (now == lastSample) return;
+            lastSample = now;
+
+            for (uint8_t i = 0; i < channelCount; i++) {
+                if (oversamplers[i].push(analogRead(pins[i]))) {
+                    channels[i].push(oversamplers[i].value());
+                }
+            }
+        #endif
+    }
+
+    // Grandeur étalonnée de la voie (0 tant qu'aucun échantillon n'a été reçu)
+    float value(int id) const {
+        return isValid(id) ? channels[id].value() : 0;
+    }
+
+    uint16_t raw(int id) const {
+        return isValid(id) ? channels[id].raw() : 0;
+    }
+
+    // Vrai une fois la fenêtre de la médiane remplie
+    bool ready(int id) const {
+        return isValid(id) && channels[id].ready();
+    }
+
+    uint32_t sampleCount(int id) const {
+        return isValid(id) ? channels[id].sampleCount() : 0;
+    }
+
+private:
+    uint8_t pins[MAX_CHANNELS];
+    AnalogFilterChain channels[MAX_CHANNELS];
+    uint8_t channelCount;
+    bool running;
+    unsigned long lastSample;
+
+    #ifdef ANALOG_ACQUISITION_CONTINUOUS
+        static inline volatile bool frameReady = false;
+
+        // Fin de trame DMA: simple drapeau, le traitement se fait dans update()
+        static void ARDUINO_ISR_ATTR onFrame() {
+            frameReady = true;
+        }
+    #else
+        Oversampler oversamplers[MAX_CHANNELS];
+    #endif
+
+    bool isValid(int id) const {
+        return id >= 0 && id < channelCount;
+    }
+};
+
+#endif
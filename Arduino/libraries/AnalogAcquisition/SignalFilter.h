@@ -0,0 +1,173 @@
+#ifndef SignalFilter_h
+#define SignalFilter_h
+
+#include <stdint.h>
+#include <string.h>
+
+// Étage de filtrage des mesures analogiques, sans dépendance à la cible:
+// il se compile aussi hors carte pour rejouer des traces enregistrées.
+
+// Calibration: point relevé (valeur brute de l'ADC → grandeur physique)
+struct CalibrationPoint {
+    uint16_t raw;
+    float value;
+};
+
+// Moyenne de `factor` conversions consécutives (suréchantillonnage)
+class Oversampler {
+public:
+    Oversampler(uint8_t oversampleFactor = 16) : factor(oversampleFactor ? oversampleFactor : 1), sum(0), count(0), average(0) {}
+
+    // Retourne true quand une moyenne complète est disponible dans value()
+    bool push(uint16_t sample) {
+        sum += sample;
+        if (++count < factor) return false;
+        average = (sum + factor / 2) / factor;
+        sum = 0;
+        count = 0;
+        return true;
+    }
+
+    uint16_t value() const { return average; }
+
+private:
+    uint8_t factor;
+    uint32_t sum;
+    uint8_t count;
+    uint16_t average;
+};
+
+// Médiane glissante sur N échantillons (N impair): élimine les pointes isolées
+template <uint8_t N>
+class MedianFilter {
+public:
+    MedianFilter() : count(0), next(0) {}
+
+    uint16_t push(uint16_t sample) {
+        window[next] = sample;
+        next = (next + 1) % N;
+        if (count < N) count++;
+
+        // Tri par insertion d'une copie: N est petit, pas d'allocation
+        uint16_t sorted[N];
+        for (uint8_t i = 0; i < count; i++) {
+            uint16_t value = window[i];
+            uint8_t j = i;
+            while (j > 0 && sorted[j - 1] > value) {
+                sorted[j] = sorted[j - 1];
+                j--;
+            }
+            sorted[j] = value;
+        }
+        return sorted[count / 2];
+    }
+
+    void reset() {
+        count = 0;
+        next = 0;
+    }
+
+private:
+    uint16_t window[N];
+    uint8_t count;
+    uint8_t next;
+};
+
+// Moyenne exponentielle en virgule fixe (8 bits de fraction), alpha = 1 / 2^shift
+class EmaFilter {
+public:
+    EmaFilter(uint8_t smoothingShift = 2) : shift(smoothingShift), state(0), primed(false) {}
+
+    void setShift(uint8_t smoothingShift) { shift = smoothingShift; }
+
+    uint16_t push(uint16_t sample) {
+        int32_t scaled = (int32_t)sample << 8;
+        if (!primed) {
+            state = scaled;   // Le premier échantillon initialise le filtre (pas de rampe depuis 0)
+            primed = true;
+        } else {
+            state += (scaled - state) >> shift;
+        }
+        return value();
+    }
+
+    uint16_t value() const { return (uint16_t)((state + 0x80) >> 8); }
+
+    void reset() { primed = false; }
+
+private:
+    uint8_t shift;
+    int32_t state;
+    bool primed;
+};
+
+// Courbe d'étalonnage par segments: interpolation linéaire entre des points triés
+// par valeur brute croissante, bornée aux extrémités. Remplace map(x, 0, 4095, 0, 100).
+class CalibrationCurve {
+public:
+    // Les points doivent rester valides (tableau global ou constant): ils ne sont pas copiés
+    CalibrationCurve(const CalibrationPoint* curvePoints = nullptr, uint8_t pointCount = 0)
+        : points(curvePoints), count(pointCount) {}
+
+    float apply(uint16_t raw) const {
+        if (count == 0) return raw;
+        if (raw <= points[0].raw) return points[0].value;
+
+        for (uint8_t i = 1; i < count; i++) {
+            if (raw <= points[i].raw) {
+                const CalibrationPoint& a = points[i - 1];
+                const CalibrationPoint& b = points[i];
+                return a.value + (b.value - a.value) * (float)(raw - a.raw) / (float)(b.raw - a.raw);
+            }
+        }
+        return points[count - 1].value;
+    }
+
+private:
+    const CalibrationPoint* points;
+    uint8_t count;
+};
+
+// Chaîne d'une voie: médiane → moyenne exponentielle → étalonnage.
+// Les échantillons reçus sont déjà suréchantillonnés.
+class AnalogFilterChain {
+public:
+    static const uint8_t MEDIAN_WINDOW = 5;
+
+    AnalogFilterChain() : filtered(0), samples(0) {}
+
+    void configure(const CalibrationPoint* points, uint8_t pointCount, uint8_t smoothingShift) {
+        curve = CalibrationCurve(points, pointCount);
+        ema.setShift(smoothingShift);
+        reset();
+    }
+
+    void push(uint16_t sample) {
+        filtered = ema.push(median.push(sample));
+        samples++;
+    }
+
+    // Valeur brute filtrée et grandeur étalonnée
+    uint16_t raw() const { return filtered; }
+    float value() const { return curve.apply(filtered); }
+
+    // La médiane n'est significative qu'une fois sa fenêtre remplie
+    bool ready() const { return samples >= MEDIAN_WINDOW; }
+    uint32_t sampleCount() const { return samples; }
+
+    void reset() {
+        median.reset();
+        ema.reset();
+        filtered = 0;
+        samples = 0;
+    }
+
+private:
+    MedianFilter<MEDIAN_WINDOW> median;
+    EmaFilter ema;
+    CalibrationCurve curve;
+    uint16_t filtered;
+    uint32_t samples;
+};
+
+#endif
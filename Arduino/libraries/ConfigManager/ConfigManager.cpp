@@ -1,43 +1,67 @@
 // ConfigManager.cpp
 #include "ConfigManager.h"
+#include <PortalPage.h>
+#include <DeviceLog.h>
 
-ConfigManager::ConfigManager() : server(80) {}
+ConfigManager::ConfigManager() : server(80), store(storage) {}
 
 bool ConfigManager::begin() {
-  #ifdef ESP32
-    preferences.begin("smart-home", false);
-  #else
-    EEPROM.begin(512);
-  #endif
-
+  store.begin();
   loadConfiguration();
 
   if (config.wifiSSID.length() > 0) {
     WiFi.mode(WIFI_STA);
     WiFi.begin(config.wifiSSID.c_str(), config.wifiPassword.c_str());
-    
-    Serial.print("Connexion WiFi");
-    unsigned long startTime = millis();
-    
-    while (WiFi.status() != WL_CONNECTED && millis() - startTime < 20000) {
-      delay(500);
-      Serial.print(".");
-    }
-    
-    if (WiFi.status() == WL_CONNECTED) {
-      Serial.println("\nConnecté!");
-      Serial.print("IP: ");
-      Serial.println(WiFi.localIP());
-      return true;
-    }
-    
-    Serial.println("\nÉchec de connexion WiFi");
+
+    RB_LOG_INFO("Connexion WiFi...");
+    connectStart = millis();
+    setState(PROV_CONNECTING);
+    return true;
   }
 
   startAP();
   return false;
 }
 
+// Une étape du provisionnement, appelée à chaque handleClient(): jamais d'attente
+void ConfigManager::updateProvisioning() {
+  if (state != PROV_CONNECTING) return;
+
+  if (WiFi.status() == WL_CONNECTED) {
+    RB_LOG_INFO("Connecté! IP: %s", WiFi.localIP().toString().c_str());
+    setState(PROV_CONNECTED);
+  } else if (millis() - connectStart >= CONNECT_TIMEOUT) {
+    RB_LOG_WARN("Échec de connexion WiFi");
+    setState(PROV_TIMEOUT);
+    startAP();
+  }
+}
+
+void ConfigManager::setState(ProvisioningState newState) {
+  if (newState == state) return;
+  state = newState;
+  if (stateCallback) stateCallback(newState);
+}
+
+void ConfigManager::onStateChange(ProvisioningCallback callback) {
+  stateCallback = callback;
+}
+
+ProvisioningState ConfigManager::getState() const {
+  return state;
+}
+
+const char* ConfigManager::stateName(ProvisioningState state) {
+  switch (state) {
+    case PROV_IDLE:       return "IDLE";
+    case PROV_CONNECTING: return "CONNECTING";
+    case PROV_CONNECTED:  return "CONNECTED";
+    case PROV_TIMEOUT:    return "TIMEOUT";
+    case PROV_AP_MODE:    return "AP_MODE";
+  }
+  return "?";
+}
+
 bool ConfigManager::isConfigured() {
   return WiFi.status() == WL_CONNECTED;
 }
@@ -48,6 +72,7 @@ NetworkConfig ConfigManager::getConfig() {
 
 void ConfigManager::setupServer() {
   server.on("/", HTTP_GET, [this]() { handleRoot(); });
+  server.on("/style.css", HTTP_GET, [this]() { PortalPage<PlatformWebServer>::sendStyle(server); });
   server.on("/save", HTTP_POST, [this]() { handleSave(); });
   server.on("/reset", HTTP_POST, [this]() { handleReset(); });
   server.onNotFound([this]() { handleNotFound(); });
@@ -62,14 +87,13 @@ void ConfigManager::startAP() {
   dnsServer.start(53, "*", AP_IP);
   setupServer();
   
-  Serial.println("\nMode AP activé");
-  Serial.print("SSID: ");
-  Serial.println(AP_SSID);
-  Serial.print("IP: ");
-  Serial.println(WiFi.softAPIP());
+  RB_LOG_INFO("Mode AP activé, SSID: %s, IP: %s", AP_SSID, WiFi.softAPIP().toString().c_str());
+  setState(PROV_AP_MODE);
 }
 
 void ConfigManager::handleClient() {
+  updateProvisioning();
+
   if (apMode) {
     dnsServer.processNextRequest();
     server.handleClient();
@@ -77,109 +101,55 @@ void ConfigManager::handleClient() {
 }
 
 void ConfigManager::loadConfiguration() {
-  #ifdef ESP32
-    config.wifiSSID = preferences.getString("wifi_ssid", "");
-    config.wifiPassword = preferences.getString("wifi_pass", "");
-    config.mqttServer = preferences.getString("mqtt_server", "");
-    config.mqttPort = preferences.getInt("mqtt_port", 1883);
-    config.mqttUser = preferences.getString("mqtt_user", "");
-    config.mqttPassword = preferences.getString("mqtt_pass", "");
-  #else
-    config.wifiSSID = readStringFromEEPROM(0);
-    config.wifiPassword = readStringFromEEPROM(50);
-    config.mqttServer = readStringFromEEPROM(100);
-    
-    int portHigh = EEPROM.read(150);
-    int portLow = EEPROM.read(151);
-    config.mqttPort = (portHigh << 8) | portLow;
-    if (config.mqttPort < 1 || config.mqttPort > 65535) {
-      config.mqttPort = 1883;
-    }
-    
-    config.mqttUser = readStringFromEEPROM(152);
-    config.mqttPassword = readStringFromEEPROM(202);
-  #endif
+  // Pas d'enregistrement valide: reprise de l'ancien format (remplacé au premier save)
+  ConfigRecord record;
+  if (store.load(record) || storage.readLegacy(record)) {
+    config.wifiSSID = record.wifiSSID;
+    config.wifiPassword = record.wifiPassword;
+    config.mqttServer = record.mqttServer;
+    config.mqttPort = record.mqttPort;
+    config.mqttUser = record.mqttUser;
+    config.mqttPassword = record.mqttPassword;
+  }
+
+  if (config.mqttPort < 1 || config.mqttPort > 65535) {
+    config.mqttPort = 1883;
+  }
 
-  // Debug
-  Serial.println("=== Configuration chargée ===");
-  Serial.print("SSID: "); Serial.println(config.wifiSSID);
-  Serial.print("MQTT Server: "); Serial.println(config.mqttServer);
+  RB_LOG_INFO("Configuration chargée, SSID: %s, serveur MQTT: %s",
+              config.wifiSSID.c_str(), config.mqttServer.c_str());
 }
 
 void ConfigManager::saveConfiguration() {
-  #ifdef ESP32
-    preferences.putString("wifi_ssid", config.wifiSSID);
-    preferences.putString("wifi_pass", config.wifiPassword);
-    preferences.putString("mqtt_server", config.mqttServer);
-    preferences.putInt("mqtt_port", config.mqttPort);
-    preferences.putString("mqtt_user", config.mqttUser);
-    preferences.putString("mqtt_pass", config.mqttPassword);
-  #else
-    writeStringToEEPROM(0, config.wifiSSID);
-    writeStringToEEPROM(50, config.wifiPassword);
-    writeStringToEEPROM(100, config.mqttServer);
-    EEPROM.write(150, (config.mqttPort >> 8) & 0xFF);
-    EEPROM.write(151, config.mqttPort & 0xFF);
-    writeStringToEEPROM(152, config.mqttUser);
-    writeStringToEEPROM(202, config.mqttPassword);
-    EEPROM.commit();
-  #endif
+  ConfigRecord record;
+  memset(&record, 0, sizeof(record));
+  ConfigStore::copyField(record.wifiSSID, sizeof(record.wifiSSID), config.wifiSSID.c_str());
+  ConfigStore::copyField(record.wifiPassword, sizeof(record.wifiPassword), config.wifiPassword.c_str());
+  ConfigStore::copyField(record.mqttServer, sizeof(record.mqttServer), config.mqttServer.c_str());
+  ConfigStore::copyField(record.mqttUser, sizeof(record.mqttUser), config.mqttUser.c_str());
+  ConfigStore::copyField(record.mqttPassword, sizeof(record.mqttPassword), config.mqttPassword.c_str());
+  record.mqttPort = config.mqttPort;
+
+  // Une seule écriture: un putBytes NVS ou un EEPROM.commit() selon la plateforme
+  if (!store.save(record)) {
+    RB_LOG_ERROR("Échec de la sauvegarde de la configuration");
+  }
 }
 
 void ConfigManager::resetConfiguration() {
-  #ifdef ESP32
-    preferences.clear();
-  #else
-    for (int i = 0; i < 512; i++) {
-      EEPROM.write(i, 0xFF);
-    }
-    EEPROM.commit();
-  #endif
+  store.clear();
   config = NetworkConfig();
 }
 
-#ifdef ESP8266
-void ConfigManager::writeStringToEEPROM(int addr, const String &str) {
-  int len = str.length();
-  EEPROM.write(addr, len);
-  for (int i = 0; i < len; i++) {
-    EEPROM.write(addr + 1 + i, str[i]);
-  }
-}
-
-String ConfigManager::readStringFromEEPROM(int addr) {
-  int len = EEPROM.read(addr);
-  if (len <= 0 || len > 100) return "";
-  
-  char data[101];
-  for (int i = 0; i < len; i++) {
-    data[i] = EEPROM.read(addr + 1 + i);
-  }
-  data[len] = '\0';
-  return String(data);
-}
-#endif
-
-
-void ConfigManager::handleRoot() {
-  String html = R"=====(
+// Page de configuration, gardée en flash; {{n}} = valeurs échappées au rendu
+static const char CONFIG_PAGE[] PROGMEM = R"=====(
   <!DOCTYPE html>
   <html>
   <head>
     <meta charset="UTF-8">
     <title>Configuration SmartHome</title>
     <meta name="viewport" content="width=device-width, initial-scale=1">
-    <style>
-      body { font-family: Arial; margin: 20px; }
-      .container { max-width: 500px; margin: 0 auto; }
-      .form-group { margin-bottom: 15px; }
-      label { display: block; margin-bottom: 5px; }
-      input { width: 100%; padding: 8px; box-sizing: border-box; }
-      button { background: #4CAF50; color: white; padding: 10px 15px; border: none; width: 100%; }
-      .reset-btn { background: #f44336; margin-top: 20px; }
-      .form-section { background: #f9f9f9; padding: 15px; border-radius: 5px; margin-bottom: 20px; }
-      h2 { margin-top: 0; color: #333; }
-    </style>
+    <link rel="stylesheet" href="/style.css">
   </head>
   <body>
     <div class="container">
@@ -190,16 +160,12 @@ void ConfigManager::handleRoot() {
         <form action="/save" method="post">
           <div class="form-group">
             <label for="ssid">SSID WiFi:</label>
-            <input type="text" id="ssid" name="ssid" required value=")=====";
-  html += config.wifiSSID;
-  html += R"=====(">
+            <input type="text" id="ssid" name="ssid" required value="{{0}}">
           </div>
           
           <div class="form-group">
             <label for="pass">Mot de passe WiFi:</label>
-            <input type="password" id="pass" name="pass" value=")=====";
-  html += config.wifiPassword;
-  html += R"=====(">
+            <input type="password" id="pass" name="pass" value="{{1}}">
           </div>
       </div>
       
@@ -207,16 +173,12 @@ void ConfigManager::handleRoot() {
           
           <div class="form-group">
             <label for="muser">Utilisateur MQTT:</label>
-            <input type="text" id="muser" name="muser" value=")=====";
-  html += config.mqttUser;
-  html += R"=====(">
+            <input type="text" id="muser" name="muser" value="{{2}}">
           </div>
           
           <div class="form-group">
             <label for="mpass">Mot de passe MQTT:</label>
-            <input type="password" id="mpass" name="mpass" value=")=====";
-  html += config.mqttPassword;
-  html += R"=====(">
+            <input type="password" id="mpass" name="mpass" value="{{3}}">
           </div>
           
           <button type="submit">Enregistrer</button>
@@ -235,9 +197,26 @@ void ConfigManager::handleRoot() {
   </html>
   )=====";
 
-  server.send(200, "text/html", html);
+void ConfigManager::handleRoot() {
+  const char* values[] = {
+    config.wifiSSID.c_str(),
+    config.wifiPassword.c_str(),
+    config.mqttUser.c_str(),
+    config.mqttPassword.c_str()
+  };
+
+  PortalPage<PlatformWebServer> page(server);
+  page.begin();
+  page.render(CONFIG_PAGE, values, sizeof(values) / sizeof(values[0]));
+  page.end();
 }
 
+static const char SAVED_PAGE[] PROGMEM =
+  "<!DOCTYPE html><html><head><meta http-equiv='refresh' charset='UTF-8' content='10;url=/'></head><body>"
+  "<h1>Configuration sauvegardée!</h1>"
+  "<p>Redémarrage dans 10 secondes...</p>"
+  "</body></html>";
+
 void ConfigManager::handleSave() {
   config.wifiSSID = server.arg("ssid");
   config.wifiPassword = server.arg("pass");
@@ -248,25 +227,21 @@ void ConfigManager::handleSave() {
   
   saveConfiguration();
   
-  String html = "<!DOCTYPE html><html><head><meta http-equiv='refresh' charset='UTF-8' content='10;url=/'></head><body>";
-  html += "<h1>Configuration sauvegardée!</h1>";
-  html += "<p>Redémarrage dans 10 secondes...</p>";
-  html += "</body></html>";
-  
-  server.send(200, "text/html", html);
+  server.send_P(200, "text/html", SAVED_PAGE);
   delay(1000);
   ESP.restart();
 }
 
+static const char RESET_PAGE[] PROGMEM =
+  "<!DOCTYPE html><html><head><meta http-equiv='refresh' content='10;url=/'></head><body>"
+  "<h1>Configuration réinitialisée!</h1>"
+  "<p>Redémarrage dans 10 secondes...</p>"
+  "</body></html>";
+
 void ConfigManager::handleReset() {
   resetConfiguration();
   
-  String html = "<!DOCTYPE html><html><head><meta http-equiv='refresh' content='10;url=/'></head><body>";
-  html += "<h1>Configuration réinitialisée!</h1>";
-  html += "<p>Redémarrage dans 10 secondes...</p>";
-  html += "</body></html>";
-  
-  server.send(200, "text/html", html);
+  server.send_P(200, "text/html", RESET_PAGE);
   delay(1000);
   ESP.restart();
 }
@@ -276,5 +251,3 @@ void ConfigManager::handleNotFound() {
   server.sendHeader("Location", "/", true);
   server.send(302, "text/plain", "");
 }
-
-// [Les méthodes handleRoot, handleSave, handleNotFound restent identiques à la version ESP32]
\ No newline at end of file
@@ -4,18 +4,9 @@
 
 #include <Arduino.h>
 #include <DNSServer.h>
-
-#ifdef ESP32
-  #include <Preferences.h>
-  #include <WiFi.h>
-  #include <WebServer.h>
-  #define WEBSERVER_TYPE WebServer
-#else // ESP8266
-  #include <EEPROM.h>
-  #include <ESP8266WiFi.h>
-  #include <ESP8266WebServer.h>
-  #define WEBSERVER_TYPE ESP8266WebServer
-#endif
+#include <RonoBoxPlatform.h>
+#include <ConfigStore.h>
+#include <PortalPage.h>
 
 struct NetworkConfig {
   String wifiSSID;
@@ -26,13 +17,29 @@ struct NetworkConfig {
   String mqttPassword;
 };
 
+// Étapes du provisionnement WiFi au démarrage
+enum ProvisioningState {
+  PROV_IDLE,
+  PROV_CONNECTING,   // Association en cours: begin() a déjà rendu la main
+  PROV_CONNECTED,
+  PROV_TIMEOUT,      // Pas d'association dans le délai imparti
+  PROV_AP_MODE       // Portail de configuration actif
+};
+
 class ConfigManager {
 public:
+    typedef void (*ProvisioningCallback)(ProvisioningState state);
+
     ConfigManager();
+    // Lance l'association WiFi (ou le portail) et rend la main immédiatement;
+    // la suite est menée par handleClient(). Retourne false si le portail est ouvert.
     bool begin();
     bool isConfigured();
     NetworkConfig getConfig();
     void handleClient();
+    void onStateChange(ProvisioningCallback callback);
+    ProvisioningState getState() const;
+    static const char* stateName(ProvisioningState state);
     void resetConfiguration();
 
 private:
@@ -40,25 +47,25 @@ private:
     void loadConfiguration();
     void saveConfiguration();
     void setupServer();
+    void updateProvisioning();
+    void setState(ProvisioningState newState);
     void handleRoot();
     void handleSave();
     void handleNotFound();
     void handleReset();
 
 
-    #ifdef ESP8266
-        void writeStringToEEPROM(int addr, const String &str);
-        String readStringFromEEPROM(int addr);
-    #endif
-
     NetworkConfig config;
     bool apMode = false;
-    WEBSERVER_TYPE server;  // Changed from WebServer to WEBSERVER_TYPE
+    ProvisioningState state = PROV_IDLE;
+    ProvisioningCallback stateCallback = nullptr;
+    unsigned long connectStart = 0;
+    static const unsigned long CONNECT_TIMEOUT = 20000; // 20s max
+    PlatformWebServer server;
     DNSServer dnsServer;
 
-    #ifdef ESP32
-        Preferences preferences;
-    #endif
+    PlatformConfigStorage storage;  // NVS ou EEPROM émulée, selon PlatformConfig::HAS_NVS
+    ConfigStore store;
 
     const char* AP_SSID = "SmartHome-Config";
     const char* AP_PASSWORD = "configureme";
@@ -0,0 +1,257 @@
+#ifndef ConfigStore_h
+#define ConfigStore_h
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <RonoBoxPlatform.h>
+#include <string.h>
+
+#include <EEPROM.h>
+#if RONOBOX_HAS_PREFERENCES
+  #include <Preferences.h>
+#endif
+
+// Configuration réseau sous forme binaire de taille fixe, versionnée et protégée par CRC32
+struct ConfigRecord {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;          // sizeof(ConfigRecord): détecte un changement de format
+    uint32_t sequence;      // Incrémenté à chaque sauvegarde: l'emplacement le plus récent gagne
+    char wifiSSID[33];
+    char wifiPassword[65];
+    char mqttServer[64];
+    char mqttUser[33];
+    char mqttPassword[65];
+    uint16_t mqttPort;
+    uint32_t crc;           // CRC32 de tous les champs qui précèdent
+};
+
+// Support physique: deux emplacements de la taille d'un ConfigRecord
+class ConfigStorage {
+public:
+    virtual ~ConfigStorage() {}
+    virtual bool begin() = 0;
+    virtual bool read(uint8_t slot, ConfigRecord& record) = 0;
+    virtual bool write(uint8_t slot, const ConfigRecord& record) = 0;  // Une seule écriture flash
+    virtual bool erase() = 0;
+};
+
+// Support retenu selon la cible: PlatformConfigStorage.
+// Chaque support sait aussi relire l'ancien format (readLegacy), d'avant ConfigRecord.
+template <bool HasNvs>
+struct ConfigStorageBackend;
+
+// Copie tronquée et toujours terminée par '\0' (voir ConfigStore::copyField)
+inline void copyConfigField(char* field, size_t size, const char* value) {
+    strncpy(field, value, size - 1);
+    field[size - 1] = '\0';
+}
+
+#if RONOBOX_HAS_PREFERENCES
+// NVS: chaque emplacement est une clé binaire, NVS gère lui-même l'usure
+class PreferencesStorage : public ConfigStorage {
+public:
+    bool begin() override {
+        return preferences.begin("smart-home", false);
+    }
+
+    bool read(uint8_t slot, ConfigRecord& record) override {
+        return preferences.getBytes(slotKey(slot), &record, sizeof(record)) == sizeof(record);
+    }
+
+    bool write(uint8_t slot, const ConfigRecord& record) override {
+        return preferences.putBytes(slotKey(slot), &record, sizeof(record)) == sizeof(record);
+    }
+
+    bool erase() override {
+        return preferences.clear();
+    }
+
+    // Ancien format: une clé NVS par champ. false si aucune n'existe.
+    bool readLegacy(ConfigRecord& record) {
+        memset(&record, 0, sizeof(record));
+        if (!preferences.isKey("wifi_ssid") && !preferences.isKey("mqtt_server")) return false;
+        readString("wifi_ssid", record.wifiSSID, sizeof(record.wifiSSID));
+        readString("wifi_pass", record.wifiPassword, sizeof(record.wifiPassword));
+        readString("mqtt_server", record.mqttServer, sizeof(record.mqttServer));
+        record.mqttPort = preferences.getInt("mqtt_port", 1883);
+        readString("mqtt_user", record.mqttUser, sizeof(record.mqttUser));
+        readString("mqtt_pass", record.mqttPassword, sizeof(record.mqttPassword));
+        return true;
+    }
+
+private:
+    Preferences preferences;
+
+    void readString(const char* key, char* field, size_t size) {
+        copyConfigField(field, size, preferences.getString(key, "").c_str());
+    }
+
+    static const char* slotKey(uint8_t slot) {
+        return slot == 0 ? "cfg0" : "cfg1";
+    }
+};
+
+template <>
+struct ConfigStorageBackend<true> {
+    typedef PreferencesStorage Type;
+};
+#endif
+
+// EEPROM émulée: les deux emplacements se suivent, un seul commit par sauvegarde
+class EepromStorage : public ConfigStorage {
+public:
+    static const size_t SIZE = 2 * sizeof(ConfigRecord) < 512 ? 512 : 2 * sizeof(ConfigRecord);
+
+    bool begin() override {
+        EEPROM.begin(SIZE);
+        return true;
+    }
+
+    bool read(uint8_t slot, ConfigRecord& record) override {
+        EEPROM.get(slot * sizeof(ConfigRecord), record);
+        return true;
+    }
+
+    bool write(uint8_t slot, const ConfigRecord& record) override {
+        EEPROM.put(slot * sizeof(ConfigRecord), record);
+        return EEPROM.commit();
+    }
+
+    bool erase() override {
+        for (size_t i = 0; i < SIZE; i++) {
+            EEPROM.write(i, 0xFF);
+        }
+        return EEPROM.commit();
+    }
+
+    // Ancien format: chaînes préfixées par leur longueur à des adresses fixes, port
+    // sur deux octets (poids fort d'abord). À appeler après begin().
+    bool readLegacy(ConfigRecord& record) {
+        memset(&record, 0, sizeof(record));
+        readString(0, record.wifiSSID, sizeof(record.wifiSSID));
+        readString(50, record.wifiPassword, sizeof(record.wifiPassword));
+        readString(100, record.mqttServer, sizeof(record.mqttServer));
+        record.mqttPort = (EEPROM.read(150) << 8) | EEPROM.read(151);
+        readString(152, record.mqttUser, sizeof(record.mqttUser));
+        readString(202, record.mqttPassword, sizeof(record.mqttPassword));
+        return record.wifiSSID[0] != '\0' || record.mqttServer[0] != '\0';
+    }
+
+private:
+    static void readString(int address, char* field, size_t size) {
+        int length = EEPROM.read(address);
+        if (length <= 0 || length > 100) return;
+
+        char data[101];
+        for (int i = 0; i < length; i++) {
+            data[i] = EEPROM.read(address + 1 + i);
+        }
+        data[length] = '\0';
+        copyConfigField(field, size, data);
+    }
+};
+
+template <>
+struct ConfigStorageBackend<false> {
+    typedef EepromStorage Type;
+};
+
+typedef ConfigStorageBackend<PlatformConfig::HAS_NVS>::Type PlatformConfigStorage;
+
+// Sauvegarde A/B: on écrit toujours dans l'emplacement inactif, la configuration
+// précédente reste donc valide tant que la nouvelle n'est pas entièrement écrite
+class ConfigStore {
+public:
+    static const uint32_t MAGIC = 0x58424F52; // "RBOX"
+    static const uint16_t VERSION = 1;
+
+    ConfigStore(ConfigStorage& configStorage)
+        : storage(configStorage), activeSlot(1), sequence(0) {}
+
+    bool begin() {
+        return storage.begin();
+    }
+
+    // Lit les deux emplacements et retient le plus récent dont le CRC est valide
+    bool load(ConfigRecord& record) {
+        ConfigRecord slots[2];
+        bool valid[2];
+        for (uint8_t i = 0; i < 2; i++) {
+            valid[i] = storage.read(i, slots[i]) && isValid(slots[i]);
+        }
+
+        int8_t best = -1;
+        if (valid[0] && valid[1]) {
+            best = (int32_t)(slots[1].sequence - slots[0].sequence) > 0 ? 1 : 0;
+        } else if (valid[0]) {
+            best = 0;
+        } else if (valid[1]) {
+            best = 1;
+        }
+
+        if (best < 0) {
+            return false;
+        }
+
+        record = slots[best];
+        activeSlot = best;
+        sequence = record.sequence;
+        return true;
+    }
+
+    bool save(ConfigRecord& record) {
+        uint8_t target = activeSlot ^ 1;
+        record.magic = MAGIC;
+        record.version = VERSION;
+        record.size = sizeof(ConfigRecord);
+        record.sequence = sequence + 1;
+        record.crc = computeCrc(record);
+
+        if (!storage.write(target, record)) {
+            return false;
+        }
+        activeSlot = target;
+        sequence = record.sequence;
+        return true;
+    }
+
+    bool clear() {
+        activeSlot = 1;
+        sequence = 0;
+        return storage.erase();
+    }
+
+    // Copie tronquée et toujours terminée par '\0' d'une valeur dans un champ du record
+    static void copyField(char* field, size_t size, const char* value) {
+        copyConfigField(field, size, value);
+    }
+
+    static uint32_t crc32(const uint8_t* data, size_t length, uint32_t crc = 0xFFFFFFFF) {
+        for (size_t i = 0; i < length; i++) {
+            crc ^= data[i];
+            for (uint8_t bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+            }
+        }
+        return crc;
+    }
+
+private:
+    ConfigStorage& storage;
+    uint8_t activeSlot;
+    uint32_t sequence;
+
+    static uint32_t computeCrc(const ConfigRecord& record) {
+        return ~crc32((const uint8_t*)&record, offsetof(ConfigRecord, crc));
+    }
+
+    static bool isValid(const ConfigRecord& record) {
+        return record.magic == MAGIC &&
+               record.version == VERSION &&
+               record.size == sizeof(ConfigRecord) &&
+               record.crc == computeCrc(record);
+    }
+};
+
+#endif
@@ -0,0 +1,230 @@
+#ifndef ConnectionStateMachine_h
+#define ConnectionStateMachine_h
+
+#include <Arduino.h>
+
+// Backoff exponentiel avec gigue ("equal jitter"): la moitié du délai est fixe,
+// l'autre moitié aléatoire, pour désynchroniser les modules après une coupure commune
+class ReconnectBackoff {
+public:
+    ReconnectBackoff(unsigned long baseDelayMs, unsigned long maxDelayMs)
+        : baseDelay(baseDelayMs), maxDelay(maxDelayMs), attempts(0) {}
+
+    // Délai avant la prochaine tentative, puis doublement du délai de base
+    unsigned long nextDelay() {
+        unsigned long delayMs = baseDelay;
+        for (uint8_t i = 0; i < attempts && delayMs < maxDelay; i++) {
+            delayMs *= 2;
+        }
+        if (delayMs > maxDelay) delayMs = maxDelay;
+        if (attempts < 255) attempts++;
+
+        unsigned long half = delayMs / 2;
+        return half + (unsigned long)random(0, (long)(delayMs - half) + 1);
+    }
+
+    // Premier essai après une perte: étalé aléatoirement sur le délai de base
+    unsigned long initialDelay() const {
+        return (unsigned long)random(0, (long)baseDelay + 1);
+    }
+
+    void reset() { attempts = 0; }
+    uint8_t getAttempts() const { return attempts; }
+
+private:
+    unsigned long baseDelay;
+    unsigned long maxDelay;
+    uint8_t attempts;
+};
+
+enum LinkState {
+    LINK_WIFI,        // Attente de l'association WiFi
+    LINK_DNS,         // Résolution de l'adresse du broker
+    LINK_MQTT,        // Connexion au broker
+    LINK_SESSION,     // CONNECT envoyé, attente de l'acceptation du broker
+    LINK_SUBSCRIBE,   // Abonnement aux topics de commande
+    LINK_DISCOVERY,   // Annonce Home Assistant
+    LINK_ONLINE
+};
+
+// Opérations élémentaires fournies par l'appareil (réelles ou simulées)
+class LinkDriver {
+public:
+    virtual ~LinkDriver() {}
+    virtual bool linkUp() = 0;           // WiFi associé ?
+    virtual void requestLink() = 0;      // Relance l'association WiFi (non bloquant)
+    virtual bool resolveBroker() = 0;    // Résout l'adresse du broker (non bloquant)
+    // Réponse DNS attendue: resolveBroker() est rappelée à chaque update() sans backoff
+    virtual bool resolvePending() { return false; }
+    // Lien perdu: l'adresse du broker est à résoudre de nouveau (DHCP ou DNS ont pu
+    // changer). false si elle est fixe (broker configuré par son IP).
+    virtual bool forgetBroker() { return false; }
+    virtual bool connectBroker() = 0;    // Demande l'ouverture de la session MQTT (non bloquant)
+    virtual bool brokerConnecting() = 0; // Réponse du broker attendue ?
+    virtual bool brokerConnected() = 0;  // Session acceptée
+    virtual bool sessionOpened() = 0;    // Premiers messages de la session (disponibilité)
+    virtual bool subscribeTopics() = 0;
+    virtual bool announce() = 0;         // Découverte Home Assistant
+    // Annonce interrompue faute de place dans la file d'émission: reprise au tour suivant
+    virtual bool announcePending() { return false; }
+};
+
+// Enchaîne WiFi → DNS → MQTT → session → abonnements → découverte, une étape par appel à update().
+// Chaque étape qui échoue est retentée après un backoff avec gigue; une perte de lien
+// ramène simplement à l'étape concernée, sans redémarrage de l'ESP.
+class ConnectionStateMachine {
+public:
+    typedef void (*StateCallback)(LinkState state);
+
+    ConnectionStateMachine(LinkDriver& linkDriver)
+        : driver(linkDriver),
+          state(LINK_WIFI),
+          nextAttempt(0),
+          wifiBackoff(2000, 60000),
+          dnsBackoff(1000, 30000),
+          mqttBackoff(1000, 60000),
+          announced(false),
+          reconnectCount(0),
+          stateCallback(nullptr) {}
+
+    void onStateChange(StateCallback callback) { stateCallback = callback; }
+
+    // Force une nouvelle annonce: tout de suite si la session est ouverte,
+    // sinon à la prochaine (ex: configuration modifiée, Home Assistant redémarré)
+    void requestAnnounce() {
+        announced = false;
+        if (state == LINK_ONLINE) setState(LINK_DISCOVERY);
+    }
+
+    void update() { update(millis()); }
+
+    void update(unsigned long now) {
+        // Détection des pertes de lien, quelle que soit l'étape en cours
+        if (state != LINK_WIFI && !driver.linkUp()) {
+            driver.forgetBroker();
+            wifiBackoff.reset();
+            schedule(now, wifiBackoff.initialDelay());
+            setState(LINK_WIFI);
+            return;
+        }
+        if (state > LINK_SESSION && !driver.brokerConnected()) {
+            schedule(now, mqttBackoff.initialDelay());
+            setState(driver.forgetBroker() ? LINK_DNS : LINK_MQTT);
+            return;
+        }
+
+        if (state == LINK_ONLINE || (long)(now - nextAttempt) < 0) {
+            return;
+        }
+
+        switch (state) {
+            case LINK_WIFI:
+                if (driver.linkUp()) {
+                    wifiBackoff.reset();
+                    setState(LINK_DNS);
+                } else {
+                    driver.requestLink();
+                    schedule(now, wifiBackoff.nextDelay());
+                }
+                break;
+
+            case LINK_DNS:
+                if (driver.resolveBroker()) {
+                    dnsBackoff.reset();
+                    setState(LINK_MQTT);
+                } else if (!driver.resolvePending()) {
+                    schedule(now, dnsBackoff.nextDelay());
+                }
+                break;
+
+            case LINK_MQTT:
+                if (driver.connectBroker()) {
+                    setState(LINK_SESSION);
+                } else {
+                    // Broker injoignable: peut-être une nouvelle adresse
+                    schedule(now, mqttBackoff.nextDelay());
+                    if (driver.forgetBroker()) setState(LINK_DNS);
+                }
+                break;
+
+            // Vérifiée à chaque appel: le CONNACK arrive pendant les tours de loop()
+            case LINK_SESSION:
+                if (driver.brokerConnected()) {
+                    if (driver.sessionOpened()) {
+                        mqttBackoff.reset();
+                        reconnectCount++;
+                        setState(LINK_SUBSCRIBE);
+                    } else {
+                        schedule(now, mqttBackoff.nextDelay());
+                        setState(LINK_MQTT);
+                    }
+                } else if (!driver.brokerConnecting()) {
+                    // Refus ou délai dépassé
+                    schedule(now, mqttBackoff.nextDelay());
+                    setState(LINK_MQTT);
+                }
+                break;
+
+            case LINK_SUBSCRIBE:
+                if (driver.subscribeTopics()) {
+                    setState(announced ? LINK_ONLINE : LINK_DISCOVERY);
+                } else {
+                    schedule(now, mqttBackoff.nextDelay());
+                }
+                break;
+
+            case LINK_DISCOVERY:
+                if (driver.announce()) {
+                    announced = true;
+                    setState(LINK_ONLINE);
+                } else if (!driver.announcePending()) {
+                    schedule(now, mqttBackoff.nextDelay());
+                }
+                break;
+
+            case LINK_ONLINE:
+                break;
+        }
+    }
+
+    LinkState getState() const { return state; }
+    bool isOnline() const { return state == LINK_ONLINE; }
+    // Nombre de sessions MQTT ouvertes (la première connexion comprise)
+    unsigned long getReconnectCount() const { return reconnectCount; }
+
+    static const char* stateName(LinkState state) {
+        switch (state) {
+            case LINK_WIFI:      return "WIFI";
+            case LINK_DNS:       return "DNS";
+            case LINK_MQTT:      return "MQTT";
+            case LINK_SESSION:   return "SESSION";
+            case LINK_SUBSCRIBE: return "SUBSCRIBE";
+            case LINK_DISCOVERY: return "DISCOVERY";
+            case LINK_ONLINE:    return "ONLINE";
+        }
+        return "?";
+    }
+
+private:
+    LinkDriver& driver;
+    LinkState state;
+    unsigned long nextAttempt;
+    ReconnectBackoff wifiBackoff;
+    ReconnectBackoff dnsBackoff;
+    ReconnectBackoff mqttBackoff;
+    bool announced;
+    unsigned long reconnectCount;
+    StateCallback stateCallback;
+
+    void schedule(unsigned long now, unsigned long delayMs) {
+        nextAttempt = now + delayMs;
+    }
+
+    void setState(LinkState newState) {
+        if (newState == state) return;
+        state = newState;
+        if (stateCallback) stateCallback(newState);
+    }
+};
+
+#endif
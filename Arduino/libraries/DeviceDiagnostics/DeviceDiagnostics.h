@@ -0,0 +1,122 @@
+#ifndef DeviceDiagnostics_h
+#define DeviceDiagnostics_h
+
+#include <Arduino.h>
+#include <RonoBoxPlatform.h>
+
+// Compteurs tenus ailleurs (MQTTDevice, machine à états de connexion), recopiés au rapport
+struct DiagnosticsCounters {
+    unsigned long publishOk;
+    unsigned long publishFailed;
+    unsigned long reconnects;
+    int32_t rssi;
+};
+
+// Métriques d'exécution d'un nœud, agrégées à coût constant:
+// - recordLoop() à chaque tour: un micros(), quelques comparaisons, aucun appel système
+// - sample() une fois par seconde: tas libre, minimum et temps de fonctionnement
+// - report() à chaque rapport: JSON dans le buffer de l'appelant, puis remise à zéro
+//   de la fenêtre (histogramme et pire blocage depuis le rapport précédent)
+class DeviceDiagnostics {
+public:
+    static const uint8_t LOOP_BUCKETS = 6;
+    static const size_t MAX_REPORT_LENGTH = 400;   // Pire cas: 18 compteurs de 10 chiffres
+
+    // Bornes supérieures (µs) des classes de durée de loop(); la dernière classe est ouverte
+    static constexpr uint32_t LOOP_BUCKET_LIMITS[LOOP_BUCKETS - 1] = { 100, 1000, 5000, 20000, 100000 };
+
+    DeviceDiagnostics()
+        : lastLoopUs(0), loopStarted(false), loopCount(0), windowMaxUs(0), lifetimeMaxUs(0),
+          lowestHeap(UINT32_MAX), uptimeMs(0), lastSampleMs(0), reportCostUs(0) {
+        resetWindow();
+    }
+
+    void recordLoop() {
+        recordLoop(micros());
+    }
+
+    // Horloge explicite: permet de rejouer une série de tours hors carte
+    void recordLoop(uint32_t nowUs) {
+        if (loopStarted) {
+            recordDuration(nowUs - lastLoopUs);   // Correct même si micros() déborde
+        }
+        lastLoopUs = nowUs;
+        loopStarted = true;
+    }
+
+    void recordDuration(uint32_t durationUs) {
+        uint8_t bucket = 0;
+        while (bucket < LOOP_BUCKETS - 1 && durationUs >= LOOP_BUCKET_LIMITS[bucket]) bucket++;
+        histogram[bucket]++;
+        loopCount++;
+        if (durationUs > windowMaxUs) windowMaxUs = durationUs;
+        if (durationUs > lifetimeMaxUs) lifetimeMaxUs = durationUs;
+    }
+
+    // Échantillonnage lent: ESP8266 ne suit pas lui-même le minimum du tas,
+    // et le temps de fonctionnement est cumulé pour survivre au débordement de millis()
+    void sample(unsigned long nowMs) {
+        uint32_t heap = RonoBoxPlatform::freeHeap();
+        if (heap < lowestHeap) lowestHeap = heap;
+        uptimeMs += nowMs - lastSampleMs;
+        lastSampleMs = nowMs;
+    }
+
+    // Coût du rapport précédent (construction et publication), publié dans le suivant
+    void setReportCost(uint32_t costUs) {
+        reportCostUs = costUs;
+    }
+
+    // Écrit le rapport JSON et ouvre une nouvelle fenêtre. Retourne la longueur, ou 0.
+    size_t report(char* buffer, size_t size, const DiagnosticsCounters& counters) {
+        uint32_t heap = RonoBoxPlatform::freeHeap();
+        if (heap < lowestHeap) lowestHeap = heap;
+        uint32_t platformMin = RonoBoxPlatform::minFreeHeap();
+        uint32_t minHeap = (platformMin != 0 && platformMin < lowestHeap) ? platformMin : lowestHeap;
+
+        int n = snprintf(buffer, size,
+            "{\"uptime_s\":%lu,\"loop_count\":%lu,\"loop_hist\":[%lu,%lu,%lu,%lu,%lu,%lu],"
+            "\"loop_max_us\":%lu,\"loop_max_all_us\":%lu,"
+            "\"heap_free\":%lu,\"heap_min\":%lu,\"heap_largest\":%lu,"
+            "\"publish_ok\":%lu,\"publish_failed\":%lu,\"reconnects\":%lu,\"rssi\":%ld,"
+            "\"report_us\":%lu}",
+            (unsigned long)(uptimeMs / 1000), loopCount,
+            histogram[0], histogram[1], histogram[2], histogram[3], histogram[4], histogram[5],
+            (unsigned long)windowMaxUs, (unsigned long)lifetimeMaxUs,
+            (unsigned long)heap, (unsigned long)minHeap,
+            (unsigned long)RonoBoxPlatform::largestFreeBlock(),
+            counters.publishOk, counters.publishFailed, counters.reconnects, (long)counters.rssi,
+            (unsigned long)reportCostUs);
+        if (n < 0 || (size_t)n >= size) {
+            if (size > 0) buffer[0] = '\0';
+            return 0;
+        }
+        resetWindow();
+        return n;
+    }
+
+    uint32_t getMaxLoopUs() const { return windowMaxUs; }
+    uint32_t getLifetimeMaxLoopUs() const { return lifetimeMaxUs; }
+    unsigned long getLoopCount() const { return loopCount; }
+    uint32_t getReportCost() const { return reportCostUs; }
+
+private:
+    uint32_t lastLoopUs;
+    bool loopStarted;
+    unsigned long histogram[LOOP_BUCKETS];
+    unsigned long loopCount;
+    uint32_t windowMaxUs;
+    uint32_t lifetimeMaxUs;
+    uint32_t lowestHeap;
+    uint64_t uptimeMs;
+    unsigned long lastSampleMs;
+    uint32_t reportCostUs;
+
+    void resetWindow() {
+        for (uint8_t i = 0; i < LOOP_BUCKETS; i++) histogram[i] = 0;
+        loopCount = 0;
+        windowMaxUs = 0;
+    }
+};
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef DeviceLog_h
+#define DeviceLog_h
+
+#include <Arduino.h>
+#include <RonoBoxPlatform.h>
+#include <stdarg.h>
+
+#define RB_LOG_LEVEL_NONE  0
+#define RB_LOG_LEVEL_ERROR 1
+#define RB_LOG_LEVEL_WARN  2
+#define RB_LOG_LEVEL_INFO  3
+#define RB_LOG_LEVEL_DEBUG 4
+
+// Niveau retenu à la compilation, à définir avant le premier #include
+#ifndef RONOBOX_LOG_LEVEL
+  #ifdef DEBUG
+    #define RONOBOX_LOG_LEVEL RB_LOG_LEVEL_DEBUG
+  #else
+    #define RONOBOX_LOG_LEVEL RB_LOG_LEVEL_INFO
+  #endif
+#endif
+
+// Condition connue à la compilation: sous le niveau retenu, l'appel, ses arguments
+// et la chaîne de format disparaissent du binaire
+#define RB_LOG(level, ...) \
+    do { if (RONOBOX_LOG_LEVEL >= (level)) DeviceLog::write((level), __VA_ARGS__); } while (0)
+
+#define RB_LOG_ERROR(...) RB_LOG(RB_LOG_LEVEL_ERROR, __VA_ARGS__)
+#define RB_LOG_WARN(...)  RB_LOG(RB_LOG_LEVEL_WARN, __VA_ARGS__)
+#define RB_LOG_INFO(...)  RB_LOG(RB_LOG_LEVEL_INFO, __VA_ARGS__)
+#define RB_LOG_DEBUG(...) RB_LOG(RB_LOG_LEVEL_DEBUG, __VA_ARGS__)
+
+// File d'octets: une ligne est ajoutée entière ou pas du tout
+template <size_t N>
+struct LogRing {
+    char data[N];
+    size_t head = 0;   // Prochaine écriture
+    size_t used = 0;
+
+    bool push(const char* text, size_t length) {
+        if (length > N - used) return false;
+        for (size_t i = 0; i < length; i++) {
+            data[(head + i) % N] = text[i];
+        }
+        head = (head + length) % N;
+        used += length;
+        return true;
+    }
+
+    // Plus longue portion lisible d'un seul tenant
+    const char* contiguous(size_t& length) const {
+        size_t tail = (head + N - used) % N;
+        length = used < N - tail ? used : N - tail;
+        return data + tail;
+    }
+
+    void consume(size_t length) {
+        used -= length;
+    }
+
+    bool popLine(char* buffer, size_t size) {
+        if (used == 0 || size == 0) return false;
+        size_t tail = (head + N - used) % N;
+        size_t n = 0;
+        while (used > 0) {
+            char c = data[tail];
+            tail = (tail + 1) % N;
+            used--;
+            if (c == '\n') break;
+            if (n < size - 1) buffer[n++] = c;
+        }
+        buffer[n] = '\0';
+        return true;
+    }
+
+    void clear() {
+        head = 0;
+        used = 0;
+    }
+};
+
+// Journal non bloquant. write() formate la ligne tout de suite (les arguments, comme
+// les portions de topic reçues, ne vivent pas au-delà de l'appel) et la range dans un
+// tampon circulaire; drain(), appelé en fin de loop(), n'écrit sur le port série que ce
+// que sa FIFO d'émission accepte sans attendre. Tampon plein: la ligne est perdue et
+// comptée, un avis est émis au vidage suivant.
+//
+// Les lignes d'un niveau suffisant peuvent aussi être gardées pour un topic MQTT
+// (setRemoteLevel / popRemote, relayées par MQTTDevice).
+// À n'utiliser que depuis loop(), jamais depuis une interruption.
+class DeviceLog {
+public:
+    static const size_t BUFFER_SIZE = PlatformConfig::LOG_BUFFER_SIZE;
+    static const size_t REMOTE_BUFFER_SIZE = PlatformConfig::LOG_REMOTE_BUFFER_SIZE;
+    static const size_t MAX_LINE_LENGTH = 160;
+
+    // Une ligne entière doit tenir dans chacun des tampons, sur toutes les cibles
+    static_assert(PlatformTraits<RonoBoxTarget::Esp32>::LOG_REMOTE_BUFFER_SIZE >= MAX_LINE_LENGTH &&
+                  PlatformTraits<RonoBoxTarget::Esp8266>::LOG_REMOTE_BUFFER_SIZE >= MAX_LINE_LENGTH,
+                  "tampon de journal plus petit qu'une ligne");
+
+    [[gnu::format(printf, 2, 3)]]
+    static void write(uint8_t level, const char* format, ...) {
+        char line[MAX_LINE_LENGTH];
+        line[0] = levelTag(level);
+        line[1] = ' ';
+
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(line + 2, sizeof(line) - 2, format, args);
+        va_end(args);
+        if (n < 0) return;
+
+        // Tronquée si besoin; exactement un '\n' final, que le format en ait un ou non
+        size_t length = 2 + ((size_t)n < sizeof(line) - 2 ? (size_t)n : sizeof(line) - 3);
+        while (length > 2 && line[length - 1] == '\n') length--;
+        line[length++] = '\n';
+
+        if (!serial.push(line, length)) {
+            droppedLines++;
+        }
+        if (level <= remoteLevel && !remote.push(line, length)) {
+            droppedLines++;
+        }
+    }
+
+    // Vide le tampon vers le port série, sans jamais attendre la FIFO d'émission
+    static void drain() {
+        if (droppedLines > 0) {
+            char notice[48];
+            int n = snprintf(notice, sizeof(notice), "W %lu lignes de journal perdues\n", droppedLines);
+            if (n > 0 && serial.push(notice, n)) droppedLines = 0;
+        }
+
+        int room = Serial.availableForWrite();
+        while (room > 0) {
+            size_t chunk;
+            const char* data = serial.contiguous(chunk);
+            if (chunk == 0) break;
+            if (chunk > (size_t)room) chunk = room;
+            Serial.write((const uint8_t*)data, chunk);
+            serial.consume(chunk);
+            room -= chunk;
+        }
+    }
+
+    // Lignes de niveau <= level gardées pour le topic distant (RB_LOG_LEVEL_NONE: aucune)
+    static void setRemoteLevel(uint8_t level) {
+        remoteLevel = level;
+    }
+
+    static uint8_t getRemoteLevel() { return remoteLevel; }
+
+    // Extrait la plus ancienne ligne distante, sans '\n' final. Retourne false si vide.
+    static bool popRemote(char* buffer, size_t size) {
+        return remote.popLine(buffer, size);
+    }
+
+    // Oublie tout ce qui est en attente (ex: avant une mesure de performance)
+    static void clear() {
+        serial.clear();
+        remote.clear();
+        droppedLines = 0;
+    }
+
+    static unsigned long getDroppedLines() { return droppedLines; }
+
+private:
+    static inline LogRing<BUFFER_SIZE> serial;
+    static inline LogRing<REMOTE_BUFFER_SIZE> remote;
+    static inline uint8_t remoteLevel = RB_LOG_LEVEL_NONE;
+    static inline unsigned long droppedLines = 0;
+
+    static char levelTag(uint8_t level) {
+        switch (level) {
+            case RB_LOG_LEVEL_ERROR: return 'E';
+            case RB_LOG_LEVEL_WARN:  return 'W';
+            case RB_LOG_LEVEL_INFO:  return 'I';
+            default:                 return 'D';
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef DeviceModel_h
+#define DeviceModel_h
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <string.h>
+
+// Vue (pointeur + longueur) sur une portion du message reçu, sans copie
+struct MQTTSpan {
+    const char* data;
+    size_t length;
+
+    bool equals(const char* text) const {
+        size_t textLength = strlen(text);
+        return textLength == length && memcmp(data, text, length) == 0;
+    }
+
+    bool isEmpty() const { return length == 0; }
+
+    // Copie terminée par '\0' dans un buffer de l'appelant (tronquée si nécessaire)
+    size_t copyTo(char* buffer, size_t size) const {
+        if (size == 0) return 0;
+        size_t n = length < size - 1 ? length : size - 1;
+        memcpy(buffer, data, n);
+        buffer[n] = '\0';
+        return n;
+    }
+};
+
+// Gestionnaire de commande ".../[nom]/set": location (terminée par '\0') et payload brut.
+// Pointeur de fonction (une lambda sans capture convient) pour que la table reste constexpr.
+typedef void (*EntityCommandHandler)(const MQTTSpan& location, const MQTTSpan& payload);
+
+enum EntityKind : uint8_t {
+    ENTITY_SENSOR,
+    ENTITY_BINARY_SENSOR,
+    ENTITY_SWITCH,
+    ENTITY_DIAGNOSTIC,      // Champ du rapport ".../diagnostics/state"
+    ENTITY_COMMAND          // Commande seule, non annoncée à Home Assistant
+};
+
+// Hash FNV-1a d'un nom, calculable à la compilation
+constexpr uint32_t entityHash(const char* name, uint32_t hash = 2166136261u) {
+    return *name ? entityHash(name + 1, (hash ^ (uint8_t)*name) * 16777619u) : hash;
+}
+
+inline uint32_t entityHash(const MQTTSpan& name) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < name.length; i++) {
+        hash = (hash ^ (uint8_t)name.data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Une ligne de la table du modèle. Construite par les fonctions ci-dessous, qui
+// calculent le hash du nom à la compilation: le dispatch d'une commande ne compare
+// de chaînes qu'en cas de hash identique.
+struct DeviceEntity {
+    EntityKind kind;
+    const char* location;
+    const char* name;
+    const char* deviceClass;
+    const char* unit;
+    const char* friendlyName;
+    int8_t precision;               // Décimales publiées, -1: précision par défaut
+    EntityCommandHandler command;   // nullptr: pas d'abonnement
+    uint32_t nameHash;
+    uint8_t qos;                    // QoS des publications d'état (1: alerte acquittée)
+
+    constexpr bool announced() const { return kind != ENTITY_COMMAND; }
+
+    // Composant Home Assistant
+    constexpr const char* component() const {
+        return kind == ENTITY_BINARY_SENSOR ? "binary_sensor" :
+               kind == ENTITY_SWITCH        ? "switch"        : "sensor";
+    }
+};
+
+constexpr DeviceEntity sensorEntity(const char* location, const char* name, const char* deviceClass,
+                                    const char* unit, const char* friendlyName, int8_t precision = -1) {
+    return { ENTITY_SENSOR, location, name, deviceClass, unit, friendlyName, precision, nullptr, entityHash(name), 0 };
+}
+
+constexpr DeviceEntity binarySensorEntity(const char* location, const char* name, const char* deviceClass,
+                                          const char* friendlyName) {
+    return { ENTITY_BINARY_SENSOR, location, name, deviceClass, "", friendlyName, -1, nullptr, entityHash(name), 0 };
+}
+
+constexpr DeviceEntity switchEntity(const char* location, const char* name, const char* friendlyName,
+                                    EntityCommandHandler command) {
+    return { ENTITY_SWITCH, location, name, "", "", friendlyName, -1, command, entityHash(name), 0 };
+}
+
+constexpr DeviceEntity diagnosticEntity(const char* key, const char* deviceClass, const char* unit,
+                                        const char* friendlyName) {
+    return { ENTITY_DIAGNOSTIC, "", key, deviceClass, unit, friendlyName, -1, nullptr, entityHash(key), 0 };
+}
+
+constexpr DeviceEntity commandEntity(const char* location, const char* name, EntityCommandHandler command) {
+    return { ENTITY_COMMAND, location, name, "", "", "", -1, command, entityHash(name), 0 };
+}
+
+// Même entité, publiée en QoS1: l'état est retransmis jusqu'à l'accusé du broker
+constexpr DeviceEntity alertEntity(DeviceEntity entity) {
+    entity.qos = 1;
+    return entity;
+}
+
+#endif
@@ -0,0 +1,186 @@
+#ifndef EdgeCapture_h
+#define EdgeCapture_h
+
+#include <Arduino.h>
+#include <atomic>
+
+// Front horodaté (micros()) capturé sur une entrée
+struct EdgeEvent {
+    uint32_t timestamp;
+    bool rising;
+};
+
+// File circulaire un producteur / un consommateur, sans verrou:
+// seul le producteur (interruption) écrit head, seul le consommateur (loop) écrit tail.
+// N doit être une puissance de 2; capacité utile N - 1.
+template <typename T, uint8_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "N doit être une puissance de 2");
+
+public:
+    SpscRing() : head(0), tail(0) {}
+
+    bool IRAM_ATTR push(const T& item) {
+        uint8_t h = head.load(std::memory_order_relaxed);
+        uint8_t next = (h + 1) & (N - 1);
+        if (next == tail.load(std::memory_order_acquire)) {
+            return false;   // Pleine: l'élément le plus récent est perdu
+        }
+        items[h] = item;
+        head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item) {
+        uint8_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[t];
+        tail.store((t + 1) & (N - 1), std::memory_order_release);
+        return true;
+    }
+
+    uint8_t size() const {
+        return (head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire)) & (N - 1);
+    }
+
+private:
+    T items[N];
+    std::atomic<uint8_t> head;
+    std::atomic<uint8_t> tail;
+};
+
+// Entrée numérique capturée par interruption (PIR, capteur de son...).
+//
+// L'interruption (sur CHANGE) horodate chaque front et le met en file, avec un
+// verrouillage anti-rebond: un front arrivant moins de `debounceUs` après le dernier
+// front retenu est ignoré. loop() dépile ensuite les changements de niveau avec poll(),
+// une nouvelle activation (front montant) pendant la période réfractaire étant écartée
+// avec le front descendant qui la suit.
+//
+// Un front qui tombe dans le verrouillage est perdu (ex: fin d'une impulsion plus
+// courte que `debounceUs`). Une fois la file vide et le verrouillage écoulé, poll()
+// relit donc la broche et remet le niveau suivi à jour: sans cela, le niveau resterait
+// haut et le front montant suivant serait pris pour un rebond.
+//
+// record() et poll() prennent leurs horodatages en paramètre: une suite de fronts
+// synthétique peut être rejouée hors cible, sans interruption.
+class EdgeInput {
+public:
+    static const uint8_t QUEUE_SIZE = 16;
+
+    EdgeInput(uint8_t inputPin, uint32_t debounceMicros, uint32_t refractoryMillis = 0)
+        : pin(inputPin), debounceUs(debounceMicros), refractoryUs(refractoryMillis * 1000UL),
+          lastEdgeUs(0), hasEdge(false), droppedCount(0), bounceCount(0),
+          currentLevel(false), lastActivationUs(0), activated(false), suppressing(false),
+          suppressedCount(0), resyncCount(0) {}
+
+    // Configure la broche et attache l'interruption (dans setup(), pas dans un constructeur global)
+    void begin(uint8_t mode = INPUT) {
+        pinMode(pin, mode);
+        currentLevel = digitalRead(pin);
+        attachInterruptArg(digitalPinToInterrupt(pin), handleInterrupt, this, CHANGE);
+    }
+
+    void end() {
+        detachInterrupt(digitalPinToInterrupt(pin));
+    }
+
+    // Côté interruption: anti-rebond puis mise en file. Retourne true si le front est retenu.
+    bool IRAM_ATTR record(uint32_t nowUs, bool level) {
+        if (hasEdge && nowUs - lastEdgeUs < debounceUs) {
+            bounceCount = bounceCount + 1;   // Pas de ++ sur un volatile (déprécié en C++20)
+            return false;
+        }
+        lastEdgeUs = nowUs;
+        hasEdge = true;
+
+        if (!queue.push({ nowUs, level })) {
+            droppedCount = droppedCount + 1;
+            return false;
+        }
+        return true;
+    }
+
+    // Côté loop(): prochain changement de niveau retenu, s'il y en a un
+    bool poll(EdgeEvent& event) {
+        return poll(event, micros(), digitalRead(pin));
+    }
+
+    // pinLevel: niveau lu sur la broche à nowUs, pour le recalage après un front perdu
+    bool poll(EdgeEvent& event, uint32_t nowUs, bool pinLevel) {
+        EdgeEvent edge;
+        while (queue.pop(edge)) {
+            if (accept(edge, event)) return true;
+        }
+
+        // File vide: si le verrouillage est écoulé, le niveau de la broche est stable
+        // et fait foi. Un front arrivant entre-temps est mis en file et sera écarté
+        // comme rebond résiduel s'il confirme ce niveau.
+        if (pinLevel != currentLevel && (!hasEdge || nowUs - lastEdgeUs >= debounceUs)) {
+            resyncCount++;
+            return accept({ nowUs, pinLevel }, event);
+        }
+        return false;
+    }
+
+    // Niveau courant, d'après les fronts déjà dépilés
+    bool level() const { return currentLevel; }
+
+    uint8_t getPin() const { return pin; }
+    uint8_t pending() const { return queue.size(); }
+    uint32_t getDroppedCount() const { return droppedCount; }         // File pleine
+    uint32_t getBounceCount() const { return bounceCount; }           // Fronts anti-rebond
+    uint32_t getSuppressedCount() const { return suppressedCount; }   // Activations réfractaires
+    uint32_t getResyncCount() const { return resyncCount; }           // Niveaux recalés sur la broche
+
+private:
+    uint8_t pin;
+    uint32_t debounceUs;
+    uint32_t refractoryUs;
+
+    // Écrits uniquement par l'interruption
+    SpscRing<EdgeEvent, QUEUE_SIZE> queue;
+    volatile uint32_t lastEdgeUs;
+    volatile bool hasEdge;
+    volatile uint32_t droppedCount;
+    volatile uint32_t bounceCount;
+
+    // Écrits uniquement par loop()
+    bool currentLevel;
+    uint32_t lastActivationUs;
+    bool activated;
+    bool suppressing;
+    uint32_t suppressedCount;
+    uint32_t resyncCount;
+
+    // Changement de niveau, puis période réfractaire des activations
+    bool accept(const EdgeEvent& edge, EdgeEvent& event) {
+        if (edge.rising == currentLevel) return false;   // Rebond résiduel: niveau inchangé
+        currentLevel = edge.rising;
+
+        if (edge.rising) {
+            if (activated && edge.timestamp - lastActivationUs < refractoryUs) {
+                suppressing = true;
+                suppressedCount++;
+                return false;
+            }
+            lastActivationUs = edge.timestamp;
+            activated = true;
+            suppressing = false;
+        } else if (suppressing) {
+            return false;   // Fin d'une activation écartée
+        }
+
+        event = edge;
+        return true;
+    }
+
+    static void IRAM_ATTR handleInterrupt(void* arg) {
+        EdgeInput* input = static_cast<EdgeInput*>(arg);
+        input->record(micros(), digitalRead(input->pin));
+    }
+};
+
+#endif
@@ -3,111 +3,320 @@
 
 #include <ArduinoJson.h>
 #include "MQTTTopicManager.h"
+#include <DeviceLog.h>
+#include <DeviceModel.h>
+#include <RonoBoxPlatform.h>
 
-class HADiscoveryConfig {
+#if RONOBOX_HAS_PREFERENCES
+  #include <Preferences.h>
+#endif
+
+// 0: aucun message, 1: résumé de l'annonce, 2: détail de chaque configuration
+#ifndef HA_DISCOVERY_LOG_LEVEL
+  #ifdef DEBUG
+    #define HA_DISCOVERY_LOG_LEVEL 2
+  #else
+    #define HA_DISCOVERY_LOG_LEVEL 1
+  #endif
+#endif
+
+// Condition connue à la compilation: les messages filtrés disparaissent du binaire.
+// Le résumé passe au niveau info du journal, le détail au niveau debug.
+#define HA_LOG(level, ...) \
+    do { if (HA_DISCOVERY_LOG_LEVEL >= (level)) \
+        RB_LOG((level) <= 1 ? RB_LOG_LEVEL_INFO : RB_LOG_LEVEL_DEBUG, __VA_ARGS__); } while (0)
+
+// Empreinte de la dernière annonce réussie, conservée entre deux démarrages.
+// Support retenu selon la cible: DiscoveryHashStore.
+template <bool HasNvs>
+struct DiscoveryHashBackend;
+
+#if RONOBOX_HAS_PREFERENCES
+// NVS: une seule écriture, et seulement quand la configuration change
+class NvsDiscoveryHash {
 public:
-    HADiscoveryConfig(MQTTTopicManager& topicManager) : topics(topicManager) {}
-
-    bool sendSensorConfig(const String& location, const String& sensor, 
-                        const String& deviceClass, const String& unit, 
-                        const String& friendlyName) {
-        #ifdef ESP32
-            DynamicJsonDocument doc(1024);  // Taille plus grande pour ESP32
-            doc["unique_id"] = "esp32_" + topics.getMacAddress() + "_" + sensor;
-        #else // ESP8266
-            DynamicJsonDocument doc(512);   // Taille réduite pour ESP8266
-            doc["unique_id"] = "esp8266_" + topics.getMacAddress() + "_" + sensor;
-        #endif
-        
-        doc["name"] = friendlyName;
-        if(deviceClass.length() > 0) doc["device_class"] = deviceClass;
-        doc["state_topic"] = topics.getTopic(location, sensor, "state");
-        if(unit.length() > 0) doc["unit_of_measurement"] = unit;
-
-        return sendConfig("sensor", location + "_" + sensor, doc);
+    uint32_t load() {
+        Preferences preferences;
+        preferences.begin("ha-discovery", true);
+        uint32_t hash = preferences.getUInt("hash", 0);
+        preferences.end();
+        return hash;
     }
-    // Overloaded function for sensors without device class
-    bool sendSensorConfig(const String& location, const String& sensor, const String& unit, 
-                      const String& friendlyName) {
-    return sendSensorConfig(location, sensor, "", unit, friendlyName);
+
+    void save(uint32_t hash) {
+        Preferences preferences;
+        preferences.begin("ha-discovery", false);
+        preferences.putUInt("hash", hash);
+        preferences.end();
     }
+};
+
+template <>
+struct DiscoveryHashBackend<true> {
+    typedef NvsDiscoveryHash Type;
+};
+#endif
 
+#if RONOBOX_HAS_RTC_USER_MEMORY
+// Pas de NVS: mémoire RTC, conservée après un redémarrage logiciel mais pas
+// après une coupure d'alimentation (l'annonce est alors simplement refaite)
+class RtcDiscoveryHash {
+public:
+    static const uint32_t RTC_OFFSET = 0;
+    static const uint32_t RTC_MAGIC = 0x48414453; // "HADS"
 
-    bool sendSwitchConfig(const String& location, const String& switchName, 
-                        const String& friendlyName) {
-        #ifdef ESP32
-            DynamicJsonDocument doc(1024);
-            doc["unique_id"] = "esp32_" + topics.getMacAddress() + "_" + switchName;
-        #else // ESP8266
-            DynamicJsonDocument doc(512);
-            doc["unique_id"] = "esp8266_" + topics.getMacAddress() + "_" + switchName;
-        #endif
-        
-        doc["name"] = friendlyName;
-        doc["command_topic"] = topics.getTopic(location, switchName, "set");
-        doc["state_topic"] = topics.getTopic(location, switchName, "state");
-
-        return sendConfig("switch", switchName, doc);
+    uint32_t load() {
+        uint32_t data[2];
+        if (!ESP.rtcUserMemoryRead(RTC_OFFSET, data, sizeof(data)) || data[0] != RTC_MAGIC) {
+            return 0;
+        }
+        return data[1];
     }
 
-    bool sendBinarySensorConfig(const String& location, const String& sensor,
-                              const String& deviceClass, const String& friendlyName) {
-        #ifdef ESP32
-            DynamicJsonDocument doc(1024);
-            doc["unique_id"] = "esp32_" + topics.getMacAddress() + "_" + sensor;
-        #else // ESP8266
-            DynamicJsonDocument doc(512);
-            doc["unique_id"] = "esp8266_" + topics.getMacAddress() + "_" + sensor;
-        #endif
-        
-        doc["name"] = friendlyName;
-        doc["device_class"] = deviceClass;
-        doc["state_topic"] = topics.getTopic(location, sensor, "state");
-
-        return sendConfig("binary_sensor", location + "_" + sensor, doc);
+    void save(uint32_t hash) {
+        uint32_t data[2] = { RTC_MAGIC, hash };
+        ESP.rtcUserMemoryWrite(RTC_OFFSET, data, sizeof(data));
     }
+};
 
-private:
-    MQTTTopicManager& topics;
+template <>
+struct DiscoveryHashBackend<false> {
+    typedef RtcDiscoveryHash Type;
+};
+#endif
+
+typedef DiscoveryHashBackend<PlatformConfig::HAS_NVS>::Type DiscoveryHashStore;
+
+// Découverte Home Assistant groupée: les entités du modèle de l'appareil (DeviceModel.h)
+// sont annoncées d'un bloc avec un bloc "device" commun et un topic de disponibilité.
+// L'annonce n'est republiée que si son empreinte a changé, ou à la demande de Home
+// Assistant (message "online" sur STATUS_TOPIC après son redémarrage).
+class HADiscoveryConfig {
+public:
+    static const uint8_t MAX_ENTITIES = PlatformConfig::MAX_ENTITIES;
+    static const size_t MAX_PAYLOAD_LENGTH = PlatformConfig::DISCOVERY_PAYLOAD_LENGTH;
+    static const size_t MAX_ID_LENGTH = 48;
+
+    // Message de naissance de Home Assistant ("online" à chaque démarrage)
+    static constexpr const char* STATUS_TOPIC = "homeassistant/status";
+
+    HADiscoveryConfig(MQTTTopicManager& topicManager)
+        : topics(topicManager), entityCount(0), announcedHash(0), hashLoaded(false),
+          forceAnnounce(false), announcing(false), nextEntity(0), pendingHash(0) {}
+
+    // L'entité doit rester valide (table statique): seule son adresse est conservée.
+    // Les commandes seules (ENTITY_COMMAND) ne sont pas annoncées.
+    bool add(const DeviceEntity& entity) {
+        if (!entity.announced()) return true;
+        if (entityCount >= MAX_ENTITIES) {
+            HA_LOG(1, "[Config] Table des entités pleine\n");
+            return false;
+        }
+        entities[entityCount++] = &entity;
+        return true;
+    }
+
+    template <size_t N>
+    bool add(const DeviceEntity (&table)[N]) {
+        bool ok = true;
+        for (size_t i = 0; i < N; i++) {
+            ok = add(table[i]) && ok;
+        }
+        return ok;
+    }
 
-    bool sendConfig(const String& deviceType, const String& entityName, JsonDocument& config) {
-        if(!topics.ensureConnected()) {
-            Serial.println("[Config] Impossible de se connecter au broker MQTT");
+    // Publie les configurations à la suite (sans délai) si l'empreinte a changé ou si
+    // une annonce complète a été demandée. La disponibilité ("online", et "offline" en
+    // dernière volonté) est gérée à la connexion par MQTTDevice.
+    // Quand la file d'émission du client est pleine, l'annonce s'arrête et false est
+    // retourné avec isAnnouncing() vrai: l'appel suivant reprend à l'entité suivante.
+    // Autre échec: false, et la machine à états relance l'annonce après un backoff.
+    bool announce() {
+        if (!topics.ensureConnected()) {
+            HA_LOG(1, "[Config] Impossible de se connecter au broker MQTT\n");
             return false;
         }
-        
-        String topic = "homeassistant/" + deviceType + "/" + entityName + "/config";
-        String payload;
-        serializeJson(config, payload);
-
-        #ifdef DEBUG
-            Serial.println("Statut MQTT: " + String(topics.getClient().state()));
-            Serial.println("Taille du payload: " + String(payload.length()));
-            Serial.println("Memoire libre: " + String(ESP.getFreeHeap()));
-            Serial.println("Envoi configuration à: " + topic);
-            Serial.println("Payload: " + payload);
-        #endif
-
-        for(int attempt = 0; attempt < 3; attempt++) {
-            if(topics.getClient().publish(topic.c_str(), payload.c_str(), true)) {
-                #ifdef DEBUG
-                    Serial.println("Configuration envoyée avec succès");
-                #endif
-                delay(100); // Petit délai entre les messages
+
+        char topic[MQTTTopicManager::MAX_TOPIC_LENGTH];
+        char payload[MAX_PAYLOAD_LENGTH];
+
+        if (!announcing) {
+            uint32_t hash = computeHash(topic, sizeof(topic), payload, sizeof(payload));
+            if (!hashLoaded) {
+                announcedHash = hashStore.load();
+                hashLoaded = true;
+            }
+            if (hash == announcedHash && !forceAnnounce) {
+                HA_LOG(1, "[Config] Découverte inchangée, pas de nouvelle annonce\n");
                 return true;
             }
-            #ifdef DEBUG
-                Serial.println("Échec de l'envoi, tentative " + String(attempt+1));
-            #endif
-            delay(500);
-            topics.ensureConnected(); // Tentative de reconnexion
+            pendingHash = hash;
+            nextEntity = 0;
+            announcing = true;
+        }
+
+        for (; nextEntity < entityCount; nextEntity++) {
+            size_t length = buildConfig(*entities[nextEntity], topic, sizeof(topic), payload, sizeof(payload));
+            if (length == 0) {
+                HA_LOG(1, "[Config] Configuration trop longue: %s\n", entities[nextEntity]->name);
+                announcing = false;
+                return false;
+            }
+
+            HA_LOG(2, "Envoi configuration à: %s (%u octets)\nPayload: %s\n",
+                   topic, (unsigned)length, payload);
+
+            if (!topics.getClient().publish(topic, payload, true)) {
+                HA_LOG(2, "File d'émission pleine, reprise à l'entité %u\n", nextEntity);
+                return false;
+            }
+        }
+
+        announcing = false;
+        forceAnnounce = false;
+        if (pendingHash != announcedHash) {
+            announcedHash = pendingHash;
+            hashStore.save(pendingHash);   // Écriture flash seulement si la configuration a changé
+        }
+        HA_LOG(1, "[Config] %u entités annoncées\n", entityCount);
+        return true;
+    }
+
+    // Annonce commencée, en attente de place dans la file d'émission
+    bool isAnnouncing() const { return announcing; }
+
+    // Force une annonce complète à la prochaine session (ex: broker sans persistance)
+    void invalidate() {
+        announcedHash = 0;
+        hashLoaded = true;
+        hashStore.save(0);
+    }
+
+    // Republie tout à la prochaine annonce, sans toucher à l'empreinte enregistrée
+    // (ex: Home Assistant redémarré)
+    void requestFullAnnounce() {
+        forceAnnounce = true;
+        announcing = false;
+    }
+
+    // Topic de disponibilité commun à toutes les entités: "[topic de base]/status"
+    void availabilityTopic(char* buffer, size_t size) {
+        snprintf(buffer, size, "%s/status", topics.baseTopic());
+    }
+
+    uint8_t size() const { return entityCount; }
+
+private:
+    MQTTTopicManager& topics;
+    const DeviceEntity* entities[MAX_ENTITIES];
+    uint8_t entityCount;
+    DiscoveryHashStore hashStore;
+    uint32_t announcedHash;
+    bool hashLoaded;
+    bool forceAnnounce;
+    bool announcing;
+    uint8_t nextEntity;         // Prochaine entité d'une annonce interrompue
+    uint32_t pendingHash;       // Empreinte de l'annonce en cours
+
+    // Identifiant commun à toutes les entités (préfixe de leurs unique_id)
+    void deviceId(char* buffer, size_t size) {
+        snprintf(buffer, size, "%s_%s", RonoBoxPlatform::name(), topics.getMacAddress().c_str());
+    }
+
+    // Écrit le topic et le payload de l'entité dans les buffers fournis, sans allocation:
+    // le document a une capacité fixe et ne référence que des chaînes déjà en place.
+    // Retourne la longueur du payload, ou 0 si un buffer est trop petit.
+    size_t buildConfig(const DeviceEntity& entity, char* topic, size_t topicSize,
+                       char* payload, size_t payloadSize) {
+        // 10 champs + bloc device (4 champs) + tableau identifiers (1 élément)
+        StaticJsonDocument<JSON_OBJECT_SIZE(10) + JSON_OBJECT_SIZE(4) + JSON_ARRAY_SIZE(1)> doc;
+        topic[0] = '\0';
+        payload[0] = '\0';
+
+        char stateTopic[MQTTTopicManager::MAX_TOPIC_LENGTH];
+        char commandTopic[MQTTTopicManager::MAX_TOPIC_LENGTH];
+        char availability[MQTTTopicManager::MAX_TOPIC_LENGTH];
+        char id[MAX_ID_LENGTH];
+        char uniqueId[MAX_ID_LENGTH + 32];
+        char deviceName[MAX_ID_LENGTH];
+        char valueTemplate[MAX_ID_LENGTH];
+
+        bool isSwitch = entity.kind == ENTITY_SWITCH;
+        bool isDiagnostic = entity.kind == ENTITY_DIAGNOSTIC;
+        deviceId(id, sizeof(id));
+        snprintf(uniqueId, sizeof(uniqueId), "%s_%s", id, entity.name);
+        snprintf(deviceName, sizeof(deviceName), "RonoBox %s", topics.getMacAddress().c_str());
+        availabilityTopic(availability, sizeof(availability));
+        // Les diagnostics partagent un seul topic: chaque entité extrait son champ
+        const char* stateObject = isDiagnostic ? "diagnostics" : entity.name;
+        if (topics.buildTopic(stateTopic, sizeof(stateTopic), entity.location, stateObject, "state") == 0) {
+            return 0;
+        }
+        if (isSwitch &&
+            topics.buildTopic(commandTopic, sizeof(commandTopic), entity.location, entity.name, "set") == 0) {
+            return 0;
+        }
+
+        doc["name"] = entity.friendlyName;
+        if (entity.deviceClass[0] != '\0') doc["device_class"] = entity.deviceClass;
+        if (isSwitch) doc["command_topic"] = (const char*)commandTopic;
+        doc["state_topic"] = (const char*)stateTopic;
+        if (entity.unit[0] != '\0') doc["unit_of_measurement"] = entity.unit;
+        doc["unique_id"] = (const char*)uniqueId;
+        doc["availability_topic"] = (const char*)availability;
+        if (isDiagnostic) {
+            snprintf(valueTemplate, sizeof(valueTemplate), "{{ value_json.%s }}", entity.name);
+            doc["value_template"] = (const char*)valueTemplate;
+            doc["entity_category"] = "diagnostic";
+        }
+
+        JsonObject device = doc.createNestedObject("device");
+        JsonArray identifiers = device.createNestedArray("identifiers");
+        identifiers.add((const char*)id);
+        device["name"] = (const char*)deviceName;
+        device["manufacturer"] = "RonoBox";
+        device["model"] = RonoBoxPlatform::model();
+
+        // Topics historiques conservés pour que Home Assistant retrouve ses entités
+        int topicLength;
+        if (isSwitch) {
+            topicLength = snprintf(topic, topicSize, "homeassistant/%s/%s/config",
+                                   entity.component(), entity.name);
+        } else if (isDiagnostic) {
+            topicLength = snprintf(topic, topicSize, "homeassistant/%s/%s/config",
+                                   entity.component(), uniqueId);
+        } else {
+            topicLength = snprintf(topic, topicSize, "homeassistant/%s/%s_%s/config",
+                                   entity.component(), entity.location, entity.name);
+        }
+        if (topicLength < 0 || (size_t)topicLength >= topicSize) {
+            return 0;
+        }
+
+        if (doc.overflowed() || measureJson(doc) >= payloadSize) {
+            return 0;
+        }
+        return serializeJson(doc, payload, payloadSize);
+    }
+
+    // FNV-1a sur les topics et payloads: tout changement d'entité, d'adresse MAC
+    // ou de format de payload produit une nouvelle empreinte
+    uint32_t computeHash(char* topic, size_t topicSize, char* payload, size_t payloadSize) {
+        uint32_t hash = 2166136261u;
+        for (uint8_t i = 0; i < entityCount; i++) {
+            buildConfig(*entities[i], topic, topicSize, payload, payloadSize);
+            hash = fnv1a(topic, hash);
+            hash = fnv1a(payload, hash);
+        }
+        return hash == 0 ? 1 : hash;   // 0 est réservé à "jamais annoncé"
+    }
+
+    static uint32_t fnv1a(const char* str, uint32_t hash) {
+        while (*str) {
+            hash = (hash ^ (uint8_t)*str++) * 16777619u;
         }
-        
-        #ifdef DEBUG
-            Serial.println("Échec après 3 tentatives");
-        #endif
-        return false;
+        return hash;
     }
 };
 
-#endif
\ No newline at end of file
+#endif
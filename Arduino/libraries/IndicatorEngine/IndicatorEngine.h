@@ -0,0 +1,185 @@
+#ifndef IndicatorEngine_h
+#define IndicatorEngine_h
+
+#include <Arduino.h>
+
+// Une image d'un motif: couleur tenue pendant durationMs, tonalité jouée à son entrée
+struct IndicatorFrame {
+    uint8_t r, g, b;
+    uint16_t durationMs;
+    uint16_t toneHz;     // 0 = silence
+    uint16_t toneMs;
+    bool breathe;        // Couleur modulée par la table de respiration sur toute la durée
+};
+
+// Motif déclaratif: les images sont jouées dans l'ordre puis, si loopFrom >= 0,
+// on reboucle sur l'image loopFrom (0: tout le motif, count - 1: tenir la dernière).
+// loopFrom < 0: motif joué une seule fois.
+struct IndicatorPattern {
+    const IndicatorFrame* frames;
+    uint8_t count;
+    int8_t loopFrom;
+};
+
+template <uint8_t N>
+constexpr IndicatorPattern indicatorPattern(const IndicatorFrame (&frames)[N], int8_t loopFrom) {
+    return { frames, N, loopFrom };
+}
+
+// Sorties physiques (LED RGB, buzzer), fournies par l'appareil
+class IndicatorOutput {
+public:
+    virtual ~IndicatorOutput() {}
+    virtual void setColor(uint8_t r, uint8_t g, uint8_t b) = 0;
+    virtual void playTone(uint16_t frequency, uint16_t durationMs) = 0;   // Non bloquant
+};
+
+enum IndicatorLayer {
+    LAYER_STATE,          // État de l'appareil (connexion, fonctionnement normal)
+    LAYER_NOTIFICATION,   // Événement bref (présence, envoi de données)
+    LAYER_ALERT,          // Alerte capteur: masque tout le reste
+    LAYER_COUNT
+};
+
+// Moteur d'animation: chaque couche joue son motif selon sa propre horloge et la
+// plus prioritaire est affichée. update() ne fait qu'avancer dans les tables et
+// n'écrit la sortie que si la couleur change: quelques microsecondes par appel,
+// jamais de delay() ni de calcul trigonométrique.
+class IndicatorEngine {
+public:
+    static const uint8_t BREATH_STEPS = 64;
+
+    IndicatorEngine(IndicatorOutput& indicatorOutput)
+        : output(indicatorOutput), colorValid(false) {}
+
+    // Démarre un motif sur une couche; sans effet si ce motif y est déjà en cours
+    // (les alertes répétées par les contrôles périodiques ne le redémarrent pas)
+    void play(IndicatorLayer layer, const IndicatorPattern& pattern) {
+        play(layer, pattern, millis());
+    }
+
+    void play(IndicatorLayer layer, const IndicatorPattern& pattern, unsigned long now) {
+        Track& track = tracks[layer];
+        if (track.active && track.pattern == &pattern) return;
+        track.pattern = &pattern;
+        track.index = 0;
+        track.frameStart = now;
+        track.entered = false;
+        track.active = pattern.count > 0;
+    }
+
+    void stop(IndicatorLayer layer) {
+        tracks[layer].active = false;
+    }
+
+    bool isPlaying(IndicatorLayer layer) const {
+        return tracks[layer].active;
+    }
+
+    void update() {
+        update(millis());
+    }
+
+    // Variante à horloge explicite (utilisée aussi pour simuler le temps hors cible)
+    void update(unsigned long now) {
+        int8_t top = -1;
+        for (int8_t layer = LAYER_COUNT - 1; layer >= 0; layer--) {
+            if (tracks[layer].active && advance(tracks[layer], now)) {
+                top = layer;
+                break;
+            }
+        }
+
+        if (top < 0) {
+            writeColor(0, 0, 0);
+            return;
+        }
+
+        Track& track = tracks[top];
+        const IndicatorFrame& frame = track.pattern->frames[track.index];
+
+        // Tonalité à l'entrée de l'image; une image entrée pendant que sa couche était
+        // masquée sonne quand la couche redevient visible
+        if (!track.entered) {
+            if (frame.toneHz > 0) output.playTone(frame.toneHz, frame.toneMs);
+            track.entered = true;
+        }
+
+        if (frame.breathe) {
+            uint8_t level = breathLevel((now - track.frameStart) * BREATH_STEPS / duration(frame));
+            writeColor(scale(frame.r, level), scale(frame.g, level), scale(frame.b, level));
+        } else {
+            writeColor(frame.r, frame.g, frame.b);
+        }
+    }
+
+private:
+    struct Track {
+        const IndicatorPattern* pattern = nullptr;
+        uint8_t index = 0;
+        unsigned long frameStart = 0;
+        bool entered = false;
+        bool active = false;
+    };
+
+    IndicatorOutput& output;
+    Track tracks[LAYER_COUNT];
+    bool colorValid;
+    uint8_t lastR, lastG, lastB;
+
+    static unsigned long duration(const IndicatorFrame& frame) {
+        return frame.durationMs > 0 ? frame.durationMs : 1;
+    }
+
+    // Avance la couche jusqu'à l'image courante. Retourne false si un motif joué
+    // une seule fois est terminé (la couche est alors désactivée).
+    bool advance(Track& track, unsigned long now) {
+        const IndicatorPattern& pattern = *track.pattern;
+        while (now - track.frameStart >= duration(pattern.frames[track.index])) {
+            track.frameStart += duration(pattern.frames[track.index]);
+            track.entered = false;
+            if (++track.index < pattern.count) continue;
+
+            if (pattern.loopFrom < 0 || pattern.loopFrom >= pattern.count) {
+                track.active = false;
+                return false;
+            }
+            track.index = pattern.loopFrom;
+
+            // Couche restée longtemps masquée: on saute les cycles entiers en une fois
+            unsigned long cycle = 0;
+            for (uint8_t i = pattern.loopFrom; i < pattern.count; i++) {
+                cycle += duration(pattern.frames[i]);
+            }
+            unsigned long behind = now - track.frameStart;
+            if (behind >= cycle) track.frameStart += behind / cycle * cycle;
+        }
+        return true;
+    }
+
+    // Demi-cosinus précalculé sur un cycle: 0 → 255 → 0
+    static uint8_t breathLevel(unsigned long step) {
+        static const uint8_t BREATH_TABLE[BREATH_STEPS] PROGMEM = {
+              0,   1,   2,   5,  10,  15,  21,  29,  37,  47,  57,  67,  79,  90, 103, 115,
+            127, 140, 152, 165, 176, 188, 198, 208, 218, 226, 234, 240, 245, 250, 253, 254,
+            255, 254, 253, 250, 245, 240, 234, 226, 218, 208, 198, 188, 176, 165, 152, 140,
+            128, 115, 103,  90,  79,  67,  57,  47,  37,  29,  21,  15,  10,   5,   2,   1,
+        };
+        return pgm_read_byte(&BREATH_TABLE[step % BREATH_STEPS]);
+    }
+
+    static uint8_t scale(uint8_t value, uint8_t level) {
+        return (uint16_t)value * level / 255;
+    }
+
+    void writeColor(uint8_t r, uint8_t g, uint8_t b) {
+        if (colorValid && r == lastR && g == lastG && b == lastB) return;
+        lastR = r;
+        lastG = g;
+        lastB = b;
+        colorValid = true;
+        output.setColor(r, g, b);
+    }
+};
+
+#endif
@@ -1,194 +1,744 @@
 #ifndef MQTTDevice_h
 #define MQTTDevice_h
 
-// Déclaration des includes spécifiques aux plateformes
-#ifdef ESP32
-  #include <WiFi.h>
-#else // ESP8266
-  #include <ESP8266WiFi.h>
-#endif
-
-#include <PubSubClient.h>
+#include <RonoBoxPlatform.h>
+
+#include <RonoBoxMQTT.h>
+#include <ConnectionStateMachine.h>
+#include <TelemetryBuffer.h>
+#include <DeviceDiagnostics.h>
+#include <DeviceLog.h>
+#include <DeviceModel.h>
 #include "MQTTTopicManager.h"
 #include "HADiscoveryConfig.h"
+#include <functional>
 
-class MQTTDevice {
+class MQTTDevice : protected LinkDriver {
 public:
     MQTTDevice(const String& macAddress)
         : wifiClient(), 
           mqttClient(wifiClient), 
           topicManager(mqttClient, macAddress),
-          haConfig(topicManager) {}
+          haConfig(topicManager),
+          link(*this) {}
 
-    // Méthodes begin() identiques pour les deux plateformes
-    bool begin(const char* mqttServer, int mqttPort = 1883) {
-        mqttClient.setServer(mqttServer, mqttPort);
-        mqttClient.setCallback([this](char* topic, byte* payload, unsigned int length) {
-            this->mqttCallback(topic, payload, length);
-        });
-        return reconnect();
+    // Enregistre le broker; la connexion est ensuite menée par handle(), sans bloquer
+    void begin(const char* mqttServer, int mqttPort = 1883) {
+        IPAddress address;
+        if (address.fromString(mqttServer)) {
+            begin(address, mqttPort);
+            return;
+        }
+        strncpy(brokerHost, mqttServer, sizeof(brokerHost) - 1);
+        brokerHost[sizeof(brokerHost) - 1] = '\0';
+        brokerPort = mqttPort;
+        brokerResolved = false;
+        dnsQuery.reset();
+        setupClient();
     }
-    
-    bool begin(const IPAddress& mqttServer, int mqttPort = 1883) {
+
+    void begin(const IPAddress& mqttServer, int mqttPort = 1883) {
+        brokerHost[0] = '\0';
+        brokerPort = mqttPort;
+        brokerResolved = true;
         mqttClient.setServer(mqttServer, mqttPort);
-        mqttClient.setCallback([this](char* topic, byte* payload, unsigned int length) {
-            this->mqttCallback(topic, payload, length);
-        });
-        return reconnect();
+        setupClient();
     }
 
+    // Fait avancer la connexion (WiFi → DNS → MQTT → abonnements → découverte)
+    // d'une étape au plus, écrit ce que la pile TCP accepte et traite les messages reçus
     void handle() {
-        if (!mqttClient.connected()) {
-            unsigned long now = millis();
-            if (now - lastReconnectAttempt > reconnectInterval) {
-                Serial.println("[MQTT] Tentative de reconnexion...");
+        diagnostics.recordLoop();
+        mqttClient.loop();   // Sans effet hors session; reçoit aussi le CONNACK
+        link.update();
+        // Hors connexion, les valeurs dues partent dans le tampon de télémétrie
+        flushPending();
+        if (mqttClient.connected()) {
+            drainBacklog();
+        }
+        updateDiagnostics();
+        if (mqttClient.connected()) {
+            drainRemoteLog();
+        }
+    }
 
-                if (reconnect()) {
-                    Serial.println("[MQTT] Reconnexion réussie !");
-                } else {
-                    Serial.println("[MQTT] Échec de reconnexion.");
-                }
+    // Appelée à l'ouverture de la première session MQTT, puis à chaque redémarrage de
+    // Home Assistant, pour annoncer les entités (par défaut: annonce groupée du modèle)
+    void onAnnounce(std::function<bool()> callback) {
+        announceCallback = callback;
+    }
 
-                lastReconnectAttempt = now;
-            }
-            return;
-        }
-        mqttClient.loop();
+    void onLinkStateChange(ConnectionStateMachine::StateCallback callback) {
+        link.onStateChange(callback);
+    }
+
+    LinkState getLinkState() const {
+        return link.getState();
     }
 
     bool isConnected() {
         return mqttClient.connected();
     }
 
-    // Méthodes de publication unifiées
-    void publishSensorData(const String& location, const String& sensor, float value) {
-        topicManager.publish(location, sensor, "state", String(value), true);
+    // Les valeurs sont mises en attente puis publiées au plus une fois par loop() (flushPending),
+    // selon la politique du capteur: bande morte, intervalle minimum et heartbeat
+    // Valeur flottante écrite avec la précision du capteur (setPrecision).
+    // Une lecture invalide (NaN, ex: DHT absent) est publiée comme "unavailable".
+    void publishSensorData(const char* location, const char* sensor, float value) {
+        TelemetryChannel* channel = findChannel(location, sensor);
+        char payload[MAX_PAYLOAD_LENGTH];
+        if (formatFixed(payload, sizeof(payload), value,
+                        channel ? channel->precision : defaultPrecision) == 0) {
+            failedCount++;
+            return;
+        }
+        stageValue(channel, location, sensor, payload, !isnan(value), value);
+    }
+
+    void publishSensorData(const char* location, const char* sensor, int value) {
+        char payload[12];
+        snprintf(payload, sizeof(payload), "%d", value);
+        stageValue(location, sensor, payload, true, value);
+    }
+
+    void publishSensorData(const char* location, const char* sensor, const char* value) {
+        stageValue(location, sensor, value, false, 0);
     }
 
-    void publishSensorData(const String& location, const String& sensor, int value) {
-        topicManager.publish(location, sensor, "state", String(value), true);
+    void publishSensorData(const char* location, const char* sensor, const bool& value) {
+        stageValue(location, sensor, value ? "ON" : "OFF", false, 0);
     }
 
     void publishSensorData(const String& location, const String& sensor, const String& value) {
-        topicManager.publish(location, sensor, "state", value, true);
+        stageValue(location.c_str(), sensor.c_str(), value.c_str(), false, 0);
+    }
+
+    // Politique de publication d'un capteur
+    struct PublishPolicy {
+        float deadband;             // Variation minimale d'une valeur numérique pour republier (0 = tout changement)
+        unsigned long minInterval;  // Délai minimum entre deux publications (ms)
+        unsigned long maxInterval;  // Heartbeat: republication même sans changement (ms), 0 = désactivé
+    };
+
+    static const uint8_t MAX_CHANNELS = PlatformConfig::MAX_CHANNELS;
+    static const size_t MAX_PAYLOAD_LENGTH = 32;
+    static const uint8_t MAX_PRECISION = 6;
+    // Attente maximale d'une réponse DNS; au-delà, nouvel essai après le backoff
+    static const unsigned long DNS_TIMEOUT_MS = 5000;
+
+    // Écrit value avec `decimals` décimales, arrondie au plus proche, par calcul entier
+    // (ni printf ni allocation). NaN ou infini donne "unavailable".
+    // Retourne la longueur écrite, ou 0 si le buffer est trop petit.
+    static size_t formatFixed(char* buffer, size_t size, float value, uint8_t decimals) {
+        static const uint32_t POW10[MAX_PRECISION + 1] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+        if (size == 0) return 0;
+        if (isnan(value) || isinf(value)) {
+            return copyPayload(buffer, size, "unavailable", 11);
+        }
+        if (decimals > MAX_PRECISION) decimals = MAX_PRECISION;
+
+        float magnitude = fabsf(value);
+        if (magnitude >= 4294967040.0f) {
+            // Au-delà de 32 bits: chemin générique, rare pour un capteur
+            int n = snprintf(buffer, size, "%.*f", decimals, (double)value);
+            if (n < 0 || (size_t)n >= size) {
+                buffer[0] = '\0';
+                return 0;
+            }
+            return n;
+        }
+
+        // Parties entière et décimale séparées: la soustraction est exacte, on ne perd
+        // pas les 24 bits de mantisse dans la multiplication
+        uint32_t whole = (uint32_t)magnitude;
+        uint32_t fraction = (uint32_t)((magnitude - whole) * POW10[decimals] + 0.5f);
+        if (fraction >= POW10[decimals]) {   // Retenue de l'arrondi, ex: 99.995 → 100.00
+            fraction -= POW10[decimals];
+            whole++;
+        }
+        bool negative = value < 0 && (whole != 0 || fraction != 0);   // Pas de "-0.0"
+
+        // Chiffres écrits de droite à gauche: décimales, point, partie entière, signe
+        char digits[20];
+        char* end = digits + sizeof(digits);
+        char* p = end;
+        for (uint8_t i = 0; i < decimals; i++) {
+            *--p = '0' + fraction % 10;
+            fraction /= 10;
+        }
+        if (decimals > 0) *--p = '.';
+        do {
+            *--p = '0' + whole % 10;
+            whole /= 10;
+        } while (whole > 0);
+        if (negative) *--p = '-';
+
+        return copyPayload(buffer, size, p, end - p);
+    }
+
+    // Précision appliquée aux capteurs sans réglage spécifique (2 décimales par défaut)
+    void setDefaultPrecision(uint8_t decimals) {
+        defaultPrecision = decimals;
+    }
+
+    // Nombre de décimales publiées pour un capteur, ex: température 1, gaz 0
+    bool setPrecision(const char* location, const char* sensor, uint8_t decimals) {
+        TelemetryChannel* channel = findChannel(location, sensor);
+        if (!channel) return false;
+        channel->precision = decimals;
+        return true;
     }
 
-    void publishSensorData(const String& location, const String& sensor, const bool& value) {
-        topicManager.publish(location, sensor, "state", value?"ON":"OFF", true);
+    // Politique appliquée aux capteurs sans réglage spécifique
+    void setDefaultPublishPolicy(float deadband, unsigned long minIntervalMs, unsigned long maxIntervalMs) {
+        defaultPolicy = {deadband, minIntervalMs, maxIntervalMs};
     }
 
-    virtual void handleCommand(const String& location, const String& device, const String& value) = 0;
+    bool setPublishPolicy(const char* location, const char* sensor, float deadband,
+                          unsigned long minIntervalMs, unsigned long maxIntervalMs) {
+        TelemetryChannel* channel = findChannel(location, sensor);
+        if (!channel) return false;
+        channel->policy = {deadband, minIntervalMs, maxIntervalMs};
+        return true;
+    }
+
+    // Publie les valeurs en attente qui satisfont leur politique (appelé par handle()).
+    // Broker injoignable: la valeur due est horodatée et mise de côté dans le tampon,
+    // la politique continue de s'appliquer (bande morte, intervalles).
+    void flushPending() {
+        unsigned long now = millis();
+        bool online = mqttClient.connected();
+        for (uint8_t i = 0; i < channelCount; i++) {
+            TelemetryChannel& channel = channels[i];
+
+            // Après une coupure, le topic d'état reçoit la dernière valeur connue
+            bool refresh = online && channel.stale;
+            if (refresh && !channel.pending) {
+                strcpy(channel.pendingPayload, channel.lastPayload);
+                channel.pendingValue = channel.lastValue;
+                channel.pending = true;
+            }
+            if (!channel.pending) continue;
+
+            if (!refresh) {
+                unsigned long elapsed = now - channel.lastPublish;
+                bool changed = !channel.published || hasChanged(channel);
+                bool heartbeat = channel.policy.maxInterval > 0 && elapsed >= channel.policy.maxInterval;
+
+                if (!changed && !heartbeat) {
+                    channel.pending = false;
+                    suppressedCount++;
+                    continue;
+                }
+                if (!heartbeat && channel.published && elapsed < channel.policy.minInterval) {
+                    continue; // Gardée en attente jusqu'à l'expiration du délai minimum
+                }
+            }
+
+            if (online) {
+                // File d'émission ou fenêtre QoS1 pleine: la valeur reste en attente et
+                // repart à un prochain tour. Pas un échec: une alerte perdue est comptée
+                // par onDelivery(false).
+                if (!topicManager.publish(channel.location, channel.sensor, "state", channel.pendingPayload, true, channel.qos)) {
+                    continue;
+                }
+                channel.stale = false;
+                publishedCount++;
+            } else {
+                backlog.push(now, i, channel.pendingPayload);
+                channel.stale = true;
+            }
+
+            strcpy(channel.lastPayload, channel.pendingPayload);
+            channel.lastValue = channel.pendingValue;
+            channel.lastPublish = now;
+            channel.published = true;
+            channel.pending = false;
+        }
+    }
+
+    // Rejoue les mesures mises de côté pendant une coupure sur ".../[capteur]/backlog",
+    // à débit limité pour ne pas saturer le broker à la reconnexion.
+    // Payload: {"value":"21.5","age_ms":12345} (âge de la mesure au moment de l'envoi)
+    void drainBacklog() {
+        unsigned long now = millis();
+        if (now - lastDrain < drainInterval) return;
+        lastDrain = now;
+
+        TelemetrySample sample;
+        for (uint8_t n = 0; n < drainBatch && backlog.peek(sample); n++) {
+            if (sample.channel >= channelCount) {
+                backlog.pop();
+                continue;
+            }
+            const TelemetryChannel& channel = channels[sample.channel];
+            char payload[64];
+            snprintf(payload, sizeof(payload), "{\"value\":\"%s\",\"age_ms\":%lu}",
+                     sample.payload, (unsigned long)(now - sample.timestamp));
+            if (!topicManager.publish(channel.location, channel.sensor, "backlog", payload, false)) {
+                break;   // Nouvel essai au prochain intervalle
+            }
+            backlog.pop();
+            forwardedCount++;
+        }
+    }
+
+    // Débit de vidage du tampon après reconnexion (défaut: 5 mesures toutes les 100 ms)
+    void setBacklogDrainRate(uint8_t samplesPerBatch, unsigned long intervalMs) {
+        drainBatch = samplesPerBatch;
+        drainInterval = intervalMs;
+    }
+
+    // Réglages (politique de perte, débordement en flash) et compteurs du tampon
+    TelemetryBuffer& getTelemetryBuffer() { return backlog; }
+
+    unsigned long getPublishedCount() const { return publishedCount; }
+    unsigned long getSuppressedCount() const { return suppressedCount; }
+    unsigned long getFailedPublishCount() const { return failedCount; }
+    unsigned long getForwardedCount() const { return forwardedCount; }
+
+    // Fenêtre QoS1: messages en vol, retransmissions, abandons, latence du dernier PUBACK
+    const RonoBoxMQTT& getMQTTClient() const { return mqttClient; }
+
+    // Rapport de santé sur ".../diagnostics/state" (défaut: toutes les 60 s).
+    // 0 désactive le rapport; avant begin(), les entités de diagnostic ne sont pas annoncées.
+    void setDiagnosticsInterval(unsigned long intervalMs) {
+        diagnosticsInterval = intervalMs;
+    }
+
+    DeviceDiagnostics& getDiagnostics() { return diagnostics; }
+
+    // Relaie les lignes de journal de niveau <= level sur ".../log/state" (non retenues).
+    // Seuls les niveaux compilés (RONOBOX_LOG_LEVEL) peuvent être relayés.
+    void enableRemoteLog(uint8_t level = RB_LOG_LEVEL_WARN) {
+        DeviceLog::setRemoteLevel(level);
+    }
+
+    // Entités de diagnostic, annoncées en plus de celles du modèle
+    static constexpr DeviceEntity DIAGNOSTIC_ENTITIES[] = {
+        diagnosticEntity("loop_max_us", "", "µs", "Blocage max de loop()"),
+        diagnosticEntity("heap_free", "data_size", "B", "Tas libre"),
+        diagnosticEntity("heap_min", "data_size", "B", "Tas libre minimum"),
+        diagnosticEntity("heap_largest", "data_size", "B", "Plus grand bloc libre"),
+        diagnosticEntity("rssi", "signal_strength", "dBm", "Signal WiFi"),
+        diagnosticEntity("reconnects", "", "", "Reconnexions"),
+        diagnosticEntity("publish_failed", "", "", "Publications en échec"),
+        diagnosticEntity("uptime_s", "duration", "s", "Temps de fonctionnement"),
+    };
+
+    // Modèle de l'appareil (voir DeviceModel.h), à fournir avant begin(). La table,
+    // en mémoire statique, n'est pas copiée: elle donne la découverte Home Assistant,
+    // un abonnement exact par entité commandable, le routage des commandes et la
+    // précision et la QoS de chaque capteur.
+    template <size_t N>
+    bool setModel(const DeviceEntity (&entities)[N]) {
+        static_assert(N <= 255, "modèle trop grand");
+        static_assert(N + sizeof(DIAGNOSTIC_ENTITIES) / sizeof(DIAGNOSTIC_ENTITIES[0]) <= HADiscoveryConfig::MAX_ENTITIES,
+                      "modèle trop grand pour la découverte Home Assistant");
+        model = entities;
+        modelSize = N;
+
+        bool ok = haConfig.add(entities);
+        for (uint8_t i = 0; i < modelSize; i++) {
+            if (entities[i].precision >= 0) {
+                ok = setPrecision(entities[i].location, entities[i].name, entities[i].precision) && ok;
+            }
+            if (entities[i].qos > 0) {
+                TelemetryChannel* channel = findChannel(entities[i].location, entities[i].name);
+                if (channel) {
+                    channel->qos = entities[i].qos;
+                } else {
+                    ok = false;
+                }
+            }
+        }
+        return ok;
+    }
 
     HADiscoveryConfig& getHAConfig() { return haConfig; }
 
 protected:
     WiFiClient wifiClient;
-    PubSubClient mqttClient;
+    RonoBoxMQTT mqttClient;
     MQTTTopicManager topicManager;
     HADiscoveryConfig haConfig;
 
 private:
-    unsigned long lastReconnectAttempt = 0;
-    const unsigned long reconnectInterval = 10000;
-
-    bool reconnect() {
-        // Génération du client ID différente selon la plateforme
-        String clientId = 
-        #ifdef ESP32
-            "ESP32Client-" + String((uint32_t)ESP.getEfuseMac());
-        #else
-            "ESP8266Client-" + String(ESP.getChipId());
-        #endif
-
-        if (mqttClient.connect(clientId.c_str())) {
-            Serial.println("[MQTT] Connecté avec succès !");
-
-            String subscribeTopic = topicManager.getBaseTopic() + "/+/set";
-            mqttClient.subscribe(subscribeTopic.c_str());
-
-            subscribeTopic = topicManager.getBaseTopic("salon") + "/+/set";
-            mqttClient.subscribe(subscribeTopic.c_str());
-
-            return true;
-        } else {
-            Serial.printf("[MQTT] Échec connexion. Code = %d\n", mqttClient.state());
+    const DeviceEntity* model = nullptr;
+    uint8_t modelSize = 0;
+
+    struct TelemetryChannel {
+        char location[16];
+        char sensor[24];
+        PublishPolicy policy;
+        uint8_t precision;
+        uint8_t qos;            // 1: publication acquittée (alertEntity)
+        bool numeric;
+        bool pending;
+        bool published;
+        bool stale;             // Dernière valeur mise de côté: topic d'état à rafraîchir
+        float pendingValue;
+        float lastValue;
+        unsigned long lastPublish;
+        char pendingPayload[MAX_PAYLOAD_LENGTH];
+        char lastPayload[MAX_PAYLOAD_LENGTH];
+    };
+
+    TelemetryChannel channels[MAX_CHANNELS];
+    uint8_t channelCount = 0;
+    PublishPolicy defaultPolicy = {0, 0, 60000};
+    uint8_t defaultPrecision = 2;
+    unsigned long publishedCount = 0;
+    unsigned long suppressedCount = 0;
+    unsigned long failedCount = 0;
+    unsigned long forwardedCount = 0;
+    TelemetryBuffer backlog;
+    uint8_t drainBatch = 5;
+    unsigned long drainInterval = 100;
+    unsigned long lastDrain = 0;
+    DeviceDiagnostics diagnostics;
+    unsigned long diagnosticsInterval = 60000;
+    unsigned long lastDiagnostics = 0;
+    unsigned long lastDiagnosticsSample = 0;
+    bool diagnosticsDeclared = false;
+
+    // Échantillonne une fois par seconde; publie le rapport quand il est dû et que le
+    // broker est joignable. Son propre coût est mesuré et publié dans le rapport suivant.
+    void updateDiagnostics() {
+        unsigned long now = millis();
+        if (now - lastDiagnosticsSample < 1000) return;
+        lastDiagnosticsSample = now;
+        diagnostics.sample(now);
+
+        if (diagnosticsInterval == 0 || !mqttClient.connected() ||
+            now - lastDiagnostics < diagnosticsInterval) {
+            return;
+        }
+        lastDiagnostics = now;
+
+        uint32_t start = micros();
+        char payload[DeviceDiagnostics::MAX_REPORT_LENGTH];
+        DiagnosticsCounters counters = {
+            publishedCount + forwardedCount, failedCount, link.getReconnectCount(), WiFi.RSSI()
+        };
+        if (diagnostics.report(payload, sizeof(payload), counters) > 0) {
+            topicManager.publish("", "diagnostics", "state", payload, true);
+        }
+        diagnostics.setReportCost(micros() - start);
+    }
+
+    // Quelques lignes par tour: le journal distant ne retarde pas loop()
+    void drainRemoteLog() {
+        char line[DeviceLog::MAX_LINE_LENGTH];
+        for (uint8_t n = 0; n < 4 && DeviceLog::popRemote(line, sizeof(line)); n++) {
+            topicManager.publish("", "log", "state", line, false);
+        }
+    }
+
+    // Entités Home Assistant lues dans le rapport (catégorie "diagnostic")
+    void declareDiagnostics() {
+        if (diagnosticsDeclared || diagnosticsInterval == 0) return;
+        diagnosticsDeclared = true;
+        haConfig.add(DIAGNOSTIC_ENTITIES);
+    }
+
+    TelemetryChannel* findChannel(const char* location, const char* sensor) {
+        for (uint8_t i = 0; i < channelCount; i++) {
+            if (strcmp(channels[i].sensor, sensor) == 0 && strcmp(channels[i].location, location) == 0) {
+                return &channels[i];
+            }
+        }
+        if (channelCount >= MAX_CHANNELS ||
+            strlen(location) >= sizeof(channels[0].location) ||
+            strlen(sensor) >= sizeof(channels[0].sensor)) {
+            return nullptr;
+        }
+        TelemetryChannel& channel = channels[channelCount++];
+        strcpy(channel.location, location);
+        strcpy(channel.sensor, sensor);
+        channel.policy = defaultPolicy;
+        channel.precision = defaultPrecision;
+        channel.qos = 0;
+        channel.numeric = false;
+        channel.pending = false;
+        channel.published = false;
+        channel.stale = false;
+        channel.pendingValue = 0;
+        channel.lastValue = 0;
+        channel.lastPublish = 0;
+        channel.pendingPayload[0] = '\0';
+        channel.lastPayload[0] = '\0';
+        return &channel;
+    }
+
+    static size_t copyPayload(char* buffer, size_t size, const char* text, size_t length) {
+        if (length >= size) {
+            buffer[0] = '\0';
+            return 0;
+        }
+        memcpy(buffer, text, length);
+        buffer[length] = '\0';
+        return length;
+    }
+
+    void stageValue(const char* location, const char* sensor, const char* payload, bool numeric, float value) {
+        TelemetryChannel* channel = nullptr;
+        if (strlen(payload) < MAX_PAYLOAD_LENGTH) {
+            channel = findChannel(location, sensor);
+        }
+        stageValue(channel, location, sensor, payload, numeric, value);
+    }
+
+    // channel == nullptr: table pleine ou valeur trop longue
+    void stageValue(TelemetryChannel* channel, const char* location, const char* sensor,
+                    const char* payload, bool numeric, float value) {
+        if (!channel) {
+            // Table pleine ou valeur trop longue: publication directe, hors politique
+            if (topicManager.publish(location, sensor, "state", payload, true)) {
+                publishedCount++;
+            } else {
+                failedCount++;
+            }
+            return;
+        }
+
+        // Une valeur encore en attente est remplacée par la plus récente (coalescence)
+        if (channel->pending) suppressedCount++;
+        strcpy(channel->pendingPayload, payload);
+        channel->pendingValue = value;
+        channel->numeric = numeric;
+        channel->pending = true;
+    }
+
+    bool hasChanged(const TelemetryChannel& channel) const {
+        // Après "unavailable" (lastValue NaN), la comparaison se fait sur le texte
+        if (channel.numeric && channel.policy.deadband > 0 && !isnan(channel.lastValue)) {
+            return fabs(channel.pendingValue - channel.lastValue) >= channel.policy.deadband;
+        }
+        return strcmp(channel.pendingPayload, channel.lastPayload) != 0;
+    }
+
+    ConnectionStateMachine link;
+    char brokerHost[64] = "";
+    int brokerPort = 1883;
+    bool brokerResolved = false;
+    AsyncDnsQuery dnsQuery;
+    std::function<bool()> announceCallback;
+
+    void setupClient() {
+        declareDiagnostics();
+        // Tampon de réception à la taille des commandes; les messages émis passent par la
+        // file, qui tient au moins une configuration de découverte
+        mqttClient.setBufferSize(PlatformConfig::MQTT_PACKET_SIZE);
+        mqttClient.setQueueSize(PlatformConfig::MQTT_QUEUE_SIZE);
+        mqttClient.setCallback([this](char* topic, byte* payload, unsigned int length) {
+            this->mqttCallback(topic, payload, length);
+        });
+        // Alerte jamais acquittée malgré les retransmissions: comptée comme un échec
+        mqttClient.onDelivery([this](uint16_t packetId, bool delivered) {
+            if (!delivered) {
+                failedCount++;
+                RB_LOG_WARN("[MQTT] Alerte %u non acquittée par le broker", packetId);
+            }
+        });
+    }
+
+    // Étapes élémentaires utilisées par la machine à états de connexion
+    bool linkUp() override {
+        return WiFi.status() == WL_CONNECTED;
+    }
+
+    void requestLink() override {
+        // En mode portail (AP seul), le WiFi est géré par ConfigManager
+        if (WiFi.getMode() & WIFI_STA) {
+            WiFi.reconnect();
+        }
+    }
+
+    // Requête envoyée au premier appel, réponse relevée aux suivants (loop() continue)
+    bool resolveBroker() override {
+        if (brokerResolved) return true;
+        AsyncDnsQuery::Status status = dnsQuery.poll();
+        if (status == AsyncDnsQuery::DNS_IDLE) status = dnsQuery.start(brokerHost, DNS_TIMEOUT_MS);
+
+        switch (status) {
+            case AsyncDnsQuery::DNS_RESOLVED:
+                mqttClient.setServer(dnsQuery.address(), brokerPort);
+                brokerResolved = true;
+                dnsQuery.reset();
+                return true;
+            case AsyncDnsQuery::DNS_FAILED:
+                RB_LOG_WARN("[MQTT] Échec de résolution DNS: %s", brokerHost);
+                dnsQuery.reset();
+                return false;
+            default:
+                return false;
+        }
+    }
+
+    bool resolvePending() override {
+        return dnsQuery.pending();
+    }
+
+    bool forgetBroker() override {
+        if (brokerHost[0] == '\0') return false;
+        brokerResolved = false;
+        return true;
+    }
+
+    // Envoie le CONNECT sans attendre: le CONNACK est lu par mqttClient.loop()
+    bool connectBroker() override {
+        // Client ID: "[modèle]Client-[identifiant de puce]", ex: ESP32Client-1234
+        char clientId[32];
+        snprintf(clientId, sizeof(clientId), "%sClient-%lu",
+                 RonoBoxPlatform::model(), (unsigned long)RonoBoxPlatform::chipId());
+
+        // Dernière volonté: le broker publie "offline" (retenu) si la session tombe sans
+        // déconnexion propre; "online" est republié à chaque nouvelle session
+        char availability[MQTTTopicManager::MAX_TOPIC_LENGTH];
+        haConfig.availabilityTopic(availability, sizeof(availability));
+
+        if (!mqttClient.connect(clientId, nullptr, nullptr, availability, 0, true, "offline")) {
+            RB_LOG_WARN("[MQTT] Échec connexion TCP. Code = %d", mqttClient.state());
             return false;
         }
+        return true;
+    }
+
+    bool brokerConnecting() override {
+        if (mqttClient.connecting()) return true;
+        if (!mqttClient.connected()) {
+            RB_LOG_WARN("[MQTT] Échec connexion. Code = %d", mqttClient.state());
+        }
+        return false;
+    }
+
+    bool brokerConnected() override {
+        return mqttClient.connected();
+    }
+
+    bool sessionOpened() override {
+        char availability[MQTTTopicManager::MAX_TOPIC_LENGTH];
+        haConfig.availabilityTopic(availability, sizeof(availability));
+        if (!mqttClient.publish(availability, "online", true)) {
+            mqttClient.disconnect();
+            return false;
+        }
+        RB_LOG_INFO("[MQTT] Connecté avec succès !");
+
+        // Le broker a pu perdre les états retenus (redémarrage sans persistance):
+        // les dernières valeurs connues sont republiées par flushPending()
+        refreshStates();
+        return true;
+    }
+
+    // Home Assistant redémarré: il a perdu les configurations et les états non
+    // retenus par le broker. Annonce complète et instantané des états, sans attendre
+    // la prochaine mesure; les reconnexions de l'appareil, elles, ne refont la
+    // découverte que si elle a changé.
+    void handleHAStatus(const MQTTSpan& status) {
+        if (!status.equals("online")) return;
+        RB_LOG_INFO("[HA] Home Assistant en ligne, nouvelle annonce");
+        haConfig.requestFullAnnounce();
+        link.requestAnnounce();
+        refreshStates();
+    }
+
+    // Chaque capteur déjà publié renverra sa dernière valeur au prochain flushPending()
+    void refreshStates() {
+        for (uint8_t i = 0; i < channelCount; i++) {
+            if (channels[i].published) channels[i].stale = true;
+        }
     }
 
+    // Un abonnement exact par entité commandable, plus le statut de Home Assistant:
+    // rien d'autre n'est reçu
+    bool subscribeTopics() override {
+        char subscribeTopic[MQTTTopicManager::MAX_TOPIC_LENGTH];
+        bool ok = mqttClient.subscribe(HADiscoveryConfig::STATUS_TOPIC);
+        for (uint8_t i = 0; i < modelSize; i++) {
+            if (!model[i].command) continue;
+            if (topicManager.buildTopic(subscribeTopic, sizeof(subscribeTopic),
+                                        model[i].location, model[i].name, "set") == 0) {
+                ok = false;
+                continue;
+            }
+            ok = mqttClient.subscribe(subscribeTopic) && ok;
+        }
+        return ok;
+    }
+
+    bool announce() override {
+        return announceCallback ? announceCallback() : haConfig.announce();
+    }
+
+    bool announcePending() override {
+        return !announceCallback && haConfig.isAnnouncing();
+    }
+
+protected:
+    // Découpe le topic en place (les '/' sont remplacés par '\0' dans le buffer reçu)
+    // et dispatche vers l'entité du modèle, sans copie ni allocation: le hash du nom
+    // reçu est comparé à celui calculé à la compilation.
+    // Format attendu: home/[location]/[deviceId]/[device]/[action],
+    // ou home/[deviceId]/[device]/[action] pour une entité sans pièce.
+    // Protégée: une classe dérivée peut y rejouer un message (commande locale, mesures).
     void mqttCallback(char* topic, byte* payload, unsigned int length) {
-        // Utilisation de buffers statiques pour éviter les allocations dynamiques
-        static char topicBuffer[128];
-        static char payloadBuffer[128];
-        
-        // Conversion sécurisée
-        strncpy(topicBuffer, topic, sizeof(topicBuffer) - 1);
-        topicBuffer[sizeof(topicBuffer) - 1] = '\0';
-        
-        unsigned int copyLength = min(length, sizeof(payloadBuffer) - 1);
-        strncpy(payloadBuffer, (const char*)payload, copyLength);
-        payloadBuffer[copyLength] = '\0';
-
-        #ifdef DEBUG
-            Serial.printf("[MQTT] Message reçu. Topic: %s, Payload: %s\n", topicBuffer, payloadBuffer);
-        #endif
-
-        // Parsing du topic
-        char* location = nullptr;
-        char* deviceId = nullptr;
-        char* device = nullptr;
-        char* action = nullptr;
-
-        char* token = strtok(topicBuffer, "/");
-        int part = 0;
-
-        while (token != nullptr) {
-            if (strcmp(token, "home") == 0) {
-                part = 1;
-            } else if (part == 1) {
-                location = token;
-                part = 2;
-            } else if (part == 2) {
-                deviceId = token;
-                part = 3;
-            } else if (part == 3) {
-                device = token;
-                part = 4;
-            } else if (part == 4) {
-                action = token;
-                break;
+        if (strcmp(topic, HADiscoveryConfig::STATUS_TOPIC) == 0) {
+            handleHAStatus({ (const char*)payload, length });
+            return;
+        }
+
+        MQTTSpan parts[5];
+        uint8_t count = 0;
+        char* start = topic;
+
+        for (char* p = topic; ; p++) {
+            if (*p == '/' || *p == '\0') {
+                bool last = (*p == '\0');
+                if (count == 5) {
+                    count++; // Trop de niveaux
+                    break;
+                }
+                parts[count].data = start;
+                parts[count].length = p - start;
+                count++;
+                if (last) break;
+                *p = '\0';
+                start = p + 1;
             }
-            token = strtok(nullptr, "/");
         }
 
-        // Validation des données parsées
-        if (!location || !deviceId || !device || !action) {
-            #ifdef DEBUG
-                Serial.println("[ERREUR] Structure de topic invalide");
-            #endif
+        MQTTSpan value = { (const char*)payload, length };
+
+        if (count < 4 || count > 5 || !parts[0].equals("home")) {
+            RB_LOG_DEBUG("[MQTT] Structure de topic invalide");
             return;
-        } 
+        }
+
+        static const MQTTSpan NO_LOCATION = { "", 0 };
+        const MQTTSpan& location = count == 5 ? parts[1] : NO_LOCATION;
+        const MQTTSpan& device = parts[count - 2];
+        const MQTTSpan& action = parts[count - 1];
+
+        RB_LOG_DEBUG("[MQTT] %s/%s/%s <- %.*s", location.data, device.data, action.data, (int)value.length, value.data);
 
-        #ifdef DEBUG
-            if (length == 0) {
-                Serial.println("[WARNING] Payload vide reçu");
+        if (!action.equals("set")) {
+            RB_LOG_DEBUG("[MQTT] Message ignoré (action non gérée: %s)", action.data);
+            return;
+        }
+
+        uint32_t hash = entityHash(device);
+        for (uint8_t i = 0; i < modelSize; i++) {
+            const DeviceEntity& entity = model[i];
+            if (entity.command && entity.nameHash == hash &&
+                device.equals(entity.name) && location.equals(entity.location)) {
+                entity.command(location, value);
+                return;
             }
-            Serial.printf("[MQTT] Parsed - Location: %s, DeviceID: %s, Device: %s, Action: %s\n", 
-                      location, deviceId, device, action ? action : "none");
-        #endif
-
-        // Gestion des commandes
-        if (action && strcmp(action, "set") == 0) {
-            handleCommand(location, device, payloadBuffer);
-        } else {
-            #ifdef DEBUG
-                Serial.printf("[INFO] Message ignoré (action non gérée: %s)\n", action ? action : "null");
-            #endif
-        }
-
-        // Nettoyage
-        memset(topicBuffer, 0, sizeof(topicBuffer));
-        memset(payloadBuffer, 0, sizeof(payloadBuffer));
+        }
+
+        RB_LOG_DEBUG("[MQTT] Aucun gestionnaire pour: %s", device.data);
     }
 };
 
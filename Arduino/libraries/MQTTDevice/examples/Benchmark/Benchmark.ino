@@ -0,0 +1,225 @@
+// Microbenchmarks des chemins chauds: construction de topic, formatage des mesures,
+// publication (QoS0 et QoS1 acquittée), mise en attente d'une mesure, dispatch d'une commande,
+// annonce Home Assistant, évaluation des règles d'alarme, instrumentation (diagnostics) et journal.
+//
+// Tout tourne sur la carte, sans WiFi ni broker: la publication passe par un
+// RonoBoxMQTT branché sur un LoopbackClient. Le temps est mesuré au compteur de
+// cycles (ESP.getCycleCount) et converti en ns avec la fréquence CPU.
+//
+// Une ligne JSON par exécution sur le port série, à comparer d'une version à l'autre:
+//   {"target":"esp32","cpu_mhz":240,"iterations":1000,"results":[{"name":"topic_build",...}]}
+//
+// heap_delta_per_op: octets non rendus par opération (fuite ou croissance de cache)
+// peak_heap_bytes:   plus forte consommation transitoire observée pendant la série
+
+// Les messages de l'annonce fausseraient la mesure et la sortie JSON
+#define HA_DISCOVERY_LOG_LEVEL 0
+
+// Coût du journal sur le traitement des messages (command_dispatch, log_debug_line):
+// 4 garde les traces debug, 0 les retire à la compilation comme en production.
+// Comparer deux exécutions; le niveau figure dans la ligne JSON ("log_level").
+// Le journal n'est jamais vidé ici: une fois son tampon plein, les lignes sont perdues
+// et la mesure ne retient que le formatage, sans l'attente du port série.
+#ifndef RONOBOX_LOG_LEVEL
+  #define RONOBOX_LOG_LEVEL 4
+#endif
+
+#include <MQTTDevice.h>
+#include <AlarmRules.h>
+#include "LoopbackClient.h"
+
+#ifdef ESP32
+  #include <esp_idf_version.h>
+  #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+    #include <esp_heap_caps.h>
+    #define BENCH_HEAP_MONITOR
+  #endif
+#endif
+
+static const uint32_t ITERATIONS = 1000;
+static const uint32_t WARMUP = 16;
+
+// Expose le dispatch des commandes, normalement appelé par le client MQTT
+class BenchDevice : public MQTTDevice {
+public:
+    using MQTTDevice::MQTTDevice;
+
+    void dispatch(char* topic, byte* payload, unsigned int length) {
+        mqttCallback(topic, payload, length);
+    }
+};
+
+LoopbackClient loopback;
+RonoBoxMQTT loopbackMqtt(loopback);
+MQTTTopicManager topics(loopbackMqtt, "A1B2C3D4E5F6");
+HADiscoveryConfig haConfig(topics);
+BenchDevice device("A1B2C3D4E5F6");
+AlarmEngine alarms;
+int gasInput = -1;
+
+// Table pleine, toutes les règles sur la même grandeur: pire cas d'un échantillon
+const AlarmRule BENCH_RULES[] = {
+    {"gaz", ALARM_ABOVE, 0, 1, 0, 30, 3, 0},
+    {"gaz", ALARM_RISE, 0, 1, 0, 10, 5, 0},
+    {"gaz", ALARM_BELOW, 0, 1, 0, 5, 1, 2000},
+    {"gaz", ALARM_ABOVE, 0, 1, 0, 60, 5, 500},
+    {"gaz", ALARM_ABOVE, 0, 1, 0, 70, 5, 0},
+    {"gaz", ALARM_RISE, 0, 1, 0, 20, 5, 1000},
+    {"gaz", ALARM_BELOW, 0, 1, 0, 2, 1, 0},
+    {"gaz", ALARM_ABOVE, 0, 1, 0, 90, 5, 0},
+};
+
+bool firstResult = true;
+volatile uint32_t sink = 0;   // Empêche le compilateur d'éliminer les appels mesurés
+
+constexpr DeviceEntity BENCH_MODEL[] = {
+    sensorEntity("salon", "temperature", "temperature", "°C", "Température Salon"),
+    sensorEntity("salon", "humidity", "humidity", "%", "Humidité Salon"),
+    binarySensorEntity("salon", "motion", "motion", "Mouvement Salon"),
+    switchEntity("salon", "lampe", "Lampe Salon", [](const MQTTSpan& location, const MQTTSpan& payload) {
+        sink += location.length + payload.length;
+    }),
+};
+
+template <typename Operation>
+void runBenchmark(const char* name, Operation operation) {
+    for (uint32_t i = 0; i < WARMUP; i++) operation(i);
+    DeviceLog::clear();
+
+    uint32_t heapBefore = ESP.getFreeHeap();
+    uint32_t lowest = heapBefore;
+    uint64_t cycles = 0;
+    uint32_t minCycles = UINT32_MAX;
+
+    #ifdef BENCH_HEAP_MONITOR
+        heap_caps_monitor_local_minimum_free_size_start();
+    #endif
+
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        uint32_t start = ESP.getCycleCount();
+        operation(i);
+        uint32_t elapsed = ESP.getCycleCount() - start;   // Correct même si le compteur déborde
+
+        cycles += elapsed;
+        if (elapsed < minCycles) minCycles = elapsed;
+
+        uint32_t freeHeap = ESP.getFreeHeap();
+        if (freeHeap < lowest) lowest = freeHeap;
+    }
+
+    #ifdef BENCH_HEAP_MONITOR
+        uint32_t monitored = heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+        if (monitored < lowest) lowest = monitored;
+        heap_caps_monitor_local_minimum_free_size_stop();
+    #endif
+
+    int32_t heapDelta = (int32_t)heapBefore - (int32_t)ESP.getFreeHeap();
+    uint32_t mhz = ESP.getCpuFreqMHz();
+    float cyclesPerOp = (float)cycles / ITERATIONS;
+
+    Serial.printf("%s{\"name\":\"%s\",\"ns_per_op\":%.1f,\"min_ns\":%.1f,\"cycles_per_op\":%.1f,"
+                  "\"heap_delta_per_op\":%.2f,\"peak_heap_bytes\":%u}",
+                  firstResult ? "" : ",", name,
+                  cyclesPerOp * 1000.0f / mhz, minCycles * 1000.0f / mhz, cyclesPerOp,
+                  (float)heapDelta / ITERATIONS, (unsigned)(heapBefore - lowest));
+    firstResult = false;
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    loopbackMqtt.setServer(IPAddress(127, 0, 0, 1), 1883);
+    loopbackMqtt.setBufferSize(PlatformConfig::MQTT_PACKET_SIZE);
+    loopbackMqtt.setQueueSize(PlatformConfig::MQTT_QUEUE_SIZE);
+    loopbackMqtt.connect("benchClient");
+    while (!loopbackMqtt.connected()) loopbackMqtt.loop();   // CONNACK immédiat du loopback
+
+    haConfig.add(BENCH_MODEL);
+    // Première annonce complète, au rythme de la file d'émission: les suivantes ne font que l'empreinte
+    while (!haConfig.announce()) loopbackMqtt.loop();
+
+    device.setModel(BENCH_MODEL);
+
+    gasInput = alarms.addInput("gaz");
+    alarms.begin(BENCH_RULES, sizeof(BENCH_RULES) / sizeof(BENCH_RULES[0]));
+}
+
+void loop() {
+    firstResult = true;
+    Serial.printf("{\"target\":\"%s\",\"cpu_mhz\":%u,\"iterations\":%u,\"log_level\":%d,\"results\":[",
+                  RonoBoxPlatform::name(), (unsigned)ESP.getCpuFreqMHz(), (unsigned)ITERATIONS,
+                  RONOBOX_LOG_LEVEL);
+
+    runBenchmark("topic_build", [](uint32_t) {
+        char topic[MQTTTopicManager::MAX_TOPIC_LENGTH];
+        sink += topics.buildTopic(topic, sizeof(topic), "salon", "temperature", "state");
+    });
+
+    runBenchmark("topic_build_string", [](uint32_t) {
+        sink += topics.getTopic("salon", "temperature", "state").length();
+    });
+
+    runBenchmark("float_format_fixed", [](uint32_t i) {
+        char payload[MQTTDevice::MAX_PAYLOAD_LENGTH];
+        sink += MQTTDevice::formatFixed(payload, sizeof(payload), 20.0f + (i % 100) * 0.01f, 1);
+    });
+
+    runBenchmark("float_format_string", [](uint32_t i) {
+        sink += String(20.0f + (i % 100) * 0.01f, 1).length();
+    });
+
+    // Mise en file puis tour de loop() qui l'écrit, comme dans MQTTDevice::handle()
+    runBenchmark("publish", [](uint32_t i) {
+        char payload[12];
+        snprintf(payload, sizeof(payload), "%u", (unsigned)i);
+        sink += topics.publish("salon", "temperature", "state", payload, true);
+        loopbackMqtt.loop();
+    });
+
+    // Aller-retour complet d'une alerte: envoi, PUBACK du loopback, libération de la fenêtre
+    runBenchmark("publish_qos1", [](uint32_t i) {
+        sink += topics.publish("cuisine", "buzzer", "state", (i & 1) ? "ON" : "OFF", true, 1);
+        loopbackMqtt.loop();
+    });
+
+    runBenchmark("sensor_stage", [](uint32_t i) {
+        device.publishSensorData("salon", "temperature", 20.0f + (i % 100) * 0.1f);
+    });
+
+    runBenchmark("command_dispatch", [](uint32_t) {
+        // Le topic est découpé en place: chaque itération repart d'une copie fraîche
+        char topic[] = "home/salon/esp32-A1B2C3D4E5F6/lampe/set";
+        byte payload[] = { 'O', 'N' };
+        device.dispatch(topic, payload, sizeof(payload));
+    });
+
+    runBenchmark("log_debug_line", [](uint32_t i) {
+        RB_LOG_DEBUG("[MQTT] %s/%s/%s <- %.*s", "salon", "esp32-A1B2C3D4E5F6", "lampe", 2, "ON");
+        sink += i;
+    });
+
+    runBenchmark("alarm_evaluate", [](uint32_t i) {
+        alarms.evaluate(gasInput, (float)(i % 100), i * 10);   // Franchit tous les seuils
+        sink += alarms.firstActive();
+    });
+
+    // Coût ajouté à chaque tour de loop() par l'instrumentation
+    runBenchmark("diagnostics_record", [](uint32_t) {
+        device.getDiagnostics().recordLoop();
+    });
+
+    runBenchmark("diagnostics_report", [](uint32_t) {
+        char payload[DeviceDiagnostics::MAX_REPORT_LENGTH];
+        DiagnosticsCounters counters = { 1000, 2, 3, -60 };
+        sink += device.getDiagnostics().report(payload, sizeof(payload), counters);
+    });
+
+    runBenchmark("ha_announce_unchanged", [](uint32_t) {
+        sink += haConfig.announce();
+    });
+
+    Serial.printf("],\"bytes_written\":%u,\"qos1_inflight\":%u}\n", (unsigned)loopback.getBytesWritten(),
+                  (unsigned)loopbackMqtt.getInflightCount());
+    delay(10000);
+}
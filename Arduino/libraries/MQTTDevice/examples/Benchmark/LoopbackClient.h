@@ -0,0 +1,122 @@
+#ifndef LoopbackClient_h
+#define LoopbackClient_h
+
+#include <Client.h>
+
+// Client réseau factice: accepte la connexion, répond au CONNECT par un CONNACK,
+// à chaque PUBLISH QoS1 par un PUBACK, et absorbe tout le reste. Le client MQTT
+// passe ainsi par tout son chemin de publication (en-têtes, longueur variable,
+// fenêtre QoS1 et accusés) sans broker.
+class LoopbackClient : public Client {
+public:
+    int connect(IPAddress, uint16_t) override { return open(); }
+    int connect(const char*, uint16_t) override { return open(); }
+
+    size_t write(uint8_t byte) override {
+        bytesWritten++;
+        scan(byte);
+        return 1;
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        bytesWritten += size;
+        for (size_t i = 0; i < size; i++) scan(buffer[i]);
+        return size;
+    }
+
+    int availableForWrite() override { return 1460; }   // Jamais plein
+    int available() override { return inboundLength - inboundRead; }
+
+    int read() override {
+        if (inboundRead == inboundLength) return -1;
+        uint8_t byte = inbound[inboundRead++];
+        if (inboundRead == inboundLength) inboundRead = inboundLength = 0;
+        return byte;
+    }
+
+    int read(uint8_t* buffer, size_t size) override {
+        size_t n = 0;
+        while (n < size && available() > 0) buffer[n++] = read();
+        return n;
+    }
+
+    int peek() override { return available() ? inbound[inboundRead] : -1; }
+    void flush() override {}
+    void stop() override { isOpen = false; inboundRead = inboundLength = 0; }
+    uint8_t connected() override { return isOpen; }
+    operator bool() override { return isOpen; }
+
+    uint32_t getBytesWritten() const { return bytesWritten; }
+
+private:
+    // CONNACK: session acceptée
+    static constexpr uint8_t CONNACK[4] = { 0x20, 0x02, 0x00, 0x00 };
+
+    bool isOpen = false;
+    uint32_t bytesWritten = 0;
+    uint8_t inbound[32];
+    uint8_t inboundRead = 0;
+    uint8_t inboundLength = 0;
+
+    // Découpage minimal du flux émis, pour repérer l'identifiant des PUBLISH QoS1
+    uint8_t packetType = 0;
+    uint8_t lengthShift = 0;
+    uint32_t packetLength = 0;
+    uint32_t packetOffset = 0;
+    uint16_t topicLength = 0;
+    uint16_t packetId = 0;
+    bool inHeader = true;
+    bool inLength = false;
+
+    int open() {
+        isOpen = true;
+        inboundRead = inboundLength = 0;
+        inHeader = true;
+        inLength = false;
+        queue(CONNACK, sizeof(CONNACK));
+        return 1;
+    }
+
+    void queue(const uint8_t* data, uint8_t size) {
+        if (inboundLength + size > sizeof(inbound)) return;
+        memcpy(inbound + inboundLength, data, size);
+        inboundLength += size;
+    }
+
+    void scan(uint8_t byte) {
+        if (inHeader) {
+            packetType = byte;
+            packetLength = 0;
+            lengthShift = 0;
+            inHeader = false;
+            inLength = true;
+            return;
+        }
+        if (inLength) {
+            packetLength |= (uint32_t)(byte & 0x7F) << lengthShift;
+            lengthShift += 7;
+            if (byte & 0x80) return;
+            inLength = false;
+            packetOffset = 0;
+            inHeader = packetLength == 0;
+            return;
+        }
+
+        bool qos1Publish = (packetType & 0xF6) == 0x32;
+        if (qos1Publish) {
+            if (packetOffset == 0) topicLength = byte << 8;
+            else if (packetOffset == 1) topicLength |= byte;
+            else if (packetOffset == 2u + topicLength) packetId = byte << 8;
+            else if (packetOffset == 3u + topicLength) {
+                packetId |= byte;
+                const uint8_t puback[] = { 0x40, 0x02, (uint8_t)(packetId >> 8), (uint8_t)packetId };
+                queue(puback, sizeof(puback));
+            }
+        }
+        if (++packetOffset == packetLength) inHeader = true;
+    }
+};
+
+constexpr uint8_t LoopbackClient::CONNACK[4];
+
+#endif
@@ -1,83 +1,134 @@
 #ifndef MQTTTopicManager_h
 #define MQTTTopicManager_h
 
-// Includes spécifiques aux plateformes
-#ifdef ESP32
-  #include <WiFi.h>
-#else // ESP8266
-  #include <ESP8266WiFi.h>
-#endif
+#include <RonoBoxPlatform.h>
 
-#include <PubSubClient.h>
+#include <RonoBoxMQTT.h>
 
 class MQTTTopicManager {
 public:
-    MQTTTopicManager(PubSubClient& mqttClient, const String& deviceMac)
-        : client(mqttClient), macAddress(deviceMac) {}
+    // Taille max d'un topic complet: home/[location]/[prefix]-[mac]/[device]/[type]
+    static const size_t MAX_TOPIC_LENGTH = 128;
+    // Nombre de topics de base (un par location) gardés en cache
+    static const uint8_t MAX_CACHED_LOCATIONS = 4;
+    static const size_t MAX_LOCATION_LENGTH = 24;
+    static const size_t MAX_BASE_TOPIC_LENGTH = 72;
 
-    String getMacAddress() const {
+    MQTTTopicManager(RonoBoxMQTT& mqttClient, const String& deviceMac)
+        : client(mqttClient), macAddress(deviceMac), cachedCount(0) {}
+
+    const String& getMacAddress() const {
         return macAddress;
     }
 
-    PubSubClient& getClient() {
+    RonoBoxMQTT& getClient() {
         return client;
     }
 
     String getBaseTopic(const String& location = "") {
-        String topic = "home/";
-        if (location.length() > 0) {
-            topic += location + "/";
-        }
-        #ifdef ESP32
-            topic += "esp32-" + macAddress;
-        #else
-            topic += "esp8266-" + macAddress;
-        #endif
-        return topic;
+        return String(baseTopic(location.c_str()));
     }
 
     String getTopic(const String& location, const String& device, const String& type) {
-        return getBaseTopic(location) + "/" + device + "/" + type;
+        char topic[MAX_TOPIC_LENGTH];
+        buildTopic(topic, sizeof(topic), location.c_str(), device.c_str(), type.c_str());
+        return String(topic);
+    }
+
+    // Topic de base "home/[location/][prefix]-[mac]", construit une seule fois par location
+    // puis servi depuis le cache (aucune allocation en régime établi)
+    const char* baseTopic(const char* location = "") {
+        if (location == nullptr) location = "";
+
+        for (uint8_t i = 0; i < cachedCount; i++) {
+            if (strcmp(cache[i].location, location) == 0) {
+                return cache[i].topic;
+            }
+        }
+
+        if (cachedCount < MAX_CACHED_LOCATIONS && strlen(location) < MAX_LOCATION_LENGTH) {
+            BaseTopicEntry& entry = cache[cachedCount++];
+            strcpy(entry.location, location);
+            formatBaseTopic(entry.topic, sizeof(entry.topic), location);
+            return entry.topic;
+        }
+
+        // Cache plein: formatage dans un buffer de travail (toujours sans allocation)
+        formatBaseTopic(scratchBaseTopic, sizeof(scratchBaseTopic), location);
+        return scratchBaseTopic;
     }
 
-    bool publish(const String& location, const String& device, const String& type, 
+    // Écrit "[base]/[device]/[type]" dans le buffer fourni.
+    // Retourne la longueur écrite, ou 0 si le buffer est trop petit.
+    size_t buildTopic(char* buffer, size_t size, const char* location,
+                      const char* device, const char* type) {
+        const char* base = baseTopic(location);
+        size_t baseLen = strlen(base);
+        size_t deviceLen = strlen(device);
+        size_t typeLen = strlen(type);
+        size_t total = baseLen + 1 + deviceLen + 1 + typeLen;
+
+        if (total >= size) {
+            if (size > 0) buffer[0] = '\0';
+            return 0;
+        }
+
+        char* p = buffer;
+        memcpy(p, base, baseLen);     p += baseLen;
+        *p++ = '/';
+        memcpy(p, device, deviceLen); p += deviceLen;
+        *p++ = '/';
+        memcpy(p, type, typeLen);     p += typeLen;
+        *p = '\0';
+        return total;
+    }
+
+    bool publish(const char* location, const char* device, const char* type,
+                const char* payload, bool retained = false, uint8_t qos = 0) {
+        char topic[MAX_TOPIC_LENGTH];
+        if (buildTopic(topic, sizeof(topic), location, device, type) == 0) {
+            return false;
+        }
+        return client.publish(topic, payload, retained, qos);
+    }
+
+    bool publish(const String& location, const String& device, const String& type,
                 const String& payload, bool retained = false) {
-        String topic = getTopic(location, device, type);
-        return client.publish(topic.c_str(), payload.c_str(), retained);
+        return publish(location.c_str(), device.c_str(), type.c_str(), payload.c_str(), retained);
     }
 
-    bool publish(const String& location, const String& device, const String& type, 
+    bool publish(const String& location, const String& device, const String& type,
                 const bool& payload, bool retained = false) {
-        String topic = getTopic(location, device, type);
         const char* boolStr = payload ? "true" : "false";
-        return client.publish(topic.c_str(), boolStr, retained);
+        return publish(location.c_str(), device.c_str(), type.c_str(), boolStr, retained);
     }
-    
+
+    // La connexion est menée par la machine à états de MQTTDevice:
+    // on se contente de constater l'état, sans jamais bloquer
     bool ensureConnected() {
-        if (!client.connected()) {
-            #ifdef ESP32
-                String clientId = "ESP32Client-" + String((uint32_t)ESP.getEfuseMac());
-            #else
-                String clientId = "ESP8266Client-" + String(ESP.getChipId());
-            #endif
-
-            if (client.connect(clientId.c_str())) {
-                // Resubscribe to necessary topics
-                client.subscribe((getBaseTopic() + "/+/set").c_str());
-                client.subscribe((getBaseTopic("salon") + "/+/set").c_str());
-                #ifdef ESP32
-                    client.subscribe((getBaseTopic("cuisine") + "/+/set").c_str());
-                #endif
-                return true;
-            }
-            return false;
-        }
-        return true;
+        return client.connected();
     }
 
 private:
-    PubSubClient& client;
+    struct BaseTopicEntry {
+        char location[MAX_LOCATION_LENGTH];
+        char topic[MAX_BASE_TOPIC_LENGTH];
+    };
+
+    RonoBoxMQTT& client;
     String macAddress;
+    BaseTopicEntry cache[MAX_CACHED_LOCATIONS];
+    uint8_t cachedCount;
+    char scratchBaseTopic[MAX_BASE_TOPIC_LENGTH];
+
+    void formatBaseTopic(char* buffer, size_t size, const char* location) {
+        const char* prefix = RonoBoxPlatform::name();
+        if (location[0] != '\0') {
+            snprintf(buffer, size, "home/%s/%s-%s", location, prefix, macAddress.c_str());
+        } else {
+            snprintf(buffer, size, "home/%s-%s", prefix, macAddress.c_str());
+        }
+    }
 };
 
 #endif
\ No newline at end of file
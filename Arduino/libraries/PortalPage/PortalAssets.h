@@ -0,0 +1,36 @@
+#ifndef PortalAssets_h
+#define PortalAssets_h
+
+#include <Arduino.h>
+
+// Feuille de style du portail (extras/portal.css), précompressée:
+//   gzip -9 -n -c extras/portal.css | xxd -i
+// Servie telle quelle avec "Content-Encoding: gzip", jamais décompressée sur l'ESP
+static const uint8_t PORTAL_CSS_GZ[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x65, 0x90,
+  0xc1, 0x6e, 0x83, 0x30, 0x10, 0x44, 0xef, 0xfd, 0x8a, 0x95, 0xa2, 0x1e,
+  0x5d, 0x41, 0x80, 0xaa, 0x35, 0xa7, 0xa8, 0x52, 0xff, 0xc3, 0xc6, 0x06,
+  0x56, 0x31, 0x5e, 0xcb, 0x18, 0x85, 0xb4, 0xea, 0xbf, 0xd7, 0x38, 0xa4,
+  0xa1, 0x89, 0x7c, 0xf3, 0xbe, 0x99, 0x9d, 0x1d, 0x49, 0xea, 0x0c, 0xdf,
+  0xd0, 0x92, 0x0d, 0xac, 0x15, 0x03, 0x9a, 0x33, 0x87, 0x83, 0x47, 0x61,
+  0x6a, 0x18, 0x84, 0xef, 0xd0, 0x72, 0xd8, 0x67, 0x6e, 0xae, 0xe1, 0xe7,
+  0xe9, 0xa5, 0x89, 0x90, 0x40, 0xab, 0x7d, 0x14, 0x0c, 0x62, 0x66, 0x27,
+  0x54, 0xa1, 0xe7, 0x50, 0x65, 0x09, 0xb8, 0xe2, 0x19, 0x88, 0x29, 0x50,
+  0x12, 0xb4, 0xe4, 0x07, 0xd6, 0x79, 0x9a, 0x5c, 0x52, 0x2c, 0x73, 0x26,
+  0x29, 0x04, 0x1a, 0x38, 0xe4, 0xd5, 0xc5, 0xd5, 0x08, 0xa9, 0x4d, 0x1c,
+  0x2b, 0x1c, 0x9d, 0x11, 0x71, 0xbb, 0x34, 0xd4, 0x1c, 0xeb, 0x7b, 0x7c,
+  0xa5, 0xd1, 0xba, 0x29, 0x44, 0x7a, 0x5d, 0x9d, 0x67, 0xd9, 0x73, 0x0d,
+  0x4e, 0x28, 0x85, 0xb6, 0xe3, 0xf0, 0xb6, 0x40, 0x92, 0x66, 0x36, 0xe2,
+  0x57, 0xfa, 0x90, 0xe4, 0x95, 0xf6, 0xd1, 0x24, 0x89, 0xe5, 0x14, 0xbd,
+  0x6c, 0x54, 0x4b, 0xd1, 0x1c, 0x97, 0x58, 0x56, 0x71, 0xd8, 0x95, 0x1f,
+  0x87, 0xcf, 0x2a, 0xab, 0xa1, 0x21, 0x43, 0x9e, 0xc3, 0xa9, 0xc7, 0xa0,
+  0x37, 0x9e, 0x79, 0x3c, 0x6e, 0x0d, 0x7b, 0x71, 0xe3, 0x60, 0xc9, 0x46,
+  0xe2, 0x5f, 0x84, 0x78, 0xac, 0xd7, 0xa3, 0x0e, 0x4c, 0x86, 0x87, 0x05,
+  0x6d, 0x59, 0x16, 0xc5, 0xeb, 0xdf, 0x45, 0x81, 0xdc, 0xa6, 0xd3, 0x54,
+  0xd1, 0xa8, 0x9b, 0x80, 0x8f, 0xc9, 0xda, 0xf7, 0xe5, 0x6d, 0xb3, 0x6c,
+  0x62, 0x30, 0x2f, 0x14, 0x4e, 0xe3, 0xda, 0xcc, 0x5d, 0x5b, 0x57, 0xfb,
+  0x7e, 0x7f, 0x2b, 0x3e, 0xed, 0xbd, 0xdd, 0xb9, 0x2b, 0x8a, 0x62, 0x41,
+  0x7e, 0x01, 0xe3, 0xa1, 0x04, 0xbf, 0x01, 0x02, 0x00, 0x00
+};
+
+#endif
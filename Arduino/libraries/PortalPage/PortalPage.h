@@ -0,0 +1,149 @@
+#ifndef PortalPage_h
+#define PortalPage_h
+
+#include <Arduino.h>
+#include <RonoBoxPlatform.h>
+
+// Serveur HTTP de chaque cœur, compilé s'il est présent (les deux sur l'hôte)
+#if __has_include(<WebServer.h>)
+  #include <WebServer.h>
+  #define RONOBOX_HAS_WEBSERVER 1
+#endif
+#if __has_include(<ESP8266WebServer.h>)
+  #include <ESP8266WebServer.h>
+  #define RONOBOX_HAS_ESP8266WEBSERVER 1
+#endif
+
+#include "PortalAssets.h"
+
+// Serveur du portail pour une cible: PlatformWebServer
+template <RonoBoxTarget Target>
+struct PortalServerBackend;
+
+#ifdef RONOBOX_HAS_WEBSERVER
+template <>
+struct PortalServerBackend<RonoBoxTarget::Esp32> {
+    typedef WebServer Type;
+};
+#endif
+
+#ifdef RONOBOX_HAS_ESP8266WEBSERVER
+template <>
+struct PortalServerBackend<RonoBoxTarget::Esp8266> {
+    typedef ESP8266WebServer Type;
+};
+#endif
+
+typedef PortalServerBackend<RONOBOX_TARGET>::Type PlatformWebServer;
+
+// Rendu en flux d'une page du portail captif.
+// Le gabarit reste en flash: les marqueurs {{0}}..{{9}} sont remplacés par les
+// valeurs échappées, le tout passe par un petit tampon sur la pile et part en
+// transfert chunked. La page complète n'existe jamais en RAM.
+//
+// Server: WebServer (ESP32) ou ESP8266WebServer
+template <typename Server>
+class PortalPage {
+public:
+    static const size_t CHUNK_SIZE = 256;
+
+    PortalPage(Server& webServer) : server(webServer), length(0) {}
+
+    // Ouvre une réponse de longueur inconnue (Transfer-Encoding: chunked)
+    void begin(int code = 200, const char* contentType = "text/html") {
+        server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+        server.send(code, contentType, "");
+    }
+
+    // Envoie le gabarit en remplaçant chaque {{n}} par values[n]
+    void render(PGM_P tpl, const char* const* values = nullptr, uint8_t count = 0) {
+        PGM_P literal = tpl;
+        PGM_P p = tpl;
+        char c;
+
+        while ((c = pgm_read_byte(p)) != '\0') {
+            if (c == '{' && pgm_read_byte(p + 1) == '{') {
+                char digit = pgm_read_byte(p + 2);
+                if (digit >= '0' && digit <= '9' &&
+                    pgm_read_byte(p + 3) == '}' && pgm_read_byte(p + 4) == '}') {
+                    writeP(literal, p - literal);
+                    uint8_t index = digit - '0';
+                    if (index < count && values[index] != nullptr) {
+                        writeEscaped(values[index]);
+                    }
+                    p += 5;
+                    literal = p;
+                    continue;
+                }
+            }
+            p++;
+        }
+        writeP(literal, p - literal);
+    }
+
+    void write(const char* data, size_t len) {
+        while (len > 0) {
+            size_t n = min(len, CHUNK_SIZE - length);
+            memcpy(buffer + length, data, n);
+            append(n);
+            data += n;
+            len -= n;
+        }
+    }
+
+    void writeP(PGM_P data, size_t len) {
+        while (len > 0) {
+            size_t n = min(len, CHUNK_SIZE - length);
+            memcpy_P(buffer + length, data, n);
+            append(n);
+            data += n;
+            len -= n;
+        }
+    }
+
+    // Échappe & < > " ' pour pouvoir placer la valeur dans un attribut value="..."
+    void writeEscaped(const char* value) {
+        for (; *value != '\0'; value++) {
+            switch (*value) {
+                case '&':  write("&amp;", 5);  break;
+                case '<':  write("&lt;", 4);   break;
+                case '>':  write("&gt;", 4);   break;
+                case '"':  write("&quot;", 6); break;
+                case '\'': write("&#39;", 5);  break;
+                default:   write(value, 1);    break;
+            }
+        }
+    }
+
+    // Vide le tampon puis envoie le bloc vide qui termine la réponse
+    void end() {
+        flush();
+        server.sendContent("", 0);
+    }
+
+    // Feuille de style commune, envoyée compressée et mise en cache par le navigateur
+    static void sendStyle(Server& webServer) {
+        webServer.sendHeader("Content-Encoding", "gzip");
+        webServer.sendHeader("Cache-Control", "max-age=86400");
+        webServer.send_P(200, "text/css", (PGM_P)PORTAL_CSS_GZ, sizeof(PORTAL_CSS_GZ));
+    }
+
+private:
+    Server& server;
+    char buffer[CHUNK_SIZE];
+    size_t length;
+
+    void append(size_t n) {
+        length += n;
+        if (length == CHUNK_SIZE) flush();
+    }
+
+    void flush() {
+        // Un bloc de longueur nulle terminerait la réponse: on ne l'envoie que dans end()
+        if (length == 0) return;
+        server.sendContent(buffer, length);
+        length = 0;
+    }
+};
+
+#endif
@@ -0,0 +1,735 @@
+#ifndef RonoBoxMQTT_h
+#define RonoBoxMQTT_h
+
+#include <RonoBoxPlatform.h>
+
+#include <Arduino.h>
+#include <Client.h>
+#include <DeviceLog.h>
+#include <functional>
+#include <stdlib.h>
+
+// Client MQTT 3.1.1 des appareils RonoBox, sans attente active. Même interface que
+// PubSubClient pour le reste du runtime, avec en plus la publication QoS1: les alertes
+// (gaz, buzzer) sont gardées dans une petite fenêtre jusqu'à leur PUBACK, retransmises
+// sur délai et renvoyées après une reconnexion. La télémétrie courante reste en QoS0.
+//
+// Rien n'attend le réseau:
+// - les paquets émis entrent entiers dans une file, écrite ensuite au fil de la place
+//   libre dans la pile TCP;
+// - les paquets reçus sont assemblés au fil des octets disponibles;
+// - connect() envoie le CONNECT et rend la main: la session s'ouvre au CONNACK,
+//   traité par loop() (connecting(), puis connected()). Seule l'ouverture TCP attend
+//   (WiFiClient::connect() n'a pas de variante sans attente), au plus setConnectTimeout().
+class RonoBoxMQTT {
+public:
+    typedef std::function<void(char* topic, uint8_t* payload, unsigned int length)> MessageCallback;
+    // Fin de vie d'un message QoS1: acquitté, ou abandonné après MAX_ATTEMPTS envois
+    typedef std::function<void(uint16_t packetId, bool delivered)> DeliveryCallback;
+
+    static const uint8_t MAX_INFLIGHT = 4;            // Messages QoS1 non acquittés
+    static const size_t MAX_INFLIGHT_MESSAGE = 128;   // Topic + payload d'un message QoS1
+    static const uint8_t MAX_ATTEMPTS = 5;
+    static const size_t DEFAULT_BUFFER_SIZE = 256;
+    static const size_t DEFAULT_QUEUE_SIZE = 1024;
+    static const unsigned long DEFAULT_CONNECT_TIMEOUT_MS = 1000;   // Broker du réseau local
+
+    // Mêmes valeurs que PubSubClient::state()
+    static const int CONNECTION_TIMEOUT = -4;
+    static const int CONNECTION_LOST = -3;
+    static const int CONNECT_FAILED = -2;
+    static const int DISCONNECTED = -1;
+    static const int CONNECTED = 0;
+
+    RonoBoxMQTT(Client& networkClient)
+        : client(networkClient), buffer(nullptr), bufferSize(0),
+          queue(nullptr), queueSize(0), queueHead(0), queueCount(0), writeBudget(0),
+          port(1883), host(nullptr),
+          keepAliveMs(15000), socketTimeoutMs(15000), connectTimeoutMs(DEFAULT_CONNECT_TIMEOUT_MS),
+          retryIntervalMs(3000),
+          sessionState(DISCONNECTED), awaitingConnack(false), connectStartedAt(0),
+          lastOutActivity(0), lastInActivity(0), lastQueueProgress(0),
+          pingOutstanding(false), pingSentAt(0), nextPacketId(1),
+          retransmitCount(0), droppedCount(0), lastAckLatencyMs(0) {
+        setBufferSize(DEFAULT_BUFFER_SIZE);
+        setQueueSize(DEFAULT_QUEUE_SIZE);
+        resetParser();
+    }
+
+    ~RonoBoxMQTT() {
+        free(buffer);
+        free(queue);
+    }
+
+    RonoBoxMQTT& setServer(IPAddress ip, uint16_t serverPort) {
+        address = ip;
+        host = nullptr;
+        port = serverPort;
+        return *this;
+    }
+
+    // Le nom doit rester valide (pas de copie)
+    RonoBoxMQTT& setServer(const char* serverHost, uint16_t serverPort) {
+        host = serverHost;
+        port = serverPort;
+        return *this;
+    }
+
+    RonoBoxMQTT& setCallback(MessageCallback messageCallback) {
+        callback = messageCallback;
+        return *this;
+    }
+
+    RonoBoxMQTT& onDelivery(DeliveryCallback deliveryCallback) {
+        delivery = deliveryCallback;
+        return *this;
+    }
+
+    RonoBoxMQTT& setKeepAlive(uint16_t seconds) {
+        keepAliveMs = seconds * 1000UL;
+        return *this;
+    }
+
+    // Attente maximale du CONNACK, et d'une file d'émission que la pile TCP ne vide plus
+    RonoBoxMQTT& setSocketTimeout(uint16_t seconds) {
+        socketTimeoutMs = seconds * 1000UL;
+        return *this;
+    }
+
+    // Attente maximale de l'ouverture TCP dans connect(), la seule de ce client. Sans
+    // elle, un broker éteint bloque loop() 3 s (ESP32) ou plus (SYN sans réponse).
+    RonoBoxMQTT& setConnectTimeout(unsigned long timeoutMs) {
+        connectTimeoutMs = timeoutMs;
+        return *this;
+    }
+
+    // Délai sans PUBACK avant de renvoyer un message QoS1
+    RonoBoxMQTT& setRetryInterval(unsigned long intervalMs) {
+        retryIntervalMs = intervalMs;
+        return *this;
+    }
+
+    // Taille maximale d'un paquet reçu; les plus grands sont lus jusqu'au bout puis ignorés
+    bool setBufferSize(size_t size) {
+        if (size == 0) return false;
+        uint8_t* resized = (uint8_t*)realloc(buffer, size);
+        if (!resized) return false;
+        buffer = resized;
+        bufferSize = size;
+        return true;
+    }
+
+    size_t getBufferSize() const { return bufferSize; }
+
+    // Capacité de la file d'émission: un paquet plus grand ne peut pas être envoyé.
+    // Hors session seulement.
+    bool setQueueSize(size_t size) {
+        if (size == 0 || sessionState == CONNECTED || awaitingConnack) return false;
+        uint8_t* resized = (uint8_t*)realloc(queue, size);
+        if (!resized) return false;
+        queue = resized;
+        queueSize = size;
+        clearQueue();
+        return true;
+    }
+
+    size_t getQueueSize() const { return queueSize; }
+    // Octets en file, pas encore acceptés par la pile TCP
+    size_t getQueuedBytes() const { return queueCount; }
+
+    bool connect(const char* clientId) {
+        return connect(clientId, nullptr, nullptr, nullptr, 0, false, nullptr);
+    }
+
+    bool connect(const char* clientId, const char* user, const char* password) {
+        return connect(clientId, user, password, nullptr, 0, false, nullptr);
+    }
+
+    // Ouvre la connexion TCP et met le CONNECT en file, sans attendre la réponse.
+    // true: session demandée; loop() traite le CONNACK (connected(), ou state() en cas
+    // de refus ou de délai dépassé). Les messages QoS1 restés sans accusé d'une session
+    // précédente repartent à l'ouverture.
+    bool connect(const char* clientId, const char* user, const char* password,
+                 const char* willTopic, uint8_t willQos, bool willRetain, const char* willMessage,
+                 bool cleanSession = true) {
+        if (connected() || connecting()) return true;
+
+        // Stream::setTimeout (ms), appelé par la référence Client et non le
+        // WiFiClient::setTimeout en secondes de l'ESP32 2.x: c'est le _timeout que lit
+        // WiFiClient::connect() sur les deux cœurs
+        client.setTimeout(connectTimeoutMs);
+        int opened = host ? client.connect(host, port) : client.connect(address, port);
+        if (opened != 1) {
+            sessionState = CONNECT_FAILED;
+            return false;
+        }
+        resetParser();
+        clearQueue();
+        pingOutstanding = false;
+
+        size_t idLength = strlen(clientId);
+        size_t remaining = 10 + 2 + idLength;
+        uint8_t flags = cleanSession ? 0x02 : 0x00;
+        if (willTopic) {
+            flags |= 0x04 | ((willQos & 0x03) << 3) | (willRetain ? 0x20 : 0x00);
+            remaining += 2 + strlen(willTopic) + 2 + strlen(willMessage);
+        }
+        if (user) {
+            flags |= 0x80;
+            remaining += 2 + strlen(user);
+            if (password) {
+                flags |= 0x40;
+                remaining += 2 + strlen(password);
+            }
+        }
+        if (!reserve(remaining)) {
+            client.stop();
+            sessionState = CONNECT_FAILED;
+            return false;
+        }
+
+        uint16_t keepAlive = keepAliveMs / 1000;
+        const uint8_t header[] = { 0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04, flags,
+                                   (uint8_t)(keepAlive >> 8), (uint8_t)keepAlive };
+        pushFixedHeader(PACKET_CONNECT, remaining);
+        push(header, sizeof(header));
+        pushString(clientId, idLength);
+        if (willTopic) {
+            pushString(willTopic, strlen(willTopic));
+            pushString(willMessage, strlen(willMessage));
+        }
+        if (user) pushString(user, strlen(user));
+        if (user && password) pushString(password, strlen(password));
+
+        sessionState = DISCONNECTED;
+        awaitingConnack = true;
+        connectStartedAt = millis();
+        writeBudget = PlatformConfig::TCP_WRITE_CHUNK;
+        flushQueue();
+        return true;
+    }
+
+    // Déconnexion propre: le broker ne publie pas la dernière volonté. Le DISCONNECT
+    // part avec ce que la pile TCP accepte encore, le reste de la file est abandonné.
+    void disconnect() {
+        if (sessionState == CONNECTED && reserve(0)) {
+            pushFixedHeader(PACKET_DISCONNECT, 0);
+            writeBudget = PlatformConfig::TCP_WRITE_CHUNK;
+            flushQueue();
+        }
+        client.stop();
+        sessionState = DISCONNECTED;
+        awaitingConnack = false;
+        clearQueue();
+    }
+
+    bool connected() {
+        if (sessionState != CONNECTED) return false;
+        if (!client.connected()) {
+            lostConnection(CONNECTION_LOST);
+            return false;
+        }
+        return true;
+    }
+
+    // CONNECT envoyé, CONNACK pas encore reçu
+    bool connecting() {
+        if (!awaitingConnack) return false;
+        if (!client.connected()) {
+            lostConnection(CONNECTION_LOST);
+            return false;
+        }
+        return true;
+    }
+
+    int state() const { return sessionState; }
+
+    bool publish(const char* topic, const char* payload, bool retained = false) {
+        return publish(topic, payload, retained, 0);
+    }
+
+    // QoS0: false si le paquet ne tient pas dans la place libre de la file.
+    // QoS1: le message est copié dans la fenêtre et sera renvoyé jusqu'à son PUBACK.
+    // false si la fenêtre est pleine ou le message trop long (l'appelant garde alors
+    // sa valeur et réessaie), true dès qu'il est pris en charge.
+    bool publish(const char* topic, const char* payload, bool retained, uint8_t qos) {
+        if (!connected()) return false;
+        size_t topicLength = strlen(topic);
+        size_t payloadLength = strlen(payload);
+
+        if (qos == 0) {
+            return queuePublish(topic, topicLength, (const uint8_t*)payload, payloadLength, retained, 0, 0, false);
+        }
+
+        if (topicLength + payloadLength > MAX_INFLIGHT_MESSAGE) return false;
+        InflightMessage* message = freeSlot();
+        if (!message) return false;
+
+        message->packetId = takePacketId();
+        message->retained = retained;
+        message->topicLength = topicLength;
+        message->payloadLength = payloadLength;
+        memcpy(message->data, topic, topicLength);
+        memcpy(message->data + topicLength, payload, payloadLength);
+        message->attempts = 0;
+        message->firstSentAt = millis();
+        send(*message);   // File pleine: loop() le mettra en file dès qu'elle aura de la place
+        return true;
+    }
+
+    // false si la requête ne tient pas dans la file (nouvel essai de l'appelant)
+    bool subscribe(const char* topic, uint8_t qos = 0) {
+        if (!connected()) return false;
+        size_t topicLength = strlen(topic);
+        size_t remaining = 2 + 2 + topicLength + 1;
+        if (!reserve(remaining)) return false;
+
+        uint16_t packetId = takePacketId();
+        const uint8_t id[] = { (uint8_t)(packetId >> 8), (uint8_t)packetId };
+        const uint8_t requestedQos = qos > 1 ? 1 : qos;
+        pushFixedHeader(PACKET_SUBSCRIBE, remaining);
+        push(id, sizeof(id));
+        pushString(topic, topicLength);
+        push(&requestedQos, 1);
+        flushQueue();
+        return true;
+    }
+
+    // Un tour de travail, jamais bloquant: écrit la file, traite les octets reçus
+    // (CONNACK compris), les retransmissions dues et le keepalive.
+    // true si la session est ouverte à la sortie.
+    bool loop() {
+        if (!connected() && !connecting()) return false;
+        unsigned long now = millis();
+
+        writeBudget = PlatformConfig::TCP_WRITE_CHUNK;
+        flushQueue();
+        readAvailable();
+        if (!connected() && !connecting()) return false;
+
+        if (awaitingConnack) {
+            if (now - connectStartedAt >= socketTimeoutMs) {
+                lostConnection(CONNECTION_TIMEOUT);
+            }
+            return false;
+        }
+
+        // La pile TCP n'accepte plus rien: connexion morte sans fermeture
+        if (queueCount > 0 && now - lastQueueProgress >= socketTimeoutMs) {
+            lostConnection(CONNECTION_TIMEOUT);
+            return false;
+        }
+
+        for (uint8_t i = 0; i < MAX_INFLIGHT; i++) {
+            InflightMessage& message = inflight[i];
+            if (message.packetId == 0) continue;
+            // Jamais mis en file (file pleine): nouvel essai à chaque tour, sans délai
+            if (message.attempts > 0 && now - message.sentAt < retryIntervalMs) continue;
+            if (message.attempts >= MAX_ATTEMPTS) {
+                RB_LOG_WARN("[MQTT] Message %u abandonné après %u envois", message.packetId, message.attempts);
+                release(message, false);
+                droppedCount++;
+                continue;
+            }
+            bool resend = message.attempts > 0;
+            if (send(message) && resend) retransmitCount++;
+        }
+
+        return serviceKeepAlive(now);
+    }
+
+    uint8_t getInflightCount() const {
+        uint8_t count = 0;
+        for (uint8_t i = 0; i < MAX_INFLIGHT; i++) {
+            if (inflight[i].packetId != 0) count++;
+        }
+        return count;
+    }
+
+    unsigned long getRetransmitCount() const { return retransmitCount; }
+    unsigned long getDroppedCount() const { return droppedCount; }
+    // Délai entre le premier envoi et le PUBACK du dernier message QoS1 acquitté
+    unsigned long getLastAckLatency() const { return lastAckLatencyMs; }
+
+private:
+    static const uint8_t PACKET_CONNECT = 0x10;
+    static const uint8_t PACKET_CONNACK = 0x20;
+    static const uint8_t PACKET_PUBLISH = 0x30;
+    static const uint8_t PACKET_PUBACK = 0x40;
+    static const uint8_t PACKET_SUBSCRIBE = 0x82;
+    static const uint8_t PACKET_SUBACK = 0x90;
+    static const uint8_t PACKET_PINGREQ = 0xC0;
+    static const uint8_t PACKET_PINGRESP = 0xD0;
+    static const uint8_t PACKET_DISCONNECT = 0xE0;
+    static const uint8_t FLAG_DUP = 0x08;
+
+    struct InflightMessage {
+        uint16_t packetId = 0;          // 0: emplacement libre
+        uint8_t attempts = 0;
+        bool retained = false;
+        uint16_t topicLength = 0;
+        uint16_t payloadLength = 0;
+        unsigned long firstSentAt = 0;
+        unsigned long sentAt = 0;
+        char data[MAX_INFLIGHT_MESSAGE];   // Topic puis payload, sans '\0'
+    };
+
+    enum ParseStep : uint8_t {
+        PARSE_HEADER,
+        PARSE_LENGTH,
+        PARSE_BODY
+    };
+
+    Client& client;
+    uint8_t* buffer;
+    size_t bufferSize;
+    // File d'émission circulaire: queueCount octets à partir de queueHead
+    uint8_t* queue;
+    size_t queueSize;
+    size_t queueHead;
+    size_t queueCount;
+    size_t writeBudget;                 // Octets encore permis ce tour (cible sans availableForWrite)
+    IPAddress address;
+    uint16_t port;
+    const char* host;
+    unsigned long keepAliveMs;
+    unsigned long socketTimeoutMs;
+    unsigned long connectTimeoutMs;
+    unsigned long retryIntervalMs;
+    int sessionState;
+    bool awaitingConnack;
+    unsigned long connectStartedAt;
+    unsigned long lastOutActivity;      // Derniers octets acceptés par la pile TCP
+    unsigned long lastInActivity;
+    unsigned long lastQueueProgress;
+    bool pingOutstanding;
+    unsigned long pingSentAt;
+    uint16_t nextPacketId;
+    MessageCallback callback;
+    DeliveryCallback delivery;
+    InflightMessage inflight[MAX_INFLIGHT];
+    unsigned long retransmitCount;
+    unsigned long droppedCount;
+    unsigned long lastAckLatencyMs;
+
+    // Paquet en cours de réception
+    ParseStep parseStep;
+    uint8_t packetHeader;
+    uint32_t packetLength;
+    uint32_t lengthMultiplier;
+    uint32_t packetReceived;
+
+    void resetParser() {
+        parseStep = PARSE_HEADER;
+        packetReceived = 0;
+    }
+
+    void lostConnection(int reason) {
+        client.stop();
+        sessionState = reason;
+        awaitingConnack = false;
+        resetParser();
+        clearQueue();
+    }
+
+    // Le keepalive suit l'activité réelle du lien, pas le rythme de loop(): le PINGREQ
+    // part dès que rien n'a été écrit depuis la moitié du délai annoncé. Le broker
+    // tolérant 1,5 fois ce délai, des tours de loop() espacés d'un keepalive ne coupent
+    // pas la session. La réponse a un keepalive pour arriver, et les octets déjà reçus
+    // sont lus avant de conclure à une perte.
+    bool serviceKeepAlive(unsigned long now) {
+        if (keepAliveMs == 0) return true;
+        if (pingOutstanding) {
+            if (now - pingSentAt >= keepAliveMs) {
+                lostConnection(CONNECTION_TIMEOUT);
+                return false;
+            }
+            return true;
+        }
+        if (now - lastOutActivity >= keepAliveMs / 2 || now - lastInActivity >= keepAliveMs) {
+            if (!reserve(0)) return true;   // File pleine: le lien n'est pas inactif
+            pushFixedHeader(PACKET_PINGREQ, 0);
+            pingOutstanding = true;
+            pingSentAt = now;
+            flushQueue();
+        }
+        return true;
+    }
+
+    // Lit ce qui est déjà arrivé, par blocs
+    void readAvailable() {
+        uint8_t chunk[64];
+        int available;
+        while ((available = client.available()) > 0) {
+            int n = client.read(chunk, available < (int)sizeof(chunk) ? available : sizeof(chunk));
+            if (n <= 0) break;
+            lastInActivity = millis();
+            for (int i = 0; i < n; i++) {
+                if (!parse(chunk[i])) return;
+            }
+        }
+        flushQueue();   // Accusés et renvois produits par les paquets reçus
+    }
+
+    bool parse(uint8_t byte) {
+        switch (parseStep) {
+            case PARSE_HEADER:
+                packetHeader = byte;
+                packetLength = 0;
+                lengthMultiplier = 1;
+                parseStep = PARSE_LENGTH;
+                break;
+
+            case PARSE_LENGTH:
+                packetLength += (byte & 0x7F) * lengthMultiplier;
+                if (byte & 0x80) {
+                    lengthMultiplier *= 128;
+                    if (lengthMultiplier > 128UL * 128 * 128) {
+                        lostConnection(CONNECTION_LOST);   // Longueur invalide
+                        return false;
+                    }
+                    break;
+                }
+                packetReceived = 0;
+                if (packetLength == 0) {
+                    parseStep = PARSE_HEADER;
+                    handlePacket();
+                } else {
+                    parseStep = PARSE_BODY;
+                }
+                break;
+
+            case PARSE_BODY:
+                // Paquet plus grand que le tampon: lu jusqu'au bout puis ignoré
+                if (packetReceived < bufferSize) buffer[packetReceived] = byte;
+                packetReceived++;
+                if (packetReceived == packetLength) {
+                    parseStep = PARSE_HEADER;
+                    if (packetLength <= bufferSize) {
+                        handlePacket();
+                    } else {
+                        RB_LOG_WARN("[MQTT] Paquet de %lu octets ignoré (tampon: %u)",
+                                    (unsigned long)packetLength, (unsigned)bufferSize);
+                    }
+                }
+                break;
+        }
+        return sessionState == CONNECTED || awaitingConnack;
+    }
+
+    void handlePacket() {
+        switch (packetHeader & 0xF0) {
+            case PACKET_CONNACK:
+                if (awaitingConnack && packetLength >= 2) openSession(buffer[1]);
+                break;
+
+            case PACKET_PUBLISH:
+                handlePublish();
+                break;
+
+            case PACKET_PUBACK:
+                if (packetLength >= 2) acknowledge((buffer[0] << 8) | buffer[1]);
+                break;
+
+            case PACKET_SUBACK:
+                if (packetLength >= 3 && buffer[2] == 0x80) {
+                    RB_LOG_WARN("[MQTT] Abonnement refusé par le broker");
+                }
+                break;
+
+            case PACKET_PINGRESP:
+                pingOutstanding = false;
+                break;
+        }
+    }
+
+    // Code de retour du CONNACK: 0 ouvre la session, 1 à 5 la refusent
+    void openSession(uint8_t returnCode) {
+        awaitingConnack = false;
+        if (returnCode != 0) {
+            client.stop();
+            sessionState = returnCode;
+            clearQueue();
+            return;
+        }
+        sessionState = CONNECTED;
+        lastInActivity = lastOutActivity = millis();
+        resendInflight();
+    }
+
+    // Le topic est décalé de deux octets pour être terminé par '\0' en place
+    void handlePublish() {
+        uint8_t qos = (packetHeader >> 1) & 0x03;
+        if (packetLength < 2) return;
+        size_t topicLength = (buffer[0] << 8) | buffer[1];
+        size_t offset = 2 + topicLength + (qos > 0 ? 2 : 0);
+        if (offset > packetLength) return;
+
+        // Sans place dans la file pour l'accusé, le message est ignoré: le broker le
+        // renverra, et il ne sera traité qu'une fois, à la réception acquittée
+        if (qos == 1) {
+            if (!reserve(2)) return;
+            const uint8_t id[] = { buffer[2 + topicLength], buffer[3 + topicLength] };
+            pushFixedHeader(PACKET_PUBACK, 2);
+            push(id, sizeof(id));
+        }
+
+        memmove(buffer, buffer + 2, topicLength);
+        buffer[topicLength] = '\0';
+        if (callback) {
+            callback((char*)buffer, buffer + offset, packetLength - offset);
+        }
+    }
+
+    void acknowledge(uint16_t packetId) {
+        for (uint8_t i = 0; i < MAX_INFLIGHT; i++) {
+            if (inflight[i].packetId == packetId) {
+                lastAckLatencyMs = millis() - inflight[i].firstSentAt;
+                release(inflight[i], true);
+                return;
+            }
+        }
+    }
+
+    void release(InflightMessage& message, bool delivered) {
+        uint16_t packetId = message.packetId;
+        message.packetId = 0;
+        if (delivery) delivery(packetId, delivered);
+    }
+
+    InflightMessage* freeSlot() {
+        for (uint8_t i = 0; i < MAX_INFLIGHT; i++) {
+            if (inflight[i].packetId == 0) return &inflight[i];
+        }
+        return nullptr;
+    }
+
+    // Identifiant non nul et distinct de ceux encore dans la fenêtre
+    uint16_t takePacketId() {
+        for (;;) {
+            uint16_t id = nextPacketId++;
+            if (nextPacketId == 0) nextPacketId = 1;
+            bool used = false;
+            for (uint8_t i = 0; i < MAX_INFLIGHT; i++) {
+                if (inflight[i].packetId == id) used = true;
+            }
+            if (!used) return id;
+        }
+    }
+
+    // Seul un paquet réellement mis en file compte comme un essai: refusé faute de
+    // place, il garde ses essais et sa date d'envoi, et loop() le retente
+    bool send(InflightMessage& message) {
+        bool duplicate = message.attempts > 0;
+        if (!queuePublish(message.data, message.topicLength,
+                          (const uint8_t*)message.data + message.topicLength, message.payloadLength,
+                          message.retained, 1, message.packetId, duplicate)) {
+            return false;
+        }
+        message.attempts++;
+        message.sentAt = millis();
+        return true;
+    }
+
+    // Après une reconnexion: tout ce qui n'a pas été acquitté repart, marqué DUP
+    void resendInflight() {
+        for (uint8_t i = 0; i < MAX_INFLIGHT; i++) {
+            if (inflight[i].packetId != 0) send(inflight[i]);
+        }
+    }
+
+    bool queuePublish(const char* topic, size_t topicLength, const uint8_t* payload, size_t payloadLength,
+                      bool retained, uint8_t qos, uint16_t packetId, bool duplicate) {
+        uint8_t type = PACKET_PUBLISH | (qos << 1) | (retained ? 0x01 : 0x00) | (duplicate ? FLAG_DUP : 0x00);
+        size_t remaining = 2 + topicLength + (qos > 0 ? 2 : 0) + payloadLength;
+        if (!reserve(remaining)) return false;
+
+        pushFixedHeader(type, remaining);
+        pushString(topic, topicLength);
+        if (qos > 0) {
+            const uint8_t id[] = { (uint8_t)(packetId >> 8), (uint8_t)packetId };
+            push(id, sizeof(id));
+        }
+        push(payload, payloadLength);
+        flushQueue();
+        return true;
+    }
+
+    // Un paquet n'entre dans la file qu'en entier: place pour l'en-tête fixe
+    // (type et longueur sur 1 à 4 octets) et les `remaining` octets qui suivent
+    bool reserve(size_t remaining) const {
+        size_t lengthBytes = remaining < 128 ? 1 : remaining < 16384 ? 2 : remaining < 2097152 ? 3 : 4;
+        return 1 + lengthBytes + remaining <= queueSize - queueCount;
+    }
+
+    void clearQueue() {
+        queueHead = 0;
+        queueCount = 0;
+    }
+
+    void push(const uint8_t* data, size_t length) {
+        size_t tail = (queueHead + queueCount) % queueSize;
+        for (size_t i = 0; i < length; i++) {
+            queue[tail] = data[i];
+            if (++tail == queueSize) tail = 0;
+        }
+        queueCount += length;
+    }
+
+    void pushFixedHeader(uint8_t type, size_t remaining) {
+        uint8_t header[5];
+        size_t n = 0;
+        header[n++] = type;
+        do {
+            uint8_t digit = remaining % 128;
+            remaining /= 128;
+            if (remaining > 0) digit |= 0x80;
+            header[n++] = digit;
+        } while (remaining > 0 && n < sizeof(header));
+        push(header, n);
+    }
+
+    void pushString(const char* text, size_t length) {
+        const uint8_t prefix[] = { (uint8_t)(length >> 8), (uint8_t)length };
+        push(prefix, sizeof(prefix));
+        push((const uint8_t*)text, length);
+    }
+
+    // Place libre dans la pile TCP quand la cible la renseigne. Sinon, une tranche
+    // fixe par tour de loop(), bien en deçà du tampon d'émission: write() n'attend pas.
+    size_t writeSpace() {
+        if (PlatformConfig::TCP_WRITE_SPACE) {
+            int space = client.availableForWrite();
+            return space > 0 ? space : 0;
+        }
+        return writeBudget;
+    }
+
+    // Écrit ce que la pile TCP accepte sans attendre; le reste part au prochain tour
+    void flushQueue() {
+        unsigned long now = millis();
+        if (queueCount == 0) {
+            lastQueueProgress = now;
+            return;
+        }
+        size_t space = writeSpace();
+        while (queueCount > 0 && space > 0) {
+            size_t contiguous = queueSize - queueHead;
+            size_t length = queueCount < contiguous ? queueCount : contiguous;
+            if (length > space) length = space;
+
+            size_t written = client.write(queue + queueHead, length);
+            if (written == 0) break;
+            if (written > length) written = length;
+            queueHead = (queueHead + written) % queueSize;
+            queueCount -= written;
+            space -= written;
+            if (writeBudget >= written) writeBudget -= written;
+            lastOutActivity = lastQueueProgress = now;
+            if (written < length) break;
+        }
+        if (queueCount == 0) queueHead = 0;
+    }
+};
+
+#endif
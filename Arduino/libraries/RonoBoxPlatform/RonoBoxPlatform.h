@@ -0,0 +1,236 @@
+#ifndef RonoBoxPlatform_h
+#define RonoBoxPlatform_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Seul endroit où les bibliothèques dépendent de la cible: pile réseau et identité
+// matérielle. MQTTTopicManager, MQTTDevice et HADiscoveryConfig passent par ici au lieu
+// de tester ESP32/ESP8266 chacun de leur côté; porter le code sur une autre cible
+// revient à fournir une spécialisation de plus à ce fichier. extras/host compile les
+// bibliothèques sur Linux avec chacune des deux spécialisations.
+
+enum class RonoBoxTarget : uint8_t {
+    Esp32,
+    Esp8266
+};
+
+// Constantes de chaque cible, connues à la compilation: tailles des tampons, préfixe
+// des topics, support de sauvegarde. Les deux spécialisations sont compilées (et
+// vérifiées plus bas) quelle que soit la carte; seule PlatformConfig dépend de la cible.
+template <RonoBoxTarget Target>
+struct PlatformTraits;
+
+template <>
+struct PlatformTraits<RonoBoxTarget::Esp32> {
+    static constexpr const char* NAME = "esp32";      // Préfixe des topics et unique_id
+    static constexpr const char* MODEL = "ESP32";     // Bloc "device" et client ID MQTT
+    static constexpr bool HAS_NVS = true;             // Preferences, sinon EEPROM émulée
+
+    static constexpr uint8_t MAX_CHANNELS = 16;       // Voies de télémétrie de MQTTDevice
+    static constexpr uint8_t MAX_ENTITIES = 20;       // Entités Home Assistant annoncées
+    static constexpr size_t DISCOVERY_PAYLOAD_LENGTH = 512;
+    static constexpr uint8_t TELEMETRY_CAPACITY = 32; // Échantillons gardés en RAM hors ligne
+    static constexpr size_t LOG_BUFFER_SIZE = 1024;
+    static constexpr size_t LOG_REMOTE_BUFFER_SIZE = 512;
+
+    static constexpr size_t MQTT_PACKET_SIZE = 512;   // Plus grand paquet reçu (commandes, règles d'alarme)
+    static constexpr size_t MQTT_QUEUE_SIZE = 2048;   // File d'émission MQTT
+    static constexpr bool TCP_WRITE_SPACE = false;    // WiFiClient ne renseigne pas availableForWrite()
+    static constexpr size_t TCP_WRITE_CHUNK = 1460;   // Octets écrits par tour de loop() (un segment TCP)
+};
+
+// ~40 Ko de tas: tampons réduits de moitié, pas de NVS
+template <>
+struct PlatformTraits<RonoBoxTarget::Esp8266> {
+    static constexpr const char* NAME = "esp8266";
+    static constexpr const char* MODEL = "ESP8266";
+    static constexpr bool HAS_NVS = false;
+
+    static constexpr uint8_t MAX_CHANNELS = 10;
+    static constexpr uint8_t MAX_ENTITIES = 20;
+    static constexpr size_t DISCOVERY_PAYLOAD_LENGTH = 512;
+    static constexpr uint8_t TELEMETRY_CAPACITY = 16;
+    static constexpr size_t LOG_BUFFER_SIZE = 512;
+    static constexpr size_t LOG_REMOTE_BUFFER_SIZE = 256;
+
+    static constexpr size_t MQTT_PACKET_SIZE = 256;
+    static constexpr size_t MQTT_QUEUE_SIZE = 1024;
+    static constexpr bool TCP_WRITE_SPACE = true;     // availableForWrite(): place dans le tampon lwIP
+    static constexpr size_t TCP_WRITE_CHUNK = 1460;
+};
+
+// Invariants dont dépendent les bibliothèques, contrôlés pour toutes les cibles
+template <RonoBoxTarget Target>
+struct PlatformTraitsCheck {
+    typedef PlatformTraits<Target> T;
+    static_assert(T::MAX_CHANNELS > 0 && T::MAX_ENTITIES > 0, "tables vides");
+    static_assert(T::TELEMETRY_CAPACITY >= 2 && T::TELEMETRY_CAPACITY % 2 == 0,
+                  "TelemetryBuffer déverse la moitié de sa capacité");
+    static_assert(T::DISCOVERY_PAYLOAD_LENGTH >= 256, "configuration Home Assistant tronquée");
+    static_assert(T::LOG_BUFFER_SIZE >= T::LOG_REMOTE_BUFFER_SIZE, "journal distant plus grand que le journal série");
+    static_assert(T::MQTT_QUEUE_SIZE >= T::DISCOVERY_PAYLOAD_LENGTH + 256,
+                  "une configuration de découverte (topic compris) doit tenir dans la file MQTT");
+    static constexpr bool value = true;
+};
+
+static_assert(PlatformTraitsCheck<RonoBoxTarget::Esp32>::value, "");
+static_assert(PlatformTraitsCheck<RonoBoxTarget::Esp8266>::value, "");
+
+#ifdef ESP32
+  #include <WiFi.h>
+  #define RONOBOX_TARGET RonoBoxTarget::Esp32
+#else // ESP8266
+  #include <ESP8266WiFi.h>
+  #define RONOBOX_TARGET RonoBoxTarget::Esp8266
+#endif
+
+#include <lwip/dns.h>
+#include <string.h>
+
+// Pile lwIP verrouillée par un mutex (ESP32, core 3.x): l'API brute s'appelle sous verrou
+#if defined(ESP32) && defined(LWIP_TCPIP_CORE_LOCKING) && LWIP_TCPIP_CORE_LOCKING
+  #include <lwip/tcpip.h>
+  #define RONOBOX_LWIP_LOCK() LOCK_TCPIP_CORE()
+  #define RONOBOX_LWIP_UNLOCK() UNLOCK_TCPIP_CORE()
+#else
+  #define RONOBOX_LWIP_LOCK()
+  #define RONOBOX_LWIP_UNLOCK()
+#endif
+
+// Constantes de la cible en cours de compilation
+typedef PlatformTraits<RONOBOX_TARGET> PlatformConfig;
+
+// Services de sauvegarde fournis par le cœur Arduino. Une bibliothèque compile chacun
+// de ses supports dès que le service existe (tous sur l'hôte, qui les émule pour les
+// deux cibles) et retient celui de PlatformConfig (HAS_NVS), jamais selon la carte.
+#if __has_include(<Preferences.h>)
+  #define RONOBOX_HAS_PREFERENCES 1
+#else
+  #define RONOBOX_HAS_PREFERENCES 0
+#endif
+
+// ESP.rtcUserMemoryRead/Write: ESP8266 seulement (l'hôte le déclare lui-même)
+#ifndef RONOBOX_HAS_RTC_USER_MEMORY
+  #ifdef ESP8266
+    #define RONOBOX_HAS_RTC_USER_MEMORY 1
+  #else
+    #define RONOBOX_HAS_RTC_USER_MEMORY 0
+  #endif
+#endif
+
+static_assert(!PlatformConfig::HAS_NVS || RONOBOX_HAS_PREFERENCES, "HAS_NVS sans Preferences.h");
+
+struct RonoBoxPlatform {
+    // Préfixe des topics ("esp32-[mac]") et des unique_id Home Assistant ("esp32_[mac]")
+    static const char* name() {
+        return PlatformConfig::NAME;
+    }
+
+    // Modèle annoncé dans le bloc "device" et préfixe du client ID MQTT
+    static const char* model() {
+        return PlatformConfig::MODEL;
+    }
+
+    // Identifiant matériel court, stable d'un démarrage à l'autre
+    static uint32_t chipId() {
+        #ifdef ESP32
+            return (uint32_t)ESP.getEfuseMac();
+        #else
+            return ESP.getChipId();
+        #endif
+    }
+
+    // Tas libre, et plus petit tas libre depuis le démarrage (0 si la cible ne le suit pas:
+    // l'appelant garde alors son propre minimum échantillonné)
+    static uint32_t freeHeap() {
+        return ESP.getFreeHeap();
+    }
+
+    static uint32_t minFreeHeap() {
+        #ifdef ESP32
+            return ESP.getMinFreeHeap();
+        #else
+            return 0;
+        #endif
+    }
+
+    // Plus grand bloc allouable d'un seul tenant (fragmentation)
+    static uint32_t largestFreeBlock() {
+        #ifdef ESP32
+            return ESP.getMaxAllocHeap();
+        #else
+            return ESP.getMaxFreeBlockSize();
+        #endif
+    }
+};
+
+// Résolution DNS sans attente, par l'API de lwIP commune aux deux cibles.
+// WiFi.hostByName() attend la réponse dans loop(), jusqu'à une quinzaine de secondes
+// sans serveur DNS. Ici start() envoie la requête, le rappel de lwIP (thread tcpip sur
+// ESP32) dépose la réponse et poll() la relève; timeoutMs borne l'attente même si le
+// rappel ne vient jamais.
+class AsyncDnsQuery {
+public:
+    enum Status : uint8_t {
+        DNS_IDLE,
+        DNS_PENDING,
+        DNS_RESOLVED,
+        DNS_FAILED
+    };
+
+    // hostName doit rester valide jusqu'à la réponse (ou reset())
+    Status start(const char* hostName, unsigned long timeoutMs) {
+        host = hostName;
+        startedAt = millis();
+        timeout = timeoutMs;
+        status = DNS_PENDING;
+
+        ip_addr_t found;
+        RONOBOX_LWIP_LOCK();
+        err_t err = dns_gethostbyname(hostName, &found, onFound, this);
+        RONOBOX_LWIP_UNLOCK();
+
+        if (err == ERR_OK) {
+            // Adresse littérale ou déjà dans le cache de lwIP: pas de rappel
+            result = IPAddress(ip4_addr_get_u32(ip_2_ip4(&found)));
+            status = DNS_RESOLVED;
+        } else if (err != ERR_INPROGRESS) {
+            status = DNS_FAILED;
+        }
+        return status;
+    }
+
+    Status poll() {
+        if (status == DNS_PENDING && millis() - startedAt >= timeout) {
+            status = DNS_FAILED;
+        }
+        return status;
+    }
+
+    bool pending() const { return status == DNS_PENDING; }
+    IPAddress address() const { return result; }
+    // Une réponse arrivée après reset() est ignorée
+    void reset() { status = DNS_IDLE; }
+
+private:
+    const char* host = nullptr;
+    volatile Status status = DNS_IDLE;
+    IPAddress result;
+    unsigned long startedAt = 0;
+    unsigned long timeout = 0;
+
+    static void onFound(const char* name, const ip_addr_t* ipaddr, void* arg) {
+        AsyncDnsQuery* query = (AsyncDnsQuery*)arg;
+        // Réponse tardive: délai dépassé, ou autre nom demandé depuis
+        if (query->status != DNS_PENDING || strcmp(name, query->host) != 0) return;
+        if (ipaddr) {
+            query->result = IPAddress(ip4_addr_get_u32(ip_2_ip4(ipaddr)));
+            query->status = DNS_RESOLVED;   // Après l'adresse: poll() la lit ensuite
+        } else {
+            query->status = DNS_FAILED;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef SensorScheduler_h
+#define SensorScheduler_h
+
+#include <Arduino.h>
+#include <DeviceLog.h>
+
+// Callback d'une tâche planifiée (fonction libre ou lambda sans capture)
+typedef void (*TaskCallback)();
+
+class SensorScheduler {
+public:
+    static const uint8_t MAX_TASKS = 16;
+
+    struct TaskStats {
+        unsigned long runs;          // Nombre d'exécutions
+        unsigned long lastJitter;    // Retard de la dernière exécution sur son échéance (ms)
+        unsigned long maxJitter;     // Retard maximal observé (ms)
+        unsigned long overruns;      // Échéances sautées car en retard de plus d'une période
+        unsigned long maxDuration;   // Durée maximale d'une exécution (ms)
+    };
+
+    SensorScheduler() : taskCount(0) {}
+
+    // Enregistre une tâche périodique. L'offset permet de décaler les tâches
+    // de même période pour ne pas les exécuter dans la même itération.
+    // Retourne l'identifiant de la tâche, ou -1 si la table est pleine.
+    int addTask(const char* name, unsigned long periodMs, TaskCallback callback,
+                unsigned long offsetMs = 0) {
+        return addTask(name, periodMs, callback, offsetMs, millis());
+    }
+
+    int addTask(const char* name, unsigned long periodMs, TaskCallback callback,
+                unsigned long offsetMs, unsigned long now) {
+        if (taskCount >= MAX_TASKS || callback == nullptr) {
+            return -1;
+        }
+        Task& task = tasks[taskCount];
+        task.name = name;
+        task.callback = callback;
+        task.period = periodMs;
+        task.nextRun = now + offsetMs;
+        task.enabled = true;
+        task.stats = TaskStats();
+        return taskCount++;
+    }
+
+    void setPeriod(int id, unsigned long periodMs) {
+        if (isValid(id)) tasks[id].period = periodMs;
+    }
+
+    void setEnabled(int id, bool enabled) {
+        if (!isValid(id)) return;
+        if (enabled && !tasks[id].enabled) {
+            tasks[id].nextRun = millis();
+        }
+        tasks[id].enabled = enabled;
+    }
+
+    // Exécute immédiatement une tâche au prochain run() (ex: publication après une commande)
+    void trigger(int id) {
+        if (isValid(id)) tasks[id].nextRun = millis();
+    }
+
+    // À appeler à chaque loop(): exécute les tâches arrivées à échéance, sans jamais attendre
+    void run() {
+        run(millis());
+    }
+
+    // Variante à horloge explicite (utilisée aussi pour simuler le temps hors cible)
+    void run(unsigned long now) {
+        for (uint8_t i = 0; i < taskCount; i++) {
+            Task& task = tasks[i];
+            if (!task.enabled || (long)(now - task.nextRun) < 0) {
+                continue;
+            }
+
+            unsigned long jitter = now - task.nextRun;
+            task.stats.lastJitter = jitter;
+            if (jitter > task.stats.maxJitter) task.stats.maxJitter = jitter;
+
+            // Cadence fixe: la prochaine échéance part de l'échéance théorique,
+            // sauf si on a raté une période entière (on se recale alors sur maintenant)
+            if (task.period > 0 && jitter >= task.period) {
+                task.stats.overruns += jitter / task.period;
+                task.nextRun = now + task.period;
+            } else {
+                task.nextRun += task.period;
+            }
+
+            unsigned long start = millis();
+            task.callback();
+            unsigned long duration = millis() - start;
+
+            task.stats.runs++;
+            if (duration > task.stats.maxDuration) task.stats.maxDuration = duration;
+        }
+    }
+
+    // Temps (ms) avant la prochaine échéance, 0 si une tâche est déjà due
+    unsigned long timeUntilNext(unsigned long now) const {
+        unsigned long best = (unsigned long)-1;
+        for (uint8_t i = 0; i < taskCount; i++) {
+            if (!tasks[i].enabled) continue;
+            long remaining = (long)(tasks[i].nextRun - now);
+            if (remaining <= 0) return 0;
+            if ((unsigned long)remaining < best) best = remaining;
+        }
+        return best;
+    }
+
+    const TaskStats& getStats(int id) const { return tasks[id].stats; }
+    const char* getName(int id) const { return tasks[id].name; }
+    uint8_t size() const { return taskCount; }
+
+    // Une ligne par tâche dans le journal: pas d'attente du port série depuis loop()
+    void printStats() const {
+        for (uint8_t i = 0; i < taskCount; i++) {
+            const Task& task = tasks[i];
+            RB_LOG_INFO("[SCHED] %-16s période=%lums exécutions=%lu gigue(max)=%lums retards=%lu durée(max)=%lums",
+                        task.name, task.period, task.stats.runs, task.stats.maxJitter,
+                        task.stats.overruns, task.stats.maxDuration);
+        }
+    }
+
+private:
+    struct Task {
+        const char* name;
+        TaskCallback callback;
+        unsigned long period;
+        unsigned long nextRun;
+        bool enabled;
+        TaskStats stats;
+    };
+
+    Task tasks[MAX_TASKS];
+    uint8_t taskCount;
+
+    bool isValid(int id) const {
+        return id >= 0 && id < taskCount;
+    }
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef LittleFSSpill_h
+#define LittleFSSpill_h
+
+#include <LittleFS.h>
+#include "TelemetryBuffer.h"
+
+// Journal d'échantillons dans un fichier LittleFS: écritures en fin de fichier par
+// lots, lecture séquentielle depuis une position gardée en RAM. Le fichier est
+// supprimé dès qu'il a été entièrement relu. Au-delà de maxBytes, ou si la flash
+// n'accepte qu'une partie du lot, le lot est refusé (le tampon RAM applique alors sa
+// politique de perte) et le journal reste tel qu'il était.
+// LittleFS.begin() doit avoir été appelé par le sketch.
+class LittleFSSpill : public TelemetrySpill {
+public:
+    LittleFSSpill(const char* filePath = "/telemetry.bin", uint32_t maxBytes = 32768)
+        : path(filePath), maxSize(maxBytes), readOffset(0), fileSize(0) {}
+
+    bool begin() override {
+        if (LittleFS.exists(path)) LittleFS.remove(path);
+        readOffset = 0;
+        fileSize = 0;
+        return true;
+    }
+
+    bool append(const TelemetrySample* samples, uint16_t count) override {
+        size_t bytes = count * sizeof(TelemetrySample);
+        if (fileSize + bytes > maxSize) return false;
+
+        // Écriture à fileSize et non en fin de fichier: un lot tronqué par une flash
+        // pleine laisse des octets au-delà de fileSize, que le lot suivant recouvre.
+        // fs::File de l'ESP32 n'a pas de truncate() pour les retirer.
+        File file = LittleFS.open(path, fileSize == 0 ? "w" : "r+");
+        if (!file) return false;
+        size_t written = file.seek(fileSize) ? file.write((const uint8_t*)samples, bytes) : 0;
+        file.close();
+        if (written != bytes) return false;   // Lot refusé en entier, fileSize inchangé
+        fileSize += bytes;
+        return true;
+    }
+
+    bool peek(TelemetrySample& sample) override {
+        if (size() == 0) return false;
+        File file = LittleFS.open(path, "r");
+        if (!file) return false;
+        bool ok = file.seek(readOffset) &&
+                  file.read((uint8_t*)&sample, sizeof(sample)) == sizeof(sample);
+        file.close();
+        return ok;
+    }
+
+    void pop() override {
+        if (size() == 0) return;
+        readOffset += sizeof(TelemetrySample);
+        if (readOffset >= fileSize) begin();   // Tout relu: on libère la flash
+    }
+
+    uint32_t size() override {
+        return (fileSize - readOffset) / sizeof(TelemetrySample);
+    }
+
+private:
+    const char* path;
+    uint32_t maxSize;
+    uint32_t readOffset;
+    uint32_t fileSize;
+};
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef TelemetryBuffer_h
+#define TelemetryBuffer_h
+
+#include <Arduino.h>
+#include <RonoBoxPlatform.h>
+
+// Mesure mise de côté pendant une coupure du broker
+struct TelemetrySample {
+    uint32_t timestamp;     // millis() au moment de la mesure
+    uint8_t channel;        // Voie de télémétrie de l'appareil
+    char payload[15];       // Valeur telle qu'elle aurait été publiée
+};
+
+// Support de débordement: journal FIFO d'échantillons en flash (ou émulé)
+class TelemetrySpill {
+public:
+    virtual ~TelemetrySpill() {}
+    virtual bool begin() = 0;                                            // Vide le journal
+    virtual bool append(const TelemetrySample* samples, uint16_t count) = 0;  // Une écriture par lot
+    virtual bool peek(TelemetrySample& sample) = 0;                     // Plus ancien échantillon
+    virtual void pop() = 0;
+    virtual uint32_t size() = 0;
+};
+
+enum TelemetryDropPolicy {
+    DROP_OLDEST,   // Tampon plein: la plus ancienne mesure laisse sa place
+    DROP_NEWEST    // Tampon plein: la nouvelle mesure est refusée
+};
+
+// Tampon borné d'échantillons horodatés, du plus ancien au plus récent.
+// RAM d'abord; quand elle est pleine et qu'un support est fourni, sa moitié la plus
+// ancienne part en flash en une seule écriture. Le journal flash contient donc
+// toujours des mesures plus anciennes que la RAM, et il est vidé en premier.
+class TelemetryBuffer {
+public:
+    static const uint8_t CAPACITY = PlatformConfig::TELEMETRY_CAPACITY;
+    static const size_t MAX_PAYLOAD_LENGTH = sizeof(TelemetrySample::payload) - 1;
+
+    TelemetryBuffer() : head(0), count(0), policy(DROP_OLDEST), spill(nullptr),
+                        droppedCount(0), spilledCount(0) {}
+
+    void setDropPolicy(TelemetryDropPolicy dropPolicy) {
+        policy = dropPolicy;
+    }
+
+    // Les horodatages millis() n'ont plus de sens après un redémarrage:
+    // le journal est vidé à l'activation
+    bool setSpill(TelemetrySpill* spillStorage) {
+        spill = spillStorage;
+        return !spill || spill->begin();
+    }
+
+    bool push(uint32_t timestamp, uint8_t channel, const char* payload) {
+        size_t length = strlen(payload);
+        if (length > MAX_PAYLOAD_LENGTH) {
+            droppedCount++;
+            return false;
+        }
+
+        if (count == CAPACITY && !spillOldestHalf()) {
+            if (policy == DROP_NEWEST) {
+                droppedCount++;
+                return false;
+            }
+            head = (head + 1) % CAPACITY;   // DROP_OLDEST: écrase la plus ancienne
+            count--;
+            droppedCount++;
+        }
+
+        TelemetrySample& sample = samples[(head + count) % CAPACITY];
+        sample.timestamp = timestamp;
+        sample.channel = channel;
+        memcpy(sample.payload, payload, length + 1);
+        count++;
+        return true;
+    }
+
+    // Plus ancien échantillon en attente (flash puis RAM), sans le retirer
+    bool peek(TelemetrySample& sample) {
+        if (spill && spill->size() > 0) {
+            return spill->peek(sample);
+        }
+        if (count == 0) return false;
+        sample = samples[head];
+        return true;
+    }
+
+    // Retire l'échantillon rendu par peek(), une fois publié
+    void pop() {
+        if (spill && spill->size() > 0) {
+            spill->pop();
+            return;
+        }
+        if (count == 0) return;
+        head = (head + 1) % CAPACITY;
+        count--;
+    }
+
+    bool isEmpty() {
+        return count == 0 && (!spill || spill->size() == 0);
+    }
+
+    uint32_t getBufferedCount() { return count + (spill ? spill->size() : 0); }
+    uint32_t getDroppedCount() const { return droppedCount; }
+    uint32_t getSpilledCount() const { return spilledCount; }
+
+private:
+    TelemetrySample samples[CAPACITY];
+    uint8_t head;
+    uint8_t count;
+    TelemetryDropPolicy policy;
+    TelemetrySpill* spill;
+    uint32_t droppedCount;
+    uint32_t spilledCount;
+
+    bool spillOldestHalf() {
+        if (!spill) return false;
+
+        // Lot contigu: la moitié la plus ancienne, recopiée dans l'ordre
+        const uint8_t batch = CAPACITY / 2;
+        TelemetrySample chunk[batch];
+        for (uint8_t i = 0; i < batch; i++) {
+            chunk[i] = samples[(head + i) % CAPACITY];
+        }
+        if (!spill->append(chunk, batch)) return false;
+
+        head = (head + batch) % CAPACITY;
+        count -= batch;
+        spilledCount += batch;
+        return true;
+    }
+};
+
+#endif
@@ -1,8 +1,16 @@
 #include <WiFi.h>
-#include <PubSubClient.h>
-#include "MQTTDevice.h"
-#include "ConfigManager.h"
+#include <MQTTDevice.h>
+#include <ConfigManager.h>
+#include <SensorScheduler.h>
+#include <AnalogAcquisition.h>
+#include <EdgeCapture.h>
+#include <IndicatorEngine.h>
+#include <AlarmRuleStore.h>
 ConfigManager configManager;
+SensorScheduler scheduler;
+AnalogAcquisition analogInputs;
+AlarmEngine alarms;
+AlarmRuleStore alarmRuleStore;
 
 // Définition des broches
 #define DHT_PIN 4         // Broche digitale pour DHT11
@@ -20,7 +28,87 @@ ConfigManager configManager;
 DHT dht(DHT_PIN, DHT_TYPE);
 
 // ==================== CLASSE POUR LA SIGNALISATION ====================
-class DeviceIndicator {
+// Motifs: {r, g, b, durée ms, tonalité Hz, durée tonalité ms, respiration}
+// Une couleur tenue après une tonalité est une image à part, sur laquelle le motif reboucle
+const IndicatorFrame TEST_FRAMES[] = {
+    {255, 0, 0, 300, 0, 0, false},       // Rouge
+    {0, 255, 0, 300, 0, 0, false},       // Vert
+    {0, 0, 255, 300, 0, 0, false},       // Bleu
+    {0, 0, 0, 300, 1000, 200, false},    // Éteint + test buzzer
+    {0, 0, 0, 300, 1500, 200, false},
+};
+const IndicatorFrame STARTUP_FRAMES[] = {
+    {255, 0, 255, 100, 800, 100, false},      // Magenta
+    {255, 0, 255, 1000, 0, 0, false},
+};
+const IndicatorFrame WIFI_CONNECTING_FRAMES[] = {
+    {0, 0, 255, 500, 0, 0, false},            // Clignotement bleu
+    {0, 0, 0, 500, 0, 0, false},
+};
+const IndicatorFrame WIFI_CONNECTED_FRAMES[] = {
+    {0, 0, 255, 200, 1000, 200, false},       // Bleu
+    {0, 0, 255, 1000, 0, 0, false},
+};
+const IndicatorFrame MQTT_CONNECTING_FRAMES[] = {
+    {0, 255, 255, 500, 0, 0, false},          // Clignotement cyan
+    {0, 0, 0, 500, 0, 0, false},
+};
+const IndicatorFrame MQTT_CONNECTED_FRAMES[] = {
+    {0, 255, 0, 130, 1000, 100, false},       // Vert + mélodie montante
+    {0, 255, 0, 130, 1200, 100, false},
+    {0, 255, 0, 260, 1400, 200, false},
+    {0, 255, 0, 1000, 0, 0, false},
+};
+const IndicatorFrame NORMAL_FRAMES[] = {
+    {0, 50, 0, 6283, 0, 0, true},             // Respiration verte douce
+};
+const IndicatorFrame CONFIG_MODE_FRAMES[] = {
+    {255, 165, 0, 500, 0, 0, false},          // Clignotement orange
+    {0, 0, 0, 500, 0, 0, false},
+};
+const IndicatorFrame CONNECTION_ERROR_FRAMES[] = {
+    {255, 0, 0, 250, 400, 500, false},        // Clignotement rouge rapide, tonalité une fois
+    {0, 0, 0, 250, 0, 0, false},
+    {255, 0, 0, 250, 0, 0, false},
+    {0, 0, 0, 250, 0, 0, false},
+};
+const IndicatorFrame GAS_ALERT_FRAMES[] = {
+    {255, 0, 0, 500, 2000, 100, false},       // Rouge clignotant + buzzer
+    {0, 0, 0, 500, 0, 0, false},
+};
+const IndicatorFrame WATER_LOW_ALERT_FRAMES[] = {
+    {0, 0, 255, 500, 1000, 200, false},       // Bleu clignotant + buzzer
+    {0, 0, 0, 500, 0, 0, false},
+};
+const IndicatorFrame SOIL_DRY_ALERT_FRAMES[] = {
+    {255, 255, 0, 500, 1500, 150, false},     // Jaune clignotant + buzzer
+    {0, 0, 0, 500, 0, 0, false},
+};
+const IndicatorFrame PRESENCE_FRAMES[] = {
+    {255, 255, 255, 100, 1200, 50, false},    // Flash blanc rapide
+};
+const IndicatorFrame DATA_SENT_FRAMES[] = {
+    {0, 255, 0, 50, 0, 0, false},             // Flash vert très rapide
+};
+
+const IndicatorPattern TEST_PATTERN = indicatorPattern(TEST_FRAMES, -1);
+const IndicatorPattern STARTUP_PATTERN = indicatorPattern(STARTUP_FRAMES, 1);
+const IndicatorPattern WIFI_CONNECTING_PATTERN = indicatorPattern(WIFI_CONNECTING_FRAMES, 0);
+const IndicatorPattern WIFI_CONNECTED_PATTERN = indicatorPattern(WIFI_CONNECTED_FRAMES, 1);
+const IndicatorPattern MQTT_CONNECTING_PATTERN = indicatorPattern(MQTT_CONNECTING_FRAMES, 0);
+const IndicatorPattern MQTT_CONNECTED_PATTERN = indicatorPattern(MQTT_CONNECTED_FRAMES, 3);
+const IndicatorPattern NORMAL_PATTERN = indicatorPattern(NORMAL_FRAMES, 0);
+const IndicatorPattern CONFIG_MODE_PATTERN = indicatorPattern(CONFIG_MODE_FRAMES, 0);
+const IndicatorPattern CONNECTION_ERROR_PATTERN = indicatorPattern(CONNECTION_ERROR_FRAMES, 2);
+const IndicatorPattern GAS_ALERT_PATTERN = indicatorPattern(GAS_ALERT_FRAMES, 0);
+const IndicatorPattern WATER_LOW_ALERT_PATTERN = indicatorPattern(WATER_LOW_ALERT_FRAMES, 0);
+const IndicatorPattern SOIL_DRY_ALERT_PATTERN = indicatorPattern(SOIL_DRY_ALERT_FRAMES, 0);
+const IndicatorPattern PRESENCE_PATTERN = indicatorPattern(PRESENCE_FRAMES, -1);
+const IndicatorPattern DATA_SENT_PATTERN = indicatorPattern(DATA_SENT_FRAMES, -1);
+
+// Les états et alertes choisissent un motif; IndicatorEngine l'anime sans jamais bloquer.
+// Priorités: alerte > notification > état.
+class DeviceIndicator : protected IndicatorOutput {
 private:
     // États de l'appareil
     enum DeviceState {
@@ -30,21 +118,17 @@ private:
         MQTT_CONNECTING,
         Device_MQTT_CONNECTED,
         NORMAL_OPERATION,
-        ALERT_GAS,
-        ALERT_WATER_LOW,
-        ALERT_SOIL_DRY,
         ERROR_CONNECTION,
         CONFIG_MODE
     };
     
     DeviceState currentState;
-    unsigned long lastBlink;
-    bool blinkState;
-    unsigned long alertStartTime;
+    IndicatorEngine engine;
+    const IndicatorPattern* currentAlert;
     bool alertActive;
     
 public:
-    DeviceIndicator() : currentState(STARTUP), lastBlink(0), blinkState(false), alertStartTime(0), alertActive(false) {}
+    DeviceIndicator() : currentState(STARTUP), engine(*this), currentAlert(nullptr), alertActive(false) {}
     
     void begin() {
         // Configuration des broches
@@ -53,27 +137,14 @@ public:
         pinMode(RGB_B_PIN, OUTPUT);
         pinMode(Buzzer_PIN, OUTPUT);
         
-        // Test initial
+        // Test initial, joué par-dessus l'état de démarrage
         testIndicators();
         setStartup();
     }
     
     void testIndicators() {
-        Serial.println("Test des indicateurs...");
-        
-        // Test RGB
-        setRGB(255, 0, 0); delay(300);    // Rouge
-        setRGB(0, 255, 0); delay(300);    // Vert
-        setRGB(0, 0, 255); delay(300);    // Bleu
-        setRGB(0, 0, 0);                  // Éteint
-        
-        // Test buzzer
-        tone(Buzzer_PIN, 1000, 200);
-        delay(300);
-        tone(Buzzer_PIN, 1500, 200);
-        delay(300);
-        
-        Serial.println("Test terminé.");
+        RB_LOG_INFO("Test des indicateurs...");
+        engine.play(LAYER_NOTIFICATION, TEST_PATTERN);
     }
     
     void setRGB(int r, int g, int b) {
@@ -82,215 +153,103 @@ public:
         analogWrite(RGB_B_PIN, b);
     }
     
-    void playTone(int frequency, int duration) {
-        tone(Buzzer_PIN, frequency, duration);
-    }
-    
-    void playMelody(int notes[], int durations[], int length) {
-        for (int i = 0; i < length; i++) {
-            tone(Buzzer_PIN, notes[i], durations[i]);
-            delay(durations[i] * 1.3);
-        }
-    }
-    
     // États de l'appareil
     void setStartup() {
-        currentState = STARTUP;
-        setRGB(255, 0, 255); // Magenta
-        playTone(800, 100);
-        Serial.println("État: STARTUP");
+        setState(STARTUP, STARTUP_PATTERN, "État: STARTUP");
     }
     
     void setWifiConnecting() {
-        currentState = Device_WIFI_CONNECTING;
-        Serial.println("État: WIFI_CONNECTING");
+        setState(Device_WIFI_CONNECTING, WIFI_CONNECTING_PATTERN, "État: WIFI_CONNECTING");
     }
     
     void setWifiConnected() {
-        currentState = WIFI_CONNECTED;
-        setRGB(0, 0, 255); // Bleu
-        playTone(1000, 200);
-        Serial.println("État: WIFI_CONNECTED");
+        setState(WIFI_CONNECTED, WIFI_CONNECTED_PATTERN, "État: WIFI_CONNECTED");
     }
     
     void setMqttConnecting() {
-        currentState = MQTT_CONNECTING;
-        Serial.println("État: MQTT_CONNECTING");
+        setState(MQTT_CONNECTING, MQTT_CONNECTING_PATTERN, "État: MQTT_CONNECTING");
     }
     
     void setMqttConnected() {
-        currentState = Device_MQTT_CONNECTED;
-        setRGB(0, 255, 0); // Vert
-        int notes[] = {1000, 1200, 1400};
-        int durations[] = {100, 100, 200};
-        playMelody(notes, durations, 3);
-        Serial.println("État: MQTT_CONNECTED");
+        setState(Device_MQTT_CONNECTED, MQTT_CONNECTED_PATTERN, "État: MQTT_CONNECTED");
     }
     
     void setNormalOperation() {
-        currentState = NORMAL_OPERATION;
-        setRGB(0, 50, 0); // Vert faible (respiration)
-        Serial.println("État: NORMAL_OPERATION");
+        setState(NORMAL_OPERATION, NORMAL_PATTERN, "État: NORMAL_OPERATION");
     }
     
     void setConfigMode() {
-        currentState = CONFIG_MODE;
-        Serial.println("État: CONFIG_MODE");
+        setState(CONFIG_MODE, CONFIG_MODE_PATTERN, "État: CONFIG_MODE");
     }
     
     void setConnectionError() {
-        currentState = ERROR_CONNECTION;
-        setRGB(255, 0, 0); // Rouge
-        playTone(400, 500);
-        Serial.println("État: ERROR_CONNECTION");
+        setState(ERROR_CONNECTION, CONNECTION_ERROR_PATTERN, "État: ERROR_CONNECTION");
     }
     
-    // Alertes
+    // Alertes: pilotées par le moteur de règles, tenues jusqu'à clearAlerts().
+    // Relancer l'alerte en cours ne redémarre pas son motif.
     void setGasAlert() {
-        currentState = ALERT_GAS;
-        alertActive = true;
-        alertStartTime = millis();
-        Serial.println("ALERTE: Gaz détecté!");
+        raiseAlert(GAS_ALERT_PATTERN, "ALERTE: Gaz détecté!");
     }
     
     void setWaterLowAlert() {
-        currentState = ALERT_WATER_LOW;
-        alertActive = true;
-        alertStartTime = millis();
-        Serial.println("ALERTE: Niveau d'eau bas!");
+        raiseAlert(WATER_LOW_ALERT_PATTERN, "ALERTE: Niveau d'eau bas!");
     }
     
     void setSoilDryAlert() {
-        currentState = ALERT_SOIL_DRY;
-        alertActive = true;
-        alertStartTime = millis();
-        Serial.println("ALERTE: Sol sec!");
+        raiseAlert(SOIL_DRY_ALERT_PATTERN, "ALERTE: Sol sec!");
     }
     
     void clearAlerts() {
         if (alertActive) {
             alertActive = false;
-            setNormalOperation();
-            Serial.println("Alertes effacées - retour à l'état normal");
+            engine.stop(LAYER_ALERT);   // L'état courant reprend
+            RB_LOG_INFO("Alertes effacées - retour à l'état normal");
         }
     }
     
-    // Fonction principale à appeler dans loop()
+    // Fonction principale à appeler dans loop(): avance les motifs, quelques µs
     void update() {
-        unsigned long currentTime = millis();
-        
-        // Gestion des clignotements
-        if (currentTime - lastBlink > 500) {
-            blinkState = !blinkState;
-            lastBlink = currentTime;
-        }
-        
-        switch (currentState) {
-            case Device_WIFI_CONNECTING:
-                // Clignotement bleu
-                if (blinkState) {
-                    setRGB(0, 0, 255);
-                } else {
-                    setRGB(0, 0, 0);
-                }
-                break;
-                
-            case MQTT_CONNECTING:
-                // Clignotement cyan
-                if (blinkState) {
-                    setRGB(0, 255, 255);
-                } else {
-                    setRGB(0, 0, 0);
-                }
-                break;
-                
-            case NORMAL_OPERATION:
-                // Respiration verte douce
-                {
-                    int brightness = (sin(currentTime / 1000.0) + 1) * 25;
-                    setRGB(0, brightness, 0);
-                }
-                break;
-                
-            case CONFIG_MODE:
-                // Clignotement orange
-                if (blinkState) {
-                    setRGB(255, 165, 0);
-                } else {
-                    setRGB(0, 0, 0);
-                }
-                break;
-                
-            case ERROR_CONNECTION:
-                // Clignotement rouge rapide
-                if (currentTime - lastBlink > 250) {
-                    blinkState = !blinkState;
-                    lastBlink = currentTime;
-                }
-                if (blinkState) {
-                    setRGB(255, 0, 0);
-                } else {
-                    setRGB(0, 0, 0);
-                }
-                break;
-                
-            case ALERT_GAS:
-                // Alerte gaz - rouge clignotant + buzzer
-                if (blinkState) {
-                    setRGB(255, 0, 0);
-                    playTone(2000, 100);
-                } else {
-                    setRGB(0, 0, 0);
-                }
-                break;
-                
-            case ALERT_WATER_LOW:
-                // Alerte eau - bleu clignotant + buzzer
-                if (blinkState) {
-                    setRGB(0, 0, 255);
-                    playTone(1000, 200);
-                } else {
-                    setRGB(0, 0, 0);
-                }
-                break;
-                
-            case ALERT_SOIL_DRY:
-                // Alerte sol sec - jaune clignotant + buzzer
-                if (blinkState) {
-                    setRGB(255, 255, 0);
-                    playTone(1500, 150);
-                } else {
-                    setRGB(0, 0, 0);
-                }
-                break;
-        }
-        
-        // Auto-clear des alertes après 30 secondes
-        if (alertActive && (currentTime - alertStartTime > 30000)) {
-            clearAlerts();
-        }
+        engine.update();
     }
     
     // Notification de présence détectée
     void notifyPresence() {
-        if (currentState == NORMAL_OPERATION) {
-            // Flash blanc rapide
-            setRGB(255, 255, 255);
-            playTone(1200, 50);
-            delay(100);
-            setRGB(0, 50, 0); // Retour à l'état normal
+        if (currentState == NORMAL_OPERATION && !alertActive) {
+            engine.play(LAYER_NOTIFICATION, PRESENCE_PATTERN);
         }
     }
     
     // Notification de données envoyées
     void notifyDataSent() {
-        if (currentState == NORMAL_OPERATION) {
-            // Flash vert très rapide
-            setRGB(0, 255, 0);
-            delay(50);
-            setRGB(0, 50, 0);
+        if (currentState == NORMAL_OPERATION && !alertActive) {
+            engine.play(LAYER_NOTIFICATION, DATA_SENT_PATTERN);
         }
     }
+
+protected:
+    void setColor(uint8_t r, uint8_t g, uint8_t b) override {
+        setRGB(r, g, b);
+    }
+
+    void playTone(uint16_t frequency, uint16_t durationMs) override {
+        tone(Buzzer_PIN, frequency, durationMs);
+    }
+
+private:
+    void setState(DeviceState state, const IndicatorPattern& pattern, const char* message) {
+        currentState = state;
+        engine.play(LAYER_STATE, pattern);
+        RB_LOG_INFO("%s", message);
+    }
+
+    void raiseAlert(const IndicatorPattern& pattern, const char* message) {
+        if (alertActive && currentAlert == &pattern) return;
+        RB_LOG_INFO("%s", message);
+        currentAlert = &pattern;
+        alertActive = true;
+        engine.play(LAYER_ALERT, pattern);
+    }
 };
 
 // Instance globale de l'indicateur
@@ -308,66 +267,6 @@ public:
                  mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
         return String(macStr);
     }
-
-    void setupHA() {
-        // Capteur de température
-        if(!getHAConfig().sendSensorConfig("salon", "temperature", "temperature", "°C", "Température Salon")) {
-            Serial.println("Échec de la configuration du capteur de température");
-        } else {
-            Serial.println("Succès de la configuration du capteur de température");
-        }
-        
-        delay(500);
-        
-        // Capteur d'humidité
-        if(!getHAConfig().sendSensorConfig("salon", "humidite", "humidity", "%", "Humidité Salon")) {
-            Serial.println("Échec de la configuration du capteur d'humidité");
-        } else {
-            Serial.println("Succès de la configuration du capteur d'humidité");
-        }
-        
-        delay(500);
-        
-        // Capteur de gaz MQ2
-        if (!getHAConfig().sendSensorConfig("salon", "gaz","ppm", "Détection de gaz (MQ2)")) {
-            Serial.println("Échec de la configuration du capteur de gaz");
-        } else {
-            Serial.println("Succès de la configuration du capteur de gaz");
-        }
-        delay(500);
-
-        // Capteur d'humidité du sol
-        if (!getHAConfig().sendSensorConfig("salon", "humidite_sol", "moisture", "%", "Humidité du sol")) {
-            Serial.println("Échec de la configuration du capteur d'humidité du sol");
-        } else {
-            Serial.println("Succès de la configuration du capteur d'humidité du sol");
-        }
-        delay(500);
-
-        // Capteur de niveau d'eau
-        if (!getHAConfig().sendSensorConfig("salon", "niveau_eau", "moisture", "%", "Niveau d'eau")) {
-            Serial.println("Échec de la configuration du capteur de niveau d'eau");
-        } else {
-            Serial.println("Succès de la configuration du capteur de niveau d'eau");
-        }
-        delay(500);
-
-        // Capteur PIR
-        if (!getHAConfig().sendBinarySensorConfig("salon", "presence", "motion", "Présence détectée")) {
-            Serial.println("Échec de la configuration du capteur PIR");
-        } else {
-            Serial.println("Succès de la configuration du capteur PIR");
-        }
-    }
-
-    void handleCommand(const String& location, const String& device, const String& value) override {
-        if (device == "lampe") {
-            Serial.print("Commande lampe reçue: ");
-            Serial.println(value);
-            publishSensorData(location, device, value);
-            Serial.printf("Commande Lampe reçue et exécutée %s dans la %s\n", value.c_str(), location.c_str());
-        }
-    }
 };
 // === Simulation Température & Humidité ===
 float simulatedTemperature = 28.0;
@@ -411,190 +310,268 @@ void simulateSensorData(float &temperature, float &humidity) {
 
 MySmartHomeDevice device;
 
-void setup() {
-    Serial.begin(115200);
-    delay(1000);
-    Serial.println("App Launching");
-    
-    // Initialiser les indicateurs
-    indicator.begin();
-    
-    // Mode configuration AP si nécessaire
-    if (!configManager.begin()) {
-        Serial.println("Mode configuration AP actif");
-        Serial.println("Connectez-vous au WiFi 'SmartHome-Config'");
-        Serial.println("Ouvrez http://192.168.4.1 dans votre navigateur");
-        indicator.setConfigMode();
-        
-        while (!configManager.isConfigured()) {
-            configManager.handleClient();
-            indicator.update();
-            delay(100);
+// Modèle de l'appareil: découverte Home Assistant, abonnements et commandes.
+// Seuls les topics ".../set" des entités ayant un gestionnaire sont écoutés.
+// Précision des capteurs climat: au-delà de la résolution du DHT, ce n'est que du bruit.
+// Gaz et alarme sont des alertes: publiées en QoS1, retransmises jusqu'à l'accusé du broker.
+constexpr DeviceEntity DEVICE_MODEL[] = {
+    sensorEntity("salon", "temperature", "temperature", "°C", "Température Salon", 1),
+    sensorEntity("salon", "humidite", "humidity", "%", "Humidité Salon", 0),
+    alertEntity(sensorEntity("salon", "gaz", "", "ppm", "Détection de gaz (MQ2)")),
+    sensorEntity("salon", "humidite_sol", "moisture", "%", "Humidité du sol"),
+    sensorEntity("salon", "niveau_eau", "moisture", "%", "Niveau d'eau"),
+    binarySensorEntity("salon", "presence", "motion", "Présence détectée"),
+    alertEntity(binarySensorEntity("salon", "alarme", "safety", "Alarme Salon")),
+
+    commandEntity("salon", "lampe", [](const MQTTSpan& location, const MQTTSpan& value) {
+        const char* state = value.equals("ON") ? "ON" : "OFF";
+        device.publishSensorData(location.data, "lampe", state);
+        RB_LOG_INFO("Commande Lampe reçue et exécutée %s dans la %s", state, location.data);
+    }),
+
+    // Règle d'alarme en JSON (voir AlarmEngine::applyJson), enregistrée en flash
+    commandEntity("salon", "alarme", [](const MQTTSpan& location, const MQTTSpan& value) {
+        bool accepted = alarms.applyJson(value.data, value.length);
+        device.publishSensorData(location.data, "alarme_regles", accepted ? "OK" : "REJET");
+    }),
+};
+
+// === Dernières valeurs des capteurs (mises à jour par l'ordonnanceur) ===
+float temperature = 0;
+float humidity = 0;
+int waterLevelPercentage = 0;
+int soilMoisturePercentage = 0;
+int gasPercentage = 0;
+int presence = 0;
+
+void readClimate() {
+    // temperature = dht.readTemperature();
+    // humidity = dht.readHumidity();
+    simulateSensorData(temperature, humidity);  // <== APPEL DE LA SIMULATION
+}
+
+// === Entrées analogiques (échantillonnées en tâche de fond, voir setupAnalogInputs) ===
+// Courbes brut 12 bits → %: points équivalents aux anciens map(), à remplacer
+// par les valeurs relevées sur chaque capteur (à sec / immergé, air pur / gaz)
+const CalibrationPoint WATER_LEVEL_CURVE[] = { {0, 0}, {4095, 100} };
+const CalibrationPoint SOIL_MOISTURE_CURVE[] = { {0, 100}, {4095, 0} };
+const CalibrationPoint GAS_CURVE[] = { {0, 0}, {4095, 100} };
+
+int waterLevelChannel = -1;
+int soilMoistureChannel = -1;
+int gasChannel = -1;
+
+void setupAnalogInputs() {
+    waterLevelChannel = analogInputs.addChannel(WATER_LEVEL_PIN, WATER_LEVEL_CURVE, 2, 3);
+    soilMoistureChannel = analogInputs.addChannel(SOIL_MOISTURE_PIN, SOIL_MOISTURE_CURVE, 2, 4);
+    gasChannel = analogInputs.addChannel(MQ2_PIN, GAS_CURVE, 2, 2);   // Réactif: sert à l'alarme
+    if (!analogInputs.begin()) {
+        RB_LOG_WARN("Acquisition analogique indisponible");
+    }
+}
+
+void readWaterLevel() {
+    waterLevelPercentage = lroundf(analogInputs.value(waterLevelChannel));
+}
+
+void readSoilMoisture() {
+    soilMoisturePercentage = lroundf(analogInputs.value(soilMoistureChannel));
+}
+
+// PIR capturé par interruption (anti-rebond 50 ms): une détection brève entre
+// deux relevés n'est pas perdue, même si loop() est occupée
+EdgeInput presenceInput(PIR_PIN, 50000);
+
+void readPresence() {
+    bool seen = presenceInput.level();
+    EdgeEvent event;
+    while (presenceInput.poll(event)) {
+        if (event.rising) {
+            seen = true;
+            indicator.notifyPresence();   // === Notification de présence ===
         }
     }
+    presence = seen || presenceInput.level();
+}
 
-    // Récupération de la configuration
-    NetworkConfig config = configManager.getConfig();
-    
-    Serial.print("Tentative de connexion à: ");
-    Serial.println(config.wifiSSID);
-    
-    // Connexion WiFi avec indication visuelle
-    indicator.setWifiConnecting();
-    WiFi.begin(config.wifiSSID.c_str(), config.wifiPassword.c_str());
-    
-    unsigned long wifiTimeout = millis() + 30000;
-    while (WiFi.status() != WL_CONNECTED && millis() < wifiTimeout) {
-        indicator.update();
-        delay(500);
-        Serial.print(".");
+void readGas() {
+    gasPercentage = lroundf(analogInputs.value(gasChannel));
+}
+
+// === Alarmes locales: évaluées à chaque échantillon filtré, sans passer par le réseau ===
+enum AlarmAction : uint8_t {
+    ALARM_ACTION_GAS,
+    ALARM_ACTION_WATER_LOW,
+    ALARM_ACTION_SOIL_DRY
+};
+
+// Règles d'usine, remplacées par celles reçues en MQTT une fois enregistrées.
+// Ordre = priorité d'affichage. {grandeur, condition, action, active, -, seuil, hystérésis, durée ms}
+const AlarmRule DEFAULT_ALARM_RULES[] = {
+    {"gaz", ALARM_ABOVE, ALARM_ACTION_GAS, 1, 0, 30, 3, 0},
+    {"gaz", ALARM_RISE, ALARM_ACTION_GAS, 1, 0, 10, 5, 0},             // +10 %/s: fuite franche
+    {"niveau_eau", ALARM_BELOW, ALARM_ACTION_WATER_LOW, 1, 0, 20, 3, 2000},
+    {"humidite_sol", ALARM_BELOW, ALARM_ACTION_SOIL_DRY, 0, 0, 20, 5, 60000},
+};
+
+int gasAlarmInput = -1;
+int waterLevelAlarmInput = -1;
+int soilMoistureAlarmInput = -1;
+
+// Affiche la règle active la plus prioritaire, ou retire l'alerte
+void showAlarms(uint8_t index, const AlarmRule& rule, bool active) {
+    RB_LOG_WARN("[Alarme] Règle %u (%s %s %.1f): %s", index, rule.input,
+                AlarmEngine::conditionName(rule.condition), rule.threshold, active ? "ON" : "OFF");
+
+    int first = alarms.firstActive();
+    if (first < 0) {
+        indicator.clearAlerts();
+        return;
     }
+    switch (alarms.getRule(first).action) {
+        case ALARM_ACTION_GAS:       indicator.setGasAlert(); break;
+        case ALARM_ACTION_WATER_LOW: indicator.setWaterLowAlert(); break;
+        case ALARM_ACTION_SOIL_DRY:  indicator.setSoilDryAlert(); break;
+    }
+}
 
-    if (WiFi.status() != WL_CONNECTED) {
-        Serial.println("\nErreur de connexion WiFi!");
-        indicator.setConnectionError();
-        delay(5000);
-        ESP.restart();
+void setupAlarms() {
+    gasAlarmInput = alarms.addInput("gaz");
+    waterLevelAlarmInput = alarms.addInput("niveau_eau");
+    soilMoistureAlarmInput = alarms.addInput("humidite_sol");
+    alarms.onAlarm(showAlarms);
+    alarms.begin(DEFAULT_ALARM_RULES, sizeof(DEFAULT_ALARM_RULES) / sizeof(DEFAULT_ALARM_RULES[0]),
+                 &alarmRuleStore);
+}
+
+// Passe chaque nouvel échantillon filtré au moteur de règles, dès sa sortie du filtre
+void feedAlarm(int channel, int input, uint32_t& lastCount) {
+    uint32_t count = analogInputs.sampleCount(channel);
+    if (count == lastCount || !analogInputs.ready(channel)) return;
+    lastCount = count;
+    alarms.evaluate(input, analogInputs.value(channel));
+}
+
+void evaluateAlarms() {
+    static uint32_t gasCount = 0, waterLevelCount = 0, soilMoistureCount = 0;
+    feedAlarm(gasChannel, gasAlarmInput, gasCount);
+    feedAlarm(waterLevelChannel, waterLevelAlarmInput, waterLevelCount);
+    feedAlarm(soilMoistureChannel, soilMoistureAlarmInput, soilMoistureCount);
+}
+
+// Les valeurs sont confiées à MQTTDevice même hors connexion: elles sont alors
+// mises de côté dans son tampon de télémétrie et rejouées à la reconnexion
+void publishTelemetry() {
+    device.publishSensorData("salon", "temperature", temperature);
+    device.publishSensorData("salon", "humidite", humidity);
+    device.publishSensorData("salon", "niveau_eau", waterLevelPercentage);
+    device.publishSensorData("salon", "humidite_sol", soilMoisturePercentage);
+    device.publishSensorData("salon", "gaz", gasPercentage);
+    device.publishSensorData("salon", "presence", presence ? "ON" : "OFF");
+    device.publishSensorData("salon", "alarme", alarms.firstActive() >= 0 ? "ON" : "OFF");
+
+    // Notification visuelle d'envoi de données
+    if (device.isConnected()) {
+        indicator.notifyDataSent();
     }
+}
 
-    Serial.println("\nConnecté au WiFi!");
-    Serial.print("Adresse IP: ");
-    Serial.println(WiFi.localIP());
-    indicator.setWifiConnected();
-    delay(1000);
+void updateIndicator() {
+    indicator.update();
+}
 
-    // Configuration MQTT
-    IPAddress MQTTBrokerip;
-    indicator.setMqttConnecting();
-    
-    if (WiFi.hostByName("raspberrypi.local", MQTTBrokerip)) {
-        Serial.print("IP du broker MQTT: ");
-        Serial.println(MQTTBrokerip);
-    } else {
-        Serial.println("Échec de résolution DNS");
-        indicator.setConnectionError();
-        delay(5000);
-        ESP.restart();
+void setupPublishPolicies() {
+    // Seuls les changements significatifs partent immédiatement, avec un heartbeat par capteur
+    device.setPublishPolicy("salon", "temperature", 0.2, 5000, 60000);
+    device.setPublishPolicy("salon", "humidite", 1.0, 5000, 60000);
+    device.setPublishPolicy("salon", "niveau_eau", 2, 2000, 60000);
+    device.setPublishPolicy("salon", "humidite_sol", 2, 5000, 60000);
+    device.setPublishPolicy("salon", "gaz", 2, 0, 30000);
+}
+
+void setupTasks() {
+    // Les voies analogiques sont déjà filtrées: ces tâches ne font que relever la valeur
+    scheduler.addTask("climat", 1000, readClimate);
+    scheduler.addTask("niveau_eau", 1000, readWaterLevel, 200);
+    scheduler.addTask("humidite_sol", 1000, readSoilMoisture, 400);
+    scheduler.addTask("gaz", 500, readGas, 600);
+    scheduler.addTask("presence", 100, readPresence);
+    scheduler.addTask("publication", 1000, publishTelemetry, 800);
+    scheduler.addTask("indicateur", 20, updateIndicator);
+}
+
+// Reflète l'état de la connexion sur l'indicateur
+void showLinkState(LinkState state) {
+    RB_LOG_INFO("Connexion: %s", ConnectionStateMachine::stateName(state));
+    switch (state) {
+        case LINK_WIFI:      indicator.setWifiConnecting(); break;
+        case LINK_DNS:       indicator.setWifiConnected(); break;
+        case LINK_MQTT:
+        case LINK_SESSION:   indicator.setMqttConnecting(); break;
+        case LINK_SUBSCRIBE: indicator.setMqttConnected(); break;
+        case LINK_DISCOVERY: break;
+        case LINK_ONLINE:    indicator.setNormalOperation(); break;
+    }
+}
+
+// Reflète le provisionnement WiFi sur l'indicateur
+void showProvisioningState(ProvisioningState state) {
+    RB_LOG_INFO("Provisionnement: %s", ConfigManager::stateName(state));
+    switch (state) {
+        case PROV_CONNECTING: indicator.setWifiConnecting(); break;
+        case PROV_CONNECTED:  indicator.setWifiConnected(); break;
+        case PROV_AP_MODE:
+            RB_LOG_INFO("Mode configuration AP actif");
+            RB_LOG_INFO("Connectez-vous au WiFi 'SmartHome-Config'");
+            RB_LOG_INFO("Ouvrez http://192.168.4.1 dans votre navigateur");
+            indicator.setConfigMode();
+            break;
+        default: break;
     }
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+    RB_LOG_INFO("App Launching");
     
-    bool mqttConnected = device.begin(MQTTBrokerip);
+    // Initialiser les indicateurs
+    indicator.begin();
     
-    if (mqttConnected) {
-        Serial.println("Connecté au broker MQTT!");
-        indicator.setMqttConnected();
-        delay(1000);
-    } else {
-        Serial.println("Échec de la connexion au broker MQTT!");
-        indicator.setConnectionError();
-        delay(5000);
-        ESP.restart();
-    }
+    // Association WiFi en arrière-plan: capteurs et alarme gaz tournent dès maintenant
+    configManager.onStateChange(showProvisioningState);
+    configManager.begin();
+
+    // WiFi → DNS → MQTT → découverte: mené par device.handle() dans loop(),
+    // avec backoff et sans redémarrage sur perte transitoire
+    device.onLinkStateChange(showLinkState);
+    device.setModel(DEVICE_MODEL);
+    device.begin("raspberrypi.local");
 
     // Configuration des périphériques
-    device.setupHA();
     dht.begin();
-    pinMode(PIR_PIN, INPUT);
+    presenceInput.begin(INPUT);
+    setupAnalogInputs();
+    setupAlarms();
+    setupPublishPolicies();
+    setupTasks();
     
-    // État normal
-    indicator.setNormalOperation();
-    Serial.println("Setup complet!");
+    RB_LOG_INFO("Setup complet!");
 }
 
 void loop() {
-    // Mettre à jour les indicateurs
-    indicator.update();
-    
-    if (WiFi.status() != WL_CONNECTED) {
-        Serial.println("Connexion WiFi perdue, tentative de reconnexion...");
-        indicator.setWifiConnecting();
-        WiFi.reconnect();
-        delay(5000);
-        
-        if (WiFi.status() != WL_CONNECTED) {
-            Serial.println("Échec reconnexion, redémarrage...");
-            indicator.setConnectionError();
-            delay(2000);
-            ESP.restart();
-        } else {
-            indicator.setWifiConnected();
-            delay(1000);
-            indicator.setNormalOperation();
-        }
-    }
-    
     configManager.handleClient();
-    
-    if (configManager.isConfigured()) {
-        device.handle();
-        
-        // === Lecture des capteurs ===
-        // float humidity = dht.readHumidity();
-        // float temperature = dht.readTemperature();
-        // delay(200);
-         float humidity = 0;
-         float temperature = 0;
-            simulateSensorData(temperature, humidity);  // <== APPEL DE LA SIMULATION
-            delay(200);
-
-        
-        int waterLevel = analogRead(WATER_LEVEL_PIN);
-        int waterLevelPercentage = map(waterLevel, 0, 4095, 0, 100);
-        delay(200);
-
-        int soilMoisture = analogRead(SOIL_MOISTURE_PIN);
-        int soilMoisturePercentage = map(soilMoisture, 4095, 0, 0, 100);
-        delay(200);
-
-        int presence = digitalRead(PIR_PIN);
-        delay(200);
 
-        int gasValue = analogRead(MQ2_PIN);
-        int gasPercentage = map(gasValue, 0, 4095, 0, 100);
-        delay(200);
-
-        // === Gestion des alertes ===
-        static bool lastAlertState = false;
-        bool currentAlertState = false;
-        
-        // Vérification des seuils d'alerte
-        if (gasPercentage > 30) {
-            indicator.setGasAlert();
-            currentAlertState = true;
-        } else if (waterLevelPercentage < 20) {
-            indicator.setWaterLowAlert();
-            currentAlertState = true;
-        } else if (soilMoisturePercentage < 20) {
-           // indicator.setSoilDryAlert();
-           // currentAlertState = true;
-        }
-        
-        // Effacer les alertes si les conditions sont revenues normales
-        if (lastAlertState && !currentAlertState) {
-            indicator.clearAlerts();
-        }
-        lastAlertState = currentAlertState;
-        
-        // === Notification de présence ===
-        static int lastPresence = 0;
-        if (presence && !lastPresence) {
-            indicator.notifyPresence();
-        }
-        lastPresence = presence;
-
-        // === Envoi des données ===
-        static unsigned long lastSend = 0;
-        if (millis() - lastSend > 1000) {
-            device.publishSensorData("salon", "temperature", temperature);
-            device.publishSensorData("salon", "humidite", humidity);
-            device.publishSensorData("salon", "niveau_eau", waterLevelPercentage);
-            device.publishSensorData("salon", "humidite_sol", soilMoisturePercentage);
-            device.publishSensorData("salon", "gaz", gasPercentage);
-            device.publishSensorData("salon", "presence", presence ?"ON":"OFF");
-            
-            // Notification visuelle d'envoi de données
-            indicator.notifyDataSent();
-            
-            lastSend = millis();
-        }
+    // La première association appartient au provisionnement; ensuite, les pertes
+    // de lien sont reprises par la machine à états de MQTTDevice
+    if (configManager.getState() == PROV_CONNECTED) {
+        device.handle();
     }
-}
\ No newline at end of file
+
+    // Acquisition analogique et alarmes à chaque tour, puis lectures capteurs,
+    // publication et indicateurs: aucune attente bloquante
+    analogInputs.update();
+    evaluateAlarms();
+    scheduler.run();
+    DeviceLog::drain();   // Temps restant: journal vers le port série, sans attendre
+}
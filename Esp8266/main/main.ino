@@ -1,7 +1,8 @@
 #include <ESP8266WiFi.h>
-#include <PubSubClient.h>
-#include "MQTTDevice.h"
-#include "ConfigManager.h"
+#include <MQTTDevice.h>
+#include <ConfigManager.h>
+#include <SensorScheduler.h>
+#include <EdgeCapture.h>
 #define BOUTON_RESET_CONFIG 0
 
 // Définitions des broches
@@ -12,14 +13,15 @@ class MySmartHomeDevice : public MQTTDevice {
 private:
     bool lampState;
     bool soundControlEnabled;
-    unsigned long lastSoundDetection;
     const unsigned long soundTimeout = 1000;
+    // Capteur de son capturé par interruption: anti-rebond 2 ms, période réfractaire soundTimeout
+    EdgeInput soundInput;
  
 public:
-    MySmartHomeDevice() : MQTTDevice(WiFi.macAddress()), lampState(false), soundControlEnabled(true), lastSoundDetection(0) {
+    MySmartHomeDevice() : MQTTDevice(WiFi.macAddress()), lampState(false), soundControlEnabled(true),
+                          soundInput(SOUND_SENSOR_PIN, 2000, soundTimeout) {
         pinMode(RELAY_PIN, OUTPUT);
         digitalWrite(RELAY_PIN, LOW);
-        pinMode(SOUND_SENSOR_PIN, INPUT);
     }
 
         void initPublish(){
@@ -30,56 +32,12 @@ public:
 
     }
 
-    void setupHA() {    
-        // Switch Lampe
-        if(!getHAConfig().sendSwitchConfig("salon", "lampe", "Lampe Salon")) {
-            Serial.println("Échec de la configuration de la lampe");
-        } else {
-            Serial.println("Succès de la configuration de la lampe");
-        }
-
-        delay(500);
-        
-        // Capteur de son
-        //    bool sendBinarySensorConfig(const String& location, const String& sensor,
-       //                        const String& deviceClass, const String& friendlyName);
-
-        if(!getHAConfig().sendBinarySensorConfig("salon", "detection_son", "song", "Détection de son")) {
-            Serial.println("Échec de la configuration du capteur de son");
-        } else {
-            Serial.println("Succès de la configuration du capteur de son");
-        }
-
-        delay(500);
-        
-        // Switch pour contrôle par son
-        if(!getHAConfig().sendSwitchConfig("salon", "sound", "Controle veilleuse par son")) {
-            Serial.println("Échec de la configuration du contrôle par son");
-        } else {
-            Serial.println("Succès de la configuration du contrôle par son");
-        }
-    }
-
-    void handleCommand(const String& location, const String& device, const String& value) override {
-        Serial.printf("Commande reçue - Location: %s, Device: %s, Value: %s\n", 
-                location.c_str(), device.c_str(), value.c_str());
-    
-        if (device == "lampe") {
-            setLampState(value == "ON");
-            Serial.print("Commande lampe reçue: ");
-            Serial.println(value);
-            publishSensorData(location, device, lampState ? "ON" : "OFF");
-        }
-        else if (device == "sound") {
-            soundControlEnabled = (value == "ON");
-            publishSensorData(location, device, soundControlEnabled ? "ON" : "OFF");
-            Serial.print("Contrôle par son ");
-            Serial.println(soundControlEnabled ? "activé" : "désactivé");
-        }
+    void setSoundControl(bool enabled) {
+        soundControlEnabled = enabled;
+        publishSensorData("salon", "sound", soundControlEnabled ? "ON" : "OFF");
+        RB_LOG_INFO("Contrôle par son %s", soundControlEnabled ? "activé" : "désactivé");
     }
 
-
-
     void setLampState(bool state) {
         lampState = state;
         digitalWrite(RELAY_PIN, state ? HIGH : LOW);
@@ -90,74 +48,97 @@ public:
         setLampState(!lampState);
     }
 
+    // À appeler dans setup(): attache l'interruption du capteur de son
+    void beginSensors() {
+        soundInput.begin(INPUT);
+    }
+
+    // Traite les claps capturés depuis le dernier appel; ceux reçus pendant que le
+    // contrôle est désactivé sont simplement écartés
     void checkSoundSensor() {
-        if (!soundControlEnabled) return;
-        
-        int soundValue = digitalRead(SOUND_SENSOR_PIN);
-        
-        if (soundValue && (millis() - lastSoundDetection > soundTimeout)) {
-            lastSoundDetection = millis();
+        EdgeEvent event;
+        while (soundInput.poll(event)) {
+            if (!event.rising || !soundControlEnabled) continue;
             toggleLamp();
             publishSensorData("salon", "detection_son", "ON");
         }
     }
-
-    void handle() {
-        MQTTDevice::handle();
-        checkSoundSensor();
-    }
 };
 
 ConfigManager configManager;
 MySmartHomeDevice device;
 NetworkConfig config;
+SensorScheduler scheduler;
+
+// Modèle de l'appareil: découverte Home Assistant, abonnements et commandes
+constexpr DeviceEntity DEVICE_MODEL[] = {
+    switchEntity("salon", "lampe", "Lampe Salon", [](const MQTTSpan& location, const MQTTSpan& value) {
+        RB_LOG_INFO("Commande lampe reçue: %.*s", (int)value.length, value.data);
+        device.setLampState(value.equals("ON"));
+    }),
+    binarySensorEntity("salon", "detection_son", "song", "Détection de son"),
+    switchEntity("salon", "sound", "Controle veilleuse par son", [](const MQTTSpan& location, const MQTTSpan& value) {
+        device.setSoundControl(value.equals("ON"));
+    }),
+};
+
+// Simuler des données de capteurs
+void publishSimulatedClimate() {
+    float temperature = random(200, 300) / 10.0;
+    float humidity = random(300, 800) / 10.0;
+
+    device.publishSensorData("salon", "temperature", temperature);
+    device.publishSensorData("salon", "humidite", humidity);
+}
+
+void checkSound() {
+    device.checkSoundSensor();
+}
+
+void showProvisioningState(ProvisioningState state) {
+    RB_LOG_INFO("Provisionnement: %s", ConfigManager::stateName(state));
+    if (state == PROV_CONNECTING) {
+        RB_LOG_INFO("Tentative de connexion à: %s", configManager.getConfig().wifiSSID.c_str());
+    } else if (state == PROV_AP_MODE) {
+        RB_LOG_INFO("Mode configuration AP actif");
+        RB_LOG_INFO("Connectez-vous au WiFi 'SmartHome-Config'");
+        RB_LOG_INFO("Ouvrez http://192.168.4.1 dans votre navigateur");
+    }
+}
 
 void setup() {
     Serial.begin(115200);
     delay(2000);
 
 
-    Serial.println("App Launching");
+    RB_LOG_INFO("App Launching");
               
-    if (!configManager.begin()) {
-        Serial.println("Mode configuration AP actif");
-        Serial.println("Connectez-vous au WiFi 'SmartHome-Config'");
-        Serial.println("Ouvrez http://192.168.4.1 dans votre navigateur");
-        
-        // Debug
-        NetworkConfig config = configManager.getConfig();
-        Serial.println("Tentative de connexion à: ");
-        Serial.println(config.wifiSSID);
-            
-        while (!configManager.isConfigured()) {
-            configManager.handleClient();
-            delay(100);
-        }
-    }
+    // Association WiFi en arrière-plan (portail de configuration en cas d'échec)
+    configManager.onStateChange(showProvisioningState);
+    configManager.begin();
 
     config = configManager.getConfig();
+    device.beginSensors();
+    device.setModel(DEVICE_MODEL);
+    device.onAnnounce([]() {
+        bool ok = device.getHAConfig().announce();
+        device.initPublish();
+        return ok;
+    });
+    device.setPrecision("salon", "temperature", 1);
+    device.setPrecision("salon", "humidite", 0);
     device.begin(config.mqttServer.c_str());
-    delay(2000);
-    device.setupHA();
-    delay(500);
-    device.initPublish();
+
+    scheduler.addTask("son", 20, checkSound);
+    scheduler.addTask("climat", 5000, publishSimulatedClimate);
 }
 
 
 void loop() {
- 
-    device.handle();
-    
-    
-    // Simuler des données de capteurs
-    static unsigned long lastSend = 0;
-    if (millis() - lastSend > 5000) {
-        float temperature = random(200, 300) / 10.0;
-        float humidity = random(300, 800) / 10.0;
-        
-        device.publishSensorData("salon", "temperature", temperature);
-        device.publishSensorData("salon", "humidite", humidity);
-      
-        lastSend = millis();
+    configManager.handleClient();
+    if (configManager.getState() == PROV_CONNECTED) {
+        device.handle();
     }
-}
\ No newline at end of file
+    scheduler.run();
+    DeviceLog::drain();   // Temps restant: journal vers le port série, sans attendre
+}
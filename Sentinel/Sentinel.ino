@@ -3,15 +3,19 @@
 #else
 #include <ESP8266WiFi.h>
 #endif
-#include <PubSubClient.h>
-#include "MQTTDevice.h"
-#include "ConfigManager.h"
+#include <MQTTDevice.h>
+#include <ConfigManager.h>
+#include <SensorScheduler.h>
+#include <EdgeCapture.h>
+#include <LittleFSSpill.h>
+#include <AlarmRuleStore.h>
 #include <Wire.h>
 #include <LiquidCrystal_I2C.h>
 #include <DHT.h>
 
 
 ConfigManager configManager;
+SensorScheduler scheduler;
 
 // Définition des broches
 #define BUZZER_PIN 34
@@ -25,12 +29,27 @@ ConfigManager configManager;
 
 DHT dht(DHT_PIN, DHT_TYPE);
 
-unsigned long lastWifiAttempt = 0;
-unsigned long lastMQTTAttempt = 0;
-const unsigned long retryInterval = 15000;
+// PIR capturé par interruption (anti-rebond 50 ms)
+EdgeInput presenceInput(PRESENCE_PIN, 50000);
 
-bool wifiConnected = false;
-bool mqttConnected = false;
+// Journal des relevés non publiés pendant une coupure du broker
+LittleFSSpill telemetrySpill;
+
+// Alarme gaz locale: évaluée à chaque lecture du MQ2, même sans broker
+AlarmEngine alarms;
+AlarmRuleStore alarmRuleStore;
+int gasAlarmInput = -1;
+int gasLevel = 0;
+
+enum AlarmAction : uint8_t {
+    ALARM_ACTION_BUZZER
+};
+
+// Règles d'usine (lecture brute du MQ2), remplacées par celles reçues en MQTT.
+// {grandeur, condition, action, active, -, seuil, hystérésis, durée ms}
+const AlarmRule DEFAULT_ALARM_RULES[] = {
+    {"gaz", ALARM_ABOVE, ALARM_ACTION_BUZZER, 1, 0, 50, 5, 0},   // Seuil à ajuster
+};
 
 // Initialisation LCD
 LiquidCrystal_I2C lcd(0x27, 16, 2); // Adresse I2C 0x27, écran 16x2
@@ -48,54 +67,32 @@ public:
         return String(macStr);
     }
 
-    void setupHA() {
-        // Capteur de température
-        if(!getHAConfig().sendSensorConfig("cuisine", "temperature", "temperature", "°C", "Température Cuisine")) {
-            Serial.println("Échec configuration température");
-        }
-        
-        // Capteur de gaz
-        if(!getHAConfig().sendSensorConfig("cuisine", "gaz", "gas", "ppm", "Détection de gaz")) {
-            Serial.println("Échec configuration capteur gaz");
-        }
-        
-        // Capteur de présence
-        if(!getHAConfig().sendBinarySensorConfig("cuisine", "presence", "motion", "Présence Cuisine")) {
-            Serial.println("Échec configuration capteur présence");
-        }
-        
-        // Buzzer comme un switch
-        if(!getHAConfig().sendSwitchConfig("cuisine", "buzzer", "Alarme Cuisine")) {
-            Serial.println("Échec configuration buzzer");
-        }
-    }
-
-    void handleCommand(const String& location, const String& device, const String& value) override {
-        if (device == "buzzer") {
-            digitalWrite(BUZZER_PIN, value == "ON" ? HIGH : LOW);
-            publishSensorData(location, device, value);
-            updateLCD();
-        }
-    }
-
    void updateLCD() {
     lcd.clear();
     lcd.setCursor(0, 0);
     lcd.print("Temp: ");
-    lcd.print(readTemperature());
+    printReading(readTemperature());
     lcd.print(" C");
 
     lcd.setCursor(0, 1);
     lcd.print("Hum: ");
-    lcd.print(readHumidity());
+    printReading(readHumidity());
     lcd.print(" %");
 }
 
+void printReading(float value) {
+    if (isnan(value)) {
+        lcd.print("--");
+    } else {
+        lcd.print(value, 1);
+    }
+}
+
+   // NaN si la lecture échoue: publié comme "unavailable" plutôt qu'une fausse valeur
    float readTemperature() {
     float temp = dht.readTemperature();  // °C
     if (isnan(temp)) {
-        Serial.println("Erreur lecture température");
-        return -1;
+        RB_LOG_WARN("Erreur lecture température");
     }
     return temp;
 }
@@ -103,8 +100,7 @@ public:
 float readHumidity() {
     float hum = dht.readHumidity();
     if (isnan(hum)) {
-        Serial.println("Erreur lecture humidité");
-        return -1;
+        RB_LOG_WARN("Erreur lecture humidité");
     }
     return hum;
 }
@@ -114,27 +110,82 @@ float readHumidity() {
         return analogRead(GAS_PIN);
     }
 
+    // Présence depuis le dernier relevé: une détection brève entre deux relevés n'est pas perdue
     bool readPresence() {
-        return digitalRead(PRESENCE_PIN);
+        bool seen = presenceInput.level();
+        EdgeEvent event;
+        while (presenceInput.poll(event)) {
+            if (event.rising) seen = true;
+        }
+        return seen || presenceInput.level();
     }
 
 
     
 
 };
-void tryReconnectWiFi(NetworkConfig config) {
-    if (!wifiConnected && millis() - lastWifiAttempt > retryInterval) {
-        Serial.println("Tentative de reconnexion WiFi...");
-        WiFi.begin(config.wifiSSID.c_str(), config.wifiPassword.c_str());
-        lastWifiAttempt = millis();
-    }
+KitchenDevice device;
+
+// Modèle de l'appareil: découverte Home Assistant, abonnements et commandes.
+// L'état du buzzer (alarme gaz) est publié en QoS1: un "ON" perdu ne passe pas inaperçu.
+constexpr DeviceEntity DEVICE_MODEL[] = {
+    sensorEntity("cuisine", "temperature", "temperature", "°C", "Température Cuisine", 1),
+    sensorEntity("cuisine", "gaz", "gas", "ppm", "Détection de gaz"),
+    binarySensorEntity("cuisine", "presence", "motion", "Présence Cuisine"),
+    alertEntity(switchEntity("cuisine", "buzzer", "Alarme Cuisine", [](const MQTTSpan& location, const MQTTSpan& value) {
+        bool on = value.equals("ON");
+        digitalWrite(BUZZER_PIN, on ? HIGH : LOW);
+        device.publishSensorData(location.data, "buzzer", on ? "ON" : "OFF");
+        device.updateLCD();
+    })),
+
+    // Règle d'alarme en JSON (voir AlarmEngine::applyJson), enregistrée en flash
+    commandEntity("cuisine", "alarme", [](const MQTTSpan& location, const MQTTSpan& value) {
+        bool accepted = alarms.applyJson(value.data, value.length);
+        device.publishSensorData(location.data, "alarme_regles", accepted ? "OK" : "REJET");
+    }),
+};
+
+// Lecture rapide du MQ2, suivie aussitôt des règles d'alarme
+void sampleGas() {
+    gasLevel = device.readGasLevel();
+    alarms.evaluate(gasAlarmInput, gasLevel);
+}
+
+// Buzzer tenu tant qu'une règle est active
+void soundAlarm(uint8_t index, const AlarmRule& rule, bool active) {
+    RB_LOG_WARN("[Alarme] Règle %u (%s %s %.1f): %s", index, rule.input,
+                AlarmEngine::conditionName(rule.condition), rule.threshold, active ? "ON" : "OFF");
+
+    bool on = alarms.firstActive() >= 0;
+    digitalWrite(BUZZER_PIN, on ? HIGH : LOW);
+    device.publishSensorData("cuisine", "buzzer", on ? "ON" : "OFF");
+}
+
+void sampleKitchen() {
+    // Lecture des capteurs (le gaz est relevé par sampleGas)
+    float temperature = device.readTemperature();
+    bool presence = device.readPresence();
 
-    if (WiFi.status() == WL_CONNECTED) {
-        wifiConnected = true;
-        Serial.println("✅ WiFi reconnecté !");
+    // Envoi des données
+    device.publishSensorData("cuisine", "temperature", temperature);
+    device.publishSensorData("cuisine", "gaz", gasLevel);
+    device.publishSensorData("cuisine", "presence", presence ? "ON" : "OFF");
+}
+
+void refreshLCD() {
+    device.updateLCD();
+}
+
+void showProvisioningState(ProvisioningState state) {
+    RB_LOG_INFO("Provisionnement: %s", ConfigManager::stateName(state));
+    if (state == PROV_AP_MODE) {
+        lcd.clear();
+        lcd.print("Mode config AP");
+        lcd.setCursor(0, 1);
+        lcd.print("192.168.4.1");
     }
-  }
-KitchenDevice device;
+}
 
 void setup() {
     Serial.begin(115200);
@@ -142,7 +193,7 @@ void setup() {
     // Initialisation des broches
     pinMode(BUZZER_PIN, OUTPUT);
     pinMode(GAS_PIN, INPUT);
-    pinMode(PRESENCE_PIN, INPUT);
+    presenceInput.begin(INPUT);
     pinMode(DHT_PIN, INPUT);
     
     // Initialisation LCD
@@ -151,24 +202,9 @@ void setup() {
     lcd.backlight();
     lcd.print("Initialisation...");
 
-    // Configuration WiFi/MQTT
-    if (!configManager.begin()) {
-        lcd.clear();
-        lcd.print("Mode config AP");
-        lcd.setCursor(0, 1);
-        lcd.print("192.168.4.1");
-    }
-    // if (!configManager.begin()) {
-    //     lcd.clear();
-    //     lcd.print("Mode config AP");
-    //     lcd.setCursor(0, 1);
-    //     lcd.print("192.168.4.1");
-        
-    //     while (!configManager.isConfigured()) {
-    //         configManager.handleClient();
-    //         delay(100);
-    //     }
-    // }
+    // Configuration WiFi/MQTT: begin() rend la main, l'alarme gaz tourne pendant l'association
+    configManager.onStateChange(showProvisioningState);
+    configManager.begin();
 
   NetworkConfig config = configManager.getConfig();
     // WiFi.begin(config.wifiSSID.c_str(), config.wifiPassword.c_str());
@@ -178,52 +214,44 @@ void setup() {
     //     Serial.print(".");
     // }
 
-    mqttConnected = device.begin(config.mqttServer.c_str(), config.mqttPort);
-if (mqttConnected) {
-    device.setupHA();
+    // Connexion et annonce Home Assistant menées par device.handle(), avec backoff
+    device.setModel(DEVICE_MODEL);
+    device.begin(config.mqttServer.c_str(), config.mqttPort);
     lcd.clear();
     device.updateLCD();
-} else {
-    Serial.println("MQTT non disponible, tentative plus tard...");
-    lcd.clear();
-    lcd.print("MQTT indispo");
-}
-
-}
-
-void loop() {
-    static unsigned long lastUpdate = 0;
-    static NetworkConfig config = configManager.getConfig();
 
-    configManager.handleClient();  // Pour le portail
-
-if(!wifiConnected) tryReconnectWiFi(config);
-    device.handle();
-
-   // tryReconnectMQTT(config);
+    // Publication sur changement (lecture brute du MQ2: bande morte de 10)
+    device.setPublishPolicy("cuisine", "temperature", 0.2, 5000, 60000);
+    device.setPublishPolicy("cuisine", "gaz", 10, 0, 30000);
+
+    // Broker injoignable: les relevés (gaz notamment) sont gardés puis rejoués;
+    // au-delà de la RAM, ils débordent dans un journal en flash
+    #ifdef ESP32
+        bool flashReady = LittleFS.begin(true);   // Formate au premier démarrage
+    #else
+        bool flashReady = LittleFS.begin();
+    #endif
+    if (flashReady) {
+        device.getTelemetryBuffer().setSpill(&telemetrySpill);
+    }
 
-    if (millis() - lastUpdate > 2000) { // Toutes les 2 secondes
-        // Lecture des capteurs
-        float temperature = device.readTemperature();
-        int gasLevel = device.readGasLevel();
-        bool presence = device.readPresence();
+    // Règles enregistrées en flash si présentes (NVS sur ESP32, LittleFS sinon)
+    gasAlarmInput = alarms.addInput("gaz");
+    alarms.onAlarm(soundAlarm);
+    alarms.begin(DEFAULT_ALARM_RULES, sizeof(DEFAULT_ALARM_RULES) / sizeof(DEFAULT_ALARM_RULES[0]),
+                 &alarmRuleStore);
 
-        // Envoi des données
-        device.publishSensorData("cuisine", "temperature", temperature);
-        device.publishSensorData("cuisine", "gaz", gasLevel);
-        device.publishSensorData("cuisine", "presence", presence ? "ON" : "OFF");
+    scheduler.addTask("gaz", 100, sampleGas);
+    scheduler.addTask("cuisine", 2000, sampleKitchen);  // Toutes les 2 secondes
+    scheduler.addTask("lcd", 2000, refreshLCD, 1000);
 
-        // Gestion alarme gaz
-        if (gasLevel > 50) { // Seuil à ajuster
-            digitalWrite(BUZZER_PIN, HIGH);
-            device.publishSensorData("cuisine", "buzzer", "ON");
-        } else {
-            digitalWrite(BUZZER_PIN, LOW);
-        }
+}
 
-        // Mise à jour LCD
-        device.updateLCD();
-        
-        lastUpdate = millis();
+void loop() {
+    configManager.handleClient();  // Provisionnement et portail
+    if (configManager.getState() == PROV_CONNECTED) {
+        device.handle();
     }
+    scheduler.run();
+    DeviceLog::drain();   // Temps restant: journal vers le port série, sans attendre
 }
\ No newline at end of file
@@ -0,0 +1,796 @@
+#ifndef ArduinoJson_h
+#define ArduinoJson_h
+
+// Sous-ensemble d'ArduinoJson 6 pour la construction hôte, utilisé seulement quand la
+// vraie bibliothèque est absente (voir ARDUINOJSON_DIR dans extras/host/CMakeLists.txt).
+// Couvre ce que les bibliothèques RonoBox appellent: StaticJsonDocument (et
+// DynamicJsonDocument pour rejouer les versions précédentes dans les tests), operator[] et
+// operator|, createNestedObject/Array, add(), overflowed(), measureJson, serializeJson,
+// deserializeJson.
+//
+// La capacité est comptée comme sur une cible 32 bits (emplacement de 16 octets,
+// chaînes copiées avec leur '\0'), pour que les tailles JSON_OBJECT_SIZE() choisies pour
+// la carte débordent ici exactement là où elles débordent sur la carte. Comme la
+// bibliothèque, un const char* est référencé, un char* ou une String est copié, et
+// deserializeJson() copie les chaînes d'une entrée constante.
+
+#include <Arduino.h>
+#include <errno.h>
+#include <limits>
+#include <type_traits>
+
+#define ARDUINOJSON_HOST_SLOT_SIZE 16
+#define JSON_OBJECT_SIZE(n) ((n) * ARDUINOJSON_HOST_SLOT_SIZE)
+#define JSON_ARRAY_SIZE(n) ((n) * ARDUINOJSON_HOST_SLOT_SIZE)
+#define ARDUINOJSON_DEFAULT_NESTING_LIMIT 10
+
+namespace ArduinoJsonHost {
+
+enum SlotType : uint8_t { T_NULL, T_BOOL, T_INT, T_FLOAT, T_STRING, T_OBJECT, T_ARRAY };
+
+struct Slot {
+    SlotType type;
+    const char* key;
+    Slot* next;
+    union {
+        bool boolean;
+        int64_t integer;
+        double real;
+        const char* string;
+        struct {
+            Slot* head;
+            Slot* tail;
+        } children;
+    };
+
+    void reset() {
+        type = T_NULL;
+        key = nullptr;
+        next = nullptr;
+        children.head = nullptr;
+        children.tail = nullptr;
+    }
+};
+
+// Mémoire du document: emplacements et chaînes copiées, sans allocation sur le tas
+struct Pool {
+    Slot* slots;
+    size_t slotCount;
+    char* strings;
+    size_t capacity;        // Octets comptés comme sur la carte
+    size_t usedSlots;
+    size_t usedStrings;
+    bool overflow;
+
+    size_t used() const { return usedSlots * ARDUINOJSON_HOST_SLOT_SIZE + usedStrings; }
+
+    Slot* allocSlot() {
+        if (usedSlots >= slotCount || used() + ARDUINOJSON_HOST_SLOT_SIZE > capacity) {
+            overflow = true;
+            return nullptr;
+        }
+        Slot* slot = &slots[usedSlots++];
+        slot->reset();
+        return slot;
+    }
+
+    const char* copyString(const char* text, size_t length) {
+        if (used() + length + 1 > capacity) {
+            overflow = true;
+            return nullptr;
+        }
+        char* copy = strings + usedStrings;
+        memcpy(copy, text, length);
+        copy[length] = '\0';
+        usedStrings += length + 1;
+        return copy;
+    }
+
+    void clear() {
+        usedSlots = 0;
+        usedStrings = 0;
+        overflow = false;
+    }
+};
+
+inline Slot* findMember(Slot* object, const char* key) {
+    if (!object || object->type != T_OBJECT) return nullptr;
+    for (Slot* child = object->children.head; child; child = child->next) {
+        if (child->key && strcmp(child->key, key) == 0) return child;
+    }
+    return nullptr;
+}
+
+inline void append(Slot* container, Slot* child) {
+    if (container->children.tail) container->children.tail->next = child;
+    else container->children.head = child;
+    container->children.tail = child;
+}
+
+inline Slot* addMember(Pool* pool, Slot* object, const char* key) {
+    if (!object) return nullptr;
+    if (object->type == T_NULL) {
+        object->type = T_OBJECT;
+        object->children.head = nullptr;
+        object->children.tail = nullptr;
+    }
+    if (object->type != T_OBJECT) return nullptr;
+    Slot* existing = findMember(object, key);
+    if (existing) return existing;
+    Slot* slot = pool->allocSlot();
+    if (!slot) return nullptr;
+    slot->key = key;
+    append(object, slot);
+    return slot;
+}
+
+inline Slot* addElement(Pool* pool, Slot* array) {
+    if (!array) return nullptr;
+    if (array->type == T_NULL) {
+        array->type = T_ARRAY;
+        array->children.head = nullptr;
+        array->children.tail = nullptr;
+    }
+    if (array->type != T_ARRAY) return nullptr;
+    Slot* slot = pool->allocSlot();
+    if (!slot) return nullptr;
+    append(array, slot);
+    return slot;
+}
+
+inline void makeContainer(Slot* slot, SlotType type) {
+    slot->type = type;
+    slot->children.head = nullptr;
+    slot->children.tail = nullptr;
+}
+
+// Affectations: const char* référencé, char* et String copiés
+inline bool store(Pool*, Slot* slot, const char* value) {
+    if (!value) {
+        slot->type = T_NULL;
+        return true;
+    }
+    slot->type = T_STRING;
+    slot->string = value;
+    return true;
+}
+
+inline bool store(Pool* pool, Slot* slot, char* value) {
+    if (!value) return store(pool, slot, (const char*)nullptr);
+    const char* copy = pool->copyString(value, strlen(value));
+    if (!copy) return false;
+    slot->type = T_STRING;
+    slot->string = copy;
+    return true;
+}
+
+inline bool store(Pool* pool, Slot* slot, const String& value) {
+    const char* copy = pool->copyString(value.c_str(), value.length());
+    if (!copy) return false;
+    slot->type = T_STRING;
+    slot->string = copy;
+    return true;
+}
+
+inline bool store(Pool*, Slot* slot, bool value) {
+    slot->type = T_BOOL;
+    slot->boolean = value;
+    return true;
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, bool>::type
+store(Pool*, Slot* slot, T value) {
+    slot->type = T_INT;
+    slot->integer = (int64_t)value;
+    return true;
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+store(Pool*, Slot* slot, T value) {
+    slot->type = T_FLOAT;
+    slot->real = (double)value;
+    return true;
+}
+
+// Lectures: la valeur si elle a le type demandé (et tient dans T), sinon la valeur par défaut
+inline const char* read(const Slot* slot, const char* fallback) {
+    return slot && slot->type == T_STRING ? slot->string : fallback;
+}
+
+inline bool read(const Slot* slot, bool fallback) {
+    return slot && slot->type == T_BOOL ? slot->boolean : fallback;
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, T>::type
+read(const Slot* slot, T fallback) {
+    if (!slot || slot->type != T_INT) return fallback;
+    int64_t value = slot->integer;
+    if (std::is_unsigned<T>::value) {
+        if (value < 0 || (uint64_t)value > (uint64_t)std::numeric_limits<T>::max()) return fallback;
+    } else if (value < (int64_t)std::numeric_limits<T>::min() || value > (int64_t)std::numeric_limits<T>::max()) {
+        return fallback;
+    }
+    return (T)value;
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value, T>::type
+read(const Slot* slot, T fallback) {
+    if (!slot) return fallback;
+    if (slot->type == T_FLOAT) return (T)slot->real;
+    if (slot->type == T_INT) return (T)slot->integer;
+    return fallback;
+}
+
+class JsonArray;
+class JsonObject;
+
+// doc["clé"] / objet["clé"]: le membre n'est créé qu'à l'affectation
+class MemberProxy {
+public:
+    MemberProxy(Pool* pool, Slot* object, const char* key) : pool(pool), object(object), key(key) {}
+
+    template <typename T>
+    MemberProxy& operator=(const T& value) {
+        Slot* slot = addMember(pool, object, key);
+        if (slot && !store(pool, slot, value)) slot->type = T_NULL;
+        return *this;
+    }
+
+    MemberProxy& operator=(const char* value) {
+        Slot* slot = addMember(pool, object, key);
+        if (slot) store(pool, slot, value);
+        return *this;
+    }
+
+    MemberProxy& operator=(char* value) {
+        Slot* slot = addMember(pool, object, key);
+        if (slot && !store(pool, slot, value)) slot->type = T_NULL;
+        return *this;
+    }
+
+    template <typename T>
+    T operator|(T fallback) const {
+        return read(findMember(object, key), fallback);
+    }
+
+    const char* operator|(const char* fallback) const { return read(findMember(object, key), fallback); }
+
+    bool isNull() const {
+        Slot* slot = findMember(object, key);
+        return !slot || slot->type == T_NULL;
+    }
+
+    template <typename T>
+    T as() const {
+        return read(findMember(object, key), T());
+    }
+
+    inline JsonObject createNestedObject();
+    inline JsonArray createNestedArray();
+
+private:
+    Pool* pool;
+    Slot* object;
+    const char* key;
+};
+
+class JsonArray {
+public:
+    JsonArray() : pool(nullptr), slot(nullptr) {}
+    JsonArray(Pool* pool, Slot* slot) : pool(pool), slot(slot) {}
+
+    template <typename T>
+    bool add(const T& value) {
+        if (!slot) return false;
+        Slot* element = addElement(pool, slot);
+        if (!element) return false;
+        if (!store(pool, element, value)) {
+            element->type = T_NULL;
+            return false;
+        }
+        return true;
+    }
+
+    bool add(const char* value) {
+        Slot* element = slot ? addElement(pool, slot) : nullptr;
+        return element && store(pool, element, value);
+    }
+
+    bool add(char* value) {
+        Slot* element = slot ? addElement(pool, slot) : nullptr;
+        return element && store(pool, element, value);
+    }
+
+    size_t size() const {
+        size_t count = 0;
+        for (Slot* child = slot ? slot->children.head : nullptr; child; child = child->next) count++;
+        return count;
+    }
+
+    bool isNull() const { return slot == nullptr; }
+
+private:
+    Pool* pool;
+    Slot* slot;
+};
+
+class JsonObject {
+public:
+    JsonObject() : pool(nullptr), slot(nullptr) {}
+    JsonObject(Pool* pool, Slot* slot) : pool(pool), slot(slot) {}
+
+    MemberProxy operator[](const char* key) const { return MemberProxy(pool, slot, key); }
+
+    JsonObject createNestedObject(const char* key) const { return MemberProxy(pool, slot, key).createNestedObject(); }
+    JsonArray createNestedArray(const char* key) const { return MemberProxy(pool, slot, key).createNestedArray(); }
+
+    bool containsKey(const char* key) const { return findMember(slot, key) != nullptr; }
+    bool isNull() const { return slot == nullptr; }
+
+    size_t size() const {
+        size_t count = 0;
+        for (Slot* child = slot ? slot->children.head : nullptr; child; child = child->next) count++;
+        return count;
+    }
+
+private:
+    Pool* pool;
+    Slot* slot;
+};
+
+inline JsonObject MemberProxy::createNestedObject() {
+    Slot* slot = addMember(pool, object, key);
+    if (!slot) return JsonObject();
+    makeContainer(slot, T_OBJECT);
+    return JsonObject(pool, slot);
+}
+
+inline JsonArray MemberProxy::createNestedArray() {
+    Slot* slot = addMember(pool, object, key);
+    if (!slot) return JsonArray();
+    makeContainer(slot, T_ARRAY);
+    return JsonArray(pool, slot);
+}
+
+} // namespace ArduinoJsonHost
+
+using ArduinoJsonHost::JsonArray;
+using ArduinoJsonHost::JsonObject;
+
+class JsonDocument {
+public:
+    JsonDocument(const JsonDocument&) = delete;
+    JsonDocument& operator=(const JsonDocument&) = delete;
+
+    ArduinoJsonHost::MemberProxy operator[](const char* key) { return ArduinoJsonHost::MemberProxy(&pool, &root, key); }
+
+    JsonObject createNestedObject(const char* key) { return (*this)[key].createNestedObject(); }
+    JsonArray createNestedArray(const char* key) { return (*this)[key].createNestedArray(); }
+
+    bool containsKey(const char* key) const { return ArduinoJsonHost::findMember(const_cast<ArduinoJsonHost::Slot*>(&root), key); }
+    bool overflowed() const { return pool.overflow; }
+    bool isNull() const { return root.type == ArduinoJsonHost::T_NULL; }
+    size_t memoryUsage() const { return pool.used(); }
+    size_t capacity() const { return pool.capacity; }
+
+    void clear() {
+        pool.clear();
+        root.reset();
+    }
+
+    // Accès internes pour la (dé)sérialisation
+    ArduinoJsonHost::Pool& memoryPool() { return pool; }
+    ArduinoJsonHost::Slot& rootSlot() { return root; }
+    const ArduinoJsonHost::Slot& rootSlot() const { return root; }
+
+protected:
+    JsonDocument(ArduinoJsonHost::Slot* slots, size_t slotCount, char* strings, size_t capacity) {
+        pool.slots = slots;
+        pool.slotCount = slotCount;
+        pool.strings = strings;
+        pool.capacity = capacity;
+        clear();
+    }
+
+private:
+    ArduinoJsonHost::Pool pool;
+    ArduinoJsonHost::Slot root;
+};
+
+template <size_t Capacity>
+class StaticJsonDocument : public JsonDocument {
+public:
+    StaticJsonDocument() : JsonDocument(slots, SLOT_COUNT, strings, Capacity) {}
+
+private:
+    static const size_t SLOT_COUNT = Capacity / ARDUINOJSON_HOST_SLOT_SIZE + 1;
+    ArduinoJsonHost::Slot slots[SLOT_COUNT];
+    char strings[Capacity + 1];
+};
+
+namespace ArduinoJsonHost {
+
+// Mémoire d'un DynamicJsonDocument, réservée sur le tas à la construction
+struct HeapStorage {
+    Slot* slots;
+    char* strings;
+
+    explicit HeapStorage(size_t capacity)
+        : slots(new Slot[capacity / ARDUINOJSON_HOST_SLOT_SIZE + 1]), strings(new char[capacity + 1]) {}
+    ~HeapStorage() {
+        delete[] slots;
+        delete[] strings;
+    }
+};
+
+} // namespace ArduinoJsonHost
+
+class DynamicJsonDocument : private ArduinoJsonHost::HeapStorage, public JsonDocument {
+public:
+    explicit DynamicJsonDocument(size_t capacity)
+        : HeapStorage(capacity),
+          JsonDocument(slots, capacity / ARDUINOJSON_HOST_SLOT_SIZE + 1, strings, capacity) {}
+};
+
+class DeserializationError {
+public:
+    enum Code { Ok, EmptyInput, IncompleteInput, InvalidInput, NoMemory, TooDeep };
+
+    DeserializationError(Code code = Ok) : value(code) {}
+
+    explicit operator bool() const { return value != Ok; }
+    bool operator==(Code other) const { return value == other; }
+    bool operator!=(Code other) const { return value != other; }
+    Code code() const { return value; }
+
+    const char* c_str() const {
+        static const char* const names[] = { "Ok", "EmptyInput", "IncompleteInput",
+                                             "InvalidInput", "NoMemory", "TooDeep" };
+        return names[value];
+    }
+
+private:
+    Code value;
+};
+
+namespace ArduinoJsonHost {
+
+class Parser {
+public:
+    Parser(Pool& pool, const char* input, size_t length)
+        : pool(pool), cursor(input), end(input + length) {}
+
+    DeserializationError parse(Slot& root) {
+        skipSpace();
+        if (cursor == end) return DeserializationError::EmptyInput;
+        return parseValue(root, ARDUINOJSON_DEFAULT_NESTING_LIMIT);
+    }
+
+private:
+    Pool& pool;
+    const char* cursor;
+    const char* end;
+
+    bool atEnd() const { return cursor == end || *cursor == '\0'; }
+
+    void skipSpace() {
+        while (!atEnd() && (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r')) cursor++;
+    }
+
+    bool literal(const char* word) {
+        size_t n = strlen(word);
+        if ((size_t)(end - cursor) < n || strncmp(cursor, word, n) != 0) return false;
+        cursor += n;
+        return true;
+    }
+
+    DeserializationError parseValue(Slot& slot, int depth) {
+        skipSpace();
+        if (atEnd()) return DeserializationError::IncompleteInput;
+        char c = *cursor;
+        if (c == '{') return depth == 0 ? DeserializationError::TooDeep : parseObject(slot, depth - 1);
+        if (c == '[') return depth == 0 ? DeserializationError::TooDeep : parseArray(slot, depth - 1);
+        if (c == '"') {
+            const char* text;
+            DeserializationError error = parseString(text);
+            if (error) return error;
+            slot.type = T_STRING;
+            slot.string = text;
+            return DeserializationError::Ok;
+        }
+        if (literal("true")) return store(&pool, &slot, true), DeserializationError::Ok;
+        if (literal("false")) return store(&pool, &slot, false), DeserializationError::Ok;
+        if (literal("null")) return slot.type = T_NULL, DeserializationError::Ok;
+        return parseNumber(slot);
+    }
+
+    DeserializationError parseObject(Slot& slot, int depth) {
+        makeContainer(&slot, T_OBJECT);
+        cursor++;
+        skipSpace();
+        if (atEnd()) return DeserializationError::IncompleteInput;
+        if (*cursor == '}') {
+            cursor++;
+            return DeserializationError::Ok;
+        }
+        for (;;) {
+            skipSpace();
+            if (atEnd()) return DeserializationError::IncompleteInput;
+            if (*cursor != '"') return DeserializationError::InvalidInput;
+            const char* key;
+            DeserializationError error = parseString(key);
+            if (error) return error;
+            skipSpace();
+            if (atEnd()) return DeserializationError::IncompleteInput;
+            if (*cursor++ != ':') return DeserializationError::InvalidInput;
+            Slot* member = addMember(&pool, &slot, key);
+            if (!member) return DeserializationError::NoMemory;
+            error = parseValue(*member, depth);
+            if (error) return error;
+            skipSpace();
+            if (atEnd()) return DeserializationError::IncompleteInput;
+            char c = *cursor++;
+            if (c == '}') return DeserializationError::Ok;
+            if (c != ',') return DeserializationError::InvalidInput;
+        }
+    }
+
+    DeserializationError parseArray(Slot& slot, int depth) {
+        makeContainer(&slot, T_ARRAY);
+        cursor++;
+        skipSpace();
+        if (atEnd()) return DeserializationError::IncompleteInput;
+        if (*cursor == ']') {
+            cursor++;
+            return DeserializationError::Ok;
+        }
+        for (;;) {
+            Slot* element = addElement(&pool, &slot);
+            if (!element) return DeserializationError::NoMemory;
+            DeserializationError error = parseValue(*element, depth);
+            if (error) return error;
+            skipSpace();
+            if (atEnd()) return DeserializationError::IncompleteInput;
+            char c = *cursor++;
+            if (c == ']') return DeserializationError::Ok;
+            if (c != ',') return DeserializationError::InvalidInput;
+        }
+    }
+
+    static void appendUtf8(char* out, size_t& n, uint32_t code) {
+        if (code < 0x80) {
+            out[n++] = (char)code;
+        } else if (code < 0x800) {
+            out[n++] = (char)(0xC0 | (code >> 6));
+            out[n++] = (char)(0x80 | (code & 0x3F));
+        } else {
+            out[n++] = (char)(0xE0 | (code >> 12));
+            out[n++] = (char)(0x80 | ((code >> 6) & 0x3F));
+            out[n++] = (char)(0x80 | (code & 0x3F));
+        }
+    }
+
+    // Décode la chaîne directement dans la zone des chaînes du document
+    DeserializationError parseString(const char*& result) {
+        cursor++;
+        size_t room = pool.capacity > pool.used() ? pool.capacity - pool.used() : 0;
+        char* out = pool.strings + pool.usedStrings;
+        size_t n = 0;
+        for (;;) {
+            if (atEnd()) return DeserializationError::IncompleteInput;
+            char c = *cursor++;
+            if (c == '"') break;
+            uint32_t code = (uint8_t)c;
+            if (c == '\\') {
+                if (atEnd()) return DeserializationError::IncompleteInput;
+                char e = *cursor++;
+                switch (e) {
+                    case '"': code = '"'; break;
+                    case '\\': code = '\\'; break;
+                    case '/': code = '/'; break;
+                    case 'b': code = '\b'; break;
+                    case 'f': code = '\f'; break;
+                    case 'n': code = '\n'; break;
+                    case 'r': code = '\r'; break;
+                    case 't': code = '\t'; break;
+                    case 'u': {
+                        if (end - cursor < 4) return DeserializationError::IncompleteInput;
+                        code = 0;
+                        for (int i = 0; i < 4; i++) {
+                            char h = *cursor++;
+                            code <<= 4;
+                            if (h >= '0' && h <= '9') code |= h - '0';
+                            else if (h >= 'a' && h <= 'f') code |= h - 'a' + 10;
+                            else if (h >= 'A' && h <= 'F') code |= h - 'A' + 10;
+                            else return DeserializationError::InvalidInput;
+                        }
+                        if (n + 4 > room) return DeserializationError::NoMemory;
+                        appendUtf8(out, n, code);
+                        continue;
+                    }
+                    default: return DeserializationError::InvalidInput;
+                }
+            }
+            if (n + 2 > room) return DeserializationError::NoMemory;
+            out[n++] = (char)code;
+        }
+        if (n + 1 > room) return DeserializationError::NoMemory;
+        out[n] = '\0';
+        pool.usedStrings += n + 1;
+        result = out;
+        return DeserializationError::Ok;
+    }
+
+    DeserializationError parseNumber(Slot& slot) {
+        const char* start = cursor;
+        bool real = false;
+        if (!atEnd() && (*cursor == '-' || *cursor == '+')) cursor++;
+        while (!atEnd()) {
+            char c = *cursor;
+            if (c >= '0' && c <= '9') {
+            } else if (c == '.' || c == 'e' || c == 'E' || ((c == '-' || c == '+') && (cursor[-1] == 'e' || cursor[-1] == 'E'))) {
+                real = true;
+            } else {
+                break;
+            }
+            cursor++;
+        }
+        if (cursor == start) return DeserializationError::InvalidInput;
+        char text[32];
+        size_t n = cursor - start;
+        if (n >= sizeof(text)) return DeserializationError::InvalidInput;
+        memcpy(text, start, n);
+        text[n] = '\0';
+        char* parsed;
+        if (!real) {
+            errno = 0;
+            long long value = strtoll(text, &parsed, 10);
+            if (*parsed == '\0' && errno == 0) {
+                slot.type = T_INT;
+                slot.integer = value;
+                return DeserializationError::Ok;
+            }
+        }
+        double value = strtod(text, &parsed);
+        if (*parsed != '\0') return DeserializationError::InvalidInput;
+        slot.type = T_FLOAT;
+        slot.real = value;
+        return DeserializationError::Ok;
+    }
+};
+
+// Sortie vers un tampon borné: compte tout, n'écrit que ce qui tient
+struct Writer {
+    char* out;
+    size_t size;
+    size_t count;
+
+    void put(char c) {
+        if (out && count + 1 < size) out[count] = c;
+        count++;
+    }
+
+    void put(const char* text) {
+        while (*text) put(*text++);
+    }
+};
+
+inline void writeString(Writer& writer, const char* text) {
+    writer.put('"');
+    for (const char* p = text; *p; p++) {
+        char c = *p;
+        switch (c) {
+            case '"': writer.put("\\\""); break;
+            case '\\': writer.put("\\\\"); break;
+            case '\b': writer.put("\\b"); break;
+            case '\f': writer.put("\\f"); break;
+            case '\n': writer.put("\\n"); break;
+            case '\r': writer.put("\\r"); break;
+            case '\t': writer.put("\\t"); break;
+            default:
+                if ((uint8_t)c < 0x20) {
+                    char escaped[8];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned)(uint8_t)c);
+                    writer.put(escaped);
+                } else {
+                    writer.put(c);
+                }
+        }
+    }
+    writer.put('"');
+}
+
+inline void writeSlot(Writer& writer, const Slot& slot) {
+    char number[32];
+    switch (slot.type) {
+        case T_NULL: writer.put("null"); break;
+        case T_BOOL: writer.put(slot.boolean ? "true" : "false"); break;
+        case T_INT:
+            snprintf(number, sizeof(number), "%lld", (long long)slot.integer);
+            writer.put(number);
+            break;
+        case T_FLOAT:
+            if (isnan(slot.real) || isinf(slot.real)) {
+                writer.put("null");
+            } else {
+                snprintf(number, sizeof(number), "%.9g", slot.real);
+                writer.put(number);
+            }
+            break;
+        case T_STRING: writeString(writer, slot.string); break;
+        case T_OBJECT:
+        case T_ARRAY: {
+            bool object = slot.type == T_OBJECT;
+            writer.put(object ? '{' : '[');
+            for (const Slot* child = slot.children.head; child; child = child->next) {
+                if (child != slot.children.head) writer.put(',');
+                if (object) {
+                    writeString(writer, child->key);
+                    writer.put(':');
+                }
+                writeSlot(writer, *child);
+            }
+            writer.put(object ? '}' : ']');
+            break;
+        }
+    }
+}
+
+} // namespace ArduinoJsonHost
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* input, size_t length) {
+    doc.clear();
+    if (!input) return DeserializationError::EmptyInput;
+    ArduinoJsonHost::Parser parser(doc.memoryPool(), input, length);
+    return parser.parse(doc.rootSlot());
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* input) {
+    return deserializeJson(doc, input, input ? strlen(input) : 0);
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const String& input) {
+    return deserializeJson(doc, input.c_str(), input.length());
+}
+
+inline size_t measureJson(const JsonDocument& doc) {
+    ArduinoJsonHost::Writer writer = { nullptr, 0, 0 };
+    ArduinoJsonHost::writeSlot(writer, doc.rootSlot());
+    return writer.count;
+}
+
+// Comme la bibliothèque: tronque à size - 1 octets, termine par '\0', retourne les octets écrits
+inline size_t serializeJson(const JsonDocument& doc, char* output, size_t size) {
+    if (!output || size == 0) return 0;
+    ArduinoJsonHost::Writer writer = { output, size, 0 };
+    ArduinoJsonHost::writeSlot(writer, doc.rootSlot());
+    size_t written = writer.count < size ? writer.count : size - 1;
+    output[written] = '\0';
+    return written;
+}
+
+inline size_t serializeJson(const JsonDocument& doc, String& output) {
+    size_t length = measureJson(doc);
+    char* buffer = (char*)malloc(length + 1);
+    if (!buffer) return 0;
+    serializeJson(doc, buffer, length + 1);
+    output = buffer;
+    free(buffer);
+    return length;
+}
+
+inline size_t serializeJson(const JsonDocument& doc, Print& output) {
+    size_t length = measureJson(doc);
+    char* buffer = (char*)malloc(length + 1);
+    if (!buffer) return 0;
+    serializeJson(doc, buffer, length + 1);
+    size_t written = output.write((const uint8_t*)buffer, length);
+    free(buffer);
+    return written;
+}
+
+#endif
@@ -0,0 +1,407 @@
+#include "Arduino.h"
+
+#include <chrono>
+#include <thread>
+
+// ---------------------------------------------------------------------------
+// Horloge
+
+namespace {
+
+bool clockIsReal = false;
+uint64_t manualMicros = 0;
+const std::chrono::steady_clock::time_point processStart = std::chrono::steady_clock::now();
+
+uint64_t realMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - processStart).count();
+}
+
+uint64_t nowMicros() {
+    return clockIsReal ? realMicros() : manualMicros;
+}
+
+} // namespace
+
+// unsigned long fait 64 bits sur l'hôte: pas de débordement à 32 bits comme sur la
+// carte. Les tests de débordement passent par les variantes à horloge explicite.
+unsigned long millis() {
+    return nowMicros() / 1000;
+}
+
+unsigned long micros() {
+    return nowMicros();
+}
+
+void delay(unsigned long ms) {
+    if (clockIsReal) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    } else {
+        manualMicros += (uint64_t)ms * 1000;
+    }
+    host::deliverNetworkEvents();
+}
+
+void delayMicroseconds(unsigned int us) {
+    if (clockIsReal) {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    } else {
+        manualMicros += us;
+    }
+}
+
+void yield() {}
+
+namespace host {
+
+void setClock(unsigned long ms) {
+    setClockMicros((uint64_t)ms * 1000);
+}
+
+void setClockMicros(uint64_t us) {
+    clockIsReal = false;
+    manualMicros = us;
+    deliverNetworkEvents();
+}
+
+void advance(unsigned long ms) {
+    manualMicros += (uint64_t)ms * 1000;
+    deliverNetworkEvents();
+}
+
+void advanceMicros(uint64_t us) {
+    manualMicros += us;
+    deliverNetworkEvents();
+}
+
+void useRealClock() {
+    clockIsReal = true;
+}
+
+bool realClock() {
+    return clockIsReal;
+}
+
+} // namespace host
+
+// ---------------------------------------------------------------------------
+// Aléatoire: xorshift reproductible (même suite à chaque exécution d'un test)
+
+namespace {
+
+uint32_t randomState = 0x2545F491;
+
+uint32_t nextRandom() {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+} // namespace
+
+long random(long max) {
+    return max <= 0 ? 0 : (long)(nextRandom() % (uint32_t)max);
+}
+
+long random(long min, long max) {
+    return max <= min ? min : min + random(max - min);
+}
+
+void randomSeed(unsigned long seed) {
+    randomState = seed ? (uint32_t)seed : 0x2545F491;
+}
+
+// ---------------------------------------------------------------------------
+// Broches
+
+namespace {
+
+const uint8_t PIN_COUNT = 64;
+
+struct PinState {
+    int level = LOW;
+    int output = 0;
+    int analog = 0;
+    void (*handler)(void*) = nullptr;
+    void (*plainHandler)() = nullptr;
+    void* arg = nullptr;
+    int mode = 0;
+};
+
+PinState pins[PIN_COUNT];
+
+} // namespace
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin < PIN_COUNT && mode == INPUT_PULLUP) pins[pin].level = HIGH;
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < PIN_COUNT ? pins[pin].level : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin < PIN_COUNT) pins[pin].output = value;
+}
+
+int analogRead(uint8_t pin) {
+    return pin < PIN_COUNT ? pins[pin].analog : 0;
+}
+
+void analogWrite(uint8_t pin, int value) {
+    if (pin < PIN_COUNT) pins[pin].output = value;
+}
+
+void tone(uint8_t pin, unsigned int frequency, unsigned long durationMs) {
+    (void)durationMs;
+    if (pin < PIN_COUNT) pins[pin].output = frequency;
+}
+
+void noTone(uint8_t pin) {
+    if (pin < PIN_COUNT) pins[pin].output = 0;
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode) {
+    if (pin >= PIN_COUNT) return;
+    pins[pin].handler = handler;
+    pins[pin].plainHandler = nullptr;
+    pins[pin].arg = arg;
+    pins[pin].mode = mode;
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(), int mode) {
+    if (pin >= PIN_COUNT) return;
+    pins[pin].handler = nullptr;
+    pins[pin].plainHandler = handler;
+    pins[pin].mode = mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+    if (pin >= PIN_COUNT) return;
+    pins[pin].handler = nullptr;
+    pins[pin].plainHandler = nullptr;
+    pins[pin].mode = 0;
+}
+
+namespace host {
+
+void setPinSilently(uint8_t pin, int level) {
+    if (pin < PIN_COUNT) pins[pin].level = level ? HIGH : LOW;
+}
+
+void setPin(uint8_t pin, int level) {
+    if (pin >= PIN_COUNT) return;
+    PinState& state = pins[pin];
+    int previous = state.level;
+    state.level = level ? HIGH : LOW;
+    if (previous == state.level) return;
+
+    bool rising = state.level == HIGH;
+    bool fire = state.mode == CHANGE || (state.mode == RISING && rising) || (state.mode == FALLING && !rising);
+    if (!fire) return;
+    if (state.handler) state.handler(state.arg);
+    if (state.plainHandler) state.plainHandler();
+}
+
+int pinOutput(uint8_t pin) {
+    return pin < PIN_COUNT ? pins[pin].output : 0;
+}
+
+void setAnalog(uint8_t pin, int value) {
+    if (pin < PIN_COUNT) pins[pin].analog = value;
+}
+
+} // namespace host
+
+// ---------------------------------------------------------------------------
+// Port série: sortie standard
+
+HardwareSerial Serial;
+
+size_t HardwareSerial::write(uint8_t byte) {
+    return fwrite(&byte, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    return fwrite(buffer, 1, size, stdout);
+}
+
+void HardwareSerial::flush() {
+    fflush(stdout);
+}
+
+// ---------------------------------------------------------------------------
+// Print
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+        if (write(*buffer++) == 0) break;
+        n++;
+    }
+    return n;
+}
+
+size_t Print::write(const char* text) {
+    return text ? write((const uint8_t*)text, strlen(text)) : 0;
+}
+
+size_t Print::print(long value, int base) {
+    char text[66];
+    if (base == 10) {
+        snprintf(text, sizeof(text), "%ld", value);
+        return write(text);
+    }
+    return print((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+    char text[66];
+    snprintf(text, sizeof(text), base == 16 ? "%lX" : "%lu", value);
+    return write(text);
+}
+
+size_t Print::print(double value, int digits) {
+    char text[64];
+    snprintf(text, sizeof(text), "%.*f", digits, value);
+    return write(text);
+}
+
+size_t Print::printf(const char* format, ...) {
+    char small[128];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(small, sizeof(small), format, args);
+    va_end(args);
+    if (n < 0) return 0;
+    if ((size_t)n < sizeof(small)) return write((const uint8_t*)small, n);
+
+    // Ligne plus longue que le tampon de pile: allocation, comme sur la carte
+    char* large = (char*)malloc(n + 1);
+    if (!large) return 0;
+    va_start(args, format);
+    vsnprintf(large, n + 1, format, args);
+    va_end(args);
+    size_t written = write((const uint8_t*)large, n);
+    free(large);
+    return written;
+}
+
+// ---------------------------------------------------------------------------
+// IPAddress
+
+bool IPAddress::fromString(const char* text) {
+    uint32_t parts[4];
+    uint8_t count = 0;
+    uint32_t value = 0;
+    bool digit = false;
+    for (const char* p = text;; p++) {
+        if (*p >= '0' && *p <= '9') {
+            value = value * 10 + (*p - '0');
+            if (value > 255) return false;
+            digit = true;
+        } else if (*p == '.' || *p == '\0') {
+            if (!digit || count == 4) return false;
+            parts[count++] = value;
+            value = 0;
+            digit = false;
+            if (*p == '\0') break;
+        } else {
+            return false;
+        }
+    }
+    if (count != 4) return false;
+    *this = IPAddress(parts[0], parts[1], parts[2], parts[3]);
+    return true;
+}
+
+String IPAddress::toString() const {
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+    return String(text);
+}
+
+// ---------------------------------------------------------------------------
+// ESP
+
+EspClass ESP;
+
+namespace {
+
+#ifdef ESP32
+const uint32_t HEAP_SIZE = 300 * 1024;
+#else
+const uint32_t HEAP_SIZE = 50 * 1024;
+#endif
+
+unsigned restarts = 0;
+uint32_t rtcMemory[128];
+
+uint32_t heapInUse(int64_t bytes) {
+    if (bytes < 0) return 0;
+    return bytes > HEAP_SIZE ? HEAP_SIZE : (uint32_t)bytes;
+}
+
+} // namespace
+
+uint64_t EspClass::getEfuseMac() {
+    return 0xF6E5D4C3B2A1ULL;
+}
+
+uint32_t EspClass::getChipId() {
+    return 0x00C3B2A1;
+}
+
+uint32_t EspClass::getFreeHeap() {
+    return HEAP_SIZE - heapInUse(host::heapStats().liveBytes);
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+    return HEAP_SIZE - heapInUse(host::heapStats().peakBytes);
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+    return getFreeHeap();
+}
+
+uint32_t EspClass::getMaxFreeBlockSize() {
+    return getFreeHeap();
+}
+
+uint32_t EspClass::getCycleCount() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - processStart).count();
+}
+
+uint32_t EspClass::getCpuFreqMHz() {
+    return 1000;
+}
+
+void EspClass::restart() {
+    restarts++;
+}
+
+bool EspClass::rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size) {
+    if (offset * 4 + size > sizeof(rtcMemory)) return false;
+    memcpy(data, rtcMemory + offset, size);
+    return true;
+}
+
+bool EspClass::rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size) {
+    if (offset * 4 + size > sizeof(rtcMemory)) return false;
+    memcpy(rtcMemory + offset, data, size);
+    return true;
+}
+
+namespace host {
+
+unsigned restartCount() {
+    return restarts;
+}
+
+void powerCycle() {
+    memset(rtcMemory, 0, sizeof(rtcMemory));
+}
+
+} // namespace host
@@ -0,0 +1,124 @@
+#ifndef Arduino_h
+#define Arduino_h
+
+// Cœur Arduino minimal pour compiler les bibliothèques RonoBox sur Linux.
+// Seul ce que les bibliothèques utilisent est fourni; le comportement suit les cœurs
+// ESP32 et ESP8266 (types, valeurs de retour), le temps et les broches sont pilotés
+// par les tests (voir HostRuntime.h).
+
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+using std::min;
+using std::max;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT          0x01
+#define OUTPUT         0x03
+#define INPUT_PULLUP   0x05
+#define INPUT_PULLDOWN 0x09
+
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+
+#define DEC 10
+#define HEX 16
+
+// Pas de flash séparée sur l'hôte: les données PROGMEM sont en RAM
+#define PROGMEM
+#define PGM_P const char*
+#define PSTR(s) (s)
+#define F(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+#define IRAM_ATTR
+#define ARDUINO_ISR_ATTR
+
+#include "WString.h"
+#include "Print.h"
+#include "IPAddress.h"
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+void tone(uint8_t pin, unsigned int frequency, unsigned long durationMs = 0);
+void noTone(uint8_t pin);
+
+#define digitalPinToInterrupt(pin) (pin)
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode);
+void attachInterrupt(uint8_t pin, void (*handler)(), int mode);
+void detachInterrupt(uint8_t pin);
+
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+
+    size_t write(uint8_t byte) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+
+    // FIFO d'émission de l'UART, jamais pleine ici
+    int availableForWrite() override { return 128; }
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    void flush() override;
+
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+// Identité et mémoire de la carte. Le tas libre est une taille fixe par cible moins
+// les octets alloués par le programme (voir host::heapStats()).
+class EspClass {
+public:
+    uint64_t getEfuseMac();
+    uint32_t getChipId();
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    uint32_t getMaxFreeBlockSize();
+    uint32_t getCycleCount();       // Nanosecondes écoulées: getCpuFreqMHz() vaut 1000
+    uint32_t getCpuFreqMHz();
+    void restart();                 // Noté par host::restartCount(), sans quitter
+
+    // Mémoire RTC utilisateur (ESP8266): conservée par restart(), perdue par host::powerCycle().
+    // Déclarée pour les deux cibles: les deux supports de DiscoveryHashBackend sont testés.
+    #define RONOBOX_HAS_RTC_USER_MEMORY 1
+    bool rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size);
+    bool rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size);
+};
+
+extern EspClass ESP;
+
+#include "HostRuntime.h"
+
+#endif
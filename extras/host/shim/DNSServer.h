@@ -0,0 +1,24 @@
+#ifndef DNSServer_h
+#define DNSServer_h
+
+#include "Arduino.h"
+
+// Portail captif: aucune requête DNS n'arrive hors carte
+class DNSServer {
+public:
+    bool start(uint16_t port, const String& domain, const IPAddress& address) {
+        (void)port;
+        (void)domain;
+        (void)address;
+        running = true;
+        return true;
+    }
+    void stop() { running = false; }
+    void processNextRequest() {}
+    bool isRunning() const { return running; }
+
+private:
+    bool running = false;
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef EEPROM_h
+#define EEPROM_h
+
+#include "Arduino.h"
+
+// EEPROM émulée de l'ESP8266: une copie en RAM, écrite en flash par commit().
+// Comme sur la carte, commit() efface tout le secteur puis le réécrit depuis le début;
+// une coupure simulée (host::eepromPowerLossAfter) laisse la fin du secteur effacée.
+class EEPROMClass {
+public:
+    static const size_t SECTOR_SIZE = 4096;
+
+    EEPROMClass() : data(nullptr), size(0), dirty(false) {}
+
+    bool begin(size_t size);
+    bool end();
+    bool commit();
+    size_t length() const { return size; }
+
+    uint8_t read(int address) const;
+    void write(int address, uint8_t value);
+
+    template <typename T>
+    T& get(int address, T& value) const {
+        if (address >= 0 && address + sizeof(T) <= size) memcpy(&value, data + address, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    const T& put(int address, const T& value) {
+        if (address >= 0 && address + sizeof(T) <= size && memcmp(data + address, &value, sizeof(T)) != 0) {
+            memcpy(data + address, &value, sizeof(T));
+            dirty = true;
+        }
+        return value;
+    }
+
+    uint8_t* getDataPtr() {
+        dirty = true;
+        return data;
+    }
+
+private:
+    uint8_t* data;
+    size_t size;
+    bool dirty;
+};
+
+extern EEPROMClass EEPROM;
+
+namespace host {
+
+unsigned eepromCommitCount();               // Effacements du secteur
+// La prochaine écriture du secteur s'arrête après `bytes` octets (coupure simulée)
+void eepromPowerLossAfter(long bytes);
+void eraseEeprom();                         // Secteur effacé (0xFF), comme une carte neuve
+const uint8_t* eepromFlash();
+
+} // namespace host
+
+#endif
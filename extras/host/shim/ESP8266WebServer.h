@@ -0,0 +1,8 @@
+#ifndef ESP8266WebServer_h
+#define ESP8266WebServer_h
+
+#include "WebServer.h"
+
+typedef WebServer ESP8266WebServer;
+
+#endif
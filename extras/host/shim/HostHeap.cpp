@@ -0,0 +1,120 @@
+// Compteurs du tas pour host::heapStats(). Sous AddressSanitizer, l'allocateur
+// d'ASan appelle nos crochets; sinon malloc/free sont interposés devant la glibc.
+
+#include "HostRuntime.h"
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace {
+
+std::atomic<uint64_t> allocations(0);
+std::atomic<uint64_t> frees(0);
+std::atomic<int64_t> liveBytes(0);
+std::atomic<int64_t> peakBytes(0);
+
+void noteAllocation(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    int64_t live = liveBytes.fetch_add((int64_t)size, std::memory_order_relaxed) + (int64_t)size;
+    int64_t peak = peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+void noteFree(size_t size) {
+    frees.fetch_add(1, std::memory_order_relaxed);
+    liveBytes.fetch_sub((int64_t)size, std::memory_order_relaxed);
+}
+
+} // namespace
+
+#if defined(__SANITIZE_ADDRESS__)
+
+extern "C" int __sanitizer_install_malloc_and_free_hooks(void (*mallocHook)(const volatile void*, size_t),
+                                                         void (*freeHook)(const volatile void*));
+extern "C" size_t __sanitizer_get_allocated_size(const volatile void* pointer);
+
+namespace {
+
+void mallocHook(const volatile void* pointer, size_t size) {
+    if (pointer) noteAllocation(size);
+}
+
+// Appelé avant la libération: la taille est encore connue
+void freeHook(const volatile void* pointer) {
+    if (pointer) noteFree(__sanitizer_get_allocated_size(pointer));
+}
+
+const int hooksInstalled = __sanitizer_install_malloc_and_free_hooks(mallocHook, freeHook);
+
+} // namespace
+
+#else
+
+#include <malloc.h>
+
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void __libc_free(void* pointer);
+
+void* malloc(size_t size) {
+    void* pointer = __libc_malloc(size);
+    if (pointer) noteAllocation(malloc_usable_size(pointer));
+    return pointer;
+}
+
+void* calloc(size_t count, size_t size) {
+    void* pointer = __libc_calloc(count, size);
+    if (pointer) noteAllocation(malloc_usable_size(pointer));
+    return pointer;
+}
+
+void* realloc(void* pointer, size_t size) {
+    size_t before = pointer ? malloc_usable_size(pointer) : 0;
+    void* grown = __libc_realloc(pointer, size);
+    if (!grown) {
+        if (pointer && size == 0) noteFree(before);   // realloc(p, 0) libère p
+        return grown;
+    }
+    if (pointer) noteFree(before);
+    noteAllocation(malloc_usable_size(grown));
+    return grown;
+}
+
+void free(void* pointer) {
+    if (pointer) noteFree(malloc_usable_size(pointer));
+    __libc_free(pointer);
+}
+
+} // extern "C"
+
+#endif
+
+namespace {
+
+// Tampons déjà alloués par la bibliothèque C++ avant nos constructeurs statiques
+// (réserve d'exceptions de libstdc++): hors du tas du programme simulé
+const int64_t startupBytes = liveBytes.load(std::memory_order_relaxed);
+
+} // namespace
+
+namespace host {
+
+HeapStats heapStats() {
+    HeapStats stats;
+    stats.allocations = allocations.load(std::memory_order_relaxed);
+    stats.frees = frees.load(std::memory_order_relaxed);
+    stats.liveBytes = liveBytes.load(std::memory_order_relaxed) - startupBytes;
+    stats.peakBytes = peakBytes.load(std::memory_order_relaxed) - startupBytes;
+    return stats;
+}
+
+void resetHeapPeak() {
+    peakBytes.store(liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+} // namespace host
@@ -0,0 +1,56 @@
+#ifndef HostRuntime_h
+#define HostRuntime_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Commandes réservées aux tests: horloge, broches, tas et redémarrages simulés.
+// Rien ici n'existe sur la carte.
+namespace host {
+
+// Horloge manuelle par défaut, à 0 au lancement: millis() et micros() n'avancent
+// que par setClock(), advance() ou delay(). useRealClock() passe au temps réel
+// (tests sur sockets).
+void setClock(unsigned long ms);
+void setClockMicros(uint64_t us);
+void advance(unsigned long ms);
+void advanceMicros(uint64_t us);
+void useRealClock();
+bool realClock();
+// Rappels réseau arrivés à échéance (réponses DNS), livrés à chaque avance de l'horloge
+// comme le ferait le thread tcpip entre deux tours de loop()
+void deliverNetworkEvents();
+
+// Niveau d'une entrée: déclenche l'interruption attachée si le front correspond
+void setPin(uint8_t pin, int level);
+// Niveau vu par digitalRead(), sans interruption (lecture faite par l'ISR après coup)
+void setPinSilently(uint8_t pin, int level);
+int pinOutput(uint8_t pin);          // Dernière valeur de digitalWrite() / analogWrite()
+void setAnalog(uint8_t pin, int value);
+
+struct HeapStats {
+    uint64_t allocations;   // malloc/calloc/realloc/new
+    uint64_t frees;
+    int64_t liveBytes;
+    int64_t peakBytes;
+};
+
+// Compteurs tenus par des crochets sur l'allocateur (ASan) ou par interposition de malloc
+HeapStats heapStats();
+void resetHeapPeak();
+
+// Allocations faites pendant l'appel de f
+template <typename F>
+uint64_t countAllocations(F f) {
+    uint64_t before = heapStats().allocations;
+    f();
+    return heapStats().allocations - before;
+}
+
+unsigned restartCount();
+// Coupure d'alimentation: la RAM RTC est perdue, la flash et la NVS restent
+void powerCycle();
+
+} // namespace host
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef IPAddress_h
+#define IPAddress_h
+
+#include <stdint.h>
+#include "WString.h"
+
+class IPAddress {
+public:
+    IPAddress() : address(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        : address((uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24)) {}
+    IPAddress(uint32_t value) : address(value) {}   // Ordre réseau, comme sur la carte
+
+    operator uint32_t() const { return address; }
+    uint8_t operator[](int index) const { return (uint8_t)(address >> (8 * index)); }
+    bool operator==(const IPAddress& other) const { return address == other.address; }
+    bool operator!=(const IPAddress& other) const { return address != other.address; }
+
+    bool fromString(const char* text);
+    bool fromString(const String& text) { return fromString(text.c_str()); }
+    String toString() const;
+
+private:
+    uint32_t address;
+};
+
+#endif
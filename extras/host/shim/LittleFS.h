@@ -0,0 +1,56 @@
+#ifndef LittleFS_h
+#define LittleFS_h
+
+#include "Arduino.h"
+#include <memory>
+
+struct HostFile;
+
+// Fichier ouvert: les écritures vont tout de suite dans le système de fichiers en mémoire
+class File : public Stream {
+public:
+    File() {}
+    explicit File(std::shared_ptr<HostFile> handle) : file(std::move(handle)) {}
+
+    explicit operator bool() const { return file != nullptr; }
+
+    size_t write(uint8_t byte) override { return write(&byte, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    size_t read(uint8_t* buffer, size_t size);
+    int peek() override;
+    bool seek(uint32_t position);
+    size_t position() const;
+    size_t size() const;
+    void close() { file.reset(); }
+
+private:
+    std::shared_ptr<HostFile> file;
+};
+
+class LittleFSClass {
+public:
+    bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+               const char* partitionLabel = "spiffs");
+    void end() {}
+    bool format();
+    bool exists(const char* path);
+    bool remove(const char* path);
+    File open(const char* path, const char* mode = "r");
+};
+
+extern LittleFSClass LittleFS;
+
+namespace host {
+
+// Capacité totale du système de fichiers (les écritures au-delà sont refusées)
+void setLittleFSCapacity(size_t bytes);
+size_t littleFSUsedBytes();
+unsigned littleFSWriteCount();          // Appels à File::write() ayant écrit
+void clearLittleFS();
+
+} // namespace host
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef Preferences_h
+#define Preferences_h
+
+#include "Arduino.h"
+
+// NVS en mémoire: chaque put est atomique (la clé garde son ancienne valeur ou prend
+// la nouvelle), le contenu survit aux instances et à host::powerCycle()
+class Preferences {
+public:
+    Preferences() : ns(nullptr), readOnly(true) {}
+    ~Preferences() { end(); }
+
+    bool begin(const char* name, bool readOnly = false, const char* partition = nullptr);
+    void end();
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+
+    size_t putBytes(const char* key, const void* value, size_t length);
+    size_t getBytes(const char* key, void* buffer, size_t maxLength);
+    size_t getBytesLength(const char* key);
+
+    size_t putUInt(const char* key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0);
+    size_t putInt(const char* key, int32_t value) { return putBytes(key, &value, sizeof(value)); }
+    int32_t getInt(const char* key, int32_t defaultValue = 0);
+    size_t putString(const char* key, const char* value);
+    size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+    String getString(const char* key, const String& defaultValue = String());
+
+private:
+    void* ns;
+    bool readOnly;
+};
+
+namespace host {
+
+unsigned nvsWriteCount();   // put* et clear() acceptés
+// Coupure après `puts` écritures acceptées: les suivantes échouent (< 0: jamais)
+void nvsPowerLossAfter(long puts);
+void eraseNvs();
+
+} // namespace host
+
+#endif
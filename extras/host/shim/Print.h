@@ -0,0 +1,55 @@
+#ifndef Print_h
+#define Print_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include "WString.h"
+
+class Print {
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t byte) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* text);
+    size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+
+    // Place libre dans le tampon d'émission, 0 si la cible ne la renseigne pas
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t print(const char* text) { return write(text); }
+    size_t print(const String& text) { return write(text.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int value, int base = DEC_BASE) { return print((long)value, base); }
+    size_t print(unsigned int value, int base = DEC_BASE) { return print((unsigned long)value, base); }
+    size_t print(long value, int base = DEC_BASE);
+    size_t print(unsigned long value, int base = DEC_BASE);
+    size_t print(double value, int digits = 2);
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T& value) { return print(value) + println(); }
+
+    [[gnu::format(printf, 2, 3)]]
+    size_t printf(const char* format, ...);
+
+private:
+    static const int DEC_BASE = 10;
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    // Délai des lectures bloquantes, et de WiFiClient::connect() sur les deux cœurs
+    void setTimeout(unsigned long timeoutMs) { _timeout = timeoutMs; }
+    unsigned long getTimeout() const { return _timeout; }
+
+protected:
+    unsigned long _timeout = 1000;
+};
+
+#endif
@@ -0,0 +1,368 @@
+// Mémoires persistantes simulées: NVS (Preferences), EEPROM émulée et LittleFS.
+// Toutes survivent à ESP.restart() et à host::powerCycle().
+
+#include "EEPROM.h"
+#include "LittleFS.h"
+#include "Preferences.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Preferences
+
+namespace {
+
+typedef std::map<std::string, std::vector<uint8_t>> Namespace;
+
+std::map<std::string, Namespace> nvs;
+unsigned nvsWrites = 0;
+long nvsPutsBeforeLoss = -1;
+
+Namespace* space(void* ns) {
+    return (Namespace*)ns;
+}
+
+bool acceptWrite() {
+    if (nvsPutsBeforeLoss == 0) return false;
+    if (nvsPutsBeforeLoss > 0) nvsPutsBeforeLoss--;
+    nvsWrites++;
+    return true;
+}
+
+} // namespace
+
+// Comme nvs_open() en lecture seule: un espace de noms absent n'est pas créé
+bool Preferences::begin(const char* name, bool readOnlyMode, const char* partition) {
+    (void)partition;
+    end();
+    if (readOnlyMode && nvs.find(name) == nvs.end()) return false;
+    ns = &nvs[name];
+    readOnly = readOnlyMode;
+    return true;
+}
+
+void Preferences::end() {
+    ns = nullptr;
+}
+
+bool Preferences::clear() {
+    if (!ns || readOnly || !acceptWrite()) return false;
+    space(ns)->clear();
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!ns || readOnly || !acceptWrite()) return false;
+    return space(ns)->erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+    return ns && space(ns)->count(key) > 0;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+    if (!ns || readOnly || !key || !value || !acceptWrite()) return 0;
+    const uint8_t* bytes = (const uint8_t*)value;
+    (*space(ns))[key].assign(bytes, bytes + length);
+    return length;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    if (!ns) return 0;
+    auto entry = space(ns)->find(key);
+    return entry == space(ns)->end() ? 0 : entry->second.size();
+}
+
+// Comme nvs_get_blob(): rien n'est copié si le tampon est trop petit
+size_t Preferences::getBytes(const char* key, void* buffer, size_t maxLength) {
+    if (!ns || !buffer) return 0;
+    auto entry = space(ns)->find(key);
+    if (entry == space(ns)->end() || entry->second.size() > maxLength) return 0;
+    memcpy(buffer, entry->second.data(), entry->second.size());
+    return entry->second.size();
+}
+
+uint32_t Preferences::getUInt(const char* key, uint32_t defaultValue) {
+    uint32_t value;
+    return getBytesLength(key) == sizeof(value) && getBytes(key, &value, sizeof(value)) ? value : defaultValue;
+}
+
+int32_t Preferences::getInt(const char* key, int32_t defaultValue) {
+    int32_t value;
+    return getBytesLength(key) == sizeof(value) && getBytes(key, &value, sizeof(value)) ? value : defaultValue;
+}
+
+size_t Preferences::putString(const char* key, const char* value) {
+    return value ? putBytes(key, value, strlen(value) + 1) : 0;
+}
+
+String Preferences::getString(const char* key, const String& defaultValue) {
+    size_t length = getBytesLength(key);
+    if (length == 0) return defaultValue;
+    std::vector<char> text(length + 1, '\0');
+    getBytes(key, text.data(), length);
+    return String(text.data());
+}
+
+namespace host {
+
+unsigned nvsWriteCount() {
+    return nvsWrites;
+}
+
+void nvsPowerLossAfter(long puts) {
+    nvsPutsBeforeLoss = puts;
+}
+
+void eraseNvs() {
+    nvs.clear();
+    nvsWrites = 0;
+    nvsPutsBeforeLoss = -1;
+}
+
+} // namespace host
+
+// ---------------------------------------------------------------------------
+// EEPROM
+
+EEPROMClass EEPROM;
+
+namespace {
+
+uint8_t flash[EEPROMClass::SECTOR_SIZE];
+bool flashInitialised = false;
+unsigned sectorErases = 0;
+long bytesBeforeLoss = -1;
+
+void initFlash() {
+    if (flashInitialised) return;
+    memset(flash, 0xFF, sizeof(flash));
+    flashInitialised = true;
+}
+
+} // namespace
+
+// Comme le cœur ESP8266: tampon RAM alloué, relu depuis la flash à chaque begin()
+bool EEPROMClass::begin(size_t requested) {
+    initFlash();
+    if (requested == 0 || requested > SECTOR_SIZE) return false;
+    requested = (requested + 3) & ~(size_t)3;
+    if (data && size != requested) {
+        free(data);
+        data = nullptr;
+    }
+    if (!data) data = (uint8_t*)malloc(requested);
+    if (!data) return false;
+    size = requested;
+    memcpy(data, flash, size);
+    dirty = false;
+    return true;
+}
+
+bool EEPROMClass::end() {
+    if (!size) return false;
+    bool committed = commit();
+    free(data);
+    data = nullptr;
+    size = 0;
+    dirty = false;
+    return committed;
+}
+
+// Effacement du secteur puis réécriture séquentielle: une coupure en cours de route
+// laisse la fin du secteur à 0xFF, enregistrements A et B compris
+bool EEPROMClass::commit() {
+    if (!size) return false;
+    if (!dirty) return true;
+    sectorErases++;
+    memset(flash, 0xFF, sizeof(flash));
+    size_t written = size;
+    if (bytesBeforeLoss >= 0 && (size_t)bytesBeforeLoss < size) written = (size_t)bytesBeforeLoss;
+    bool lost = bytesBeforeLoss >= 0;
+    bytesBeforeLoss = -1;
+    memcpy(flash, data, written);
+    if (lost) return false;
+    dirty = false;
+    return true;
+}
+
+uint8_t EEPROMClass::read(int address) const {
+    return address >= 0 && (size_t)address < size ? data[address] : 0;
+}
+
+void EEPROMClass::write(int address, uint8_t value) {
+    if (address < 0 || (size_t)address >= size || data[address] == value) return;
+    data[address] = value;
+    dirty = true;
+}
+
+namespace host {
+
+unsigned eepromCommitCount() {
+    return sectorErases;
+}
+
+void eepromPowerLossAfter(long bytes) {
+    bytesBeforeLoss = bytes;
+}
+
+void eraseEeprom() {
+    flashInitialised = false;
+    initFlash();
+    sectorErases = 0;
+    bytesBeforeLoss = -1;
+}
+
+const uint8_t* eepromFlash() {
+    initFlash();
+    return flash;
+}
+
+} // namespace host
+
+// ---------------------------------------------------------------------------
+// LittleFS
+
+LittleFSClass LittleFS;
+
+struct HostFile {
+    std::shared_ptr<std::vector<uint8_t>> content;
+    size_t position;
+    bool writable;
+};
+
+namespace {
+
+std::map<std::string, std::shared_ptr<std::vector<uint8_t>>> files;
+size_t fsCapacity = 64 * 1024;
+unsigned fsWrites = 0;
+bool mounted = false;
+
+size_t usedBytes() {
+    size_t total = 0;
+    for (const auto& entry : files) total += entry.second->size();
+    return total;
+}
+
+} // namespace
+
+size_t File::write(const uint8_t* buffer, size_t length) {
+    if (!file || !file->writable || length == 0) return 0;
+    std::vector<uint8_t>& content = *file->content;
+    size_t end = file->position + length;
+    size_t growth = end > content.size() ? end - content.size() : 0;
+    size_t used = usedBytes();
+    size_t room = fsCapacity > used ? fsCapacity - used : 0;
+    if (growth > room) {
+        length -= growth - room;
+        end = file->position + length;
+    }
+    if (length == 0) return 0;
+    if (end > content.size()) content.resize(end);
+    memcpy(content.data() + file->position, buffer, length);
+    file->position = end;
+    fsWrites++;
+    return length;
+}
+
+int File::available() {
+    if (!file) return 0;
+    size_t size = file->content->size();
+    return file->position < size ? (int)(size - file->position) : 0;
+}
+
+int File::read() {
+    uint8_t byte;
+    return read(&byte, 1) == 1 ? byte : -1;
+}
+
+size_t File::read(uint8_t* buffer, size_t length) {
+    size_t left = (size_t)available();
+    if (length > left) length = left;
+    if (length == 0) return 0;
+    memcpy(buffer, file->content->data() + file->position, length);
+    file->position += length;
+    return length;
+}
+
+int File::peek() {
+    return available() > 0 ? (*file->content)[file->position] : -1;
+}
+
+bool File::seek(uint32_t target) {
+    if (!file || target > file->content->size()) return false;
+    file->position = target;
+    return true;
+}
+
+size_t File::position() const {
+    return file ? file->position : 0;
+}
+
+size_t File::size() const {
+    return file ? file->content->size() : 0;
+}
+
+bool LittleFSClass::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles,
+                          const char* partitionLabel) {
+    (void)formatOnFail;
+    (void)basePath;
+    (void)maxOpenFiles;
+    (void)partitionLabel;
+    mounted = true;
+    return true;
+}
+
+bool LittleFSClass::format() {
+    files.clear();
+    return true;
+}
+
+bool LittleFSClass::exists(const char* path) {
+    return mounted && files.count(path) > 0;
+}
+
+bool LittleFSClass::remove(const char* path) {
+    return mounted && files.erase(path) > 0;
+}
+
+// Modes "r", "r+", "w", "w+", "a", "a+" comme fopen()
+File LittleFSClass::open(const char* path, const char* mode) {
+    if (!mounted || !path || !mode) return File();
+    auto entry = files.find(path);
+    bool reading = mode[0] == 'r';
+    if (reading && entry == files.end()) return File();
+
+    std::shared_ptr<HostFile> handle = std::make_shared<HostFile>();
+    if (entry == files.end()) {
+        entry = files.emplace(path, std::make_shared<std::vector<uint8_t>>()).first;
+    }
+    handle->content = entry->second;
+    if (mode[0] == 'w') handle->content->clear();
+    handle->position = mode[0] == 'a' ? handle->content->size() : 0;
+    handle->writable = !reading || mode[1] == '+';
+    return File(handle);
+}
+
+namespace host {
+
+void setLittleFSCapacity(size_t bytes) {
+    fsCapacity = bytes;
+}
+
+size_t littleFSUsedBytes() {
+    return usedBytes();
+}
+
+unsigned littleFSWriteCount() {
+    return fsWrites;
+}
+
+void clearLittleFS() {
+    files.clear();
+    fsWrites = 0;
+}
+
+} // namespace host
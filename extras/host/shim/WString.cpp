@@ -0,0 +1,214 @@
+#include "WString.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+unsigned int String::strlength(const char* cstr) {
+    return (unsigned int)strlen(cstr);
+}
+
+String::String(const char* cstr) : buffer(nullptr), capacity(0), len(0) {
+    if (cstr) copy(cstr, strlength(cstr));
+}
+
+String::String(const String& other) : buffer(nullptr), capacity(0), len(0) {
+    copy(other.c_str(), other.len);
+}
+
+String::String(String&& other) noexcept : buffer(other.buffer), capacity(other.capacity), len(other.len) {
+    other.buffer = nullptr;
+    other.capacity = 0;
+    other.len = 0;
+}
+
+String::String(char c) : buffer(nullptr), capacity(0), len(0) {
+    copy(&c, 1);
+}
+
+String::String(int value, unsigned char base) : String((long)value, base) {}
+
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {}
+
+String::String(long value, unsigned char base) : buffer(nullptr), capacity(0), len(0) {
+    char text[66];
+    if (base == 10) snprintf(text, sizeof(text), "%ld", value);
+    else snprintf(text, sizeof(text), "%lx", (unsigned long)value);
+    copy(text, strlength(text));
+}
+
+String::String(unsigned long value, unsigned char base) : buffer(nullptr), capacity(0), len(0) {
+    char text[66];
+    snprintf(text, sizeof(text), base == 16 ? "%lx" : "%lu", value);
+    copy(text, strlength(text));
+}
+
+String::String(float value, unsigned int decimals) : String((double)value, decimals) {}
+
+String::String(double value, unsigned int decimals) : buffer(nullptr), capacity(0), len(0) {
+    char text[64];
+    snprintf(text, sizeof(text), "%.*f", (int)decimals, value);
+    copy(text, strlength(text));
+}
+
+String::~String() {
+    free(buffer);
+}
+
+String& String::operator=(const String& other) {
+    if (this != &other) copy(other.c_str(), other.len);
+    return *this;
+}
+
+String& String::operator=(String&& other) noexcept {
+    if (this != &other) {
+        free(buffer);
+        buffer = other.buffer;
+        capacity = other.capacity;
+        len = other.len;
+        other.buffer = nullptr;
+        other.capacity = 0;
+        other.len = 0;
+    }
+    return *this;
+}
+
+String& String::operator=(const char* cstr) {
+    if (cstr) copy(cstr, strlength(cstr));
+    else invalidate();
+    return *this;
+}
+
+void String::invalidate() {
+    free(buffer);
+    buffer = nullptr;
+    capacity = 0;
+    len = 0;
+}
+
+bool String::reserve(unsigned int size) {
+    if (buffer && capacity >= size) return true;
+    char* grown = (char*)realloc(buffer, size + 1);
+    if (!grown) return false;
+    if (!buffer) grown[0] = '\0';
+    buffer = grown;
+    capacity = size;
+    return true;
+}
+
+bool String::copy(const char* cstr, unsigned int length) {
+    if (length == 0) {
+        // Chaîne vide: pas d'allocation, comme avec le tampon interne des cœurs ESP
+        if (buffer) buffer[0] = '\0';
+        len = 0;
+        return true;
+    }
+    if (!reserve(length)) {
+        invalidate();
+        return false;
+    }
+    memmove(buffer, cstr, length);
+    buffer[length] = '\0';
+    len = length;
+    return true;
+}
+
+bool String::concat(const char* cstr, unsigned int length) {
+    if (!cstr) return false;
+    if (length == 0) return true;
+    // cstr peut pointer dans notre propre tampon (s += s): on retient le décalage
+    bool self = buffer && cstr >= buffer && cstr < buffer + len;
+    size_t offset = self ? cstr - buffer : 0;
+    if (!reserve(len + length)) return false;
+    memmove(buffer + len, self ? buffer + offset : cstr, length);
+    len += length;
+    buffer[len] = '\0';
+    return true;
+}
+
+bool String::equals(const String& other) const {
+    return len == other.len && memcmp(c_str(), other.c_str(), len) == 0;
+}
+
+bool String::equals(const char* cstr) const {
+    return strcmp(c_str(), cstr ? cstr : "") == 0;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    if (from >= len) return -1;
+    const char* found = (const char*)memchr(buffer + from, c, len - from);
+    return found ? (int)(found - buffer) : -1;
+}
+
+int String::indexOf(const char* text, unsigned int from) const {
+    if (from >= len || !text) return -1;
+    const char* found = strstr(buffer + from, text);
+    return found ? (int)(found - buffer) : -1;
+}
+
+bool String::startsWith(const char* prefix) const {
+    size_t n = strlen(prefix);
+    return n <= len && memcmp(c_str(), prefix, n) == 0;
+}
+
+bool String::endsWith(const char* suffix) const {
+    size_t n = strlen(suffix);
+    return n <= len && memcmp(c_str() + len - n, suffix, n) == 0;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) {
+        unsigned int swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from >= len) return String();
+    if (to > len) to = len;
+    String result;
+    result.copy(buffer + from, to - from);
+    return result;
+}
+
+void String::toCharArray(char* out, unsigned int size, unsigned int index) const {
+    if (!out || size == 0) return;
+    if (index >= len) {
+        out[0] = '\0';
+        return;
+    }
+    unsigned int n = len - index;
+    if (n > size - 1) n = size - 1;
+    memcpy(out, buffer + index, n);
+    out[n] = '\0';
+}
+
+long String::toInt() const {
+    return atol(c_str());
+}
+
+float String::toFloat() const {
+    return (float)atof(c_str());
+}
+
+String operator+(const String& lhs, const String& rhs) {
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
+
+String operator+(const String& lhs, const char* rhs) {
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
+
+String operator+(const char* lhs, const String& rhs) {
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
+
+String operator+(const String& lhs, char rhs) {
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
@@ -0,0 +1,86 @@
+#ifndef WString_h
+#define WString_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// String Arduino: tampon sur le tas, agrandi par realloc() comme sur la carte,
+// pour que les compteurs d'allocation voient ce que la carte verrait. Sans tampon
+// interne pour les chaînes courtes (SSO): les comptes sont un majorant.
+class String {
+public:
+    String(const char* cstr = "");
+    String(const String& other);
+    String(String&& other) noexcept;
+    explicit String(char c);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(float value, unsigned int decimals = 2);
+    explicit String(double value, unsigned int decimals = 2);
+    ~String();
+
+    String& operator=(const String& other);
+    String& operator=(String&& other) noexcept;
+    String& operator=(const char* cstr);
+
+    bool reserve(unsigned int size);
+    unsigned int length() const { return len; }
+    bool isEmpty() const { return len == 0; }
+    const char* c_str() const { return buffer ? buffer : ""; }
+
+    bool concat(const String& other) { return concat(other.c_str(), other.len); }
+    bool concat(const char* cstr) { return cstr ? concat(cstr, strlength(cstr)) : false; }
+    bool concat(const char* cstr, unsigned int length);
+    bool concat(char c) { return concat(&c, 1); }
+    bool concat(int value) { return concat(String(value)); }
+    bool concat(unsigned int value) { return concat(String(value)); }
+    bool concat(long value) { return concat(String(value)); }
+    bool concat(unsigned long value) { return concat(String(value)); }
+    bool concat(float value) { return concat(String(value)); }
+    bool concat(double value) { return concat(String(value)); }
+
+    template <typename T>
+    String& operator+=(const T& value) {
+        concat(value);
+        return *this;
+    }
+
+    bool equals(const String& other) const;
+    bool equals(const char* cstr) const;
+    bool operator==(const String& other) const { return equals(other); }
+    bool operator==(const char* cstr) const { return equals(cstr); }
+    bool operator!=(const String& other) const { return !equals(other); }
+    bool operator!=(const char* cstr) const { return !equals(cstr); }
+
+    char charAt(unsigned int index) const { return index < len ? buffer[index] : '\0'; }
+    char operator[](unsigned int index) const { return charAt(index); }
+
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const char* text, unsigned int from = 0) const;
+    bool startsWith(const char* prefix) const;
+    bool endsWith(const char* suffix) const;
+    String substring(unsigned int from) const { return substring(from, len); }
+    String substring(unsigned int from, unsigned int to) const;
+    void toCharArray(char* out, unsigned int size, unsigned int index = 0) const;
+
+    long toInt() const;
+    float toFloat() const;
+
+private:
+    char* buffer;
+    unsigned int capacity;
+    unsigned int len;
+
+    static unsigned int strlength(const char* cstr);
+    void invalidate();
+    bool copy(const char* cstr, unsigned int length);
+};
+
+String operator+(const String& lhs, const String& rhs);
+String operator+(const String& lhs, const char* rhs);
+String operator+(const char* lhs, const String& rhs);
+String operator+(const String& lhs, char rhs);
+
+#endif
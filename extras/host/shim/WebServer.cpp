@@ -0,0 +1,114 @@
+#include "WebServer.h"
+
+#include <strings.h>
+
+namespace {
+
+WebServer* startedServer = nullptr;
+
+} // namespace
+
+void WebServer::begin() {
+    started = true;
+    startedServer = this;
+}
+
+void WebServer::stop() {
+    started = false;
+    if (startedServer == this) startedServer = nullptr;
+}
+
+namespace host {
+
+WebServer* webServer() {
+    return startedServer;
+}
+
+} // namespace host
+
+const char* WebServer::Response::header(const char* name) const {
+    for (const auto& entry : headers) {
+        if (strcasecmp(entry.first.c_str(), name) == 0) return entry.second.c_str();
+    }
+    return nullptr;
+}
+
+void WebServer::on(const String& uri, HTTPMethod method, THandlerFunction handler) {
+    routes.push_back(Route{ uri.c_str(), method, handler });
+}
+
+void WebServer::sendHeader(const String& name, const String& value, bool first) {
+    auto header = std::make_pair(std::string(name.c_str()), std::string(value.c_str()));
+    if (first) pendingHeaders.insert(pendingHeaders.begin(), header);
+    else pendingHeaders.push_back(header);
+}
+
+// Ouvre la réponse; avec CONTENT_LENGTH_UNKNOWN le corps suivra par sendContent()
+void WebServer::send(int code, const char* contentType, const String& content) {
+    response.code = code;
+    response.contentType = contentType ? contentType : "text/html";
+    response.headers = pendingHeaders;
+    pendingHeaders.clear();
+    response.chunked = contentLength == CONTENT_LENGTH_UNKNOWN;
+    if (!response.chunked) {
+        char length[24];
+        snprintf(length, sizeof(length), "%u",
+                 (unsigned)(contentLength == CONTENT_LENGTH_NOT_SET ? content.length() : contentLength));
+        response.headers.push_back(std::make_pair(std::string("Content-Length"), std::string(length)));
+        response.finished = true;
+    } else {
+        response.headers.push_back(std::make_pair(std::string("Transfer-Encoding"), std::string("chunked")));
+    }
+    response.headers.push_back(std::make_pair(std::string("Content-Type"), response.contentType));
+    response.body.append(content.c_str(), content.length());
+    contentLength = CONTENT_LENGTH_NOT_SET;
+}
+
+void WebServer::send_P(int code, PGM_P contentType, PGM_P content, size_t length) {
+    String body;
+    body.concat(content, (unsigned int)length);
+    send(code, contentType, body);
+}
+
+// En transfert chunked, un bloc vide termine la réponse
+void WebServer::sendContent(const char* content, size_t length) {
+    if (response.chunked) {
+        if (length == 0) {
+            response.finished = true;
+            return;
+        }
+        response.chunks.push_back(length);
+    }
+    response.body.append(content, length);
+}
+
+String WebServer::arg(const String& name) const {
+    for (const auto& entry : requestArgs) {
+        if (entry.first == name.c_str()) return String(entry.second.c_str());
+    }
+    return String();
+}
+
+bool WebServer::hasArg(const String& name) const {
+    for (const auto& entry : requestArgs) {
+        if (entry.first == name.c_str()) return true;
+    }
+    return false;
+}
+
+const WebServer::Response& WebServer::request(HTTPMethod method, const char* uri,
+                                              std::vector<std::pair<std::string, std::string>> args) {
+    response = Response();
+    pendingHeaders.clear();
+    contentLength = CONTENT_LENGTH_NOT_SET;
+    requestArgs = std::move(args);
+    for (const Route& route : routes) {
+        if (route.uri == uri && (route.method == HTTP_ANY || route.method == method)) {
+            route.handler();
+            return response;
+        }
+    }
+    if (notFound) notFound();
+    else send(404, "text/plain", "Not found");
+    return response;
+}
@@ -0,0 +1,96 @@
+#ifndef WebServer_h
+#define WebServer_h
+
+#include "Arduino.h"
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum HTTPMethod {
+    HTTP_ANY,
+    HTTP_GET,
+    HTTP_HEAD,
+    HTTP_POST,
+    HTTP_PUT,
+    HTTP_PATCH,
+    HTTP_DELETE,
+    HTTP_OPTIONS
+};
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+// Serveur HTTP sans socket: request() appelle le gestionnaire de la route comme
+// handleClient() le ferait, et rend la réponse telle qu'elle serait partie
+// (en-têtes, corps, découpage en blocs chunked).
+class WebServer {
+public:
+    typedef std::function<void()> THandlerFunction;
+
+    struct Response {
+        int code = 0;
+        std::string contentType;
+        std::vector<std::pair<std::string, std::string>> headers;
+        std::string body;
+        std::vector<size_t> chunks;     // Taille de chaque bloc envoyé (transfert chunked)
+        bool chunked = false;
+        bool finished = false;          // Bloc vide final reçu
+
+        const char* header(const char* name) const;
+    };
+
+    explicit WebServer(int port = 80) : port(port) {}
+    ~WebServer() { stop(); }
+
+    void begin();
+    void stop();
+    void handleClient() {}
+
+    void on(const String& uri, THandlerFunction handler) { on(uri, HTTP_ANY, handler); }
+    void on(const String& uri, HTTPMethod method, THandlerFunction handler);
+    void onNotFound(THandlerFunction handler) { notFound = handler; }
+
+    void setContentLength(size_t length) { contentLength = length; }
+    void sendHeader(const String& name, const String& value, bool first = false);
+    void send(int code, const char* contentType = nullptr, const String& content = String());
+    void send(int code, const String& contentType, const String& content) { send(code, contentType.c_str(), content); }
+    void send_P(int code, PGM_P contentType, PGM_P content) { send(code, contentType, String(content)); }
+    void send_P(int code, PGM_P contentType, PGM_P content, size_t length);
+    void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+    void sendContent(const char* content, size_t length);
+
+    String arg(const String& name) const;
+    bool hasArg(const String& name) const;
+
+    // Requête simulée. args: paramètres de formulaire (nom, valeur).
+    const Response& request(HTTPMethod method, const char* uri,
+                            std::vector<std::pair<std::string, std::string>> args = {});
+    const Response& lastResponse() const { return response; }
+    bool isStarted() const { return started; }
+
+private:
+    struct Route {
+        std::string uri;
+        HTTPMethod method;
+        THandlerFunction handler;
+    };
+
+    int port;
+    bool started = false;
+    std::vector<Route> routes;
+    THandlerFunction notFound;
+    std::vector<std::pair<std::string, std::string>> requestArgs;
+    std::vector<std::pair<std::string, std::string>> pendingHeaders;
+    size_t contentLength = CONTENT_LENGTH_NOT_SET;
+    Response response;
+};
+
+namespace host {
+
+// Dernier serveur démarré par begin() (ex: celui, privé, du portail de ConfigManager)
+WebServer* webServer();
+
+} // namespace host
+
+#endif
@@ -0,0 +1,370 @@
+#include "WiFi.h"
+
+#include <lwip/dns.h>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/sockios.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <map>
+#include <string>
+#include <vector>
+
+WiFiClass WiFi;
+
+namespace {
+
+bool networkUp = true;
+long joinDelayMs = 0;
+bool began = false;
+unsigned long beganAt = 0;
+unsigned beginCount = 0;
+WiFiMode_t currentMode = WIFI_OFF;
+
+std::map<std::string, IPAddress> dnsTable;
+bool dnsFailAll = false;
+unsigned dnsQueries = 0;
+long dnsDelayMs = 0;
+
+// Requête lwIP en cours: le rappel part quand l'horloge simulée atteint dueAt
+struct DnsAnswer {
+    std::string name;
+    bool found;
+    IPAddress address;
+    uint64_t dueAt;
+    dns_found_callback callback;
+    void* arg;
+};
+
+std::vector<DnsAnswer> dnsAnswers;
+
+Client* routedPeer = nullptr;
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// WiFiClient
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+    if (routedPeer) return routedPeer->connect(ip, port);
+    stop();
+    if (WiFi.status() != WL_CONNECTED) return 0;
+
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) return 0;
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+    int one = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = (uint32_t)ip;
+
+    // Connexion bornée par _timeout, comme les deux cœurs
+    if (::connect(sock, (sockaddr*)&address, sizeof(address)) < 0) {
+        if (errno != EINPROGRESS) {
+            close(sock);
+            return 0;
+        }
+        pollfd waiting = { sock, POLLOUT, 0 };
+        int error = 0;
+        socklen_t length = sizeof(error);
+        if (poll(&waiting, 1, (int)_timeout) != 1 ||
+            getsockopt(sock, SOL_SOCKET, SO_ERROR, &error, &length) < 0 || error != 0) {
+            close(sock);
+            return 0;
+        }
+    }
+    fd = sock;
+    peerClosed = false;
+    return 1;
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+    if (routedPeer) return routedPeer->connect(host, port);
+    IPAddress ip;
+    if (!WiFi.hostByName(host, ip)) return 0;
+    return connect(ip, port);
+}
+
+size_t WiFiClient::write(const uint8_t* buffer, size_t size) {
+    if (routedPeer) return routedPeer->write(buffer, size);
+    if (fd < 0 || size == 0) return 0;
+    ssize_t sent = send(fd, buffer, size, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (sent < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) stop();
+        return 0;
+    }
+    return (size_t)sent;
+}
+
+// Place libre dans le tampon d'émission du noyau, comme tcp_sndbuf() sur l'ESP8266
+int WiFiClient::availableForWrite() {
+    if (routedPeer) return routedPeer->availableForWrite();
+    if (fd < 0) return 0;
+    int capacity = 0;
+    socklen_t length = sizeof(capacity);
+    int queued = 0;
+    if (getsockopt(fd, SOL_SOCKET, SO_SNDBUF, &capacity, &length) < 0 || ioctl(fd, SIOCOUTQ, &queued) < 0) {
+        return 0;
+    }
+    return capacity > queued ? capacity - queued : 0;
+}
+
+bool WiFiClient::checkPeer() {
+    if (fd < 0) return false;
+    if (peerClosed) return false;
+    char byte;
+    ssize_t n = recv(fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) peerClosed = true;
+    return !peerClosed;
+}
+
+int WiFiClient::available() {
+    if (routedPeer) return routedPeer->available();
+    if (fd < 0) return 0;
+    int pending = 0;
+    if (ioctl(fd, FIONREAD, &pending) < 0) return 0;
+    if (pending == 0) checkPeer();
+    return pending;
+}
+
+int WiFiClient::read() {
+    uint8_t byte;
+    return read(&byte, 1) == 1 ? byte : -1;
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size) {
+    if (routedPeer) return routedPeer->read(buffer, size);
+    if (fd < 0) return -1;
+    ssize_t n = recv(fd, buffer, size, MSG_DONTWAIT);
+    if (n == 0) peerClosed = true;
+    return n > 0 ? (int)n : -1;
+}
+
+int WiFiClient::peek() {
+    if (routedPeer) return routedPeer->peek();
+    if (fd < 0) return -1;
+    uint8_t byte;
+    return recv(fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT) == 1 ? byte : -1;
+}
+
+void WiFiClient::stop() {
+    if (routedPeer) {
+        routedPeer->stop();
+        return;
+    }
+    if (fd >= 0) close(fd);
+    fd = -1;
+    peerClosed = false;
+}
+
+// Connecté tant que des données restent à lire, même si le pair a fermé
+uint8_t WiFiClient::connected() {
+    if (routedPeer) return routedPeer->connected();
+    if (fd < 0) return 0;
+    return available() > 0 || checkPeer();
+}
+
+// ---------------------------------------------------------------------------
+// WiFiClass
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* password) {
+    (void)ssid;
+    (void)password;
+    if (currentMode == WIFI_OFF) currentMode = WIFI_STA;
+    began = true;
+    beganAt = millis();
+    beginCount++;
+    return status();
+}
+
+wl_status_t WiFiClass::status() {
+    if (!began) return WL_IDLE_STATUS;
+    if (!(currentMode & WIFI_STA)) return WL_DISCONNECTED;
+    if (!networkUp || joinDelayMs < 0) return WL_DISCONNECTED;
+    return millis() - beganAt >= (unsigned long)joinDelayMs ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+bool WiFiClass::mode(WiFiMode_t mode) {
+    currentMode = mode;
+    return true;
+}
+
+WiFiMode_t WiFiClass::getMode() {
+    return currentMode;
+}
+
+bool WiFiClass::reconnect() {
+    if (!began) return false;
+    beganAt = millis();
+    beginCount++;
+    return true;
+}
+
+bool WiFiClass::disconnect(bool wifiOff) {
+    began = false;
+    if (wifiOff) currentMode = WIFI_OFF;
+    return true;
+}
+
+IPAddress WiFiClass::localIP() {
+    return status() == WL_CONNECTED ? IPAddress(192, 168, 1, 50) : IPAddress();
+}
+
+bool WiFiClass::softAPConfig(IPAddress ip, IPAddress gateway, IPAddress subnet) {
+    (void)ip;
+    (void)gateway;
+    (void)subnet;
+    return true;
+}
+
+bool WiFiClass::softAP(const char* ssid, const char* password) {
+    (void)ssid;
+    (void)password;
+    currentMode = (WiFiMode_t)(currentMode | WIFI_AP);
+    return true;
+}
+
+IPAddress WiFiClass::softAPIP() {
+    return currentMode & WIFI_AP ? IPAddress(192, 168, 4, 1) : IPAddress();
+}
+
+int8_t WiFiClass::RSSI() {
+    return status() == WL_CONNECTED ? -58 : 0;
+}
+
+String WiFiClass::macAddress() {
+    return String("A1:B2:C3:D4:E5:F6");
+}
+
+namespace {
+
+// Table simulée, puis résolveur du système si les clients utilisent de vrais sockets
+bool lookup(const char* host, IPAddress& result) {
+    result = IPAddress();
+    if (!host || dnsFailAll || WiFi.status() != WL_CONNECTED) return false;
+    if (result.fromString(host)) return true;
+
+    auto entry = dnsTable.find(host);
+    if (entry != dnsTable.end()) {
+        result = entry->second;
+        return true;
+    }
+    if (routedPeer) return false;
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host, nullptr, &hints, &found) != 0 || !found) return false;
+    result = IPAddress((uint32_t)((sockaddr_in*)found->ai_addr)->sin_addr.s_addr);
+    freeaddrinfo(found);
+    return true;
+}
+
+} // namespace
+
+int WiFiClass::hostByName(const char* host, IPAddress& result) {
+    dnsQueries++;
+    return lookup(host, result) ? 1 : 0;
+}
+
+// Adresse littérale ou réponse sans délai: ERR_OK tout de suite, comme un nom déjà
+// dans le cache de lwIP. Sinon ERR_INPROGRESS et rappel (ipaddr nul en cas d'échec).
+err_t dns_gethostbyname(const char* hostname, ip_addr_t* addr, dns_found_callback found, void* callback_arg) {
+    if (!hostname || !addr || !found) return ERR_ARG;
+    if (WiFi.status() != WL_CONNECTED) return ERR_VAL;
+    dnsQueries++;
+
+    IPAddress result;
+    bool resolved = lookup(hostname, result);
+    if (resolved && (dnsDelayMs == 0 || IPAddress().fromString(hostname))) {
+        addr->addr = (uint32_t)result;
+        return ERR_OK;
+    }
+    if (dnsDelayMs >= 0) {
+        uint64_t dueAt = (uint64_t)micros() + (uint64_t)dnsDelayMs * 1000;
+        dnsAnswers.push_back({ hostname, resolved, result, dueAt, found, callback_arg });
+    }
+    return ERR_INPROGRESS;
+}
+
+namespace host {
+
+void setWiFi(bool associated) {
+    networkUp = associated;
+}
+
+void setWiFiJoinDelay(long delayMs) {
+    joinDelayMs = delayMs;
+}
+
+unsigned wifiBeginCount() {
+    return beginCount;
+}
+
+void setDnsEntry(const char* name, IPAddress address) {
+    dnsTable[name] = address;
+}
+
+void setDnsFailure(bool failAll) {
+    dnsFailAll = failAll;
+}
+
+unsigned dnsQueryCount() {
+    return dnsQueries;
+}
+
+void setDnsDelay(long delayMs) {
+    dnsDelayMs = delayMs;
+}
+
+void deliverNetworkEvents() {
+    uint64_t now = micros();
+    // Un rappel peut relancer une requête: parcours d'une copie
+    std::vector<DnsAnswer> due;
+    for (auto it = dnsAnswers.begin(); it != dnsAnswers.end();) {
+        if (it->dueAt <= now) {
+            due.push_back(*it);
+            it = dnsAnswers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (const DnsAnswer& answer : due) {
+        ip_addr_t address = { (uint32_t)answer.address };
+        answer.callback(answer.name.c_str(), answer.found ? &address : nullptr, answer.arg);
+    }
+}
+
+void routeWiFiClients(Client* peer) {
+    routedPeer = peer;
+}
+
+void resetWiFi() {
+    networkUp = true;
+    joinDelayMs = 0;
+    began = false;
+    beganAt = 0;
+    beginCount = 0;
+    currentMode = WIFI_OFF;
+    dnsTable.clear();
+    dnsFailAll = false;
+    dnsQueries = 0;
+    dnsDelayMs = 0;
+    dnsAnswers.clear();
+    routedPeer = nullptr;
+}
+
+} // namespace host
@@ -0,0 +1,101 @@
+#ifndef WiFi_h
+#define WiFi_h
+
+#include "Arduino.h"
+#include "Client.h"
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} WiFiMode_t;
+
+// Socket TCP non bloquant. connect() attend au plus getTimeout() ms (setTimeout), comme
+// WiFiClient::connect() des deux cœurs; write() n'écrit que ce que le noyau accepte.
+// Un Client de test peut prendre la place de tous les sockets (host::routeWiFiClients).
+class WiFiClient : public Client {
+public:
+    WiFiClient() : fd(-1), peerClosed(false) {}
+    ~WiFiClient() override { stop(); }
+    WiFiClient(const WiFiClient&) = delete;
+    WiFiClient& operator=(const WiFiClient&) = delete;
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char* host, uint16_t port) override;
+    size_t write(uint8_t byte) override { return write(&byte, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int availableForWrite() override;
+    int available() override;
+    int read() override;
+    int read(uint8_t* buffer, size_t size) override;
+    int peek() override;
+    void flush() override {}
+    void stop() override;
+    uint8_t connected() override;
+    operator bool() override { return connected(); }
+
+    void setNoDelay(bool) {}
+
+private:
+    int fd;
+    bool peerClosed;
+
+    bool checkPeer();
+};
+
+// Station et point d'accès simulés: l'association est pilotée par host::setWiFi()
+class WiFiClass {
+public:
+    wl_status_t begin(const char* ssid, const char* password = nullptr);
+    wl_status_t status();
+    bool mode(WiFiMode_t mode);
+    WiFiMode_t getMode();
+    bool reconnect();
+    bool disconnect(bool wifiOff = false);
+    IPAddress localIP();
+    bool softAPConfig(IPAddress ip, IPAddress gateway, IPAddress subnet);
+    bool softAP(const char* ssid, const char* password = nullptr);
+    IPAddress softAPIP();
+    int8_t RSSI();
+    String macAddress();
+    // Résolution bloquante (getaddrinfo), ou table de host::setDnsEntry()
+    int hostByName(const char* host, IPAddress& result);
+};
+
+extern WiFiClass WiFi;
+
+namespace host {
+
+// Association WiFi: immédiate, différée de joinDelayMs après begin()/reconnect(), ou refusée
+void setWiFi(bool associated);
+void setWiFiJoinDelay(long joinDelayMs);   // < 0: aucune association
+unsigned wifiBeginCount();
+
+// Résolution de noms sans réseau; failAll: toute résolution échoue
+void setDnsEntry(const char* name, IPAddress address);
+void setDnsFailure(bool failAll);
+unsigned dnsQueryCount();
+// Délai des réponses à dns_gethostbyname(): 0 immédiat (cache lwIP), < 0 jamais
+void setDnsDelay(long delayMs);
+
+// Tous les WiFiClient passent par ce Client (broker simulé); nullptr: sockets réels
+void routeWiFiClients(Client* peer);
+
+// Retour à l'état de départ: réseau présent sans délai, table DNS vide, compteurs à 0
+void resetWiFi();
+
+} // namespace host
+
+#endif
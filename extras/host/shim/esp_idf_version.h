@@ -0,0 +1,8 @@
+#ifndef esp_idf_version_h
+#define esp_idf_version_h
+
+// ESP-IDF 4.4 (cœur Arduino ESP32 2.x): les API réservées à l'IDF 5 restent hors compilation
+#define ESP_IDF_VERSION_VAL(major, minor, patch) (((major) << 16) | ((minor) << 8) | (patch))
+#define ESP_IDF_VERSION ESP_IDF_VERSION_VAL(4, 4, 0)
+
+#endif
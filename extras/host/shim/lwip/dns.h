@@ -0,0 +1,30 @@
+#ifndef lwip_dns_h
+#define lwip_dns_h
+
+#include <stdint.h>
+
+// Sous-ensemble de l'API brute de lwIP utilisé pour la résolution sans attente.
+// Les réponses viennent de la table de host::setDnsEntry(); elles arrivent après
+// host::setDnsDelay() ms d'horloge simulée, comme le rappel du thread tcpip.
+
+typedef int8_t err_t;
+
+#define ERR_OK          0
+#define ERR_INPROGRESS  -5
+#define ERR_VAL         -6
+#define ERR_ARG         -16
+
+typedef struct {
+    uint32_t addr;
+} ip4_addr_t;
+
+typedef ip4_addr_t ip_addr_t;
+
+#define ip_2_ip4(ipaddr) (ipaddr)
+#define ip4_addr_get_u32(src) ((src)->addr)
+
+typedef void (*dns_found_callback)(const char* name, const ip_addr_t* ipaddr, void* callback_arg);
+
+err_t dns_gethostbyname(const char* hostname, ip_addr_t* addr, dns_found_callback found, void* callback_arg);
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef DeviceHarness_h
+#define DeviceHarness_h
+
+// MQTTDevice complet relié au FakeBroker par le WiFi simulé: tous ses WiFiClient
+// passent par le broker en mémoire pendant la vie du harnais
+
+#include "HostTest.h"
+#include "FakeBroker.h"
+
+#include <MQTTDevice.h>
+#include <string>
+
+template <typename Device = MQTTDevice>
+struct DeviceHarness {
+    FakeBroker broker;
+    Device device;
+
+    explicit DeviceHarness(const char* mac = "A1B2C3D4E5F6") : device(mac), mac(mac) {
+        host::routeWiFiClients(&broker);
+        WiFi.mode(WIFI_STA);
+        WiFi.begin("ssid", "password");
+    }
+
+    ~DeviceHarness() {
+        host::routeWiFiClients(nullptr);
+    }
+
+    // Un tour de loop() du sketch
+    void step(unsigned long ms = 10) {
+        device.handle();
+        host::advance(ms);
+    }
+
+    void run(unsigned long durationMs, unsigned long stepMs = 10) {
+        for (unsigned long elapsed = 0; elapsed < durationMs; elapsed += stepMs) step(stepMs);
+    }
+
+    bool runUntilOnline(unsigned long maxMs = 10000) {
+        return HostTest::runUntil([this] { device.handle(); },
+                                  [this] { return device.getLinkState() == LINK_ONLINE; }, maxMs);
+    }
+
+    // "home/[location/]esp32-[mac]/[name]/[type]"
+    std::string topic(const char* location, const char* name, const char* type = "state") const {
+        std::string text = "home/";
+        if (location[0] != '\0') text += std::string(location) + "/";
+        return text + RonoBoxPlatform::name() + "-" + mac + "/" + name + "/" + type;
+    }
+
+    std::string availabilityTopic() const {
+        return std::string("home/") + RonoBoxPlatform::name() + "-" + mac + "/status";
+    }
+
+private:
+    std::string mac;
+};
+
+#endif
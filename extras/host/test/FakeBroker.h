@@ -0,0 +1,390 @@
+#ifndef FakeBroker_h
+#define FakeBroker_h
+
+// Broker MQTT 3.1.1 en mémoire, branché à la place du socket (Client, ou tous les
+// WiFiClient via host::routeWiFiClients). Décode ce que le client écrit, répond
+// CONNACK, SUBACK, PUBACK et PINGRESP, garde les messages publiés et les retenus,
+// publie la dernière volonté si le lien tombe sans DISCONNECT.
+//
+// Pannes à la demande: connexion refusée, CONNACK retenu ou refusé, accusés perdus,
+// pile TCP pleine (setWriteSpace), coupure du lien (dropLink).
+//
+// Les tampons sont réservés à la construction: en régime établi, le broker n'alloue
+// rien tant que setRecording(false) (mesures d'allocation du code testé).
+
+#include <Client.h>
+#include <map>
+#include <string>
+#include <vector>
+
+class FakeBroker : public Client {
+public:
+    struct Message {
+        std::string topic;
+        std::string payload;
+        uint8_t qos;
+        bool retained;
+        bool duplicate;
+        uint16_t packetId;
+    };
+
+    FakeBroker() {
+        inbound.reserve(4096);
+        packet.reserve(4096);
+    }
+
+    // --- Client ---
+
+    int connect(IPAddress ip, uint16_t port) override {
+        (void)port;
+        attempts++;
+        lastAddress = ip;
+        if (listening != IPAddress() && ip != listening) return 0;   // Ancienne adresse
+        return open();
+    }
+
+    int connect(const char* host, uint16_t port) override {
+        (void)host;
+        (void)port;
+        attempts++;
+        return open();
+    }
+
+    size_t write(uint8_t byte) override { return write(&byte, 1); }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        if (!isOpen) return 0;
+        if (writeSpace >= 0 && size > (size_t)writeSpace) size = writeSpace;
+        if (writeSpace >= 0) writeSpace -= size;
+        for (size_t i = 0; i < size; i++) scan(buffer[i]);
+        bytesReceived += size;
+        return size;
+    }
+
+    using Print::write;
+
+    int availableForWrite() override { return writeSpace >= 0 ? writeSpace : 1460; }
+    int available() override { return (int)(inbound.size() - inboundRead); }
+
+    int read() override {
+        uint8_t byte;
+        return read(&byte, 1) == 1 ? byte : -1;
+    }
+
+    int read(uint8_t* buffer, size_t size) override {
+        size_t n = 0;
+        while (n < size && inboundRead < inbound.size()) buffer[n++] = inbound[inboundRead++];
+        if (inboundRead == inbound.size()) {
+            inbound.clear();
+            inboundRead = 0;
+        }
+        return n > 0 ? (int)n : -1;
+    }
+
+    int peek() override { return available() > 0 ? inbound[inboundRead] : -1; }
+    void flush() override {}
+
+    void stop() override {
+        if (isOpen && !cleanDisconnect) publishWill();
+        isOpen = false;
+        inbound.clear();
+        inboundRead = 0;
+    }
+
+    uint8_t connected() override { return isOpen || available() > 0; }
+    operator bool() override { return connected(); }
+
+    // --- Pilotage du test ---
+
+    void setRecording(bool enabled) { recording = enabled; }
+    void refuseConnections(bool refuse) { refusing = refuse; }
+    // Seule adresse joignable (broker déplacé par le DHCP); non renseignée: toutes
+    void listenOn(IPAddress address) { listening = address; }
+    IPAddress connectedAddress() const { return lastAddress; }
+    unsigned connectionAttempts() const { return attempts; }   // Ouvertures TCP, refusées comprises
+    void holdConnack(bool hold) { holdingConnack = hold; }
+    void setConnackCode(uint8_t code) { connackCode = code; }
+    void setAutoAck(bool enabled) { autoAck = enabled; }
+    void dropNextAcks(unsigned count) { acksToDrop = count; }
+    // Octets que la pile TCP accepte encore (< 0: illimité)
+    void setWriteSpace(long bytes) { writeSpace = bytes; }
+
+    // Coupure sans fermeture propre: le broker publie la dernière volonté
+    void dropLink() {
+        if (!isOpen) return;
+        publishWill();
+        isOpen = false;
+        inbound.clear();
+        inboundRead = 0;
+    }
+
+    // CONNACK retenu par holdConnack(true)
+    void sendConnack(uint8_t code = 0) {
+        const uint8_t connack[] = { 0x20, 0x02, 0x00, code };
+        queue(connack, sizeof(connack));
+    }
+
+    // Message du broker vers le client (commande, statut Home Assistant)
+    void deliver(const char* topic, const char* payload, uint8_t qos = 0, uint16_t packetId = 1,
+                 bool duplicate = false) {
+        size_t topicLength = strlen(topic);
+        size_t payloadLength = strlen(payload);
+        size_t remaining = 2 + topicLength + (qos > 0 ? 2 : 0) + payloadLength;
+        uint8_t header = 0x30 | (qos << 1) | (duplicate ? 0x08 : 0x00);
+        queue(&header, 1);
+        queueLength(remaining);
+        const uint8_t length[] = { (uint8_t)(topicLength >> 8), (uint8_t)topicLength };
+        queue(length, 2);
+        queue((const uint8_t*)topic, topicLength);
+        if (qos > 0) {
+            const uint8_t id[] = { (uint8_t)(packetId >> 8), (uint8_t)packetId };
+            queue(id, 2);
+        }
+        queue((const uint8_t*)payload, payloadLength);
+    }
+
+    // PUBACK d'un message QoS1 retenu par setAutoAck(false)
+    void acknowledge(uint16_t packetId) {
+        const uint8_t puback[] = { 0x40, 0x02, (uint8_t)(packetId >> 8), (uint8_t)packetId };
+        queue(puback, sizeof(puback));
+    }
+
+    bool isConnected() const { return isOpen; }
+    bool sessionOpen() const { return isOpen && connackSent; }
+    unsigned connectCount() const { return connects; }
+    unsigned connackCount() const { return connacks; }
+    unsigned pingCount() const { return pings; }
+    unsigned disconnectCount() const { return disconnects; }
+    size_t getBytesReceived() const { return bytesReceived; }
+
+    const std::string& clientId() const { return lastClientId; }
+    const std::string& willTopic() const { return lastWillTopic; }
+    const std::string& willMessage() const { return lastWillMessage; }
+    bool willRetained() const { return lastWillRetain; }
+
+    const std::vector<Message>& messages() const { return published; }
+    const std::vector<std::string>& subscriptions() const { return subscribed; }
+    const std::vector<uint16_t>& clientAcks() const { return pubacksFromClient; }
+    void clearMessages() { published.clear(); }
+
+    // Messages publiés sur un topic (ordre d'arrivée)
+    std::vector<const Message*> on(const std::string& topic) const {
+        std::vector<const Message*> found;
+        for (const Message& message : published) {
+            if (message.topic == topic) found.push_back(&message);
+        }
+        return found;
+    }
+
+    const Message* last(const std::string& topic) const {
+        for (auto it = published.rbegin(); it != published.rend(); ++it) {
+            if (it->topic == topic) return &*it;
+        }
+        return nullptr;
+    }
+
+    // Valeur retenue par le broker (vide si aucune)
+    std::string retained(const std::string& topic) const {
+        auto entry = retainedStore.find(topic);
+        return entry == retainedStore.end() ? std::string() : entry->second;
+    }
+
+    size_t publishCount() const { return publishes; }
+
+private:
+    bool isOpen = false;
+    bool cleanDisconnect = false;
+    bool connackSent = false;
+    bool recording = true;
+    bool refusing = false;
+    IPAddress listening;
+    IPAddress lastAddress;
+    unsigned attempts = 0;
+    bool holdingConnack = false;
+    uint8_t connackCode = 0;
+    bool autoAck = true;
+    unsigned acksToDrop = 0;
+    long writeSpace = -1;
+
+    unsigned connects = 0;
+    unsigned connacks = 0;
+    unsigned pings = 0;
+    unsigned disconnects = 0;
+    size_t publishes = 0;
+    size_t bytesReceived = 0;
+
+    std::vector<uint8_t> inbound;
+    size_t inboundRead = 0;
+
+    // Paquet émis par le client en cours de décodage
+    std::vector<uint8_t> packet;
+    uint8_t packetType = 0;
+    uint32_t packetLength = 0;
+    uint32_t lengthMultiplier = 1;
+    enum { HEADER, LENGTH, BODY } step = HEADER;
+
+    std::string lastClientId;
+    std::string lastWillTopic;
+    std::string lastWillMessage;
+    bool lastWillRetain = false;
+    bool hasWill = false;
+
+    std::vector<Message> published;
+    std::vector<std::string> subscribed;
+    std::vector<uint16_t> pubacksFromClient;
+    std::map<std::string, std::string> retainedStore;
+
+    int open() {
+        if (refusing) return 0;
+        isOpen = true;
+        cleanDisconnect = false;
+        connackSent = false;
+        hasWill = false;
+        inbound.clear();
+        inboundRead = 0;
+        step = HEADER;
+        return 1;
+    }
+
+    void queue(const uint8_t* data, size_t size) {
+        if (!isOpen) return;
+        inbound.insert(inbound.end(), data, data + size);
+    }
+
+    void queueLength(size_t remaining) {
+        do {
+            uint8_t digit = remaining % 128;
+            remaining /= 128;
+            if (remaining > 0) digit |= 0x80;
+            queue(&digit, 1);
+        } while (remaining > 0);
+    }
+
+    void scan(uint8_t byte) {
+        switch (step) {
+            case HEADER:
+                packetType = byte;
+                packetLength = 0;
+                lengthMultiplier = 1;
+                packet.clear();
+                step = LENGTH;
+                break;
+            case LENGTH:
+                packetLength += (byte & 0x7F) * lengthMultiplier;
+                lengthMultiplier *= 128;
+                if (byte & 0x80) break;
+                step = packetLength == 0 ? HEADER : BODY;
+                if (packetLength == 0) handle();
+                break;
+            case BODY:
+                packet.push_back(byte);
+                if (packet.size() == packetLength) {
+                    step = HEADER;
+                    handle();
+                }
+                break;
+        }
+    }
+
+    uint16_t word(size_t offset) const { return (packet[offset] << 8) | packet[offset + 1]; }
+
+    std::string string(size_t& offset) const {
+        uint16_t length = word(offset);
+        std::string text((const char*)packet.data() + offset + 2, length);
+        offset += 2 + length;
+        return text;
+    }
+
+    void handle() {
+        switch (packetType & 0xF0) {
+            case 0x10: handleConnect(); break;
+            case 0x30: handlePublish(); break;
+            case 0x40: if (recording) pubacksFromClient.push_back(word(0)); break;
+            case 0x80: handleSubscribe(); break;
+            case 0xC0: {
+                pings++;
+                const uint8_t pingresp[] = { 0xD0, 0x00 };
+                queue(pingresp, sizeof(pingresp));
+                break;
+            }
+            case 0xE0:
+                disconnects++;
+                cleanDisconnect = true;
+                isOpen = false;
+                break;
+        }
+    }
+
+    void handleConnect() {
+        connects++;
+        uint8_t flags = packet[7];
+        size_t offset = 10;
+        lastClientId = string(offset);
+        hasWill = flags & 0x04;
+        if (hasWill) {
+            lastWillTopic = string(offset);
+            lastWillMessage = string(offset);
+            lastWillRetain = flags & 0x20;
+        }
+        if (!holdingConnack) {
+            sendConnack(connackCode);
+            connackSent = connackCode == 0;
+            connacks++;
+        }
+    }
+
+    void handlePublish() {
+        publishes++;
+        uint8_t qos = (packetType >> 1) & 0x03;
+        bool retain = packetType & 0x01;
+        size_t offset = 0;
+        uint16_t topicLength = word(0);
+        uint16_t id = qos > 0 ? word(2 + topicLength) : 0;
+        if (recording) {
+            Message message;
+            message.topic = string(offset);
+            if (qos > 0) offset += 2;
+            message.payload.assign((const char*)packet.data() + offset, packet.size() - offset);
+            message.qos = qos;
+            message.retained = retain;
+            message.duplicate = packetType & 0x08;
+            message.packetId = id;
+            if (retain) retainedStore[message.topic] = message.payload;
+            published.push_back(message);
+        }
+        if (qos == 1 && autoAck) {
+            if (acksToDrop > 0) {
+                acksToDrop--;
+            } else {
+                acknowledge(id);
+            }
+        }
+    }
+
+    void handleSubscribe() {
+        size_t offset = 2;
+        while (offset + 2 < packet.size()) {
+            std::string topic = string(offset);
+            offset++;   // QoS demandée
+            if (recording) subscribed.push_back(topic);
+        }
+        const uint8_t suback[] = { 0x90, 0x03, packet[0], packet[1], 0x00 };
+        queue(suback, sizeof(suback));
+    }
+
+    void publishWill() {
+        if (!hasWill || !recording) return;
+        Message will;
+        will.topic = lastWillTopic;
+        will.payload = lastWillMessage;
+        will.qos = 0;
+        will.retained = lastWillRetain;
+        will.duplicate = false;
+        will.packetId = 0;
+        if (lastWillRetain) retainedStore[will.topic] = will.payload;
+        published.push_back(will);
+        hasWill = false;
+    }
+};
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef HostTest_h
+#define HostTest_h
+
+// Mini-cadre de test des bibliothèques sur l'hôte: TEST_CASE enregistre un cas,
+// CHECK* signalent un échec sans interrompre le cas, REQUIRE l'interrompt.
+// Avant chaque cas, l'horloge, le WiFi, la NVS, l'EEPROM, LittleFS et la RAM RTC
+// simulés repartent de zéro.
+
+#include <Arduino.h>
+#include <stdexcept>
+
+namespace HostTest {
+
+typedef void (*TestFunction)();
+
+void registerTest(const char* name, TestFunction function);
+void fail(const char* file, int line, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+void checkString(const char* actual, const char* expected, const char* actualText,
+                 const char* expectedText, const char* file, int line);
+
+struct Registrar {
+    Registrar(const char* name, TestFunction function) { registerTest(name, function); }
+};
+
+struct Abort : std::runtime_error {
+    Abort() : std::runtime_error("REQUIRE") {}
+};
+
+// Fait avancer l'horloge simulée par pas de stepMs en appelant step(), jusqu'à ce que
+// done() soit vrai (true) ou que maxMs soit écoulé (false)
+template <typename Step, typename Done>
+bool runUntil(Step step, Done done, unsigned long maxMs, unsigned long stepMs = 10) {
+    for (unsigned long elapsed = 0; elapsed <= maxMs; elapsed += stepMs) {
+        step();
+        if (done()) return true;
+        host::advance(stepMs);
+    }
+    return false;
+}
+
+} // namespace HostTest
+
+#define TEST_CASE(name)                                                   \
+    static void name();                                                   \
+    static HostTest::Registrar name##_registrar(#name, name);            \
+    static void name()
+
+#define CHECK(condition)                                                  \
+    do {                                                                  \
+        if (!(condition)) HostTest::fail(__FILE__, __LINE__, "%s", #condition); \
+    } while (0)
+
+#define REQUIRE(condition)                                                \
+    do {                                                                  \
+        if (!(condition)) {                                               \
+            HostTest::fail(__FILE__, __LINE__, "%s", #condition);         \
+            throw HostTest::Abort();                                      \
+        }                                                                 \
+    } while (0)
+
+// Entiers: les deux valeurs sont affichées en cas d'échec
+#define CHECK_EQ(actual, expected)                                        \
+    do {                                                                  \
+        long long a_ = (long long)(actual);                               \
+        long long e_ = (long long)(expected);                             \
+        if (a_ != e_) HostTest::fail(__FILE__, __LINE__, "%s == %s (%lld != %lld)", \
+                                     #actual, #expected, a_, e_);         \
+    } while (0)
+
+// Les temporaires (String::c_str()) vivent jusqu'à la fin de l'appel de comparaison
+#define CHECK_STR(actual, expected) \
+    HostTest::checkString((actual), (expected), #actual, #expected, __FILE__, __LINE__)
+
+#define CHECK_NEAR(actual, expected, tolerance)                           \
+    do {                                                                  \
+        double a_ = (actual);                                             \
+        double e_ = (expected);                                           \
+        if (fabs(a_ - e_) > (tolerance)) HostTest::fail(__FILE__, __LINE__, "%s ~ %s (%g != %g)", \
+                                                        #actual, #expected, a_, e_); \
+    } while (0)
+
+#endif
@@ -0,0 +1,84 @@
+#include "HostTest.h"
+
+#include <EEPROM.h>
+#include <LittleFS.h>
+#include <Preferences.h>
+#include <WiFi.h>
+#include <vector>
+
+namespace HostTest {
+
+namespace {
+
+struct TestEntry {
+    const char* name;
+    TestFunction function;
+};
+
+std::vector<TestEntry>& registry() {
+    static std::vector<TestEntry> tests;
+    return tests;
+}
+
+unsigned failures = 0;
+
+void resetHost() {
+    host::setClock(0);
+    host::resetWiFi();
+    host::eraseNvs();
+    host::eraseEeprom();
+    host::clearLittleFS();
+    host::setLittleFSCapacity(64 * 1024);
+    host::powerCycle();
+    randomSeed(0);
+}
+
+} // namespace
+
+void registerTest(const char* name, TestFunction function) {
+    registry().push_back(TestEntry{ name, function });
+}
+
+void fail(const char* file, int line, const char* format, ...) {
+    failures++;
+    fprintf(stderr, "%s:%d: échec: ", file, line);
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+void checkString(const char* actual, const char* expected, const char* actualText,
+                 const char* expectedText, const char* file, int line) {
+    if (!actual) actual = "(null)";
+    if (!expected) expected = "(null)";
+    if (strcmp(actual, expected) != 0) {
+        fail(file, line, "%s == %s\n    \"%s\"\n != \"%s\"", actualText, expectedText, actual, expected);
+    }
+}
+
+} // namespace HostTest
+
+// Sans argument: tous les cas; sinon seulement ceux dont le nom contient l'argument
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    unsigned run = 0;
+    unsigned failed = 0;
+    for (const HostTest::TestEntry& test : HostTest::registry()) {
+        if (filter && !strstr(test.name, filter)) continue;
+        HostTest::resetHost();
+        unsigned before = HostTest::failures;
+        try {
+            test.function();
+        } catch (const HostTest::Abort&) {
+        }
+        fflush(stdout);
+        bool ok = HostTest::failures == before;
+        fprintf(stderr, "[%s] %s\n", ok ? " OK " : "FAIL", test.name);
+        run++;
+        if (!ok) failed++;
+    }
+    fprintf(stderr, "%u cas, %u en échec\n", run, failed);
+    return failed == 0 && run > 0 ? 0 : 1;
+}
@@ -0,0 +1,12 @@
+// Le sketch Benchmark compilé pour l'hôte: même code, une exécution de loop().
+// Les temps (compteur de cycles = nanosecondes réelles) ne valent pas ceux de la carte;
+// la ligne JSON sert à comparer deux versions, et les colonnes heap_* sont exactes
+// (même code d'allocation). millis() reste manuelle: les delay() du sketch sont instantanés.
+
+#include "Benchmark.ino"
+
+int main() {
+    setup();
+    loop();
+    return 0;
+}
@@ -0,0 +1,257 @@
+// Règles d'alarme locales (AlarmEngine): pente ALARM_RISE face au bruit ADC à la
+// cadence des trames (100 par seconde), seuils avec hystérésis et durée, mise à jour
+// par JSON et règles enregistrées (NVS sur ESP32, LittleFS sur ESP8266) protégées par
+// le CRC32 de ConfigStore.
+
+#include "HostTest.h"
+
+#include <AlarmRuleStore.h>
+#include <LittleFS.h>
+#include <Preferences.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+const unsigned long FRAME_MS = 10;
+const float PERCENT_PER_LSB = 100.0f / 4095;
+
+// Règles par défaut de mainCode
+const AlarmRule DEFAULT_RULES[] = {
+    {"gaz", ALARM_ABOVE, 1, 1, 0, 30, 3, 0},
+    {"gaz", ALARM_RISE, 1, 1, 0, 10, 5, 0},
+    {"niveau_eau", ALARM_BELOW, 2, 1, 0, 20, 3, 2000},
+    {"humidite_sol", ALARM_BELOW, 3, 0, 0, 20, 5, 60000},
+};
+const uint8_t DEFAULT_COUNT = sizeof(DEFAULT_RULES) / sizeof(DEFAULT_RULES[0]);
+
+const AlarmRule LEAK_RULE[] = {
+    {"gaz", ALARM_RISE, 1, 1, 0, 10, 5, 0},
+};
+
+struct Transition {
+    uint8_t index;
+    bool active;
+    unsigned long at;
+};
+std::vector<Transition> transitions;
+
+void record(uint8_t index, const AlarmRule&, bool active) {
+    transitions.push_back({ index, active, millis() });
+}
+
+// Première transition de la règle index vers active, ou nullptr
+const Transition* find(uint8_t index, bool active) {
+    for (const Transition& transition : transitions) {
+        if (transition.index == index && transition.active == active) return &transition;
+    }
+    return nullptr;
+}
+
+// Bruit de ±3 LSB, reproductible
+struct Noise {
+    uint32_t state = 20260417;
+    int next() {
+        state = state * 1664525 + 1013904223;
+        return (int)(state >> 16) % 7 - 3;
+    }
+};
+
+struct Engine {
+    AlarmEngine alarms;
+    int gas;
+    int waterLevel;
+    int soilMoisture;
+
+    Engine(const AlarmRule* rules, uint8_t count, AlarmRuleStorage* storage = nullptr) {
+        transitions.clear();
+        gas = alarms.addInput("gaz");
+        waterLevel = alarms.addInput("niveau_eau");
+        soilMoisture = alarms.addInput("humidite_sol");
+        alarms.onAlarm(record);
+        alarms.begin(rules, count, storage);
+    }
+};
+
+// Une trame de gaz (en LSB) toutes les 10 ms pendant durationMs
+template <typename Level>
+void feedGas(Engine& engine, unsigned long durationMs, Level level) {
+    unsigned long start = millis();
+    while (millis() - start < durationMs) {
+        engine.alarms.evaluate(engine.gas, level(millis() - start) * PERCENT_PER_LSB, millis());
+        host::advance(FRAME_MS);
+    }
+}
+
+void prepareStorage() {
+    if (!PlatformConfig::HAS_NVS) LittleFS.begin();
+}
+
+} // namespace
+
+// Gaz stable à ~10 % avec ±3 LSB de bruit pendant une minute: d'une trame à l'autre
+// le bruit vaut jusqu'à ~15 %/s, mais la pente sur une seconde reste bien sous 10 %/s
+TEST_CASE(rise_ignores_frame_to_frame_noise) {
+    Engine engine(DEFAULT_RULES, DEFAULT_COUNT);
+    Noise noise;
+    int previous = 400;
+    float maxFrameRate = 0;
+    feedGas(engine, 60000, [&](unsigned long) {
+        int level = 400 + noise.next();
+        maxFrameRate = std::max(maxFrameRate, (level - previous) * PERCENT_PER_LSB * 1000 / FRAME_MS);
+        previous = level;
+        return level;
+    });
+    CHECK(maxFrameRate > 10);   // Deux échantillons seuls déclencheraient la règle
+    CHECK(transitions.empty());
+    CHECK_EQ(engine.alarms.firstActive(), -1);
+}
+
+// Fuite: +20 %/s pendant 3 s, puis palier. La pente est vue en moins de 1,5 s (entre
+// 1 et 2 fenêtres), puis retombe sous le seuil moins l'hystérésis une fois le palier atteint
+TEST_CASE(leak_ramp_fires_then_clears_on_plateau) {
+    Engine engine(LEAK_RULE, 1);
+    Noise noise;
+    feedGas(engine, 5000, [&](unsigned long) { return 400 + noise.next(); });
+    REQUIRE(transitions.empty());
+
+    const float rampLsbPerMs = 20 / PERCENT_PER_LSB / 1000;
+    unsigned long rampStart = millis();
+    feedGas(engine, 3000, [&](unsigned long t) { return 400 + (int)(t * rampLsbPerMs) + noise.next(); });
+    const Transition* fired = find(0, true);
+    REQUIRE(fired != nullptr);
+    CHECK(fired->at - rampStart <= 1500);
+    CHECK(engine.alarms.isActive(0));
+
+    unsigned long plateauStart = millis();
+    const int plateau = 400 + (int)(3000 * rampLsbPerMs);
+    feedGas(engine, 5000, [&](unsigned long) { return plateau + noise.next(); });
+    const Transition* cleared = find(0, false);
+    REQUIRE(cleared != nullptr);
+    CHECK(cleared->at - plateauStart <= 2000);
+    CHECK_EQ(transitions.size(), 2);
+}
+
+// Échantillons plus espacés que la fenêtre: pente prise sur l'échantillon précédent
+TEST_CASE(sparse_samples_use_previous_sample) {
+    Engine engine(LEAK_RULE, 1);
+    engine.alarms.evaluate(engine.gas, 10, 0);
+    engine.alarms.evaluate(engine.gas, 20, 5000);   // +2 %/s
+    CHECK(transitions.empty());
+    engine.alarms.evaluate(engine.gas, 80, 10000);  // +12 %/s
+    CHECK(engine.alarms.isActive(0));
+}
+
+// Fenêtre plus courte: réaction plus rapide, au prix d'une pente plus bruitée
+TEST_CASE(rise_window_is_configurable) {
+    Engine engine(LEAK_RULE, 1);
+    engine.alarms.setRiseWindow(200);
+    feedGas(engine, 2000, [](unsigned long) { return 400; });
+
+    const float rampLsbPerMs = 20 / PERCENT_PER_LSB / 1000;
+    unsigned long rampStart = millis();
+    feedGas(engine, 1000, [&](unsigned long t) { return 400 + (int)(t * rampLsbPerMs); });
+    const Transition* fired = find(0, true);
+    REQUIRE(fired != nullptr);
+    CHECK(fired->at - rampStart <= 300);
+}
+
+// Niveau d'eau (sous 20 % pendant 2 s, hystérésis 3): une baisse brève n'alarme pas,
+// la retombée attend 23 %
+TEST_CASE(below_rule_needs_duration_and_hysteresis) {
+    Engine engine(DEFAULT_RULES, DEFAULT_COUNT);
+    const uint8_t water = 2;
+    auto feedWater = [&](float value, unsigned long durationMs) {
+        for (unsigned long t = 0; t < durationMs; t += 100) {
+            engine.alarms.evaluate(engine.waterLevel, value, millis());
+            host::advance(100);
+        }
+    };
+
+    feedWater(50, 1000);
+    feedWater(15, 1500);
+    feedWater(50, 500);
+    CHECK(!engine.alarms.isActive(water));
+
+    feedWater(15, 2100);
+    CHECK(engine.alarms.isActive(water));
+    feedWater(22, 1000);
+    CHECK(engine.alarms.isActive(water));
+    feedWater(24, 100);
+    CHECK(!engine.alarms.isActive(water));
+    CHECK_EQ(transitions.size(), 2);
+
+    // Règle désactivée (humidité du sol): jamais évaluée
+    feedWater(50, 100);
+    for (int i = 0; i < 700; i++) {
+        engine.alarms.evaluate(engine.soilMoisture, 5, millis());
+        host::advance(100);
+    }
+    CHECK(!engine.alarms.isActive(3));
+}
+
+// Message complet (chaînes recopiées par deserializeJson), règle ajoutée en fin de
+// table et retrouvée au démarrage suivant; suppression par {"delete":true}
+TEST_CASE(json_update_is_saved_and_reloaded) {
+    prepareStorage();
+    AlarmRuleStore store;
+    {
+        Engine engine(DEFAULT_RULES, DEFAULT_COUNT, &store);
+        const char* json = "{\"rule\":4,\"input\":\"niveau_eau\",\"condition\":\"above\",\"threshold\":95,"
+                           "\"hysteresis\":2,\"duration_ms\":500,\"action\":7,\"enabled\":true}";
+        REQUIRE(engine.alarms.applyJson(json, strlen(json)));
+        CHECK_EQ(engine.alarms.size(), DEFAULT_COUNT + 1);
+
+        const char* update = "{\"rule\":1,\"threshold\":15}";
+        REQUIRE(engine.alarms.applyJson(update, strlen(update)));
+        const char* unknown = "{\"rule\":0,\"condition\":\"fast\"}";
+        CHECK(!engine.alarms.applyJson(unknown, strlen(unknown)));
+        const char* outOfRange = "{\"rule\":9}";
+        CHECK(!engine.alarms.applyJson(outOfRange, strlen(outOfRange)));
+    }
+
+    Engine reloaded(DEFAULT_RULES, DEFAULT_COUNT, &store);
+    REQUIRE(reloaded.alarms.size() == DEFAULT_COUNT + 1);
+    const AlarmRule& added = reloaded.alarms.getRule(4);
+    CHECK_STR(added.input, "niveau_eau");
+    CHECK_EQ(added.condition, ALARM_ABOVE);
+    CHECK_NEAR(added.threshold, 95, 0.001f);
+    CHECK_NEAR(added.hysteresis, 2, 0.001f);
+    CHECK_EQ(added.durationMs, 500);
+    CHECK_EQ(added.action, 7);
+    CHECK_EQ(added.enabled, 1);
+    CHECK_NEAR(reloaded.alarms.getRule(1).threshold, 15, 0.001f);
+    CHECK_EQ(reloaded.alarms.getRule(1).condition, ALARM_RISE);
+
+    const char* remove = "{\"rule\":0,\"delete\":true}";
+    REQUIRE(reloaded.alarms.applyJson(remove, strlen(remove)));
+    Engine afterDelete(DEFAULT_RULES, DEFAULT_COUNT, &store);
+    CHECK_EQ(afterDelete.alarms.size(), DEFAULT_COUNT);
+    CHECK_EQ(afterDelete.alarms.getRule(0).condition, ALARM_RISE);
+}
+
+// Jeu enregistré scellé par le CRC32 de ConfigStore; un octet altéré ramène les
+// règles du sketch
+TEST_CASE(corrupted_rules_fall_back_to_defaults) {
+    prepareStorage();
+    AlarmRuleStore store;
+    {
+        Engine engine(DEFAULT_RULES, DEFAULT_COUNT, &store);
+        REQUIRE(engine.alarms.removeRule(3));
+    }
+
+    AlarmRuleSet stored;
+    REQUIRE(store.load(stored));
+    CHECK_EQ(stored.crc, ~ConfigStore::crc32((const uint8_t*)&stored, offsetof(AlarmRuleSet, crc)));
+    {
+        Engine engine(DEFAULT_RULES, DEFAULT_COUNT, &store);
+        CHECK_EQ(engine.alarms.size(), DEFAULT_COUNT - 1);
+    }
+
+    stored.rules[0].threshold = 90;
+    REQUIRE(store.save(stored));
+    Engine engine(DEFAULT_RULES, DEFAULT_COUNT, &store);
+    CHECK_EQ(engine.alarms.size(), DEFAULT_COUNT);
+    CHECK_NEAR(engine.alarms.getRule(0).threshold, 30, 0.001f);
+}
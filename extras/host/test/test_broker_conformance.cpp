@@ -0,0 +1,335 @@
+// RonoBoxMQTT sur de vrais sockets TCP (WiFiClient de l'hôte) face à un vrai broker
+// lancé pour chaque cas sur 127.0.0.1: mosquitto s'il est installé, sinon
+// tools/mini_broker.py (commande RONOBOX_BROKER_COMMAND choisie par CMake). Horloge
+// réelle: keepalive, délais et débit sont ceux du système.
+
+#include "HostTest.h"
+
+#include <RonoBoxMQTT.h>
+#include <WiFi.h>
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <netinet/in.h>
+#include <signal.h>
+#include <spawn.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+extern char** environ;
+
+namespace {
+
+const IPAddress LOCALHOST(127, 0, 0, 1);
+
+// Socket d'écoute sur un port libre de 127.0.0.1 (0 si impossible)
+int listenLocal(int backlog, uint16_t& port) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) return -1;
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (bind(sock, (sockaddr*)&address, sizeof(address)) < 0 || listen(sock, backlog) < 0 ||
+        getsockname(sock, (sockaddr*)&address, &length) < 0) {
+        close(sock);
+        return -1;
+    }
+    port = ntohs(address.sin_port);
+    return sock;
+}
+
+bool acceptsConnections(uint16_t port) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bool open = connect(sock, (sockaddr*)&address, sizeof(address)) == 0;
+    close(sock);
+    return open;
+}
+
+// Broker du cas en cours, arrêté à la fin du cas
+struct BrokerProcess {
+    pid_t pid = -1;
+    uint16_t port = 0;
+
+    BrokerProcess() {
+        int probe = listenLocal(1, port);   // Port libre, rendu au broker
+        if (probe < 0) return;
+        close(probe);
+
+        char command[512];
+        snprintf(command, sizeof(command), "exec " RONOBOX_BROKER_COMMAND " >/dev/null 2>&1", (unsigned)port);
+        char* const argv[] = { (char*)"sh", (char*)"-c", command, nullptr };
+        if (posix_spawn(&pid, "/bin/sh", nullptr, nullptr, argv, environ) != 0) pid = -1;
+    }
+
+    ~BrokerProcess() {
+        if (pid <= 0) return;
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+    }
+
+    bool ready() {
+        for (int i = 0; i < 500 && pid > 0; i++) {
+            if (acceptsConnections(port)) return true;
+            delay(10);
+        }
+        return false;
+    }
+};
+
+struct Delivery {
+    uint16_t packetId;
+    bool delivered;
+};
+
+struct Peer {
+    WiFiClient socket;
+    RonoBoxMQTT mqtt;
+    std::vector<std::pair<std::string, std::string>> received;
+    std::vector<Delivery> deliveries;
+
+    explicit Peer(uint16_t port) : mqtt(socket) {
+        mqtt.setServer(LOCALHOST, port);
+        mqtt.setCallback([this](char* topic, uint8_t* payload, unsigned int length) {
+            received.emplace_back(topic, std::string((const char*)payload, length));
+        });
+        mqtt.onDelivery([this](uint16_t packetId, bool delivered) { deliveries.push_back({ packetId, delivered }); });
+    }
+};
+
+// Tours de loop() de chaque client jusqu'à done() ou maxMs de temps réel
+template <typename Done>
+bool pumpUntil(std::initializer_list<Peer*> peers, Done done, unsigned long maxMs = 5000) {
+    unsigned long start = millis();
+    while (millis() - start < maxMs) {
+        for (Peer* peer : peers) peer->mqtt.loop();
+        if (done()) return true;
+        delayMicroseconds(200);
+    }
+    return false;
+}
+
+void pump(std::initializer_list<Peer*> peers, unsigned long durationMs) {
+    pumpUntil(peers, [] { return false; }, durationMs);
+}
+
+bool open(Peer& peer, const char* clientId, const char* willTopic = nullptr, const char* will = nullptr) {
+    if (!peer.mqtt.connect(clientId, nullptr, nullptr, willTopic, 0, false, will)) return false;
+    return pumpUntil({ &peer }, [&] { return peer.mqtt.connected(); });
+}
+
+// Abonnement confirmé: un message témoin publié après le SUBSCRIBE revient
+bool subscribe(Peer& peer, const char* filter, uint8_t qos = 0) {
+    if (!peer.mqtt.subscribe(filter, qos)) return false;
+    std::string probe = std::string(filter);
+    probe = probe.substr(0, probe.find('#')) + "temoin";
+    if (!peer.mqtt.publish(probe.c_str(), "1")) return false;
+    bool seen = pumpUntil({ &peer }, [&] {
+        for (const auto& message : peer.received) {
+            if (message.first == probe) return true;
+        }
+        return false;
+    });
+    peer.received.clear();
+    return seen;
+}
+
+void startRealTime() {
+    host::useRealClock();
+    WiFi.mode(WIFI_STA);
+    WiFi.begin("ssid", "password");
+}
+
+} // namespace
+
+// CONNECT/CONNACK, SUBSCRIBE avec joker, aller-retour QoS0 d'un petit et d'un grand
+// paquet (longueur sur deux octets, écrit en plusieurs tranches), message retenu
+// rendu à un nouvel abonné
+TEST_CASE(qos0_round_trip_and_retained) {
+    startRealTime();
+    BrokerProcess broker;
+    REQUIRE(broker.ready());
+
+    Peer peer(broker.port);
+    REQUIRE(peer.mqtt.setBufferSize(4096));
+    REQUIRE(peer.mqtt.setQueueSize(8192));
+    REQUIRE(open(peer, "rb-conformance"));
+    REQUIRE(subscribe(peer, "rb/test/#"));
+
+    const std::string large(3000, 'x');
+    REQUIRE(peer.mqtt.publish("rb/test/petit", "21.5"));
+    REQUIRE(peer.mqtt.publish("rb/test/grand", large.c_str()));
+    REQUIRE(pumpUntil({ &peer }, [&] { return peer.received.size() == 2; }));
+    CHECK_STR(peer.received[0].first.c_str(), "rb/test/petit");
+    CHECK_STR(peer.received[0].second.c_str(), "21.5");
+    CHECK_STR(peer.received[1].first.c_str(), "rb/test/grand");
+    CHECK(peer.received[1].second == large);
+
+    REQUIRE(peer.mqtt.publish("rb/retenu", "online", true));
+    pump({ &peer }, 100);
+    Peer late(broker.port);
+    REQUIRE(open(late, "rb-late"));
+    REQUIRE(late.mqtt.subscribe("rb/retenu"));
+    REQUIRE(pumpUntil({ &late }, [&] { return !late.received.empty(); }));
+    CHECK_STR(late.received[0].second.c_str(), "online");
+}
+
+// QoS1: PUBACK du broker (livraison annoncée), et message QoS1 reçu puis acquitté
+TEST_CASE(qos1_is_acknowledged_both_ways) {
+    startRealTime();
+    BrokerProcess broker;
+    REQUIRE(broker.ready());
+
+    Peer peer(broker.port);
+    REQUIRE(open(peer, "rb-qos1"));
+    REQUIRE(subscribe(peer, "rb/alerte/#", 1));
+
+    REQUIRE(peer.mqtt.publish("rb/alerte/gaz", "75", false, 1));
+    REQUIRE(pumpUntil({ &peer }, [&] { return !peer.deliveries.empty() && !peer.received.empty(); }));
+    CHECK(peer.deliveries[0].delivered);
+    CHECK_STR(peer.received[0].second.c_str(), "75");
+    CHECK_EQ(peer.mqtt.getInflightCount(), 0);
+    CHECK_EQ(peer.mqtt.getRetransmitCount(), 0);
+    CHECK(peer.mqtt.getLastAckLatency() < 1000);
+
+    // Session gardée: le broker n'a pas coupé faute d'accusé
+    pump({ &peer }, 200);
+    CHECK(peer.mqtt.connected());
+}
+
+// Dernière volonté publiée quand le socket se ferme sans DISCONNECT, pas après
+// disconnect()
+TEST_CASE(will_follows_abrupt_close_only) {
+    startRealTime();
+    BrokerProcess broker;
+    REQUIRE(broker.ready());
+
+    Peer watcher(broker.port);
+    REQUIRE(open(watcher, "rb-watcher"));
+    REQUIRE(subscribe(watcher, "rb/status/#"));
+
+    Peer device(broker.port);
+    REQUIRE(open(device, "rb-device", "rb/status/device", "offline"));
+    device.mqtt.disconnect();
+    pump({ &watcher }, 300);
+    CHECK(watcher.received.empty());
+
+    REQUIRE(open(device, "rb-device", "rb/status/device", "offline"));
+    device.socket.stop();   // Lien coupé: ni DISCONNECT ni FIN attendu côté client
+    REQUIRE(pumpUntil({ &watcher }, [&] { return !watcher.received.empty(); }));
+    CHECK_STR(watcher.received[0].first.c_str(), "rb/status/device");
+    CHECK_STR(watcher.received[0].second.c_str(), "offline");
+}
+
+// Keepalive d'une seconde, session inactive trois secondes: le PINGREQ la maintient
+TEST_CASE(keepalive_holds_idle_session) {
+    startRealTime();
+    BrokerProcess broker;
+    REQUIRE(broker.ready());
+
+    Peer peer(broker.port);
+    peer.mqtt.setKeepAlive(1);
+    REQUIRE(open(peer, "rb-keepalive"));
+    pump({ &peer }, 3000);
+    CHECK(peer.mqtt.connected());
+    CHECK_EQ(peer.mqtt.state(), RonoBoxMQTT::CONNECTED);
+}
+
+// Débit: 5000 messages QoS0 (payload de 64 octets) publiés au rythme où la file se
+// vide, tous reçus en ordre; puis 500 alertes QoS1 par la fenêtre de MAX_INFLIGHT
+TEST_CASE(throughput_qos0_and_qos1) {
+    startRealTime();
+    BrokerProcess broker;
+    REQUIRE(broker.ready());
+
+    Peer peer(broker.port);
+    REQUIRE(open(peer, "rb-throughput"));
+    REQUIRE(subscribe(peer, "rb/debit/#"));
+
+    const unsigned COUNT = 5000;
+    std::string payload(64, 'd');
+    auto started = std::chrono::steady_clock::now();
+    for (unsigned sent = 0; sent < COUNT;) {
+        snprintf(&payload[0], 9, "%08u", sent);
+        payload[8] = '-';
+        if (peer.mqtt.publish("rb/debit/qos0", payload.c_str())) {
+            sent++;
+        } else {
+            peer.mqtt.loop();
+        }
+        REQUIRE(peer.mqtt.connected());
+    }
+    REQUIRE(pumpUntil({ &peer }, [&] { return peer.received.size() == COUNT; }, 20000));
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    bool ordered = true;
+    for (unsigned i = 0; i < COUNT; i++) {
+        if (strtoul(peer.received[i].second.c_str(), nullptr, 10) != i) ordered = false;
+    }
+    CHECK(ordered);
+    printf("{\"qos0_msgs_per_s\":%.0f}\n", COUNT / seconds);
+
+    const unsigned ALERTS = 500;
+    peer.received.clear();
+    started = std::chrono::steady_clock::now();
+    for (unsigned sent = 0; sent < ALERTS;) {
+        if (peer.mqtt.publish("rb/debit/qos1", "alerte", false, 1)) {
+            sent++;
+        } else {
+            peer.mqtt.loop();
+        }
+        REQUIRE(peer.mqtt.connected());
+    }
+    REQUIRE(pumpUntil({ &peer }, [&] { return peer.deliveries.size() == ALERTS; }, 20000));
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    unsigned delivered = 0;
+    for (const Delivery& delivery : peer.deliveries) delivered += delivery.delivered;
+    CHECK_EQ(delivered, ALERTS);
+    CHECK_EQ(peer.mqtt.getDroppedCount(), 0);
+    printf("{\"qos1_msgs_per_s\":%.0f}\n", ALERTS / seconds);
+}
+
+// Broker qui ne répond pas au SYN (file d'attente d'accept() pleine): connect() rend
+// la main après setConnectTimeout(), sans attendre le délai du cœur
+TEST_CASE(connect_is_bounded_by_connect_timeout) {
+    startRealTime();
+    uint16_t port = 0;
+    int listener = listenLocal(0, port);
+    REQUIRE(listener >= 0);
+
+    // Remplit la file d'accept(): les SYN suivants sont ignorés par le noyau
+    std::vector<int> fillers;
+    for (int i = 0; i < 4; i++) {
+        int sock = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        connect(sock, (sockaddr*)&address, sizeof(address));
+        fillers.push_back(sock);
+    }
+    delay(100);
+
+    Peer peer(port);
+    peer.mqtt.setConnectTimeout(300);
+    auto started = std::chrono::steady_clock::now();
+    bool opened = peer.mqtt.connect("rb-timeout");
+    long elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - started).count();
+    CHECK(!opened);
+    CHECK_EQ(peer.mqtt.state(), RonoBoxMQTT::CONNECT_FAILED);
+    CHECK(elapsedMs >= 250);
+    CHECK(elapsedMs < 1000);
+
+    for (int sock : fillers) close(sock);
+    close(listener);
+}
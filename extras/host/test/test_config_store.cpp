@@ -0,0 +1,221 @@
+// ConfigStore sur la flash émulée de chaque cible (NVS sur ESP32, secteur EEPROM sur
+// ESP8266): sauvegarde A/B en une écriture, validation au démarrage, coupures de courant
+
+#include "HostTest.h"
+
+#include <ConfigStore.h>
+#include <EEPROM.h>
+#include <Preferences.h>
+
+namespace {
+
+ConfigRecord makeRecord(const char* ssid, uint16_t port = 1883) {
+    ConfigRecord record;
+    memset(&record, 0, sizeof(record));
+    ConfigStore::copyField(record.wifiSSID, sizeof(record.wifiSSID), ssid);
+    ConfigStore::copyField(record.wifiPassword, sizeof(record.wifiPassword), "motdepasse");
+    ConfigStore::copyField(record.mqttServer, sizeof(record.mqttServer), "192.168.1.10");
+    record.mqttPort = port;
+    return record;
+}
+
+// Écritures flash: put NVS, ou effacement + réécriture du secteur EEPROM
+unsigned flashWrites() {
+    return PlatformConfig::HAS_NVS ? host::nvsWriteCount() : host::eepromCommitCount();
+}
+
+// Coupure pendant la prochaine écriture, après `bytes` octets sur ESP8266
+// (un put NVS est atomique: il a lieu ou pas)
+void losePowerDuringNextWrite(long bytes) {
+    if (PlatformConfig::HAS_NVS) {
+        host::nvsPowerLossAfter(0);
+    } else {
+        host::eepromPowerLossAfter(bytes);
+    }
+}
+
+// Redémarrage: nouvelle instance qui relit la flash
+struct Boot {
+    PlatformConfigStorage storage;
+    ConfigStore store;
+
+    Boot() : store(storage) {
+        host::nvsPowerLossAfter(-1);
+        host::powerCycle();
+        store.begin();
+    }
+};
+
+} // namespace
+
+TEST_CASE(blank_flash_has_no_config) {
+    Boot boot;
+    ConfigRecord record;
+    CHECK(!boot.store.load(record));
+}
+
+TEST_CASE(save_is_one_write_and_survives_reboot) {
+    {
+        Boot boot;
+        ConfigRecord record = makeRecord("maison", 1884);
+        unsigned writes = flashWrites();
+        REQUIRE(boot.store.save(record));
+        CHECK_EQ(flashWrites() - writes, 1);
+    }
+
+    Boot boot;
+    ConfigRecord loaded;
+    REQUIRE(boot.store.load(loaded));
+    CHECK_STR(loaded.wifiSSID, "maison");
+    CHECK_STR(loaded.mqttServer, "192.168.1.10");
+    CHECK_EQ(loaded.mqttPort, 1884);
+    CHECK_EQ(loaded.sequence, 1);
+}
+
+// Les sauvegardes alternent entre les deux emplacements, la plus récente gagne
+TEST_CASE(saves_alternate_slots) {
+    Boot boot;
+    for (int i = 1; i <= 5; i++) {
+        char ssid[16];
+        snprintf(ssid, sizeof(ssid), "reseau-%d", i);
+        ConfigRecord record = makeRecord(ssid);
+        REQUIRE(boot.store.save(record));
+    }
+
+    ConfigRecord slots[2];
+    REQUIRE(boot.storage.read(0, slots[0]));
+    REQUIRE(boot.storage.read(1, slots[1]));
+    CHECK_STR(slots[0].wifiSSID, "reseau-5");   // 1, 3, 5 dans l'emplacement 0
+    CHECK_STR(slots[1].wifiSSID, "reseau-4");
+
+    Boot reboot;
+    ConfigRecord loaded;
+    REQUIRE(reboot.store.load(loaded));
+    CHECK_STR(loaded.wifiSSID, "reseau-5");
+    CHECK_EQ(loaded.sequence, 5);
+}
+
+// Emplacement le plus récent corrompu (CRC faux): retour à la configuration précédente
+TEST_CASE(corrupted_slot_falls_back_to_previous) {
+    {
+        Boot boot;
+        ConfigRecord first = makeRecord("ancien");
+        ConfigRecord second = makeRecord("nouveau");
+        REQUIRE(boot.store.save(first));
+        REQUIRE(boot.store.save(second));
+
+        ConfigRecord damaged;
+        REQUIRE(boot.storage.read(1, damaged));
+        damaged.wifiPassword[3] ^= 0x40;
+        REQUIRE(boot.storage.write(1, damaged));
+    }
+
+    Boot boot;
+    ConfigRecord loaded;
+    REQUIRE(boot.store.load(loaded));
+    CHECK_STR(loaded.wifiSSID, "ancien");
+
+    // La sauvegarde suivante remplace l'emplacement abîmé, pas la copie valide
+    ConfigRecord next = makeRecord("suivant");
+    REQUIRE(boot.store.save(next));
+    ConfigRecord kept;
+    REQUIRE(boot.storage.read(0, kept));
+    CHECK_STR(kept.wifiSSID, "ancien");
+}
+
+// Enregistrement d'un autre format (taille ou version): ignoré plutôt que mal relu
+TEST_CASE(foreign_format_is_rejected) {
+    Boot boot;
+    ConfigRecord record = makeRecord("maison");
+    record.magic = ConfigStore::MAGIC;
+    record.version = ConfigStore::VERSION;
+    record.size = sizeof(ConfigRecord) - 4;
+    record.sequence = 1;
+    record.crc = ~ConfigStore::crc32((const uint8_t*)&record, offsetof(ConfigRecord, crc));
+    REQUIRE(boot.storage.write(0, record));
+
+    ConfigRecord loaded;
+    CHECK(!boot.store.load(loaded));
+}
+
+// Numéro de séquence qui repasse par 0: la comparaison se fait modulo 2^32
+TEST_CASE(sequence_wraps) {
+    Boot boot;
+    ConfigRecord older = makeRecord("avant");
+    ConfigRecord newer = makeRecord("apres");
+    older.magic = newer.magic = ConfigStore::MAGIC;
+    older.version = newer.version = ConfigStore::VERSION;
+    older.size = newer.size = sizeof(ConfigRecord);
+    older.sequence = 0xFFFFFFFF;
+    newer.sequence = 0;
+    older.crc = ~ConfigStore::crc32((const uint8_t*)&older, offsetof(ConfigRecord, crc));
+    newer.crc = ~ConfigStore::crc32((const uint8_t*)&newer, offsetof(ConfigRecord, crc));
+    REQUIRE(boot.storage.write(0, older));
+    REQUIRE(boot.storage.write(1, newer));
+
+    ConfigRecord loaded;
+    REQUIRE(boot.store.load(loaded));
+    CHECK_STR(loaded.wifiSSID, "apres");
+}
+
+// Coupure pendant la sauvegarde, à chaque octet de l'écriture: au redémarrage on relit
+// l'ancienne ou la nouvelle configuration, jamais un enregistrement à moitié écrit.
+// Limite de l'ESP8266: commit() efface tout le secteur avant de le réécrire, les deux
+// emplacements compris. Une coupure avant la fin de l'emplacement 0 perd donc les deux
+// copies (retour au portail de configuration); seul le NVS de l'ESP32 garantit
+// l'ancienne configuration dans tous les cas.
+TEST_CASE(power_loss_during_save) {
+    const long sweep = PlatformConfig::HAS_NVS ? 1 : (long)(2 * sizeof(ConfigRecord) + 8);
+
+    for (long lostAfter = 0; lostAfter < sweep; lostAfter++) {
+        for (uint8_t saves = 1; saves <= 2; saves++) {   // Nouvelle config vers l'emplacement 1 puis 0
+            host::eraseNvs();
+            host::eraseEeprom();
+            {
+                Boot boot;
+                for (uint8_t i = 0; i < saves; i++) {
+                    ConfigRecord old = makeRecord("ancien");
+                    REQUIRE(boot.store.save(old));
+                }
+                ConfigRecord fresh = makeRecord("nouveau");
+                losePowerDuringNextWrite(lostAfter);
+                CHECK(!boot.store.save(fresh));
+            }
+
+            Boot boot;
+            ConfigRecord loaded;
+            bool found = boot.store.load(loaded);
+            if (PlatformConfig::HAS_NVS || lostAfter >= (long)sizeof(ConfigRecord)) {
+                if (!found) {
+                    HostTest::fail(__FILE__, __LINE__, "configuration perdue (coupure après %ld octets)", lostAfter);
+                    continue;
+                }
+            }
+            if (found) {
+                bool oldOrNew = strcmp(loaded.wifiSSID, "ancien") == 0 || strcmp(loaded.wifiSSID, "nouveau") == 0;
+                CHECK(oldOrNew);
+                CHECK_STR(loaded.wifiPassword, "motdepasse");
+            }
+            // Sur NVS, la sauvegarde refusée n'a rien changé
+            if (PlatformConfig::HAS_NVS && found) CHECK_STR(loaded.wifiSSID, "ancien");
+        }
+    }
+}
+
+TEST_CASE(clear_erases_both_slots) {
+    {
+        Boot boot;
+        ConfigRecord record = makeRecord("maison");
+        REQUIRE(boot.store.save(record));
+        REQUIRE(boot.store.save(record));
+        REQUIRE(boot.store.clear());
+    }
+    Boot boot;
+    ConfigRecord loaded;
+    CHECK(!boot.store.load(loaded));
+
+    // Après effacement, la numérotation repart de 1
+    ConfigRecord record = makeRecord("neuf");
+    REQUIRE(boot.store.save(record));
+    CHECK_EQ(record.sequence, 1);
+}
@@ -0,0 +1,188 @@
+// Payloads de découverte Home Assistant: octet pour octet identiques à ceux de
+// l'ancien constructeur (DynamicJsonDocument sérialisé dans une String), et construits
+// sans aucune allocation sur le tas
+
+#include "DeviceHarness.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+const IPAddress BROKER(10, 0, 0, 2);
+
+constexpr DeviceEntity MODEL[] = {
+    sensorEntity("salon", "temperature", "temperature", "°C", "Température Salon", 1),
+    sensorEntity("salon", "gaz", "", "ppm", "Détection de gaz (MQ2)"),            // Sans device_class
+    sensorEntity("cuisine", "niveau", "moisture", "", "Niveau \"cuve\""),          // Sans unité, guillemets
+    binarySensorEntity("salon", "presence", "motion", "Présence détectée"),
+    switchEntity("chambre", "lampe", "Lampe Chambre", [](const MQTTSpan&, const MQTTSpan&) {}),
+    commandEntity("salon", "alarme", [](const MQTTSpan&, const MQTTSpan&) {}),      // Non annoncée
+};
+
+// Constructeur d'origine (annonce groupée avant les buffers fixes), recopié tel quel:
+// document alloué sur le tas, topics et identifiants en String
+class LegacyDiscovery {
+public:
+    struct Entity {
+        const char* component;   // sensor, binary_sensor, switch
+        const char* location;
+        const char* object;
+        const char* deviceClass;
+        const char* unit;
+        const char* friendlyName;
+    };
+
+    LegacyDiscovery(MQTTTopicManager& topicManager) : topics(topicManager) {}
+
+    String availabilityTopic() {
+        return String(topics.baseTopic()) + "/status";
+    }
+
+    // Identifiant commun à toutes les entités (préfixe de leurs unique_id)
+    String deviceId() {
+        #ifdef ESP32
+            return "esp32_" + topics.getMacAddress();
+        #else
+            return "esp8266_" + topics.getMacAddress();
+        #endif
+    }
+
+    void buildConfig(const Entity& entity, String& topic, String& payload) {
+        #ifdef ESP32
+            DynamicJsonDocument doc(1024);
+        #else
+            DynamicJsonDocument doc(512);
+        #endif
+
+        bool isSwitch = strcmp(entity.component, "switch") == 0;
+        String id = deviceId();
+
+        doc["name"] = entity.friendlyName;
+        if (entity.deviceClass[0] != '\0') doc["device_class"] = entity.deviceClass;
+        if (isSwitch) doc["command_topic"] = topics.getTopic(entity.location, entity.object, "set");
+        doc["state_topic"] = topics.getTopic(entity.location, entity.object, "state");
+        if (entity.unit[0] != '\0') doc["unit_of_measurement"] = entity.unit;
+        doc["unique_id"] = id + "_" + entity.object;
+        doc["availability_topic"] = availabilityTopic();
+
+        JsonObject device = doc.createNestedObject("device");
+        JsonArray identifiers = device.createNestedArray("identifiers");
+        identifiers.add(id);
+        device["name"] = "RonoBox " + topics.getMacAddress();
+        device["manufacturer"] = "RonoBox";
+        #ifdef ESP32
+            device["model"] = "ESP32";
+        #else
+            device["model"] = "ESP8266";
+        #endif
+
+        // Topics historiques conservés pour que Home Assistant retrouve ses entités
+        topic = "homeassistant/";
+        topic += entity.component;
+        topic += "/";
+        if (!isSwitch) {
+            topic += entity.location;
+            topic += "_";
+        }
+        topic += entity.object;
+        topic += "/config";
+
+        payload = "";
+        serializeJson(doc, payload);
+    }
+
+private:
+    MQTTTopicManager& topics;
+};
+
+struct Config {
+    std::string topic;
+    std::string payload;
+};
+
+// Sortie de l'ancien constructeur pour les entités annoncées de MODEL, et allocations
+// faites pendant la construction des configurations
+std::vector<Config> legacyConfigs(uint64_t* allocations = nullptr) {
+    FakeBroker unused;
+    RonoBoxMQTT client(unused);
+    MQTTTopicManager topics(client, "A1B2C3D4E5F6");
+    LegacyDiscovery legacy(topics);
+
+    std::vector<Config> configs;
+    for (const DeviceEntity& entity : MODEL) {
+        if (!entity.announced()) continue;
+        LegacyDiscovery::Entity old = { entity.component(), entity.location, entity.name,
+                                        entity.deviceClass, entity.unit, entity.friendlyName };
+        String topic;
+        String payload;
+        uint64_t count = host::countAllocations([&] { legacy.buildConfig(old, topic, payload); });
+        if (allocations) *allocations += count;
+        configs.push_back({ topic.c_str(), payload.c_str() });
+    }
+    return configs;
+}
+
+std::vector<Config> announcedConfigs(const FakeBroker& broker) {
+    std::vector<Config> configs;
+    for (const FakeBroker::Message& message : broker.messages()) {
+        if (message.topic.compare(0, 14, "homeassistant/") == 0) {
+            configs.push_back({ message.topic, message.payload });
+        }
+    }
+    return configs;
+}
+
+} // namespace
+
+TEST_CASE(payloads_match_previous_builder) {
+    DeviceHarness<> harness;
+    harness.device.setModel(MODEL);
+    harness.device.setDiagnosticsInterval(0);
+    harness.device.begin(BROKER);
+    REQUIRE(harness.runUntilOnline());
+    harness.run(200);
+
+    std::vector<Config> expected = legacyConfigs();
+    std::vector<Config> actual = announcedConfigs(harness.broker);
+    REQUIRE(expected.size() == 5);
+    REQUIRE(actual.size() == expected.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        CHECK_STR(actual[i].topic.c_str(), expected[i].topic.c_str());
+        CHECK_STR(actual[i].payload.c_str(), expected[i].payload.c_str());
+    }
+}
+
+// Annonce complète (empreinte, construction des 5 configurations, mise en file):
+// aucune allocation, là où l'ancien constructeur allouait pour chaque entité.
+// L'annonce mesurée est celle demandée par Home Assistant, une fois l'empreinte
+// relue: la lecture NVS du premier démarrage n'entre pas dans la mesure.
+TEST_CASE(announce_does_not_allocate) {
+    DeviceHarness<> harness;
+    harness.device.setModel(MODEL);
+    harness.device.setDiagnosticsInterval(0);
+    harness.device.begin(BROKER);
+    REQUIRE(harness.runUntilOnline());
+    harness.run(200);
+
+    HADiscoveryConfig& discovery = harness.device.getHAConfig();
+    uint32_t sent = harness.broker.getBytesReceived();
+    harness.broker.setRecording(false);   // Seules les allocations de l'appareil comptent
+    discovery.requestFullAnnounce();
+    bool ok = false;
+    uint64_t announceAllocations = host::countAllocations([&] { ok = discovery.announce(); });
+    harness.broker.setRecording(true);
+    CHECK(ok);
+    harness.run(200);
+    CHECK(harness.broker.getBytesReceived() - sent > 5 * 250);   // Les 5 configurations sont parties
+
+    uint64_t legacyAllocations = 0;
+    legacyConfigs(&legacyAllocations);
+
+    printf("{\"name\":\"discovery_payload\",\"target\":\"%s\",\"before_allocs\":%llu,\"after_allocs\":%llu}\n",
+           RonoBoxPlatform::name(), (unsigned long long)legacyAllocations,
+           (unsigned long long)announceAllocations);
+
+    CHECK_EQ(announceAllocations, 0);
+    CHECK(legacyAllocations >= 5);   // Au moins un document par entité
+}
@@ -0,0 +1,231 @@
+// Découverte Home Assistant groupée au démarrage: temps jusqu'à la première mesure
+// publiée, sur le broker en mémoire, avant (setupHA bloquant: delay(100) après chaque
+// configuration et delay(500) entre deux appels) et après (annonce du modèle sans
+// délai, reprise quand la file d'émission est pleine, rien si l'empreinte n'a pas changé)
+
+#include "DeviceHarness.h"
+
+#include <Preferences.h>
+
+#include <string>
+
+namespace {
+
+const IPAddress BROKER(10, 0, 0, 2);
+
+// Modèle de mainCode (entités annoncées et commandes)
+constexpr DeviceEntity MODEL[] = {
+    sensorEntity("salon", "temperature", "temperature", "°C", "Température Salon", 1),
+    sensorEntity("salon", "humidite", "humidity", "%", "Humidité Salon", 0),
+    alertEntity(sensorEntity("salon", "gaz", "", "ppm", "Détection de gaz (MQ2)")),
+    sensorEntity("salon", "humidite_sol", "moisture", "%", "Humidité du sol"),
+    sensorEntity("salon", "niveau_eau", "moisture", "%", "Niveau d'eau"),
+    binarySensorEntity("salon", "presence", "motion", "Présence détectée"),
+    alertEntity(binarySensorEntity("salon", "alarme", "safety", "Alarme Salon")),
+    commandEntity("salon", "lampe", [](const MQTTSpan&, const MQTTSpan&) {}),
+};
+const unsigned ANNOUNCED = 7;
+
+// Même modèle avec une entité renommée
+constexpr DeviceEntity CHANGED_MODEL[] = {
+    sensorEntity("salon", "temperature", "temperature", "°C", "Température du salon", 1),
+    sensorEntity("salon", "humidite", "humidity", "%", "Humidité Salon", 0),
+    alertEntity(sensorEntity("salon", "gaz", "", "ppm", "Détection de gaz (MQ2)")),
+    sensorEntity("salon", "humidite_sol", "moisture", "%", "Humidité du sol"),
+    sensorEntity("salon", "niveau_eau", "moisture", "%", "Niveau d'eau"),
+    binarySensorEntity("salon", "presence", "motion", "Présence détectée"),
+    alertEntity(binarySensorEntity("salon", "alarme", "safety", "Alarme Salon")),
+    commandEntity("salon", "lampe", [](const MQTTSpan&, const MQTTSpan&) {}),
+};
+
+// Nombre d'appels sendConfig de l'ancien setupHA de mainCode
+const unsigned LEGACY_CONFIGS = 6;
+
+size_t configCount(const FakeBroker& broker) {
+    size_t count = 0;
+    for (const FakeBroker::Message& message : broker.messages()) {
+        if (message.topic.compare(0, 14, "homeassistant/") == 0) count++;
+    }
+    return count;
+}
+
+// Démarrage de l'appareil jusqu'à la fin de l'annonce: LINK_ONLINE est atteint quand
+// les configurations sont dans la file d'émission, quelques tours les amènent au broker
+template <size_t N>
+bool boot(DeviceHarness<>& harness, const DeviceEntity (&model)[N]) {
+    harness.device.setModel(model);
+    harness.device.setDiagnosticsInterval(0);
+    harness.device.begin(BROKER);
+    if (!harness.runUntilOnline()) return false;
+    harness.run(200);
+    return true;
+}
+
+// Tours de loop() du sketch (une mesure par tour) jusqu'à la première température
+// reçue par le broker; retourne le temps simulé depuis begin(), 0 si jamais reçue
+template <typename Device>
+unsigned long firstTelemetryMs(DeviceHarness<Device>& harness, unsigned long maxMs = 20000) {
+    const std::string state = harness.topic("salon", "temperature");
+    unsigned long start = millis();
+    while (millis() - start < maxMs) {
+        harness.device.publishSensorData("salon", "temperature", 21.5f);
+        harness.step();
+        if (!harness.broker.on(state).empty()) return millis() - start;
+    }
+    return 0;
+}
+
+} // namespace
+
+TEST_CASE(startup_time_before_and_after) {
+    unsigned long legacyMs;
+    {
+        // Ancien chemin: setup() bloquait dans setupHA, loop() et les mesures ne
+        // commençaient qu'après les délais fixes
+        DeviceHarness<> harness;
+        bool setupDone = false;
+        harness.device.setModel(MODEL);
+        harness.device.setDiagnosticsInterval(0);
+        harness.device.onAnnounce([&] {
+            bool ok = harness.device.getHAConfig().announce();
+            for (unsigned i = 0; i < LEGACY_CONFIGS; i++) {
+                delay(100);   // Après chaque configuration
+                delay(500);   // Entre deux appels de setupHA
+            }
+            setupDone = true;
+            return ok;
+        });
+        harness.device.begin(BROKER);
+        REQUIRE(HostTest::runUntil([&] { harness.device.handle(); }, [&] { return setupDone; }, 20000));
+        unsigned long setupMs = millis();
+        unsigned long loopMs = firstTelemetryMs(harness);
+        REQUIRE(loopMs > 0);
+        legacyMs = setupMs + loopMs;
+    }
+
+    host::eraseNvs();
+    host::powerCycle();
+    host::setClock(0);
+
+    DeviceHarness<> harness;
+    harness.device.setModel(MODEL);
+    harness.device.setDiagnosticsInterval(0);
+    harness.device.begin(BROKER);
+    unsigned long batchedMs = firstTelemetryMs(harness);
+    REQUIRE(batchedMs > 0);
+    harness.run(200);
+    CHECK_EQ(configCount(harness.broker), ANNOUNCED);
+
+    printf("{\"name\":\"startup_to_first_telemetry\",\"target\":\"%s\",\"entities\":%u,"
+           "\"before_ms\":%lu,\"after_ms\":%lu}\n",
+           RonoBoxPlatform::name(), ANNOUNCED, legacyMs, batchedMs);
+
+    CHECK(legacyMs >= LEGACY_CONFIGS * 600);
+    CHECK(batchedMs < 200);   // Quelques tours de loop(): WiFi, connexion, session
+}
+
+// Une configuration retenue par entité, avec le même bloc device et le topic de disponibilité
+TEST_CASE(announce_shares_device_block_and_availability) {
+    DeviceHarness<> harness;
+    REQUIRE(boot(harness, MODEL));
+
+    const std::string availability = "\"availability_topic\":\"" + harness.availabilityTopic() + "\"";
+    const std::string device = std::string("\"device\":{\"identifiers\":[\"") + RonoBoxPlatform::name() +
+                               "_A1B2C3D4E5F6\"],\"name\":\"RonoBox A1B2C3D4E5F6\",\"manufacturer\":\"RonoBox\"";
+    size_t count = 0;
+    for (const FakeBroker::Message& message : harness.broker.messages()) {
+        if (message.topic.compare(0, 14, "homeassistant/") != 0) continue;
+        count++;
+        CHECK(message.retained);
+        CHECK(message.payload.find(availability) != std::string::npos);
+        CHECK(message.payload.find(device) != std::string::npos);
+    }
+    CHECK_EQ(count, ANNOUNCED);
+    CHECK(harness.broker.last("homeassistant/sensor/salon_temperature/config") != nullptr);
+    CHECK(harness.broker.last("homeassistant/binary_sensor/salon_presence/config") != nullptr);
+    CHECK_STR(harness.broker.retained(harness.availabilityTopic()).c_str(), "online");
+}
+
+// Redémarrage avec le même modèle: l'empreinte enregistrée évite de tout republier
+// (NVS sur ESP32, mémoire RTC conservée par ESP.restart() sur ESP8266)
+TEST_CASE(unchanged_model_is_not_announced_again) {
+    {
+        DeviceHarness<> harness;
+        REQUIRE(boot(harness, MODEL));
+        CHECK_EQ(configCount(harness.broker), ANNOUNCED);
+    }
+    unsigned writes = host::nvsWriteCount();
+    ESP.restart();
+
+    DeviceHarness<> harness;
+    REQUIRE(boot(harness, MODEL));
+    CHECK_EQ(configCount(harness.broker), 0);
+    CHECK_EQ(host::nvsWriteCount(), writes);   // Pas de nouvelle écriture flash
+}
+
+// Coupure d'alimentation: l'ESP8266 perd sa mémoire RTC et refait l'annonce, l'ESP32
+// retrouve l'empreinte en NVS
+TEST_CASE(power_cycle_keeps_hash_only_in_nvs) {
+    {
+        DeviceHarness<> harness;
+        REQUIRE(boot(harness, MODEL));
+    }
+    host::powerCycle();
+
+    DeviceHarness<> harness;
+    REQUIRE(boot(harness, MODEL));
+    CHECK_EQ(configCount(harness.broker), PlatformConfig::HAS_NVS ? 0 : ANNOUNCED);
+}
+
+TEST_CASE(changed_model_is_announced_again) {
+    {
+        DeviceHarness<> harness;
+        REQUIRE(boot(harness, MODEL));
+    }
+    ESP.restart();
+
+    DeviceHarness<> harness;
+    REQUIRE(boot(harness, CHANGED_MODEL));
+    CHECK_EQ(configCount(harness.broker), ANNOUNCED);
+    const FakeBroker::Message* renamed = harness.broker.last("homeassistant/sensor/salon_temperature/config");
+    REQUIRE(renamed != nullptr);
+    CHECK(renamed->payload.find("Température du salon") != std::string::npos);
+}
+
+// Home Assistant redémarré ("online" sur homeassistant/status): annonce complète
+// sur la session en cours, sans reconnexion
+TEST_CASE(home_assistant_restart_triggers_full_announce) {
+    DeviceHarness<> harness;
+    REQUIRE(boot(harness, MODEL));
+    harness.broker.clearMessages();
+
+    harness.broker.deliver(HADiscoveryConfig::STATUS_TOPIC, "online");
+    harness.run(200);
+    CHECK_EQ(configCount(harness.broker), ANNOUNCED);
+    CHECK_EQ(harness.broker.connectCount(), 1);
+}
+
+// Pile TCP presque pleine: l'annonce s'interrompt et reprend au tour suivant, sans
+// perdre ni répéter d'entité
+TEST_CASE(announce_resumes_when_queue_has_room) {
+    DeviceHarness<> harness;
+    harness.device.setModel(MODEL);
+    harness.device.setDiagnosticsInterval(0);
+    harness.broker.setWriteSpace(600);   // Environ une configuration par tour
+    harness.device.begin(BROKER);
+
+    bool paused = false;
+    bool online = HostTest::runUntil([&] {
+        harness.device.handle();
+        harness.broker.setWriteSpace(600);
+        paused = paused || harness.device.getHAConfig().isAnnouncing();
+    }, [&] { return harness.device.getLinkState() == LINK_ONLINE; }, 10000);
+    REQUIRE(online);
+    CHECK(paused);
+    for (int i = 0; i < 20; i++) {
+        harness.step();
+        harness.broker.setWriteSpace(600);
+    }
+    CHECK_EQ(configCount(harness.broker), ANNOUNCED);
+    CHECK(!harness.device.getHAConfig().isAnnouncing());
+}
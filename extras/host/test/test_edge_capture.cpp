@@ -0,0 +1,173 @@
+// Capture de fronts par interruption (EdgeInput): trains de fronts synthétiques,
+// rejoués soit directement (record/poll horodatés), soit par l'interruption simulée
+// de la broche. Cas du capteur de son de l'ESP8266 (anti-rebond 2 ms, période
+// réfractaire 1 s) et du PIR de mainCode (anti-rebond 50 ms).
+
+#include "HostTest.h"
+
+#include <EdgeCapture.h>
+#include <vector>
+
+namespace {
+
+const uint8_t SOUND_PIN = 12;
+const uint8_t PIR_PIN = 27;
+
+struct Edge {
+    uint32_t atUs;
+    bool level;
+};
+
+// Rejoue un train de fronts sur la broche, avec un tour de loop() (poll) toutes les
+// `loopUs`, jusqu'à `endUs`; les fronts déjà passés sont ignorés. Retourne les fronts
+// montants remontés par poll().
+std::vector<uint32_t> replay(EdgeInput& input, uint8_t pin, const std::vector<Edge>& edges,
+                             uint32_t endUs, uint32_t loopUs = 10000) {
+    std::vector<uint32_t> rises;
+    size_t next = 0;
+    while (next < edges.size() && edges[next].atUs < micros()) next++;
+    uint32_t nextLoop = micros() + loopUs;
+    while (micros() < endUs) {
+        uint32_t now = micros();
+        while (next < edges.size() && edges[next].atUs <= now) {
+            host::setPin(pin, edges[next].level);   // Interruption CHANGE
+            next++;
+        }
+        if (now >= nextLoop) {
+            EdgeEvent event;
+            while (input.poll(event)) {
+                if (event.rising) rises.push_back(event.timestamp);
+            }
+            nextLoop += loopUs;
+        }
+        host::advanceMicros(100);
+    }
+    return rises;
+}
+
+// Clap: impulsion de `widthUs`, avec des rebonds pendant les 300 premières µs
+void addClap(std::vector<Edge>& edges, uint32_t startUs, uint32_t widthUs) {
+    edges.push_back({ startUs, true });
+    edges.push_back({ startUs + 100, false });
+    edges.push_back({ startUs + 200, true });
+    edges.push_back({ startUs + widthUs, false });
+}
+
+} // namespace
+
+// Fronts rejoués sans interruption: le front descendant d'une impulsion plus courte
+// que l'anti-rebond est perdu, le niveau est recalé sur la broche au tour suivant
+TEST_CASE(short_pulse_level_is_resynced) {
+    EdgeInput input(SOUND_PIN, 2000);
+    EdgeEvent event;
+
+    CHECK(input.record(1000, true));
+    CHECK(!input.record(1800, false));   // 0,8 ms plus tard: dans le verrouillage
+    CHECK_EQ(input.getBounceCount(), 1);
+
+    REQUIRE(input.poll(event, 1900, false));
+    CHECK(event.rising);
+    CHECK(input.level());
+    CHECK(!input.poll(event, 2500, false));   // Verrouillage pas encore écoulé: on attend
+
+    REQUIRE(input.poll(event, 3000, false));
+    CHECK(!event.rising);
+    CHECK(!input.level());
+    CHECK_EQ(input.getResyncCount(), 1);
+
+    // Le clap suivant n'est plus pris pour un rebond
+    CHECK(input.record(500000, true));
+    REQUIRE(input.poll(event, 500100, true));
+    CHECK(event.rising);
+    CHECK_EQ(event.timestamp, 500000);
+}
+
+// Capteur de son de l'ESP8266: claps d'1 ms (plus courts que l'anti-rebond de 2 ms),
+// espacés de 1,2 s. Chaque clap doit basculer la lampe, pas un sur deux.
+TEST_CASE(every_short_clap_is_counted) {
+    host::setPinSilently(SOUND_PIN, LOW);
+    EdgeInput input(SOUND_PIN, 2000, 1000);
+    input.begin(INPUT);
+
+    std::vector<Edge> edges;
+    const uint32_t start = micros() + 100000;
+    for (int i = 0; i < 8; i++) addClap(edges, start + i * 1200000, 1000);
+
+    std::vector<uint32_t> rises = replay(input, SOUND_PIN, edges, start + 8 * 1200000 + 100000);
+    CHECK_EQ(rises.size(), 8);
+    CHECK(!input.level());
+    CHECK_EQ(input.getSuppressedCount(), 0);
+    CHECK(input.getBounceCount() >= 8 * 2);
+    input.end();
+}
+
+// Deuxième clap pendant la période réfractaire (1 s): écarté avec son front
+// descendant, le suivant est de nouveau accepté
+TEST_CASE(clap_within_refractory_period_is_suppressed) {
+    host::setPinSilently(SOUND_PIN, LOW);
+    EdgeInput input(SOUND_PIN, 2000, 1000);
+    input.begin(INPUT);
+
+    std::vector<Edge> edges;
+    const uint32_t start = micros() + 100000;
+    addClap(edges, start, 1000);
+    addClap(edges, start + 300000, 1000);
+    addClap(edges, start + 1300000, 1000);
+
+    std::vector<uint32_t> rises = replay(input, SOUND_PIN, edges, start + 1500000);
+    REQUIRE(rises.size() == 2);
+    CHECK_EQ(rises[0], start);
+    CHECK_EQ(rises[1], start + 1300000);
+    CHECK_EQ(input.getSuppressedCount(), 1);
+    CHECK(!input.level());
+    input.end();
+}
+
+// PIR (anti-rebond 50 ms): une détection de 20 ms remonte, puis le niveau revient
+// à OFF au lieu de rester bloqué à ON
+TEST_CASE(brief_presence_does_not_stick_on) {
+    host::setPinSilently(PIR_PIN, LOW);
+    EdgeInput input(PIR_PIN, 50000);
+    input.begin(INPUT);
+
+    const uint32_t start = micros() + 100000;
+    std::vector<Edge> edges = { { start, true }, { start + 20000, false },
+                                { start + 2000000, true }, { start + 2500000, false } };
+
+    std::vector<uint32_t> rises = replay(input, PIR_PIN, edges, start + 200000, 100000);
+    CHECK_EQ(rises.size(), 1);
+    CHECK(!input.level());
+
+    // Présence suivante, plus longue que l'anti-rebond: ON puis OFF par les fronts
+    rises = replay(input, PIR_PIN, edges, start + 2200000, 100000);
+    CHECK_EQ(rises.size(), 1);
+    CHECK(input.level());
+    rises = replay(input, PIR_PIN, edges, start + 2700000, 100000);
+    CHECK(rises.empty());
+    CHECK(!input.level());
+    CHECK_EQ(input.getResyncCount(), 1);
+    input.end();
+}
+
+// loop() bloquée pendant que les fronts s'accumulent: la file pleine perd les plus
+// récents, et le niveau se recale sur la broche une fois la file vidée
+TEST_CASE(full_queue_drops_edges_then_resyncs) {
+    EdgeInput input(SOUND_PIN, 1000);
+    uint32_t now = 0;
+    bool level = false;
+    for (int i = 0; i < 20; i++) {
+        now += 5000;
+        level = !level;
+        input.record(now, level);
+    }
+    CHECK_EQ(input.pending(), EdgeInput::QUEUE_SIZE - 1);
+    CHECK_EQ(input.getDroppedCount(), 20 - (EdgeInput::QUEUE_SIZE - 1));
+
+    // La file se termine sur un front montant, la broche est retombée à LOW
+    // (fronts perdus): 15 changements dépilés, puis le recalage
+    EdgeEvent event;
+    unsigned changes = 0;
+    while (input.poll(event, now + 10000, level)) changes++;
+    CHECK_EQ(changes, EdgeInput::QUEUE_SIZE - 1 + 1);
+    CHECK_EQ(input.level(), level);
+}
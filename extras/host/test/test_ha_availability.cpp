@@ -0,0 +1,164 @@
+// Disponibilité Home Assistant: dernière volonté "offline" retenue à chaque session,
+// "online" republié à la reconnexion, annonce complète seulement au redémarrage de
+// Home Assistant (message de naissance sur homeassistant/status), et instantané des
+// derniers états sans attendre la mesure suivante. Le broker en mémoire joue aussi
+// Home Assistant: il publie la dernière volonté quand le lien tombe sans DISCONNECT.
+
+#include "DeviceHarness.h"
+
+#include <Preferences.h>
+#include <string>
+
+namespace {
+
+const IPAddress BROKER(10, 0, 0, 2);
+
+constexpr DeviceEntity MODEL[] = {
+    sensorEntity("salon", "temperature", "temperature", "°C", "Température Salon", 1),
+    sensorEntity("salon", "humidite", "humidity", "%", "Humidité Salon", 0),
+    binarySensorEntity("salon", "presence", "motion", "Présence détectée"),
+    commandEntity("salon", "lampe", [](const MQTTSpan&, const MQTTSpan&) {}),
+};
+const unsigned ANNOUNCED = 3;
+
+size_t configCount(const FakeBroker& broker) {
+    size_t count = 0;
+    for (const FakeBroker::Message& message : broker.messages()) {
+        if (message.topic.compare(0, 14, "homeassistant/") == 0) count++;
+    }
+    return count;
+}
+
+bool boot(DeviceHarness<>& harness) {
+    harness.device.setModel(MODEL);
+    harness.device.setDiagnosticsInterval(0);
+    harness.device.begin(BROKER);
+    if (!harness.runUntilOnline()) return false;
+    harness.run(200);
+    return true;
+}
+
+// Une mesure de chaque capteur, publiée au tour suivant
+void measure(DeviceHarness<>& harness, float temperature, float humidity) {
+    harness.device.publishSensorData("salon", "temperature", temperature);
+    harness.device.publishSensorData("salon", "humidite", humidity);
+    harness.run(100);
+}
+
+// Coupure du lien sans DISCONNECT, puis reconnexion
+bool flap(DeviceHarness<>& harness) {
+    harness.broker.dropLink();
+    if (!harness.runUntilOnline(70000)) return false;
+    harness.run(200);
+    return true;
+}
+
+} // namespace
+
+// CONNECT avec dernière volonté "offline" retenue sur le topic de disponibilité des
+// configurations, "online" retenu dès la session ouverte, abonnement au statut de HA
+TEST_CASE(session_opens_with_offline_will_and_online_birth) {
+    DeviceHarness<> harness;
+    REQUIRE(boot(harness));
+
+    CHECK_STR(harness.broker.willTopic().c_str(), harness.availabilityTopic().c_str());
+    CHECK_STR(harness.broker.willMessage().c_str(), "offline");
+    CHECK(harness.broker.willRetained());
+    CHECK_STR(harness.broker.retained(harness.availabilityTopic()).c_str(), "online");
+
+    const std::vector<std::string>& subscriptions = harness.broker.subscriptions();
+    CHECK(std::find(subscriptions.begin(), subscriptions.end(), HADiscoveryConfig::STATUS_TOPIC) !=
+          subscriptions.end());
+
+    const std::string availability = "\"availability_topic\":\"" + harness.availabilityTopic() + "\"";
+    const FakeBroker::Message* config = harness.broker.last("homeassistant/sensor/salon_temperature/config");
+    REQUIRE(config != nullptr);
+    CHECK(config->payload.find(availability) != std::string::npos);
+}
+
+// Lien coupé: le broker publie "offline"; à la reconnexion "online" revient et les
+// derniers états sont republiés sans nouvelle mesure, sans refaire la découverte
+TEST_CASE(reconnect_republishes_availability_and_states_only) {
+    DeviceHarness<> harness;
+    REQUIRE(boot(harness));
+    measure(harness, 21.5f, 40);
+    const std::string temperature = harness.topic("salon", "temperature");
+    const std::string humidity = harness.topic("salon", "humidite");
+    REQUIRE(harness.broker.on(temperature).size() == 1);
+
+    harness.broker.clearMessages();
+    harness.broker.dropLink();
+    CHECK_STR(harness.broker.retained(harness.availabilityTopic()).c_str(), "offline");
+
+    unsigned writes = host::nvsWriteCount();
+    REQUIRE(harness.runUntilOnline(70000));
+    harness.run(200);
+    CHECK_STR(harness.broker.retained(harness.availabilityTopic()).c_str(), "online");
+    CHECK_EQ(configCount(harness.broker), 0);
+    CHECK_EQ(host::nvsWriteCount(), writes);
+
+    const FakeBroker::Message* lastTemperature = harness.broker.last(temperature);
+    const FakeBroker::Message* lastHumidity = harness.broker.last(humidity);
+    REQUIRE(lastTemperature != nullptr);
+    REQUIRE(lastHumidity != nullptr);
+    CHECK_STR(lastTemperature->payload.c_str(), "21.5");
+    CHECK_STR(lastHumidity->payload.c_str(), "40");
+    CHECK(lastTemperature->retained);
+    CHECK_EQ(harness.broker.on(temperature).size(), 1);   // Une seule fois
+}
+
+// Lien instable: dix coupures, aucune configuration republiée, la disponibilité suit
+TEST_CASE(flapping_link_does_not_rediscover) {
+    DeviceHarness<> harness;
+    REQUIRE(boot(harness));
+    CHECK_EQ(configCount(harness.broker), ANNOUNCED);
+    harness.broker.clearMessages();
+
+    for (int i = 0; i < 10; i++) {
+        REQUIRE(flap(harness));
+        CHECK_STR(harness.broker.retained(harness.availabilityTopic()).c_str(), "online");
+    }
+    CHECK_EQ(configCount(harness.broker), 0);
+    CHECK_EQ(harness.broker.connectCount(), 11);
+
+    // Disponibilité: un "offline" (dernière volonté) et un "online" par coupure
+    std::vector<const FakeBroker::Message*> availability = harness.broker.on(harness.availabilityTopic());
+    REQUIRE(availability.size() == 20);
+    for (size_t i = 0; i < availability.size(); i++) {
+        CHECK_STR(availability[i]->payload.c_str(), i % 2 == 0 ? "offline" : "online");
+    }
+}
+
+// Home Assistant redémarré: annonce complète et instantané des états sur la session
+// en cours; son "offline" (arrêt) ne déclenche rien
+TEST_CASE(home_assistant_birth_triggers_announce_and_state_snapshot) {
+    DeviceHarness<> harness;
+    REQUIRE(boot(harness));
+    measure(harness, 19, 55);
+    harness.broker.clearMessages();
+
+    harness.broker.deliver(HADiscoveryConfig::STATUS_TOPIC, "offline");
+    harness.run(200);
+    CHECK(harness.broker.messages().empty());
+
+    unsigned writes = host::nvsWriteCount();
+    harness.broker.deliver(HADiscoveryConfig::STATUS_TOPIC, "online");
+    harness.run(200);
+    CHECK_EQ(configCount(harness.broker), ANNOUNCED);
+    CHECK_EQ(harness.broker.on(harness.topic("salon", "temperature")).size(), 1);
+    CHECK_EQ(harness.broker.on(harness.topic("salon", "humidite")).size(), 1);
+    CHECK_EQ(harness.broker.connectCount(), 1);
+    CHECK_EQ(host::nvsWriteCount(), writes);   // Empreinte inchangée: pas d'écriture flash
+}
+
+// Un nouvel appareil sur le même broker (autre adresse MAC) a sa propre disponibilité
+TEST_CASE(availability_topic_is_per_device) {
+    DeviceHarness<> first;
+    REQUIRE(boot(first));
+    const std::string firstTopic = first.availabilityTopic();
+
+    DeviceHarness<> second("0A0B0C0D0E0F");
+    REQUIRE(boot(second));
+    CHECK(second.availabilityTopic() != firstTopic);
+    CHECK_STR(second.broker.willTopic().c_str(), second.availabilityTopic().c_str());
+}
@@ -0,0 +1,168 @@
+// Pannes de lien simulées: perte du WiFi, DNS en échec ou lent, broker déplacé ou
+// qui refuse les connexions. La machine à états doit revenir en ligne seule, sans
+// redémarrer l'ESP ni bloquer loop().
+
+#include "DeviceHarness.h"
+
+namespace {
+
+const IPAddress BROKER(10, 0, 0, 2);
+const IPAddress MOVED_BROKER(10, 0, 0, 3);
+
+void beginByName(DeviceHarness<>& harness) {
+    host::setDnsEntry("broker.local", BROKER);
+    harness.device.setDiagnosticsInterval(0);
+    harness.device.begin("broker.local");
+}
+
+} // namespace
+
+TEST_CASE(wifi_loss_recovers_without_restart) {
+    DeviceHarness<> harness;
+    harness.device.begin(BROKER);
+    REQUIRE(harness.runUntilOnline());
+
+    host::setWiFi(false);
+    harness.run(5000);
+    harness.broker.dropLink();   // Keepalive expiré côté broker pendant la coupure
+    CHECK_EQ(harness.device.getLinkState(), LINK_WIFI);
+    CHECK(host::wifiBeginCount() >= 2);   // WiFi.reconnect() relancé pendant la coupure
+
+    host::setWiFi(true);
+    CHECK(harness.runUntilOnline(60000));
+    CHECK_EQ(harness.broker.connectCount(), 2);
+    CHECK_EQ(host::restartCount(), 0);
+}
+
+// Sans réponse DNS, les requêtes s'espacent (backoff 1 s → 30 s) au lieu de partir à chaque tour
+TEST_CASE(dns_failure_is_retried_with_backoff) {
+    DeviceHarness<> harness;
+    host::setDnsFailure(true);
+    beginByName(harness);
+
+    harness.run(10000);
+    CHECK_EQ(harness.device.getLinkState(), LINK_DNS);
+    CHECK(host::dnsQueryCount() >= 3);
+    CHECK(host::dnsQueryCount() <= 6);
+    CHECK_EQ(harness.broker.connectCount(), 0);
+
+    host::setDnsFailure(false);
+    CHECK(harness.runUntilOnline(30000));
+    CHECK(harness.broker.connectedAddress() == BROKER);
+    CHECK_EQ(host::restartCount(), 0);
+}
+
+// Réponse lente: loop() continue de tourner, la requête n'est envoyée qu'une fois
+TEST_CASE(slow_dns_answer_does_not_block_loop) {
+    DeviceHarness<> harness;
+    host::setDnsDelay(2000);
+    beginByName(harness);
+
+    unsigned long loops = 0;
+    while (millis() < 1500) {
+        harness.step();
+        loops++;
+    }
+    CHECK_EQ(harness.device.getLinkState(), LINK_DNS);
+    CHECK_EQ(host::dnsQueryCount(), 1);
+    CHECK_EQ(loops, 150);
+
+    CHECK(harness.runUntilOnline(1000));
+    CHECK_EQ(host::dnsQueryCount(), 1);
+}
+
+// Le rappel de lwIP n'arrive jamais: l'attente est bornée par DNS_TIMEOUT_MS
+TEST_CASE(dns_timeout_bounds_wait) {
+    DeviceHarness<> harness;
+    host::setDnsDelay(-1);
+    beginByName(harness);
+
+    harness.run(MQTTDevice::DNS_TIMEOUT_MS - 100);
+    CHECK_EQ(host::dnsQueryCount(), 1);
+    harness.run(2000);   // Délai dépassé, puis nouvel essai après au plus 1 s de backoff
+    CHECK_EQ(host::dnsQueryCount(), 2);
+
+    host::setDnsDelay(0);
+    CHECK(harness.runUntilOnline(MQTTDevice::DNS_TIMEOUT_MS + 5000));
+}
+
+// Nouvelle adresse du broker (bail DHCP): la session tombe, le nom est résolu de nouveau
+TEST_CASE(moved_broker_is_resolved_again) {
+    DeviceHarness<> harness;
+    beginByName(harness);
+    REQUIRE(harness.runUntilOnline());
+    unsigned queries = host::dnsQueryCount();
+
+    host::setDnsEntry("broker.local", MOVED_BROKER);
+    harness.broker.listenOn(MOVED_BROKER);
+    harness.broker.dropLink();
+
+    CHECK(harness.runUntilOnline(30000));
+    CHECK(harness.broker.connectedAddress() == MOVED_BROKER);
+    CHECK(host::dnsQueryCount() > queries);
+    CHECK_EQ(host::restartCount(), 0);
+}
+
+// Broker déplacé pendant que le lien était ouvert ailleurs: l'échec TCP fait aussi
+// repasser par le DNS
+TEST_CASE(unreachable_address_triggers_new_resolution) {
+    DeviceHarness<> harness;
+    beginByName(harness);
+    harness.broker.listenOn(MOVED_BROKER);
+
+    harness.run(1000);
+    CHECK(harness.broker.connectedAddress() == BROKER);
+    CHECK(harness.device.getLinkState() != LINK_ONLINE);
+
+    host::setDnsEntry("broker.local", MOVED_BROKER);
+    CHECK(harness.runUntilOnline(30000));
+    CHECK(harness.broker.connectedAddress() == MOVED_BROKER);
+}
+
+TEST_CASE(wifi_loss_resolves_broker_again) {
+    DeviceHarness<> harness;
+    beginByName(harness);
+    REQUIRE(harness.runUntilOnline());
+    unsigned queries = host::dnsQueryCount();
+
+    host::setWiFi(false);
+    harness.run(3000);
+    host::setWiFi(true);
+    CHECK(harness.runUntilOnline(60000));
+    CHECK_EQ(host::dnsQueryCount(), queries + 1);
+}
+
+// Broker configuré par son IP: jamais de requête DNS, même après une coupure
+TEST_CASE(fixed_address_skips_dns) {
+    DeviceHarness<> harness;
+    harness.device.begin(BROKER);
+    REQUIRE(harness.runUntilOnline());
+
+    harness.broker.dropLink();
+    CHECK(harness.runUntilOnline(30000));
+    CHECK_EQ(host::dnsQueryCount(), 0);
+    CHECK_EQ(harness.broker.connectCount(), 2);
+}
+
+// Broker qui refuse les connexions: backoff exponentiel plafonné à 60 s
+TEST_CASE(refused_broker_backs_off) {
+    DeviceHarness<> harness;
+    harness.device.begin(BROKER);
+    REQUIRE(harness.runUntilOnline());
+    unsigned sessions = harness.broker.connectCount();
+    unsigned attempts = harness.broker.connectionAttempts();
+
+    harness.broker.refuseConnections(true);
+    harness.broker.dropLink();
+    harness.run(120000, 50);
+    CHECK_EQ(harness.broker.connectCount(), sessions);
+    // Délais 1, 2, 4 ... 60 s avec gigue "equal jitter": 6 à 9 essais en deux minutes
+    CHECK(harness.broker.connectionAttempts() - attempts >= 6);
+    CHECK(harness.broker.connectionAttempts() - attempts <= 9);
+    CHECK(harness.device.getLinkState() == LINK_MQTT);
+
+    harness.broker.refuseConnections(false);
+    CHECK(harness.runUntilOnline(60000));
+    CHECK_EQ(harness.broker.connectCount(), sessions + 1);
+    CHECK_EQ(host::restartCount(), 0);
+}
@@ -0,0 +1,215 @@
+// Supports de sauvegarde choisis par PlatformTraits (HAS_NVS) et non par la carte: les
+// deux spécialisations de chaque bibliothèque sont compilées et exercées dans chacun
+// des deux binaires (NVS et EEPROM/LittleFS/RTC émulés), puis le choix de
+// PlatformConfig est vérifié pour la cible compilée.
+
+#include "HostTest.h"
+
+#include <AlarmRuleStore.h>
+#include <ConfigManager.h>
+#include <EEPROM.h>
+#include <HADiscoveryConfig.h>
+#include <LittleFS.h>
+#include <Preferences.h>
+#include <type_traits>
+
+namespace {
+
+static_assert(std::is_same<PlatformConfigStorage,
+                           std::conditional<PlatformConfig::HAS_NVS, PreferencesStorage, EepromStorage>::type>::value,
+              "support de ConfigStore");
+static_assert(std::is_same<DiscoveryHashStore,
+                           std::conditional<PlatformConfig::HAS_NVS, NvsDiscoveryHash, RtcDiscoveryHash>::type>::value,
+              "support de l'empreinte de découverte");
+static_assert(std::is_same<AlarmRuleStore,
+                           std::conditional<PlatformConfig::HAS_NVS, PreferencesRuleStorage, LittleFSRuleStorage>::type>::value,
+              "support des règles d'alarme");
+static_assert(std::is_same<PlatformWebServer, PortalServerBackend<RONOBOX_TARGET>::Type>::value,
+              "serveur du portail");
+static_assert(PlatformTraits<RonoBoxTarget::Esp32>::HAS_NVS && !PlatformTraits<RonoBoxTarget::Esp8266>::HAS_NVS,
+              "NVS sur ESP32 seulement");
+
+// Écritures flash propres à chaque support (et non à la cible compilée)
+template <bool HasNvs>
+unsigned configWrites() {
+    return HasNvs ? host::nvsWriteCount() : host::eepromCommitCount();
+}
+
+ConfigRecord makeRecord(const char* ssid) {
+    ConfigRecord record;
+    memset(&record, 0, sizeof(record));
+    ConfigStore::copyField(record.wifiSSID, sizeof(record.wifiSSID), ssid);
+    ConfigStore::copyField(record.mqttServer, sizeof(record.mqttServer), "192.168.1.10");
+    record.mqttPort = 1884;
+    return record;
+}
+
+template <bool HasNvs>
+void checkConfigRoundTrip() {
+    typedef typename ConfigStorageBackend<HasNvs>::Type Storage;
+    {
+        Storage storage;
+        ConfigStore store(storage);
+        REQUIRE(store.begin());
+        ConfigRecord legacy;
+        CHECK(!storage.readLegacy(legacy));   // Flash vierge: pas d'ancien format à reprendre
+
+        unsigned writes = configWrites<HasNvs>();
+        ConfigRecord record = makeRecord(HasNvs ? "nvs" : "eeprom");
+        REQUIRE(store.save(record));
+        CHECK_EQ(configWrites<HasNvs>() - writes, 1);
+    }
+    host::powerCycle();
+
+    Storage storage;
+    ConfigStore store(storage);
+    REQUIRE(store.begin());
+    ConfigRecord record;
+    REQUIRE(store.load(record));
+    CHECK_STR(record.wifiSSID, HasNvs ? "nvs" : "eeprom");
+    CHECK_EQ(record.mqttPort, 1884);
+}
+
+// Ancien format ESP32: une clé par champ dans l'espace "smart-home"
+void writeLegacyNvs() {
+    Preferences preferences;
+    preferences.begin("smart-home", false);
+    preferences.putString("wifi_ssid", "ancien");
+    preferences.putString("wifi_pass", "secret");
+    preferences.putString("mqtt_server", "broker.local");
+    preferences.putInt("mqtt_port", 1885);
+    preferences.putString("mqtt_user", "ronobox");
+    preferences.end();
+}
+
+// Ancien format ESP8266: chaînes préfixées par leur longueur à des adresses fixes
+void writeLegacyEeprom() {
+    auto writeString = [](int address, const char* value) {
+        size_t length = strlen(value);
+        EEPROM.write(address, length);
+        for (size_t i = 0; i < length; i++) EEPROM.write(address + 1 + i, value[i]);
+    };
+    EEPROM.begin(512);
+    writeString(0, "ancien");
+    writeString(50, "secret");
+    writeString(100, "broker.local");
+    EEPROM.write(150, 1885 >> 8);
+    EEPROM.write(151, 1885 & 0xFF);
+    writeString(152, "ronobox");
+    EEPROM.write(202, 0);
+    EEPROM.commit();
+}
+
+template <bool HasNvs>
+void checkLegacyRead() {
+    if (HasNvs) {
+        writeLegacyNvs();
+    } else {
+        writeLegacyEeprom();
+    }
+    typename ConfigStorageBackend<HasNvs>::Type storage;
+    REQUIRE(storage.begin());
+    ConfigRecord record;
+    REQUIRE(storage.readLegacy(record));
+    CHECK_STR(record.wifiSSID, "ancien");
+    CHECK_STR(record.wifiPassword, "secret");
+    CHECK_STR(record.mqttServer, "broker.local");
+    CHECK_EQ(record.mqttPort, 1885);
+    CHECK_STR(record.mqttUser, "ronobox");
+    CHECK_STR(record.mqttPassword, "");
+}
+
+template <bool HasNvs>
+void checkAlarmRules() {
+    LittleFS.begin();
+    AlarmRuleSet set;
+    memset(&set, 0, sizeof(set));
+    set.magic = AlarmEngine::MAGIC;
+    set.count = 1;
+    strcpy(set.rules[0].input, "gaz");
+    set.rules[0].threshold = 42;
+
+    typename AlarmRuleStorageBackend<HasNvs>::Type storage;
+    unsigned nvsWrites = host::nvsWriteCount();
+    unsigned fileWrites = host::littleFSWriteCount();
+    REQUIRE(storage.save(set));
+    CHECK_EQ(host::nvsWriteCount() - nvsWrites, HasNvs ? 1 : 0);
+    CHECK_EQ(host::littleFSWriteCount() - fileWrites, HasNvs ? 0 : 1);
+
+    host::powerCycle();
+    AlarmRuleSet loaded;
+    REQUIRE(storage.load(loaded));
+    CHECK_EQ(memcmp(&loaded, &set, sizeof(set)), 0);
+}
+
+} // namespace
+
+TEST_CASE(config_store_nvs_backend) {
+    checkConfigRoundTrip<true>();
+}
+
+TEST_CASE(config_store_eeprom_backend) {
+    checkConfigRoundTrip<false>();
+}
+
+TEST_CASE(legacy_nvs_keys_are_read) {
+    checkLegacyRead<true>();
+}
+
+TEST_CASE(legacy_eeprom_fields_are_read) {
+    checkLegacyRead<false>();
+}
+
+// ConfigManager reprend l'ancien format de son propre support
+TEST_CASE(config_manager_migrates_legacy_config) {
+    if (PlatformConfig::HAS_NVS) {
+        writeLegacyNvs();
+    } else {
+        writeLegacyEeprom();
+    }
+    ConfigManager manager;
+    CHECK(manager.begin());
+    NetworkConfig config = manager.getConfig();
+    CHECK_STR(config.wifiSSID.c_str(), "ancien");
+    CHECK_STR(config.mqttServer.c_str(), "broker.local");
+    CHECK_EQ(config.mqttPort, 1885);
+}
+
+// NVS: l'empreinte survit à une coupure d'alimentation
+TEST_CASE(discovery_hash_nvs_backend) {
+    NvsDiscoveryHash store;
+    CHECK_EQ(store.load(), 0);
+    store.save(0x12345678);
+    host::powerCycle();
+    CHECK_EQ(NvsDiscoveryHash().load(), 0x12345678);
+}
+
+// Mémoire RTC: conservée par ESP.restart(), perdue par une coupure
+TEST_CASE(discovery_hash_rtc_backend) {
+    RtcDiscoveryHash store;
+    CHECK_EQ(store.load(), 0);
+    unsigned writes = host::nvsWriteCount();
+    store.save(0x12345678);
+    CHECK_EQ(host::nvsWriteCount(), writes);
+    ESP.restart();
+    CHECK_EQ(RtcDiscoveryHash().load(), 0x12345678);
+    host::powerCycle();
+    CHECK_EQ(RtcDiscoveryHash().load(), 0);
+}
+
+TEST_CASE(alarm_rules_nvs_backend) {
+    checkAlarmRules<true>();
+}
+
+TEST_CASE(alarm_rules_littlefs_backend) {
+    checkAlarmRules<false>();
+}
+
+// Les deux serveurs du portail se compilent avec PortalPage (identiques sur l'hôte)
+TEST_CASE(portal_server_backends) {
+    PortalServerBackend<RonoBoxTarget::Esp32>::Type esp32Server(80);
+    PortalServerBackend<RonoBoxTarget::Esp8266>::Type esp8266Server(80);
+    PortalPage<PortalServerBackend<RonoBoxTarget::Esp32>::Type> esp32Page(esp32Server);
+    PortalPage<PortalServerBackend<RonoBoxTarget::Esp8266>::Type> esp8266Page(esp8266Server);
+    CHECK_EQ(sizeof(esp32Page), sizeof(esp8266Page));
+}
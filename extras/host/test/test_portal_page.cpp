@@ -0,0 +1,325 @@
+// Portail captif rendu en flux: page de configuration comparée octet par octet à
+// celle que construisait l'ancien handleRoot() (String concaténée), échappement des
+// valeurs, feuille de style gzip, et tas utilisé par les deux rendus
+
+#include "HostTest.h"
+
+#include <ConfigManager.h>
+#include <PortalPage.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifdef RONOBOX_HAVE_ZLIB
+  #include <zlib.h>
+#endif
+
+namespace {
+
+// Ancien handleRoot(), style compris
+String legacyPage(const String& ssid, const String& password, const String& user, const String& userPassword) {
+  String html = R"=====(
+  <!DOCTYPE html>
+  <html>
+  <head>
+    <meta charset="UTF-8">
+    <title>Configuration SmartHome</title>
+    <meta name="viewport" content="width=device-width, initial-scale=1">
+    <style>
+      body { font-family: Arial; margin: 20px; }
+      .container { max-width: 500px; margin: 0 auto; }
+      .form-group { margin-bottom: 15px; }
+      label { display: block; margin-bottom: 5px; }
+      input { width: 100%; padding: 8px; box-sizing: border-box; }
+      button { background: #4CAF50; color: white; padding: 10px 15px; border: none; width: 100%; }
+      .reset-btn { background: #f44336; margin-top: 20px; }
+      .form-section { background: #f9f9f9; padding: 15px; border-radius: 5px; margin-bottom: 20px; }
+      h2 { margin-top: 0; color: #333; }
+    </style>
+  </head>
+  <body>
+    <div class="container">
+      <h1>Configuration SmartHome</h1>
+      
+      <div class="form-section">
+        <h2>Paramètres WiFi</h2>
+        <form action="/save" method="post">
+          <div class="form-group">
+            <label for="ssid">SSID WiFi:</label>
+            <input type="text" id="ssid" name="ssid" required value=")=====";
+  html += ssid;
+  html += R"=====(">
+          </div>
+          
+          <div class="form-group">
+            <label for="pass">Mot de passe WiFi:</label>
+            <input type="password" id="pass" name="pass" value=")=====";
+  html += password;
+  html += R"=====(">
+          </div>
+      </div>
+      
+     
+          
+          <div class="form-group">
+            <label for="muser">Utilisateur MQTT:</label>
+            <input type="text" id="muser" name="muser" value=")=====";
+  html += user;
+  html += R"=====(">
+          </div>
+          
+          <div class="form-group">
+            <label for="mpass">Mot de passe MQTT:</label>
+            <input type="password" id="mpass" name="mpass" value=")=====";
+  html += userPassword;
+  html += R"=====(">
+          </div>
+          
+          <button type="submit">Enregistrer</button>
+        </form>
+      </div>
+      
+      <div class="form-section">
+        <h2>Réinitialisation</h2>
+        <p>Ceci effacera tous les paramètres et redémarrera l'appareil.</p>
+        <form action="/reset" method="post" onsubmit="return confirm('Êtes-vous sûr de vouloir réinitialiser tous les paramètres?');">
+          <button type="submit" class="reset-btn">Réinitialiser la configuration</button>
+        </form>
+      </div>
+    </div>
+  </body>
+  </html>
+  )=====";
+  return html;
+}
+
+const char* const STYLE_OPEN = "    <style>\n";
+const char* const STYLE_CLOSE = "    </style>\n";
+
+// Seule différence voulue: le bloc <style> est devenu un lien vers /style.css
+std::string withStyleLink(const String& legacy) {
+    std::string page = legacy.c_str();
+    size_t open = page.find(STYLE_OPEN);
+    size_t close = page.find(STYLE_CLOSE);
+    if (open == std::string::npos || close == std::string::npos) return page;
+    return page.substr(0, open) + "    <link rel=\"stylesheet\" href=\"/style.css\">\n" +
+           page.substr(close + strlen(STYLE_CLOSE));
+}
+
+// Contenu du bloc <style> de l'ancienne page, sans l'indentation
+std::string legacyStyle() {
+    std::string page = legacyPage("", "", "", "").c_str();
+    size_t open = page.find(STYLE_OPEN) + strlen(STYLE_OPEN);
+    size_t close = page.find(STYLE_CLOSE);
+    std::istringstream lines(page.substr(open, close - open));
+    std::string line, css;
+    while (std::getline(lines, line)) css += line.substr(6) + "\n";
+    return css;
+}
+
+// Serveur minimal pour PortalPage: garde les octets reçus dans un tampon réservé
+// d'avance, pour que les mesures de tas ne voient que le rendu
+struct CaptureServer {
+    std::string body;
+    size_t chunks = 0;
+    size_t largestChunk = 0;
+    bool finished = false;
+
+    CaptureServer() { body.reserve(8192); }
+
+    void setContentLength(size_t) {}
+    void send(int, const char*, const char*) {}
+    void sendContent(const char* data, size_t length) {
+        if (length == 0) {
+            finished = true;
+            return;
+        }
+        chunks++;
+        if (length > largestChunk) largestChunk = length;
+        body.append(data, length);
+    }
+};
+
+// Configuration enregistrée, WiFi injoignable: le portail s'ouvre après le délai
+// d'association et sert la page remplie
+WebServer* openPortal(ConfigManager& manager, const char* ssid, const char* password,
+                      const char* user, const char* userPassword) {
+    if (ssid[0] != '\0') {
+        PlatformConfigStorage storage;
+        ConfigStore store(storage);
+        store.begin();
+        ConfigRecord record;
+        memset(&record, 0, sizeof(record));
+        ConfigStore::copyField(record.wifiSSID, sizeof(record.wifiSSID), ssid);
+        ConfigStore::copyField(record.wifiPassword, sizeof(record.wifiPassword), password);
+        ConfigStore::copyField(record.mqttUser, sizeof(record.mqttUser), user);
+        ConfigStore::copyField(record.mqttPassword, sizeof(record.mqttPassword), userPassword);
+        record.mqttPort = 1883;
+        store.save(record);
+    }
+
+    host::setWiFiJoinDelay(-1);
+    manager.begin();
+    HostTest::runUntil([&] { manager.handleClient(); },
+                       [&] { return manager.getState() == PROV_AP_MODE; }, 30000, 100);
+    return host::webServer();
+}
+
+} // namespace
+
+TEST_CASE(blank_portal_matches_legacy_page) {
+    ConfigManager manager;
+    WebServer* server = openPortal(manager, "", "", "", "");
+    REQUIRE(server != nullptr);
+
+    const WebServer::Response& response = server->request(HTTP_GET, "/");
+    CHECK_EQ(response.code, 200);
+    CHECK_STR(response.contentType.c_str(), "text/html");
+    CHECK(response.chunked);
+    CHECK(response.finished);
+    CHECK(response.body == withStyleLink(legacyPage("", "", "", "")));
+
+    // Blocs pleins de CHUNK_SIZE octets, sauf le dernier
+    REQUIRE(!response.chunks.empty());
+    for (size_t i = 0; i + 1 < response.chunks.size(); i++) {
+        CHECK_EQ(response.chunks[i], PortalPage<PlatformWebServer>::CHUNK_SIZE);
+    }
+    CHECK(response.chunks.back() <= PortalPage<PlatformWebServer>::CHUNK_SIZE);
+}
+
+TEST_CASE(filled_portal_matches_legacy_page) {
+    ConfigManager manager;
+    WebServer* server = openPortal(manager, "Maison-5G", "pass word 123", "ronobox", "s3cret");
+    REQUIRE(server != nullptr);
+
+    const WebServer::Response& response = server->request(HTTP_GET, "/");
+    CHECK(response.finished);
+    CHECK(response.body == withStyleLink(legacyPage("Maison-5G", "pass word 123", "ronobox", "s3cret")));
+}
+
+// L'ancienne page recopiait les valeurs brutes: un SSID avec " cassait l'attribut value
+TEST_CASE(values_are_escaped) {
+    ConfigManager manager;
+    WebServer* server = openPortal(manager, "a\"b<c>", "x&y'z", "", "");
+    REQUIRE(server != nullptr);
+
+    const WebServer::Response& response = server->request(HTTP_GET, "/");
+    CHECK(response.body.find("value=\"a&quot;b&lt;c&gt;\"") != std::string::npos);
+    CHECK(response.body.find("value=\"x&amp;y&#39;z\"") != std::string::npos);
+    CHECK(response.body.find("a\"b") == std::string::npos);
+}
+
+TEST_CASE(template_markers) {
+    CaptureServer server;
+    PortalPage<CaptureServer> page(server);
+    const char* values[] = { "un", nullptr, "<trois>" };
+
+    page.begin();
+    page.render("[{{0}}][{{1}}][{{2}}][{{7}}][{{x}}][{0}][{{", values, 3);
+    page.end();
+    CHECK_STR(server.body.c_str(), "[un][][&lt;trois&gt;][][{{x}}][{0}][{{");
+    CHECK(server.finished);
+}
+
+// Valeur plus longue qu'un bloc: découpée sans perte à la frontière
+TEST_CASE(long_value_spans_chunks) {
+    CaptureServer server;
+    PortalPage<CaptureServer> page(server);
+    std::string value(3 * PortalPage<CaptureServer>::CHUNK_SIZE + 17, 'v');
+    value[PortalPage<CaptureServer>::CHUNK_SIZE - 3] = '&';
+    const char* values[] = { value.c_str() };
+
+    page.begin();
+    page.render("<{{0}}>", values, 1);
+    page.end();
+
+    std::string expected = "<" + value + ">";
+    expected.replace(1 + PortalPage<CaptureServer>::CHUNK_SIZE - 3, 1, "&amp;");
+    CHECK(server.body == expected);
+    CHECK_EQ(server.largestChunk, PortalPage<CaptureServer>::CHUNK_SIZE);
+}
+
+TEST_CASE(style_is_served_gzipped_and_cached) {
+    ConfigManager manager;
+    WebServer* server = openPortal(manager, "", "", "", "");
+    REQUIRE(server != nullptr);
+
+    const WebServer::Response& response = server->request(HTTP_GET, "/style.css");
+    CHECK_EQ(response.code, 200);
+    CHECK_STR(response.contentType.c_str(), "text/css");
+    REQUIRE(response.header("Content-Encoding") != nullptr);
+    CHECK_STR(response.header("Content-Encoding"), "gzip");
+    CHECK(response.header("Cache-Control") != nullptr);
+    CHECK_EQ(response.body.size(), sizeof(PORTAL_CSS_GZ));
+    CHECK(memcmp(response.body.data(), PORTAL_CSS_GZ, sizeof(PORTAL_CSS_GZ)) == 0);
+}
+
+#ifdef RONOBOX_HAVE_ZLIB
+// L'asset compressé correspond à extras/portal.css, qui reprend l'ancien bloc <style>
+TEST_CASE(gzip_asset_matches_source) {
+    std::ifstream file(RONOBOX_PORTAL_CSS);
+    REQUIRE(file.good());
+    std::stringstream source;
+    source << file.rdbuf();
+
+    std::string inflated(16384, '\0');
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    REQUIRE(inflateInit2(&stream, 16 + MAX_WBITS) == Z_OK);
+    stream.next_in = (Bytef*)PORTAL_CSS_GZ;
+    stream.avail_in = sizeof(PORTAL_CSS_GZ);
+    stream.next_out = (Bytef*)&inflated[0];
+    stream.avail_out = inflated.size();
+    int result = inflate(&stream, Z_FINISH);
+    inflated.resize(stream.total_out);
+    inflateEnd(&stream);
+
+    CHECK_EQ(result, Z_STREAM_END);
+    CHECK(inflated == source.str());
+    CHECK(inflated == legacyStyle());
+}
+#endif
+
+// Tas pendant le rendu: la page entière en String (et ses réallocations) avant,
+// rien après: le gabarit reste en flash et le tampon de bloc est sur la pile
+TEST_CASE(render_peak_heap) {
+    String ssid = "Maison-5G";
+    String password = "pass word 123";
+    String user = "ronobox";
+    String userPassword = "s3cret";
+
+    host::resetHeapPeak();
+    int64_t before = host::heapStats().liveBytes;
+    uint64_t legacyAllocations = host::countAllocations([&] {
+        String html = legacyPage(ssid, password, user, userPassword);
+        CHECK(html.length() > 2000);
+    });
+    int64_t legacyPeak = host::heapStats().peakBytes - before;
+
+    // Même page, rendue par PortalPage depuis un gabarit à marqueurs
+    std::string tpl = withStyleLink(legacyPage("{{0}}", "{{1}}", "{{2}}", "{{3}}"));
+    const char* values[] = { ssid.c_str(), password.c_str(), user.c_str(), userPassword.c_str() };
+    CaptureServer server;
+    PortalPage<CaptureServer> page(server);
+
+    host::resetHeapPeak();
+    before = host::heapStats().liveBytes;
+    uint64_t streamedAllocations = host::countAllocations([&] {
+        page.begin();
+        page.render(tpl.c_str(), values, 4);
+        page.end();
+    });
+    int64_t streamedPeak = host::heapStats().peakBytes - before;
+
+    CHECK(server.body == withStyleLink(legacyPage(ssid, password, user, userPassword)));
+    printf("{\"name\":\"portal_render\",\"target\":\"%s\",\"page_bytes\":%u,\"legacy_peak_heap\":%lld,"
+           "\"legacy_allocations\":%llu,\"streamed_peak_heap\":%lld,\"streamed_allocations\":%llu,"
+           "\"chunk_bytes\":%u}\n",
+           RonoBoxPlatform::name(), (unsigned)server.body.size(), (long long)legacyPeak,
+           (unsigned long long)legacyAllocations, (long long)streamedPeak,
+           (unsigned long long)streamedAllocations, (unsigned)PortalPage<CaptureServer>::CHUNK_SIZE);
+
+    CHECK(legacyPeak >= (int64_t)server.body.size());
+    CHECK_EQ(streamedAllocations, 0);
+    CHECK_EQ(streamedPeak, 0);
+}
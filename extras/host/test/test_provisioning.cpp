@@ -0,0 +1,157 @@
+// Provisionnement WiFi de ConfigManager sur horloge simulée: begin() rend la main tout
+// de suite, les états (association, connecté, délai dépassé, portail) s'enchaînent
+// pendant les tours de loop(), qui continuent de tourner pour les capteurs et l'alarme
+
+#include "HostTest.h"
+
+#include <ConfigManager.h>
+#include <vector>
+
+namespace {
+
+std::vector<ProvisioningState> transitions;
+
+void recordState(ProvisioningState state) {
+    transitions.push_back(state);
+}
+
+void storeConfig(const char* ssid) {
+    PlatformConfigStorage storage;
+    ConfigStore store(storage);
+    store.begin();
+    ConfigRecord record;
+    memset(&record, 0, sizeof(record));
+    ConfigStore::copyField(record.wifiSSID, sizeof(record.wifiSSID), ssid);
+    ConfigStore::copyField(record.wifiPassword, sizeof(record.wifiPassword), "motdepasse");
+    ConfigStore::copyField(record.mqttServer, sizeof(record.mqttServer), "192.168.1.10");
+    record.mqttPort = 1883;
+    store.save(record);
+}
+
+// Tours de loop(): ConfigManager puis une tâche capteur, tous les 10 ms
+struct Loop {
+    ConfigManager& manager;
+    unsigned long sensorRuns = 0;
+
+    void run(unsigned long durationMs) {
+        for (unsigned long elapsed = 0; elapsed < durationMs; elapsed += 10) {
+            manager.handleClient();
+            sensorRuns++;
+            host::advance(10);
+        }
+    }
+};
+
+} // namespace
+
+TEST_CASE(no_config_opens_portal) {
+    transitions.clear();
+    ConfigManager manager;
+    manager.onStateChange(recordState);
+
+    CHECK(!manager.begin());
+    CHECK_EQ(manager.getState(), PROV_AP_MODE);
+    REQUIRE(transitions.size() == 1);
+    CHECK_EQ(transitions[0], PROV_AP_MODE);
+    CHECK(WiFi.getMode() & WIFI_AP);
+    REQUIRE(host::webServer() != nullptr);
+    CHECK(host::webServer()->isStarted());
+}
+
+// Association en 3 s: begin() ne consomme pas de temps, loop() tourne pendant l'attente
+TEST_CASE(association_completes_in_background) {
+    transitions.clear();
+    storeConfig("maison");
+    host::setWiFiJoinDelay(3000);
+
+    ConfigManager manager;
+    manager.onStateChange(recordState);
+    CHECK(manager.begin());
+    CHECK_EQ(millis(), 0);
+    CHECK_EQ(manager.getState(), PROV_CONNECTING);
+    CHECK(!manager.isConfigured());
+    CHECK_STR(manager.getConfig().wifiSSID.c_str(), "maison");
+
+    Loop loop = { manager };
+    loop.run(2900);
+    CHECK_EQ(manager.getState(), PROV_CONNECTING);
+    CHECK_EQ(loop.sensorRuns, 290);
+
+    loop.run(200);
+    CHECK_EQ(manager.getState(), PROV_CONNECTED);
+    CHECK(manager.isConfigured());
+    CHECK(!(WiFi.getMode() & WIFI_AP));
+
+    REQUIRE(transitions.size() == 2);
+    CHECK_EQ(transitions[0], PROV_CONNECTING);
+    CHECK_EQ(transitions[1], PROV_CONNECTED);
+}
+
+// Pas d'association: délai dépassé à CONNECT_TIMEOUT (20 s), puis portail
+TEST_CASE(association_timeout_falls_back_to_portal) {
+    transitions.clear();
+    storeConfig("maison");
+    host::setWiFiJoinDelay(-1);
+
+    ConfigManager manager;
+    manager.onStateChange(recordState);
+    CHECK(manager.begin());
+
+    Loop loop = { manager };
+    loop.run(19900);
+    CHECK_EQ(manager.getState(), PROV_CONNECTING);
+    CHECK(host::webServer() == nullptr);
+
+    loop.run(200);
+    CHECK_EQ(manager.getState(), PROV_AP_MODE);
+    CHECK(WiFi.getMode() & WIFI_AP);
+    REQUIRE(host::webServer() != nullptr);
+    CHECK(host::webServer()->isStarted());
+    CHECK_EQ(loop.sensorRuns, 2010);
+
+    REQUIRE(transitions.size() == 3);
+    CHECK_EQ(transitions[0], PROV_CONNECTING);
+    CHECK_EQ(transitions[1], PROV_TIMEOUT);
+    CHECK_EQ(transitions[2], PROV_AP_MODE);
+
+    // Le portail reste ouvert: plus de changement d'état
+    loop.run(60000);
+    CHECK_EQ(transitions.size(), 3);
+}
+
+// Formulaire du portail: configuration enregistrée puis redémarrage
+TEST_CASE(portal_save_stores_config_and_restarts) {
+    ConfigManager manager;
+    CHECK(!manager.begin());
+    REQUIRE(host::webServer() != nullptr);
+
+    const WebServer::Response& response = host::webServer()->request(HTTP_POST, "/save", {
+        { "ssid", "nouveau" }, { "pass", "secret" }, { "mqtt", "broker.local" },
+        { "port", "1884" }, { "muser", "ronobox" }, { "mpass", "mqtt" } });
+    CHECK_EQ(response.code, 200);
+    CHECK_EQ(host::restartCount(), 1);
+
+    ConfigManager rebooted;
+    host::setWiFiJoinDelay(0);
+    CHECK(rebooted.begin());
+    NetworkConfig config = rebooted.getConfig();
+    CHECK_STR(config.wifiSSID.c_str(), "nouveau");
+    CHECK_STR(config.mqttServer.c_str(), "broker.local");
+    CHECK_EQ(config.mqttPort, 1884);
+    CHECK_STR(config.mqttUser.c_str(), "ronobox");
+
+    rebooted.handleClient();
+    CHECK_EQ(rebooted.getState(), PROV_CONNECTED);
+}
+
+// Toute autre adresse renvoie vers la page du portail (détection de portail captif)
+TEST_CASE(unknown_path_redirects_to_portal) {
+    ConfigManager manager;
+    CHECK(!manager.begin());
+    REQUIRE(host::webServer() != nullptr);
+
+    const WebServer::Response& response = host::webServer()->request(HTTP_GET, "/generate_204");
+    CHECK_EQ(response.code, 302);
+    REQUIRE(response.header("Location") != nullptr);
+    CHECK_STR(response.header("Location"), "/");
+}
@@ -0,0 +1,136 @@
+// Politique de publication de MQTTDevice contre le broker en mémoire: bande morte,
+// intervalles minimum et heartbeat, coalescence des valeurs en attente, compteurs
+
+#include "DeviceHarness.h"
+
+static bool online(DeviceHarness<>& harness) {
+    harness.device.setDiagnosticsInterval(0);
+    harness.device.begin(IPAddress(10, 0, 0, 2));
+    if (!harness.runUntilOnline()) return false;
+    harness.broker.clearMessages();
+    return true;
+}
+
+static size_t count(DeviceHarness<>& harness, const std::string& topic) {
+    return harness.broker.on(topic).size();
+}
+
+TEST_CASE(unchanged_value_is_suppressed) {
+    DeviceHarness<> harness;
+    harness.device.setDefaultPublishPolicy(0, 0, 0);
+    REQUIRE(online(harness));
+    std::string topic = harness.topic("salon", "lampe");
+
+    for (int i = 0; i < 10; i++) {
+        harness.device.publishSensorData("salon", "lampe", true);
+        harness.step(1000);
+    }
+    CHECK_EQ(count(harness, topic), 1);
+    CHECK_STR(harness.broker.last(topic)->payload.c_str(), "ON");
+    CHECK(harness.broker.last(topic)->retained);
+    CHECK_EQ(harness.device.getPublishedCount(), 1);
+    CHECK_EQ(harness.device.getSuppressedCount(), 9);
+
+    harness.device.publishSensorData("salon", "lampe", false);
+    harness.step();
+    CHECK_EQ(count(harness, topic), 2);
+    CHECK_STR(harness.broker.last(topic)->payload.c_str(), "OFF");
+}
+
+TEST_CASE(deadband_filters_small_changes) {
+    DeviceHarness<> harness;
+    harness.device.setDefaultPublishPolicy(0, 0, 0);
+    REQUIRE(online(harness));
+    harness.device.publishSensorData("salon", "temperature", 21.0f);
+    harness.step();
+    harness.device.setPublishPolicy("salon", "temperature", 0.5f, 0, 0);
+    std::string topic = harness.topic("salon", "temperature");
+
+    const float readings[] = { 21.1f, 21.3f, 20.7f, 21.6f, 21.4f, 20.9f };
+    for (float value : readings) {
+        harness.device.publishSensorData("salon", "temperature", value);
+        harness.step(1000);
+    }
+    // Écarts mesurés depuis la dernière valeur publiée: 21.0 → 21.6 → 20.9 (≥ 0.5)
+    std::vector<const FakeBroker::Message*> sent = harness.broker.on(topic);
+    REQUIRE(sent.size() == 3);
+    CHECK_STR(sent[1]->payload.c_str(), "21.60");
+    CHECK_STR(sent[2]->payload.c_str(), "20.90");
+    CHECK_EQ(harness.device.getSuppressedCount(), 4);
+}
+
+// Changements trop rapprochés: la dernière valeur part à l'expiration du délai minimum
+TEST_CASE(min_interval_coalesces_to_latest_value) {
+    DeviceHarness<> harness;
+    harness.device.setDefaultPublishPolicy(0, 5000, 0);
+    REQUIRE(online(harness));
+    std::string topic = harness.topic("cuisine", "gaz");
+
+    harness.device.publishSensorData("cuisine", "gaz", 10);
+    harness.step(1000);
+    for (int value = 11; value <= 14; value++) {
+        harness.device.publishSensorData("cuisine", "gaz", value);
+        harness.step(1000);
+    }
+    CHECK_EQ(count(harness, topic), 1);
+    harness.run(1000);
+    std::vector<const FakeBroker::Message*> sent = harness.broker.on(topic);
+    REQUIRE(sent.size() == 2);
+    CHECK_STR(sent[0]->payload.c_str(), "10");
+    CHECK_STR(sent[1]->payload.c_str(), "14");
+    CHECK_EQ(harness.device.getSuppressedCount(), 3);   // 11, 12 et 13 remplacées
+}
+
+TEST_CASE(several_values_per_loop_give_one_publish) {
+    DeviceHarness<> harness;
+    harness.device.setDefaultPublishPolicy(0, 0, 0);
+    REQUIRE(online(harness));
+    std::string topic = harness.topic("salon", "humidity");
+
+    for (int value = 40; value < 45; value++) harness.device.publishSensorData("salon", "humidity", value);
+    harness.step();
+    REQUIRE(count(harness, topic) == 1);
+    CHECK_STR(harness.broker.last(topic)->payload.c_str(), "44");
+    CHECK_EQ(harness.device.getSuppressedCount(), 4);
+}
+
+TEST_CASE(heartbeat_republishes_unchanged_value) {
+    DeviceHarness<> harness;
+    harness.device.setDefaultPublishPolicy(0, 0, 60000);
+    REQUIRE(online(harness));
+    std::string topic = harness.topic("salon", "motion");
+
+    for (int second = 0; second < 180; second++) {
+        harness.device.publishSensorData("salon", "motion", false);
+        harness.step(1000);
+    }
+    CHECK_EQ(count(harness, topic), 3);     // t=0, 60 s, 120 s
+    CHECK_EQ(harness.device.getPublishedCount(), 3);
+}
+
+TEST_CASE(precision_and_invalid_readings) {
+    DeviceHarness<> harness;
+    harness.device.setDefaultPublishPolicy(0, 0, 0);
+    REQUIRE(online(harness));
+    harness.device.publishSensorData("salon", "temperature", 0.0f);
+    harness.step();
+    CHECK(harness.device.setPrecision("salon", "temperature", 1));
+    std::string topic = harness.topic("salon", "temperature");
+
+    harness.device.publishSensorData("salon", "temperature", 21.46f);
+    harness.step();
+    CHECK_STR(harness.broker.last(topic)->payload.c_str(), "21.5");
+    harness.device.publishSensorData("salon", "temperature", NAN);
+    harness.step();
+    CHECK_STR(harness.broker.last(topic)->payload.c_str(), "unavailable");
+    harness.device.publishSensorData("salon", "temperature", -0.04f);
+    harness.step();
+    CHECK_STR(harness.broker.last(topic)->payload.c_str(), "0.0");
+
+    char payload[MQTTDevice::MAX_PAYLOAD_LENGTH];
+    CHECK(MQTTDevice::formatFixed(payload, sizeof(payload), 99.995f, 2) > 0);
+    CHECK_STR(payload, "100.00");
+    CHECK(MQTTDevice::formatFixed(payload, sizeof(payload), -3.25f, 0) > 0);
+    CHECK_STR(payload, "-3");
+    CHECK_EQ(MQTTDevice::formatFixed(payload, 3, 123.0f, 0), 0);
+}
@@ -0,0 +1,193 @@
+// Publications QoS1 sur un lien qui perd des paquets: PUBACK perdus (retransmission
+// marquée DUP, même identifiant), broker muet (abandon après MAX_ATTEMPTS envois), file
+// d'émission pleine (aucun essai consommé tant que le paquet n'est pas en file), PUBLISH
+// QoS1 reçu sans place pour l'accusé (ignoré jusqu'à la réémission du broker), et
+// fenêtre pleine côté MQTTDevice (l'alerte attend, sans compter d'échec).
+
+#include "DeviceHarness.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+const IPAddress BROKER(10, 0, 0, 2);
+const unsigned long RETRY_MS = 1000;
+
+struct Delivery {
+    uint16_t packetId;
+    bool delivered;
+};
+
+// Client MQTT seul, relié directement au broker en mémoire
+struct Session {
+    FakeBroker broker;
+    RonoBoxMQTT mqtt;
+    std::vector<Delivery> deliveries;
+    std::vector<std::string> received;
+
+    Session() : mqtt(broker) {
+        mqtt.setServer(BROKER, 1883);
+        mqtt.setRetryInterval(RETRY_MS);
+        mqtt.onDelivery([this](uint16_t packetId, bool delivered) { deliveries.push_back({ packetId, delivered }); });
+        mqtt.setCallback([this](char* topic, uint8_t* payload, unsigned int length) {
+            received.push_back(std::string(topic) + "=" + std::string((const char*)payload, length));
+        });
+    }
+
+    bool open() {
+        if (!mqtt.connect("qos1-test")) return false;
+        return HostTest::runUntil([this] { mqtt.loop(); }, [this] { return mqtt.connected(); }, 1000);
+    }
+
+    void run(unsigned long durationMs) {
+        for (unsigned long elapsed = 0; elapsed < durationMs; elapsed += 10) {
+            mqtt.loop();
+            host::advance(10);
+        }
+    }
+
+    // Remplit la file d'émission jusqu'au dernier octet de messages QoS0 (pile TCP
+    // bloquée): un PUBLISH sur "r" occupe 5 octets plus sa charge utile
+    void fillQueue() {
+        broker.setWriteSpace(0);
+        const std::string filler(100, 'x');
+        size_t free = RonoBoxMQTT::DEFAULT_QUEUE_SIZE - mqtt.getQueuedBytes();
+        while (free > 0) {
+            size_t packet = free > 110 ? 100 : free;
+            REQUIRE(mqtt.publish("r", filler.substr(0, packet - 5).c_str()));
+            free -= packet;
+        }
+        REQUIRE(mqtt.getQueuedBytes() == RonoBoxMQTT::DEFAULT_QUEUE_SIZE);
+    }
+};
+
+} // namespace
+
+// Deux PUBACK perdus: trois copies du même identifiant, les deux dernières DUP, une
+// seule livraison annoncée
+TEST_CASE(lost_pubacks_are_retransmitted_as_duplicates) {
+    Session session;
+    REQUIRE(session.open());
+    session.broker.dropNextAcks(2);
+
+    REQUIRE(session.mqtt.publish("alerte/gaz", "42", false, 1));
+    session.run(5 * RETRY_MS);
+
+    std::vector<const FakeBroker::Message*> copies = session.broker.on("alerte/gaz");
+    REQUIRE(copies.size() == 3);
+    CHECK_EQ(copies[0]->qos, 1);
+    CHECK(!copies[0]->duplicate);
+    for (size_t i = 1; i < copies.size(); i++) {
+        CHECK(copies[i]->duplicate);
+        CHECK_EQ(copies[i]->packetId, copies[0]->packetId);
+    }
+    REQUIRE(session.deliveries.size() == 1);
+    CHECK_EQ(session.deliveries[0].packetId, copies[0]->packetId);
+    CHECK(session.deliveries[0].delivered);
+    CHECK_EQ(session.mqtt.getRetransmitCount(), 2);
+    CHECK_EQ(session.mqtt.getInflightCount(), 0);
+    CHECK_EQ(session.mqtt.getDroppedCount(), 0);
+}
+
+// Broker qui n'acquitte jamais: MAX_ATTEMPTS envois puis abandon annoncé
+TEST_CASE(unacknowledged_message_is_dropped_after_max_attempts) {
+    Session session;
+    REQUIRE(session.open());
+    session.broker.setAutoAck(false);
+
+    REQUIRE(session.mqtt.publish("alerte/gaz", "42", false, 1));
+    session.run((RonoBoxMQTT::MAX_ATTEMPTS + 2) * RETRY_MS);
+
+    CHECK_EQ(session.broker.on("alerte/gaz").size(), RonoBoxMQTT::MAX_ATTEMPTS);
+    REQUIRE(session.deliveries.size() == 1);
+    CHECK(!session.deliveries[0].delivered);
+    CHECK_EQ(session.mqtt.getDroppedCount(), 1);
+    CHECK_EQ(session.mqtt.getInflightCount(), 0);
+}
+
+// File pleine pendant dix secondes (MAX_ATTEMPTS intervalles et plus): le message n'est
+// pas mis en file, ne consomme aucun essai, et part une seule fois, sans DUP, ensuite
+TEST_CASE(full_queue_does_not_consume_attempts) {
+    Session session;
+    REQUIRE(session.open());
+    session.fillQueue();
+
+    REQUIRE(session.mqtt.publish("alerte/gaz", "42", false, 1));
+    CHECK_EQ(session.mqtt.getInflightCount(), 1);
+    session.run(10 * RETRY_MS);
+    REQUIRE(session.mqtt.connected());
+    CHECK(session.deliveries.empty());
+    CHECK_EQ(session.mqtt.getRetransmitCount(), 0);
+
+    session.broker.setWriteSpace(-1);
+    session.run(2 * RETRY_MS);
+    std::vector<const FakeBroker::Message*> copies = session.broker.on("alerte/gaz");
+    REQUIRE(copies.size() == 1);
+    CHECK(!copies[0]->duplicate);
+    REQUIRE(session.deliveries.size() == 1);
+    CHECK(session.deliveries[0].delivered);
+    CHECK_EQ(session.mqtt.getRetransmitCount(), 0);
+}
+
+// PUBLISH QoS1 reçu file pleine: pas d'accusé possible, donc pas de traitement; la
+// réémission du broker (DUP) est traitée une seule fois et acquittée
+TEST_CASE(inbound_qos1_without_room_for_puback_is_not_dispatched) {
+    Session session;
+    REQUIRE(session.open());
+    session.fillQueue();
+
+    session.broker.deliver("commande/lampe", "ON", 1, 7);
+    session.run(100);
+    CHECK(session.received.empty());
+
+    session.broker.setWriteSpace(-1);
+    session.run(100);
+    CHECK(session.broker.clientAcks().empty());
+
+    session.broker.deliver("commande/lampe", "ON", 1, 7, true);
+    session.run(100);
+    REQUIRE(session.received.size() == 1);
+    CHECK_STR(session.received[0].c_str(), "commande/lampe=ON");
+    REQUIRE(session.broker.clientAcks().size() == 1);
+    CHECK_EQ(session.broker.clientAcks()[0], 7);
+}
+
+// Cinq alertes pour une fenêtre de quatre, broker muet: la cinquième attend en file
+// côté MQTTDevice sans être comptée en échec, puis part dès qu'une place se libère
+TEST_CASE(device_alert_waits_for_full_window_without_failure) {
+    static constexpr DeviceEntity MODEL[] = {
+        alertEntity(sensorEntity("cuisine", "gaz", "gas", "%", "Gaz cuisine")),
+        alertEntity(sensorEntity("garage", "gaz", "gas", "%", "Gaz garage")),
+        alertEntity(sensorEntity("cave", "eau", "moisture", "%", "Fuite cave")),
+        alertEntity(sensorEntity("buanderie", "eau", "moisture", "%", "Fuite buanderie")),
+        alertEntity(sensorEntity("chaufferie", "fumee", "smoke", "%", "Fumée chaufferie")),
+    };
+    static_assert(sizeof(MODEL) / sizeof(MODEL[0]) > RonoBoxMQTT::MAX_INFLIGHT, "fenêtre à dépasser");
+
+    DeviceHarness<> harness;
+    harness.device.setModel(MODEL);
+    harness.device.setDiagnosticsInterval(0);
+    harness.device.begin(BROKER);
+    REQUIRE(harness.runUntilOnline());
+    harness.run(200);
+    harness.broker.setAutoAck(false);
+
+    for (const DeviceEntity& entity : MODEL) {
+        harness.device.publishSensorData(entity.location, entity.name, 75);
+    }
+    harness.run(500);
+    const std::string last = harness.topic("chaufferie", "fumee");
+    CHECK(harness.broker.on(last).empty());
+    CHECK_EQ(harness.device.getMQTTClient().getInflightCount(), RonoBoxMQTT::MAX_INFLIGHT);
+    CHECK_EQ(harness.device.getFailedPublishCount(), 0);
+
+    harness.broker.setAutoAck(true);
+    harness.run(8000);
+    const FakeBroker::Message* alert = harness.broker.last(last);
+    REQUIRE(alert != nullptr);
+    CHECK_STR(alert->payload.c_str(), "75");
+    CHECK_EQ(alert->qos, 1);
+    CHECK_EQ(harness.device.getMQTTClient().getInflightCount(), 0);
+    CHECK_EQ(harness.device.getFailedPublishCount(), 0);
+}
@@ -0,0 +1,185 @@
+// Ordonnanceur coopératif piloté par l'horloge simulée: cadence, décalage, gigue,
+// retards et recalage, sans attente dans loop()
+
+#include "HostTest.h"
+
+#include <SensorScheduler.h>
+
+static unsigned long fastRuns, slowRuns, publishRuns;
+static unsigned long lastFastAt;
+
+static void resetCounters() {
+    fastRuns = slowRuns = publishRuns = 0;
+    lastFastAt = 0;
+}
+
+// Boucle principale simulée: un run() tous les stepMs jusqu'à durationMs (exclu)
+static void loopFor(SensorScheduler& scheduler, unsigned long durationMs, unsigned long stepMs) {
+    unsigned long end = millis() + durationMs;
+    while (millis() < end) {
+        scheduler.run();
+        host::advance(stepMs);
+    }
+}
+
+TEST_CASE(tasks_run_at_their_period) {
+    resetCounters();
+    SensorScheduler scheduler;
+    int fast = scheduler.addTask("fast", 100, [] { fastRuns++; });
+    int slow = scheduler.addTask("slow", 250, [] { slowRuns++; });
+    int publish = scheduler.addTask("publish", 1000, [] { publishRuns++; });
+
+    loopFor(scheduler, 10000, 10);
+    CHECK_EQ(fastRuns, 100);
+    CHECK_EQ(slowRuns, 40);
+    CHECK_EQ(publishRuns, 10);
+    CHECK_EQ(scheduler.getStats(fast).maxJitter, 0);
+    CHECK_EQ(scheduler.getStats(slow).overruns, 0);
+    CHECK_EQ(scheduler.getStats(publish).runs, 10);
+}
+
+TEST_CASE(offset_staggers_tasks_of_same_period) {
+    resetCounters();
+    SensorScheduler scheduler;
+    scheduler.addTask("a", 200, [] { fastRuns++; });
+    scheduler.addTask("b", 200, [] { slowRuns++; }, 100);
+
+    scheduler.run();
+    CHECK_EQ(fastRuns, 1);
+    CHECK_EQ(slowRuns, 0);
+    host::advance(100);
+    scheduler.run();
+    CHECK_EQ(fastRuns, 1);
+    CHECK_EQ(slowRuns, 1);
+}
+
+// Boucle plus lente que la résolution voulue: la gigue est mesurée, la cadence
+// moyenne reste celle de la période (échéances théoriques, pas de dérive)
+TEST_CASE(jitter_is_tracked_without_drift) {
+    resetCounters();
+    SensorScheduler scheduler;
+    int fast = scheduler.addTask("fast", 100, [] { fastRuns++; });
+
+    loopFor(scheduler, 10000, 30);
+    const SensorScheduler::TaskStats& stats = scheduler.getStats(fast);
+    CHECK(stats.maxJitter > 0 && stats.maxJitter < 30);
+    CHECK_EQ(stats.overruns, 0);
+    CHECK(fastRuns >= 99 && fastRuns <= 100);
+}
+
+// Une tâche bloquante (ex: ancien delay(200)) fait rater des échéances aux autres:
+// elles sont comptées, puis la tâche se recale au lieu de rattraper en rafale
+TEST_CASE(blocking_task_causes_counted_overruns) {
+    resetCounters();
+    SensorScheduler scheduler;
+    int fast = scheduler.addTask("fast", 100, [] {
+        fastRuns++;
+        lastFastAt = millis();
+    });
+    int blocking = scheduler.addTask("blocking", 1000, [] { delay(350); }, 50);
+
+    scheduler.run();          // fast à t=0
+    host::advance(50);
+    scheduler.run();          // blocking à t=50, rend la main à t=400
+    CHECK_EQ(millis(), 400);
+    CHECK_EQ(scheduler.getStats(blocking).maxDuration, 350);
+
+    scheduler.run();          // fast en retard de 300 ms sur son échéance de t=100
+    CHECK_EQ(fastRuns, 2);
+    CHECK_EQ(scheduler.getStats(fast).lastJitter, 300);
+    CHECK_EQ(scheduler.getStats(fast).overruns, 3);
+
+    scheduler.run();          // Recalée sur t=500: pas de rafale de rattrapage
+    CHECK_EQ(fastRuns, 2);
+    host::advance(100);
+    scheduler.run();
+    CHECK_EQ(fastRuns, 3);
+    CHECK_EQ(lastFastAt, 500);
+}
+
+TEST_CASE(disabled_task_resumes_immediately) {
+    resetCounters();
+    SensorScheduler scheduler;
+    int fast = scheduler.addTask("fast", 1000, [] { fastRuns++; });
+    scheduler.run();
+    scheduler.setEnabled(fast, false);
+    loopFor(scheduler, 3000, 10);
+    CHECK_EQ(fastRuns, 1);
+
+    scheduler.setEnabled(fast, true);
+    scheduler.run();
+    CHECK_EQ(fastRuns, 2);
+}
+
+// Publication immédiate après une commande, sans attendre la période
+TEST_CASE(trigger_runs_task_on_next_pass) {
+    resetCounters();
+    SensorScheduler scheduler;
+    int publish = scheduler.addTask("publish", 5000, [] { publishRuns++; });
+    scheduler.run();
+    host::advance(10);
+    scheduler.run();
+    CHECK_EQ(publishRuns, 1);
+    scheduler.trigger(publish);
+    scheduler.run();
+    CHECK_EQ(publishRuns, 2);
+}
+
+TEST_CASE(time_until_next_bounds_idle_sleep) {
+    resetCounters();
+    SensorScheduler scheduler;
+    scheduler.addTask("fast", 100, [] { fastRuns++; }, 0, 0);
+    scheduler.addTask("slow", 250, [] { slowRuns++; }, 30, 0);
+    CHECK_EQ(scheduler.timeUntilNext(0), 0);
+    scheduler.run(0);
+    CHECK_EQ(scheduler.timeUntilNext(0), 30);
+    scheduler.run(30);
+    CHECK_EQ(scheduler.timeUntilNext(30), 70);
+}
+
+TEST_CASE(table_full_is_reported) {
+    SensorScheduler scheduler;
+    for (uint8_t i = 0; i < SensorScheduler::MAX_TASKS; i++) {
+        CHECK_EQ(scheduler.addTask("task", 100, [] {}), i);
+    }
+    CHECK_EQ(scheduler.addTask("extra", 100, [] {}), -1);
+    CHECK_EQ(scheduler.addTask("null", 100, nullptr), -1);
+}
+
+// Échéances comparées par différence signée: le débordement de millis() ne fige
+// aucune tâche (horloge explicite, débordement du type de la carte)
+TEST_CASE(deadlines_survive_clock_wrap) {
+    resetCounters();
+    SensorScheduler scheduler;
+    const unsigned long start = (unsigned long)-250;
+    scheduler.addTask("fast", 100, [] { fastRuns++; }, 0, start);
+
+    unsigned long now = start;
+    for (int i = 0; i < 100; i++, now += 10) scheduler.run(now);
+    CHECK_EQ(fastRuns, 10);
+}
+
+// Statistiques passées par le journal non bloquant (une ligne par tâche), pas
+// écrites directement sur le port série
+TEST_CASE(stats_go_through_device_log) {
+    resetCounters();
+    DeviceLog::clear();
+    DeviceLog::setRemoteLevel(RB_LOG_LEVEL_INFO);
+    SensorScheduler scheduler;
+    scheduler.addTask("fast", 100, [] { fastRuns++; });
+    scheduler.addTask("slow", 250, [] { slowRuns++; });
+    loopFor(scheduler, 1000, 10);
+
+    scheduler.printStats();
+    char line[DeviceLog::MAX_LINE_LENGTH];
+    REQUIRE(DeviceLog::popRemote(line, sizeof(line)));
+    CHECK(strncmp(line, "I [SCHED] fast ", 15) == 0);
+    CHECK(strstr(line, "période=100ms exécutions=10 ") != nullptr);
+    REQUIRE(DeviceLog::popRemote(line, sizeof(line)));
+    CHECK(strncmp(line, "I [SCHED] slow ", 15) == 0);
+    CHECK(strstr(line, "exécutions=4 ") != nullptr);
+    CHECK(!DeviceLog::popRemote(line, sizeof(line)));
+
+    DeviceLog::setRemoteLevel(RB_LOG_LEVEL_NONE);
+    DeviceLog::clear();
+}
@@ -0,0 +1,162 @@
+// Le cœur simulé lui-même: si ces cas échouent, les autres tests ne prouvent rien
+
+#include "HostTest.h"
+
+#include <EEPROM.h>
+#include <LittleFS.h>
+#include <Preferences.h>
+#include <WebServer.h>
+#include <WiFi.h>
+
+TEST_CASE(string_grows_and_compares) {
+    String text("abc");
+    text += 12;
+    text += '-';
+    text += String(1.5f, 1);
+    CHECK_STR(text.c_str(), "abc12-1.5");
+    CHECK_EQ(text.length(), 9);
+    CHECK(text.startsWith("abc") && text.endsWith("1.5"));
+    CHECK_EQ(text.indexOf('-'), 5);
+    CHECK_STR(text.substring(3, 5).c_str(), "12");
+    text += text;
+    CHECK_STR(text.c_str(), "abc12-1.5abc12-1.5");
+    CHECK(String("42").toInt() == 42);
+}
+
+TEST_CASE(empty_string_does_not_allocate) {
+    CHECK_EQ(host::countAllocations([] {
+        String empty;
+        String copy(empty);
+        (void)copy;
+    }), 0);
+    CHECK(host::countAllocations([] { String text("x"); }) >= 1);
+}
+
+TEST_CASE(clock_is_manual) {
+    CHECK_EQ(millis(), 0);
+    host::advance(1500);
+    CHECK_EQ(millis(), 1500);
+    delay(10);
+    CHECK_EQ(millis(), 1510);
+    CHECK_EQ(micros(), 1510000);
+}
+
+static int isrCount = 0;
+static void countEdge(void* arg) {
+    (void)arg;
+    isrCount++;
+}
+
+TEST_CASE(pin_change_fires_interrupt) {
+    isrCount = 0;
+    attachInterruptArg(digitalPinToInterrupt(5), countEdge, nullptr, RISING);
+    host::setPin(5, HIGH);
+    host::setPin(5, HIGH);
+    host::setPin(5, LOW);
+    CHECK_EQ(isrCount, 1);
+    CHECK_EQ(digitalRead(5), LOW);
+    detachInterrupt(5);
+}
+
+TEST_CASE(ip_address_round_trip) {
+    IPAddress ip;
+    CHECK(ip.fromString("192.168.1.20"));
+    CHECK_STR(ip.toString().c_str(), "192.168.1.20");
+    CHECK_EQ(ip[3], 20);
+    CHECK(!ip.fromString("192.168.1"));
+    CHECK(!ip.fromString("300.1.1.1"));
+}
+
+TEST_CASE(preferences_survive_power_cycle) {
+    Preferences preferences;
+    CHECK(!preferences.begin("absent", true));
+    CHECK(preferences.begin("test", false));
+    CHECK_EQ(preferences.putUInt("n", 7), 4);
+    preferences.end();
+    host::powerCycle();
+    CHECK(preferences.begin("test", true));
+    CHECK_EQ(preferences.getUInt("n", 0), 7);
+    CHECK_EQ(preferences.putUInt("n", 8), 0);   // Lecture seule
+    preferences.end();
+}
+
+TEST_CASE(eeprom_commit_rewrites_whole_sector) {
+    CHECK(EEPROM.begin(64));
+    EEPROM.write(0, 1);
+    EEPROM.write(63, 2);
+    CHECK(EEPROM.commit());
+    CHECK_EQ(host::eepromCommitCount(), 1);
+    CHECK(EEPROM.commit());                     // Rien de modifié: pas d'effacement
+    CHECK_EQ(host::eepromCommitCount(), 1);
+
+    EEPROM.write(0, 3);
+    host::eepromPowerLossAfter(10);
+    CHECK(!EEPROM.commit());
+    CHECK(EEPROM.begin(64));
+    CHECK_EQ(EEPROM.read(0), 3);
+    CHECK_EQ(EEPROM.read(63), 0xFF);            // Effacé, jamais réécrit
+    EEPROM.end();
+}
+
+TEST_CASE(littlefs_refuses_writes_beyond_capacity) {
+    host::setLittleFSCapacity(8);
+    CHECK(LittleFS.begin());
+    File file = LittleFS.open("/a", "w");
+    CHECK(file);
+    CHECK_EQ(file.write((const uint8_t*)"0123456789", 10), 8);
+    file.close();
+    CHECK(!LittleFS.open("/b", "r"));
+    file = LittleFS.open("/a", "r");
+    uint8_t buffer[16];
+    CHECK_EQ(file.read(buffer, sizeof(buffer)), 8);
+    CHECK(LittleFS.remove("/a"));
+    CHECK(!LittleFS.exists("/a"));
+}
+
+TEST_CASE(web_server_records_chunks) {
+    WebServer server(80);
+    server.on("/", HTTP_GET, [&server] {
+        server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+        server.send(200, "text/html", "");
+        server.sendContent("abc", 3);
+        server.sendContent("de", 2);
+        server.sendContent("", 0);
+    });
+    const WebServer::Response& response = server.request(HTTP_GET, "/");
+    CHECK_EQ(response.code, 200);
+    CHECK(response.chunked && response.finished);
+    CHECK_EQ(response.chunks.size(), 2);
+    CHECK(response.body == "abcde");
+    CHECK_EQ(server.request(HTTP_GET, "/absent").code, 404);
+}
+
+TEST_CASE(wifi_joins_after_delay) {
+    host::setWiFiJoinDelay(2000);
+    WiFi.mode(WIFI_STA);
+    WiFi.begin("ssid", "pass");
+    CHECK(WiFi.status() != WL_CONNECTED);
+    host::advance(2000);
+    CHECK(WiFi.status() == WL_CONNECTED);
+    host::setWiFi(false);
+    CHECK(WiFi.status() != WL_CONNECTED);
+
+    host::setWiFi(true);
+    host::setDnsEntry("broker.local", IPAddress(10, 0, 0, 2));
+    IPAddress ip;
+    CHECK(WiFi.hostByName("broker.local", ip));
+    CHECK(ip == IPAddress(10, 0, 0, 2));
+    host::setDnsFailure(true);
+    CHECK(!WiFi.hostByName("broker.local", ip));
+}
+
+TEST_CASE(heap_counter_sees_allocations) {
+    host::HeapStats before = host::heapStats();
+    void* block = malloc(1000);
+    host::HeapStats during = host::heapStats();
+    free(block);
+    host::HeapStats after = host::heapStats();
+    CHECK_EQ(during.allocations - before.allocations, 1);
+    CHECK(during.liveBytes - before.liveBytes >= 1000);
+    CHECK_EQ(after.liveBytes, before.liveBytes);
+    CHECK(ESP.getFreeHeap() > 0);
+}
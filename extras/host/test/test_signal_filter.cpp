@@ -0,0 +1,181 @@
+// Chaîne de filtrage analogique (médiane → moyenne exponentielle → étalonnage) rejouée
+// sur les traces de test/traces/: une trame ADC par ligne, avec le niveau de référence.
+// Les traces sont générées par tools/make_traces.py; une capture réelle au même format
+// se rejoue de la même façon.
+
+#include "HostTest.h"
+
+#include <AnalogAcquisition.h>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Frame {
+    uint16_t reference;
+    uint16_t sample;
+};
+
+std::vector<Frame> loadTrace(const char* name) {
+    std::vector<Frame> frames;
+    std::ifstream file(std::string(RONOBOX_TRACE_DIR) + "/" + name);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        size_t comma = line.find(',');
+        if (comma == std::string::npos) continue;
+        frames.push_back({ (uint16_t)atoi(line.c_str()), (uint16_t)atoi(line.c_str() + comma + 1) });
+    }
+    return frames;
+}
+
+// Écart de la sortie filtrée à la référence, une fois la médiane remplie
+struct Error {
+    double maxAbs = 0;
+    double mean = 0;
+    double rms = 0;
+};
+
+template <typename Filter>
+Error replay(const std::vector<Frame>& trace, Filter filter, size_t from = 0, size_t to = SIZE_MAX) {
+    Error error;
+    size_t count = 0;
+    for (size_t i = 0; i < trace.size() && i < to; i++) {
+        int output = filter(trace[i].sample);
+        if (i < from || i < AnalogFilterChain::MEDIAN_WINDOW) continue;
+        double difference = output - trace[i].reference;
+        error.maxAbs = std::max(error.maxAbs, std::fabs(difference));
+        error.mean += difference;
+        error.rms += difference * difference;
+        count++;
+    }
+    if (count > 0) {
+        error.mean /= count;
+        error.rms = std::sqrt(error.rms / count);
+    }
+    return error;
+}
+
+// Bruit de la trace elle-même, hors parasites (écart à la référence)
+Error inputError(const std::vector<Frame>& trace, size_t from = 0, size_t to = SIZE_MAX) {
+    return replay(trace, [](uint16_t sample) { return (int)sample; }, from, to);
+}
+
+const CalibrationPoint GAS_CURVE[] = { {0, 0}, {4095, 100} };
+const CalibrationPoint SOIL_MOISTURE_CURVE[] = { {0, 100}, {4095, 0} };
+
+} // namespace
+
+TEST_CASE(traces_are_present) {
+    CHECK_EQ(loadTrace("gas_step.csv").size(), 1000);
+    CHECK_EQ(loadTrace("water_level_glitches.csv").size(), 600);
+    CHECK_EQ(loadTrace("soil_drying.csv").size(), 2000);
+}
+
+// MQ2 (lissage 1/4, comme dans mainCode): les parasites 0/4095 n'atteignent pas la
+// sortie, la fuite est suivie en quelques trames
+TEST_CASE(gas_trace_rejects_spikes_and_follows_step) {
+    std::vector<Frame> trace = loadTrace("gas_step.csv");
+    REQUIRE(trace.size() == 1000);
+    const size_t step = 500;
+
+    AnalogFilterChain chain;
+    chain.configure(GAS_CURVE, 2, 2);
+    Error before = replay(trace, [&](uint16_t sample) { chain.push(sample); return (int)chain.raw(); }, 0, step);
+    CHECK(before.maxAbs <= 15);
+
+    // Même lissage sans médiane: chaque parasite décale la sortie de centaines de LSB
+    EmaFilter emaOnly(2);
+    Error withoutMedian = replay(trace, [&](uint16_t sample) { return (int)emaOnly.push(sample); }, 0, step);
+    CHECK(withoutMedian.maxAbs > 200);
+
+    // Après la fuite: 90 % du saut atteint en moins de 200 ms (20 trames)
+    size_t settled = 0;
+    for (size_t i = step; i < trace.size(); i++) {
+        chain.push(trace[i].sample);
+        if (!settled && chain.raw() >= 410 + (2050 - 410) * 9 / 10) settled = i - step + 1;
+    }
+    CHECK(settled > 0);
+    CHECK(settled <= 20);
+    CHECK_NEAR(chain.value(), 2050 * 100.0f / 4095, 0.5f);
+
+    // Nouvelle chaîne sur toute la trace, écart mesuré une fois la fuite établie
+    AnalogFilterChain replayed;
+    replayed.configure(GAS_CURVE, 2, 2);
+    Error after = replay(trace, [&](uint16_t sample) { replayed.push(sample); return (int)replayed.raw(); }, step + 50);
+    CHECK(after.maxAbs <= 15);
+}
+
+// Pointes de commutation d'une trame: la médiane les supprime complètement
+TEST_CASE(water_level_trace_ignores_glitches) {
+    std::vector<Frame> trace = loadTrace("water_level_glitches.csv");
+    REQUIRE(!trace.empty());
+
+    AnalogFilterChain chain;
+    chain.configure(nullptr, 0, 3);
+    Error input = inputError(trace);
+    Error output = replay(trace, [&](uint16_t sample) { chain.push(sample); return (int)chain.raw(); });
+
+    CHECK(input.maxAbs >= 800);
+    CHECK(output.maxAbs <= 8);
+    CHECK(chain.ready());
+    CHECK_EQ(chain.sampleCount(), trace.size());
+}
+
+// Dérive lente (sol qui sèche, lissage 1/16): bruit divisé par plus de 2, retard de
+// la moyenne exponentielle borné à quelques LSB sur la rampe
+TEST_CASE(soil_trace_smooths_noise_with_small_lag) {
+    std::vector<Frame> trace = loadTrace("soil_drying.csv");
+    REQUIRE(!trace.empty());
+
+    AnalogFilterChain chain;
+    chain.configure(SOIL_MOISTURE_CURVE, 2, 4);
+    const size_t warmup = 100;   // Rattrapage du premier échantillon
+    Error input = inputError(trace, warmup);
+    Error output = replay(trace, [&](uint16_t sample) { chain.push(sample); return (int)chain.raw(); }, warmup);
+
+    printf("{\"name\":\"signal_filter_soil\",\"target\":\"%s\",\"input_rms\":%.2f,\"output_rms\":%.2f,"
+           "\"lag_lsb\":%.2f}\n",
+           RonoBoxPlatform::name(), input.rms, output.rms, output.mean);
+
+    CHECK(output.rms < input.rms / 2);
+    CHECK(std::fabs(output.mean) <= 6);   // Sortie en retard: au-dessus d'une rampe descendante
+    CHECK(output.mean >= 0);
+    // Étalonnage inversé: 0 → 100 %, 4095 → 0 %
+    CHECK_NEAR(chain.value(), 100.0f - chain.raw() * 100.0f / 4095, 0.01f);
+}
+
+// Trace rejouée par l'ADC simulé: une conversion par milliseconde dans update(),
+// `oversample` conversions moyennées par trame
+TEST_CASE(acquisition_replays_trace_through_adc) {
+    std::vector<Frame> trace = loadTrace("gas_step.csv");
+    REQUIRE(!trace.empty());
+    const uint8_t pin = 34;
+    const uint8_t oversample = 4;
+
+    AnalogAcquisition adc;
+    int gas = adc.addChannel(pin, GAS_CURVE, 2, 2);
+    REQUIRE(gas == 0);
+    REQUIRE(adc.begin(oversample));
+
+    AnalogFilterChain reference;
+    reference.configure(GAS_CURVE, 2, 2);
+    host::setClock(1);   // update() ne convertit pas pendant la milliseconde 0
+    for (const Frame& frame : trace) {
+        host::setAnalog(pin, frame.sample);
+        for (uint8_t i = 0; i < oversample; i++) {
+            adc.update();
+            adc.update();   // Même milliseconde: pas de seconde conversion
+            host::advance(1);
+        }
+        reference.push(frame.sample);
+        if (adc.raw(gas) != reference.raw()) break;
+    }
+    CHECK_EQ(adc.sampleCount(gas), trace.size());
+    CHECK_EQ(adc.raw(gas), reference.raw());
+    CHECK_NEAR(adc.value(gas), reference.value(), 0.001f);
+    CHECK(adc.ready(gas));
+}
@@ -0,0 +1,250 @@
+// Tampon de télémétrie hors ligne (TelemetryBuffer) et son débordement en flash
+// (LittleFSSpill sur le LittleFS émulé), puis scénario de coupure du broker: les
+// mesures de gaz de Sentinel prises pendant la coupure sont rejouées dans l'ordre,
+// à débit limité, une fois le broker revenu.
+
+#include "DeviceHarness.h"
+
+#include <LittleFS.h>
+#include <LittleFSSpill.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace {
+
+const IPAddress BROKER(10, 0, 0, 2);
+const uint8_t CAPACITY = TelemetryBuffer::CAPACITY;
+
+void pushNumbered(TelemetryBuffer& buffer, int from, int to) {
+    for (int i = from; i < to; i++) {
+        char payload[12];
+        snprintf(payload, sizeof(payload), "%d", i);
+        buffer.push(i * 1000, 0, payload);
+    }
+}
+
+// Vide le tampon dans l'ordre de peek()
+std::vector<int> drain(TelemetryBuffer& buffer) {
+    std::vector<int> values;
+    TelemetrySample sample;
+    while (buffer.peek(sample)) {
+        values.push_back(atoi(sample.payload));
+        buffer.pop();
+    }
+    return values;
+}
+
+bool consecutive(const std::vector<int>& values, int first) {
+    for (size_t i = 0; i < values.size(); i++) {
+        if (values[i] != first + (int)i) return false;
+    }
+    return true;
+}
+
+constexpr DeviceEntity MODEL[] = {
+    alertEntity(sensorEntity("salon", "gaz", "", "ppm", "Détection de gaz (MQ2)")),
+};
+
+} // namespace
+
+TEST_CASE(ram_buffer_drops_oldest_by_default) {
+    TelemetryBuffer buffer;
+    pushNumbered(buffer, 0, CAPACITY + 5);
+    CHECK_EQ(buffer.getBufferedCount(), CAPACITY);
+    CHECK_EQ(buffer.getDroppedCount(), 5);
+
+    std::vector<int> values = drain(buffer);
+    REQUIRE(values.size() == CAPACITY);
+    CHECK(consecutive(values, 5));
+    CHECK(buffer.isEmpty());
+}
+
+TEST_CASE(ram_buffer_can_keep_oldest) {
+    TelemetryBuffer buffer;
+    buffer.setDropPolicy(DROP_NEWEST);
+    pushNumbered(buffer, 0, CAPACITY + 5);
+    CHECK_EQ(buffer.getDroppedCount(), 5);
+
+    std::vector<int> values = drain(buffer);
+    REQUIRE(values.size() == CAPACITY);
+    CHECK(consecutive(values, 0));
+}
+
+TEST_CASE(oversized_payload_is_counted_as_dropped) {
+    TelemetryBuffer buffer;
+    CHECK(!buffer.push(0, 0, "0123456789abcdef"));
+    CHECK_EQ(buffer.getDroppedCount(), 1);
+    CHECK(buffer.isEmpty());
+}
+
+// RAM pleine: la moitié la plus ancienne part en flash en une écriture; l'ordre
+// global est conservé (flash d'abord, puis RAM) et rien n'est perdu
+TEST_CASE(spill_keeps_order_with_one_write_per_batch) {
+    LittleFS.begin();
+    LittleFSSpill spill;
+    TelemetryBuffer buffer;
+    REQUIRE(buffer.setSpill(&spill));
+
+    const int total = CAPACITY * 4;
+    unsigned writes = host::littleFSWriteCount();
+    pushNumbered(buffer, 0, total);
+    CHECK_EQ(buffer.getDroppedCount(), 0);
+    CHECK_EQ(buffer.getBufferedCount(), total);
+    CHECK_EQ(buffer.getSpilledCount(), total - CAPACITY / 2 - CAPACITY / 2);
+    CHECK_EQ(host::littleFSWriteCount() - writes, buffer.getSpilledCount() / (CAPACITY / 2));
+
+    std::vector<int> values = drain(buffer);
+    REQUIRE(values.size() == (size_t)total);
+    CHECK(consecutive(values, 0));
+    CHECK_EQ(host::littleFSUsedBytes(), 0);   // Journal supprimé une fois relu
+}
+
+// Journal flash plein (maxBytes): retour à la politique de perte de la RAM
+TEST_CASE(full_spill_falls_back_to_drop_policy) {
+    LittleFS.begin();
+    const uint32_t batchBytes = CAPACITY / 2 * sizeof(TelemetrySample);
+    LittleFSSpill spill("/telemetry.bin", 2 * batchBytes);
+    TelemetryBuffer buffer;
+    REQUIRE(buffer.setSpill(&spill));
+
+    pushNumbered(buffer, 0, CAPACITY * 3);
+    CHECK_EQ(buffer.getSpilledCount(), CAPACITY);
+    CHECK_EQ(buffer.getBufferedCount(), CAPACITY * 2);
+    CHECK_EQ(buffer.getDroppedCount(), CAPACITY);
+
+    // Les plus anciennes de la RAM ont laissé leur place: la flash garde 0..CAPACITY-1,
+    // la RAM les CAPACITY dernières
+    std::vector<int> values = drain(buffer);
+    REQUIRE(values.size() == (size_t)CAPACITY * 2);
+    CHECK(consecutive(std::vector<int>(values.begin(), values.begin() + CAPACITY), 0));
+    CHECK(consecutive(std::vector<int>(values.begin() + CAPACITY, values.end()), CAPACITY * 2));
+}
+
+// Flash presque pleine: le deuxième lot n'est écrit qu'en partie (LittleFS émulé plus
+// petit que deux lots, reste non multiple d'un échantillon). Il est refusé, et le lot
+// suivant, une fois la place revenue, se relit aux bons emplacements
+TEST_CASE(short_write_leaves_spill_consistent) {
+    LittleFS.begin();
+    const uint32_t batchBytes = CAPACITY / 2 * sizeof(TelemetrySample);
+    host::setLittleFSCapacity(batchBytes + batchBytes / 2 + 3);
+    LittleFSSpill spill;
+    TelemetryBuffer buffer;
+    REQUIRE(buffer.setSpill(&spill));
+
+    pushNumbered(buffer, 0, CAPACITY + CAPACITY / 2);
+    CHECK_EQ(buffer.getSpilledCount(), CAPACITY / 2);
+    pushNumbered(buffer, CAPACITY + CAPACITY / 2, CAPACITY * 2);
+    CHECK_EQ(buffer.getSpilledCount(), CAPACITY / 2);
+    CHECK(host::littleFSUsedBytes() > batchBytes);   // Octets du lot tronqué restés en flash
+    CHECK_EQ(buffer.getDroppedCount(), CAPACITY / 2);
+
+    host::setLittleFSCapacity(64 * 1024);
+    pushNumbered(buffer, CAPACITY * 2, CAPACITY * 3);
+    CHECK_EQ(buffer.getSpilledCount(), CAPACITY * 3 / 2);
+
+    // Chaque échantillon relu est entier: horodatage, voie et valeur concordent
+    TelemetrySample sample;
+    std::vector<int> values;
+    bool intact = true;
+    while (buffer.peek(sample)) {
+        int value = atoi(sample.payload);
+        if (sample.timestamp != (uint32_t)value * 1000 || sample.channel != 0) intact = false;
+        values.push_back(value);
+        buffer.pop();
+    }
+    CHECK(intact);
+    REQUIRE(values.size() == (size_t)CAPACITY * 3 - CAPACITY / 2);
+    CHECK(consecutive(std::vector<int>(values.begin(), values.begin() + CAPACITY / 2), 0));
+    CHECK(std::is_sorted(values.begin(), values.end()));
+    CHECK_EQ(values.back(), CAPACITY * 3 - 1);
+    CHECK_EQ(host::littleFSUsedBytes(), 0);
+}
+
+// Démarrage: les horodatages millis() d'avant le redémarrage n'ont plus de sens,
+// le journal laissé en flash est effacé
+TEST_CASE(spill_is_cleared_at_boot) {
+    LittleFS.begin();
+    {
+        LittleFSSpill spill;
+        TelemetryBuffer buffer;
+        REQUIRE(buffer.setSpill(&spill));
+        pushNumbered(buffer, 0, CAPACITY * 2);
+        CHECK(host::littleFSUsedBytes() > 0);
+    }
+    LittleFSSpill spill;
+    TelemetryBuffer buffer;
+    REQUIRE(buffer.setSpill(&spill));
+    CHECK(buffer.isEmpty());
+    CHECK_EQ(host::littleFSUsedBytes(), 0);
+}
+
+// Broker arrêté pendant 2 minutes, une mesure de gaz par seconde (comme Sentinel),
+// avec débordement en flash: toutes les mesures arrivent après le redémarrage du
+// broker, dans l'ordre, sur ".../gaz/backlog", au plus 5 toutes les 100 ms
+TEST_CASE(broker_outage_replays_every_sample) {
+    LittleFS.begin();
+    LittleFSSpill spill;
+    DeviceHarness<> harness;
+    harness.device.setModel(MODEL);
+    harness.device.setDiagnosticsInterval(0);
+    REQUIRE(harness.device.getTelemetryBuffer().setSpill(&spill));
+    harness.device.begin(BROKER);
+    REQUIRE(harness.runUntilOnline());
+
+    int reading = 100;
+    auto measure = [&] {
+        harness.device.publishSensorData("salon", "gaz", reading++);
+        harness.run(1000);
+    };
+    for (int i = 0; i < 5; i++) measure();
+    const std::string state = harness.topic("salon", "gaz");
+    const std::string backlog = harness.topic("salon", "gaz", "backlog");
+    CHECK_EQ(harness.broker.on(state).size(), 5);
+
+    // Arrêt du broker
+    harness.broker.refuseConnections(true);
+    harness.broker.dropLink();
+    const int firstLost = reading;
+    for (int i = 0; i < 120; i++) measure();
+    const int outageSamples = reading - firstLost;
+    TelemetryBuffer& buffer = harness.device.getTelemetryBuffer();
+    CHECK(harness.device.getLinkState() != LINK_ONLINE);
+    CHECK_EQ(buffer.getBufferedCount(), outageSamples);
+    CHECK(buffer.getSpilledCount() > 0);   // 120 mesures: la RAM seule ne suffit pas
+    CHECK_EQ(buffer.getDroppedCount(), 0);
+
+    // Redémarrage: vidage à débit limité, mesuré par fenêtres de 100 ms
+    harness.broker.refuseConnections(false);
+    REQUIRE(harness.runUntilOnline(70000));
+    size_t previous = harness.broker.on(backlog).size();
+    size_t maxPerWindow = 0;
+    for (int window = 0; window < 100 && !buffer.isEmpty(); window++) {
+        harness.run(100);
+        size_t now = harness.broker.on(backlog).size();
+        maxPerWindow = std::max(maxPerWindow, now - previous);
+        previous = now;
+    }
+    harness.run(200);
+    CHECK(buffer.isEmpty());
+    CHECK(maxPerWindow <= 5);
+    CHECK_EQ(harness.device.getForwardedCount(), outageSamples);
+    CHECK_EQ(host::littleFSUsedBytes(), 0);
+
+    std::vector<const FakeBroker::Message*> replayed = harness.broker.on(backlog);
+    REQUIRE(replayed.size() == (size_t)outageSamples);
+    long lastAge = -1;
+    for (int i = 0; i < outageSamples; i++) {
+        int value = 0;
+        long age = 0;
+        REQUIRE(sscanf(replayed[i]->payload.c_str(), "{\"value\":\"%d\",\"age_ms\":%ld}", &value, &age) == 2);
+        CHECK_EQ(value, firstLost + i);
+        if (lastAge >= 0) CHECK(age < lastAge);   // Du plus ancien au plus récent
+        lastAge = age;
+    }
+
+    // Le topic d'état reçoit la dernière valeur dès la reconnexion
+    const FakeBroker::Message* last = harness.broker.last(state);
+    REQUIRE(last != nullptr);
+    CHECK_EQ(atoi(last->payload.c_str()), reading - 1);
+}
@@ -0,0 +1,124 @@
+// Topics construits dans des tampons de pile à partir du topic de base mis en cache:
+// même format qu'avant, et plus aucune allocation par publication en régime établi
+
+#include "HostTest.h"
+#include "FakeBroker.h"
+
+#include <MQTTDevice.h>
+
+static const char* MAC = "A1B2C3D4E5F6";
+
+static std::string expected(const char* location, const char* device, const char* type) {
+    std::string topic = "home/";
+    if (location[0] != '\0') topic += std::string(location) + "/";
+    topic += std::string(RonoBoxPlatform::name()) + "-" + MAC + "/" + device + "/" + type;
+    return topic;
+}
+
+TEST_CASE(topics_keep_legacy_format) {
+    FakeBroker broker;
+    RonoBoxMQTT mqtt(broker);
+    MQTTTopicManager topics(mqtt, MAC);
+    char topic[MQTTTopicManager::MAX_TOPIC_LENGTH];
+
+    CHECK(topics.buildTopic(topic, sizeof(topic), "salon", "temperature", "state") > 0);
+    CHECK_STR(topic, expected("salon", "temperature", "state").c_str());
+    CHECK(topics.buildTopic(topic, sizeof(topic), "", "diagnostics", "state") > 0);
+    CHECK_STR(topic, expected("", "diagnostics", "state").c_str());
+
+    // Interface String conservée pour les sketches
+    CHECK_STR(topics.getTopic("cuisine", "gaz", "state").c_str(), expected("cuisine", "gaz", "state").c_str());
+    CHECK_STR(topics.getBaseTopic("cuisine").c_str(), ("home/cuisine/" + std::string(RonoBoxPlatform::name()) +
+                                                       "-" + MAC).c_str());
+}
+
+TEST_CASE(locations_beyond_cache_are_still_correct) {
+    FakeBroker broker;
+    RonoBoxMQTT mqtt(broker);
+    MQTTTopicManager topics(mqtt, MAC);
+    const char* locations[] = { "salon", "cuisine", "chambre", "garage", "cave", "grenier" };
+    char topic[MQTTTopicManager::MAX_TOPIC_LENGTH];
+
+    for (int round = 0; round < 2; round++) {
+        for (const char* location : locations) {
+            CHECK(topics.buildTopic(topic, sizeof(topic), location, "lampe", "set") > 0);
+            CHECK_STR(topic, expected(location, "lampe", "set").c_str());
+        }
+    }
+}
+
+TEST_CASE(too_small_buffer_yields_empty_topic) {
+    FakeBroker broker;
+    RonoBoxMQTT mqtt(broker);
+    MQTTTopicManager topics(mqtt, MAC);
+    std::string full = expected("salon", "temperature", "state");
+    std::vector<char> topic(full.size());   // Pas de place pour le '\0'
+
+    CHECK_EQ(topics.buildTopic(topic.data(), topic.size(), "salon", "temperature", "state"), 0);
+    CHECK_EQ(topic[0], '\0');
+    topic.resize(full.size() + 1);
+    CHECK_EQ(topics.buildTopic(topic.data(), topic.size(), "salon", "temperature", "state"), full.size());
+}
+
+TEST_CASE(build_topic_does_not_allocate) {
+    FakeBroker broker;
+    RonoBoxMQTT mqtt(broker);
+    MQTTTopicManager topics(mqtt, MAC);
+    const char* locations[] = { "salon", "cuisine", "chambre", "garage", "cave" };
+    char topic[MQTTTopicManager::MAX_TOPIC_LENGTH];
+
+    uint64_t allocations = host::countAllocations([&] {
+        for (int i = 0; i < 100; i++) {
+            topics.buildTopic(topic, sizeof(topic), locations[i % 5], "temperature", "state");
+        }
+    });
+    CHECK_EQ(allocations, 0);
+}
+
+constexpr DeviceEntity MODEL[] = {
+    sensorEntity("salon", "temperature", "temperature", "°C", "Température Salon", 1),
+    sensorEntity("salon", "humidity", "humidity", "%", "Humidité Salon", 0),
+    binarySensorEntity("salon", "motion", "motion", "Mouvement Salon"),
+    sensorEntity("cuisine", "gaz", "gas", "%", "Gaz Cuisine", 0),
+};
+
+// Boucle de mainCode: six mesures par seconde, toutes publiées (elles changent à chaque tour)
+TEST_CASE(steady_state_publish_does_not_allocate) {
+    FakeBroker broker;
+    host::routeWiFiClients(&broker);
+    WiFi.mode(WIFI_STA);
+    WiFi.begin("ssid", "password");
+
+    MQTTDevice device(MAC);
+    device.setModel(MODEL);
+    device.setDiagnosticsInterval(0);
+    device.begin(IPAddress(10, 0, 0, 2));
+    REQUIRE(HostTest::runUntil([&] { device.handle(); },
+                               [&] { return device.getLinkState() == LINK_ONLINE; }, 10000));
+
+    broker.setRecording(false);
+    int tick = 0;
+    auto second = [&] {
+        tick++;
+        device.publishSensorData("salon", "temperature", 20.0f + (tick % 10) * 0.1f);
+        device.publishSensorData("salon", "humidity", 40 + tick % 7);
+        device.publishSensorData("salon", "motion", tick % 2 == 0);
+        device.publishSensorData("cuisine", "gaz", (float)(tick % 50));
+        device.publishSensorData("cuisine", "temperature", 22.0f + (tick % 3));
+        device.publishSensorData("", "uptime", (int)tick);
+        for (int i = 0; i < 10; i++) {
+            device.handle();
+            host::advance(100);
+        }
+    };
+
+    for (int i = 0; i < 5; i++) second();   // Caches et canaux créés
+    size_t before = broker.publishCount();
+    uint64_t allocations = host::countAllocations([&] {
+        for (int i = 0; i < 60; i++) second();
+    });
+    CHECK_EQ(allocations, 0);
+    CHECK(broker.publishCount() - before >= 60 * 5);
+    CHECK_EQ(device.getFailedPublishCount(), 0);
+    host::routeWiFiClients(nullptr);
+}
@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+# Génère les traces de test/traces/ rejouées par test_signal_filter.
+#
+# Une trame par ligne, comme les livre l'ADC en mode continu (100 trames/s, chaque
+# trame étant déjà la moyenne de 64 conversions): "référence,échantillon".
+# La référence est le niveau sans bruit, l'échantillon ce que reçoit la chaîne de
+# filtrage. Les traces sont synthétiques (graine fixe); une capture réelle au même
+# format, avec la référence mesurée à part, peut être ajoutée à côté.
+#
+#   python3 extras/host/tools/make_traces.py
+
+import os
+import random
+
+FRAMES_PER_SECOND = 100
+HERE = os.path.dirname(os.path.abspath(__file__))
+OUTPUT = os.path.join(HERE, "..", "test", "traces")
+
+
+def clamp(value):
+    return max(0, min(4095, int(round(value))))
+
+
+def write(name, description, rows):
+    with open(os.path.join(OUTPUT, name), "w") as out:
+        out.write("# %s\n" % description)
+        out.write("# référence,échantillon (trames ADC 12 bits, %d/s)\n" % FRAMES_PER_SECOND)
+        for reference, sample in rows:
+            out.write("%d,%d\n" % (reference, sample))
+
+
+def gas_step(rng):
+    # MQ2: air propre puis fuite à t = 5 s, bruit de 6 LSB et parasites isolés
+    rows = []
+    for frame in range(10 * FRAMES_PER_SECOND):
+        reference = 410 if frame < 5 * FRAMES_PER_SECOND else 2050
+        sample = reference + rng.gauss(0, 6)
+        if rng.random() < 0.02:
+            sample = rng.choice([0, 4095])
+        rows.append((reference, clamp(sample)))
+    return rows
+
+
+def water_level_glitches(rng):
+    # Niveau stable, pompe qui commute: une pointe d'une trame toutes les 0,5 s
+    rows = []
+    for frame in range(6 * FRAMES_PER_SECOND):
+        reference = 2480
+        sample = reference + rng.gauss(0, 4)
+        if frame % (FRAMES_PER_SECOND // 2) == 25:
+            sample = reference + rng.choice([-1, 1]) * rng.randint(800, 1600)
+        rows.append((reference, clamp(sample)))
+    return rows
+
+
+def soil_drying(rng):
+    # Sol qui sèche lentement: rampe de 3100 à 2600 en 20 s, bruit de 12 LSB
+    rows = []
+    frames = 20 * FRAMES_PER_SECOND
+    for frame in range(frames):
+        reference = 3100 - 500 * frame / frames
+        rows.append((int(round(reference)), clamp(reference + rng.gauss(0, 12))))
+    return rows
+
+
+if __name__ == "__main__":
+    rng = random.Random(20260417)
+    write("gas_step.csv", "Synthétique: MQ2, fuite de gaz à t = 5 s, parasites 0/4095", gas_step(rng))
+    write("water_level_glitches.csv", "Synthétique: niveau d'eau stable, pointes de commutation",
+          water_level_glitches(rng))
+    write("soil_drying.csv", "Synthétique: humidité du sol en baisse lente", soil_drying(rng))
@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+# Broker MQTT 3.1.1 minimal pour test_broker_conformance quand mosquitto n'est pas
+# installé. Couvre ce qu'utilise RonoBoxMQTT: CONNECT (dernière volonté, session
+# propre), PUBLISH QoS0/QoS1 avec PUBACK, messages retenus, SUBSCRIBE/UNSUBSCRIBE
+# avec jokers + et #, PINGREQ, DISCONNECT, et fermeture après 1,5 keepalive de
+# silence. Pas de session persistante ni de QoS2 (refusée au SUBSCRIBE par 0x01 max).
+#
+#   python3 extras/host/tools/mini_broker.py --port 1883
+
+import argparse
+import asyncio
+
+CONNECT, CONNACK, PUBLISH, PUBACK = 1, 2, 3, 4
+SUBSCRIBE, SUBACK, UNSUBSCRIBE, UNSUBACK = 8, 9, 10, 11
+PINGREQ, PINGRESP, DISCONNECT = 12, 13, 14
+
+
+def encode_length(length):
+    out = bytearray()
+    while True:
+        digit = length % 128
+        length //= 128
+        out.append(digit | (0x80 if length else 0))
+        if not length:
+            return bytes(out)
+
+
+def string(data):
+    return len(data).to_bytes(2, "big") + data
+
+
+def matches(pattern, topic):
+    pattern_levels = pattern.split("/")
+    topic_levels = topic.split("/")
+    if topic.startswith("$") and pattern_levels[0] in ("+", "#"):
+        return False
+    for i, level in enumerate(pattern_levels):
+        if level == "#":
+            return True
+        if i >= len(topic_levels):
+            return False
+        if level != "+" and level != topic_levels[i]:
+            return False
+    return len(pattern_levels) == len(topic_levels)
+
+
+class Session:
+    def __init__(self, broker, reader, writer):
+        self.broker = broker
+        self.reader = reader
+        self.writer = writer
+        self.subscriptions = {}     # filtre -> QoS accordée
+        self.will = None            # (topic, payload, qos, retained)
+        self.keep_alive = 0
+        self.next_id = 1
+
+    def send(self, packet_type, flags, body):
+        self.writer.write(bytes([(packet_type << 4) | flags]) + encode_length(len(body)) + body)
+
+    def deliver(self, topic, payload, qos, retained):
+        flags = (qos << 1) | (1 if retained else 0)
+        body = string(topic.encode())
+        if qos:
+            body += self.next_id.to_bytes(2, "big")
+            self.next_id = self.next_id % 0xFFFF + 1
+        self.send(PUBLISH, flags, body + payload)
+
+    async def read_packet(self):
+        timeout = self.keep_alive * 1.5 if self.keep_alive else None
+        header = (await asyncio.wait_for(self.reader.readexactly(1), timeout))[0]
+        length, multiplier = 0, 1
+        while True:
+            byte = (await self.reader.readexactly(1))[0]
+            length += (byte & 0x7F) * multiplier
+            if not byte & 0x80:
+                break
+            multiplier *= 128
+            if multiplier > 128 ** 3:
+                raise ValueError("longueur invalide")
+        return header >> 4, header & 0x0F, await self.reader.readexactly(length)
+
+    def handle_connect(self, body):
+        if body[:7] != b"\x00\x04MQTT\x04":
+            self.send(CONNACK, 0, b"\x00\x01")   # Version de protocole refusée
+            return False
+        flags = body[7]
+        self.keep_alive = int.from_bytes(body[8:10], "big")
+        offset = 10
+        client_length = int.from_bytes(body[offset:offset + 2], "big")
+        offset += 2 + client_length
+        if flags & 0x04:
+            topic_length = int.from_bytes(body[offset:offset + 2], "big")
+            topic = body[offset + 2:offset + 2 + topic_length].decode()
+            offset += 2 + topic_length
+            message_length = int.from_bytes(body[offset:offset + 2], "big")
+            message = body[offset + 2:offset + 2 + message_length]
+            self.will = (topic, message, (flags >> 3) & 0x03, bool(flags & 0x20))
+        self.send(CONNACK, 0, b"\x00\x00")
+        return True
+
+    def handle_publish(self, flags, body):
+        qos = (flags >> 1) & 0x03
+        topic_length = int.from_bytes(body[:2], "big")
+        topic = body[2:2 + topic_length].decode()
+        offset = 2 + topic_length
+        if qos:
+            packet_id = body[offset:offset + 2]
+            offset += 2
+        self.broker.publish(topic, body[offset:], qos, bool(flags & 0x01))
+        if qos == 1:
+            self.send(PUBACK, 0, packet_id)
+
+    def handle_subscribe(self, body):
+        packet_id, offset, granted = body[:2], 2, bytearray()
+        while offset < len(body):
+            length = int.from_bytes(body[offset:offset + 2], "big")
+            pattern = body[offset + 2:offset + 2 + length].decode()
+            qos = min(body[offset + 2 + length], 1)
+            offset += 3 + length
+            self.subscriptions[pattern] = qos
+            granted.append(qos)
+        self.send(SUBACK, 0, packet_id + bytes(granted))
+        for topic, (payload, qos) in self.broker.retained.items():
+            for pattern in self.subscriptions:
+                if matches(pattern, topic):
+                    self.deliver(topic, payload, min(qos, self.subscriptions[pattern]), True)
+                    break
+
+    def handle_unsubscribe(self, body):
+        offset = 2
+        while offset < len(body):
+            length = int.from_bytes(body[offset:offset + 2], "big")
+            self.subscriptions.pop(body[offset + 2:offset + 2 + length].decode(), None)
+            offset += 2 + length
+        self.send(UNSUBACK, 0, body[:2])
+
+    async def run(self):
+        clean = False
+        try:
+            packet_type, _, body = await self.read_packet()
+            if packet_type != CONNECT or not self.handle_connect(body):
+                return
+            self.broker.sessions.add(self)
+            while True:
+                packet_type, flags, body = await self.read_packet()
+                if packet_type == PUBLISH:
+                    self.handle_publish(flags, body)
+                elif packet_type == SUBSCRIBE:
+                    self.handle_subscribe(body)
+                elif packet_type == UNSUBSCRIBE:
+                    self.handle_unsubscribe(body)
+                elif packet_type == PINGREQ:
+                    self.send(PINGRESP, 0, b"")
+                elif packet_type == DISCONNECT:
+                    clean = True
+                    return
+                await self.writer.drain()
+        except (asyncio.IncompleteReadError, asyncio.TimeoutError, ConnectionError, ValueError):
+            pass
+        finally:
+            self.broker.sessions.discard(self)
+            if not clean and self.will:
+                self.broker.publish(*self.will)
+            self.writer.close()
+
+
+class Broker:
+    def __init__(self):
+        self.sessions = set()
+        self.retained = {}          # topic -> (payload, QoS)
+
+    def publish(self, topic, payload, qos, retained):
+        if retained:
+            if payload:
+                self.retained[topic] = (payload, qos)
+            else:
+                self.retained.pop(topic, None)
+        for session in list(self.sessions):
+            granted = [q for pattern, q in session.subscriptions.items() if matches(pattern, topic)]
+            if granted:
+                session.deliver(topic, payload, min(qos, max(granted)), False)
+
+    async def accept(self, reader, writer):
+        await Session(self, reader, writer).run()
+
+
+async def serve(host, port):
+    broker = Broker()
+    server = await asyncio.start_server(broker.accept, host, port)
+    async with server:
+        await server.serve_forever()
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Broker MQTT 3.1.1 minimal des tests hôte")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=1883)
+    arguments = parser.parse_args()
+    try:
+        asyncio.run(serve(arguments.host, arguments.port))
+    except KeyboardInterrupt:
+        pass